@@ -3,18 +3,32 @@ CONFIG += console gui opengl thread
 
 INCLUDEPATH += /usr/include/nvidia-current
 
-LIBS+= -lOpenCL -lQtOpenGL
+LIBS+= -lOpenCL -lQtOpenGL -lz
+
+# the split red/black pressure iteration of the CPU solver relies on loop vectorization
+QMAKE_CXXFLAGS_RELEASE += -ftree-vectorize
 
 SOURCES += \
 	src/main.cpp \
 	src/solver/navierStokesCPU.cpp \
 	src/solver/navierStokesGPU.cpp \
+	src/solver/navierStokesMultiGPU.cpp \
+	src/solver/navierStokesHybrid.cpp \
+	src/solver/navierStokesEnsembleCPU.cpp \
     src/inputParser.cpp \
     src/viewer/Viewer.cpp \
     src/viewer/SimplePGMWriter.cpp \
     src/viewer/VTKWriter.cpp \
+    src/viewer/VTIWriter.cpp \
+    src/viewer/AsyncViewer.cpp \
+    src/viewer/TimeSeriesWriter.cpp \
+    src/viewer/TimeSeriesReader.cpp \
+    src/viewer/FieldCompressor.cpp \
+    src/viewer/RegionWriter.cpp \
     src/solver/navierStokesSolver.cpp \
     src/Simulation.cpp \
+    src/Checkpoint.cpp \
+    src/FlowField.cpp \
 	src/ui/MainWindow.cpp \
     src/viewer/GLViewer.cpp \
     src/CLManager.cpp
@@ -22,13 +36,25 @@ SOURCES += \
 HEADERS += \
 	src/solver/navierStokesSolver.h \
 	src/solver/navierStokesGPU.h \
+	src/solver/navierStokesMultiGPU.h \
+	src/solver/navierStokesHybrid.h \
 	src/solver/navierStokesCPU.h \
+	src/solver/navierStokesEnsembleCPU.h \
     src/inputParser.h \
     src/viewer/Viewer.h \
     src/viewer/SimplePGMWriter.h \
     src/viewer/VTKWriter.h \
+    src/viewer/VTIWriter.h \
+    src/viewer/AsyncViewer.h \
+    src/viewer/TimeSeries.h \
+    src/viewer/TimeSeriesWriter.h \
+    src/viewer/TimeSeriesReader.h \
+    src/viewer/FieldCompressor.h \
+    src/viewer/RegionWriter.h \
     src/Definitions.h \
     src/Simulation.h \
+    src/Checkpoint.h \
+    src/FlowField.h \
 	src/ui/MainWindow.h \
     src/Parameters.h \
     src/viewer/GLViewer.h \
@@ -40,6 +66,10 @@ OTHER_FILES += \
     src/kernels/rightHandSide.cl \
     src/kernels/deltaT.cl \
     src/kernels/computeFG.cl \
+    src/kernels/computeFGRHS.cl \
     src/kernels/boundaryConditions.cl \
-    src/kernels/pressure.cl
+    src/kernels/pressure.cl \
+    src/kernels/pressureSplit.cl \
+    src/kernels/obstacles.cl \
+    src/kernels/regionOutput.cl
 
@@ -5,11 +5,39 @@
 #include "CLManager.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdio.h>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+
+// number of benchmark runs of each candidate local range
+#define TUNING_RUNS 3
+
+// number of profiled commands collected before they are evaluated
+#define PROFILE_BATCH 4096
+
+// maximum number of commands in the timeline, the statistics include all
+#define PROFILE_TRACE_LIMIT 1000000
 
 //********************************************************************
 //**    implementation
 //********************************************************************
 
+//============================================================================
+CLCompileThread::CLCompileThread ( CLManager* manager )
+{
+	_manager = manager;
+}
+
+//============================================================================
+void CLCompileThread::run ( )
+{
+	_manager->buildProgram();
+}
+
+
 // -------------------------------------------------
 //	constructor / destructor
 // -------------------------------------------------
@@ -19,19 +47,108 @@ CLManager::CLManager ( Parameters* parameters )
 {
 	_parameters = parameters;
 
+	_compileThread = 0;
+	_clBuildError  = CL_SUCCESS;
+
+	_profiling     = !parameters->profileFile.empty();
+
 	_clWorkgroupSize = 0;
+	_clComputeUnits  = 0;
 
 	try
 	{
 		// create OpenCL platform
 		cl::Platform::get( &_clPlatforms );
-		_clPlatforms[0].getDevices( CL_DEVICE_TYPE_GPU, &_clDevices );
+
+		if( _parameters->clPlatform >= (int)_clPlatforms.size() )
+		{
+			std::cerr << "OpenCL platform " << _parameters->clPlatform << " not found (see -cllist)" << std::endl;
+			throw cl::Error( CL_DEVICE_NOT_FOUND, "clGetPlatformIDs" );
+		}
+
+		cl::Platform& platform = _clPlatforms[_parameters->clPlatform];
+
+		// devices of the requested type
+		std::vector<cl::Device> devices;
+
+		try
+		{
+			if( _parameters->clDeviceType == DEVICE_DEFAULT )
+			{
+				// fall back to any device, e.g. CPU runtimes like pocl
+				try
+				{
+					platform.getDevices( CL_DEVICE_TYPE_GPU, &devices );
+				}
+				catch( cl::Error error )
+				{
+					if( error.err() != CL_DEVICE_NOT_FOUND )
+						throw error;
+
+					platform.getDevices( CL_DEVICE_TYPE_ALL, &devices );
+				}
+			}
+			else
+			{
+				platform.getDevices( getDeviceType( _parameters->clDeviceType ), &devices );
+			}
+		}
+		catch( cl::Error error )
+		{
+			if( error.err() == CL_DEVICE_NOT_FOUND )
+			{
+				std::cerr << "No OpenCL device of the requested type found (see -cllist)" << std::endl;
+			}
+			throw error;
+		}
+
+		// the domain is split into strips across several devices or sub-devices
+		int count = std::max( 1, _parameters->clStrips );
+
+		if( _parameters->clFission != FISSION_NONE )
+		{
+			if( _parameters->clDevice >= (int)devices.size() )
+			{
+				std::cerr << "OpenCL device " << _parameters->clDevice << " not found (see -cllist)" << std::endl;
+				throw cl::Error( CL_DEVICE_NOT_FOUND, "clGetDeviceIDs" );
+			}
+
+			// use parts of the device only
+			_clDevices = createSubDevices( devices[_parameters->clDevice], count );
+		}
+		else
+		{
+			if( _parameters->clDevice + count > (int)devices.size() )
+			{
+				std::cerr << "OpenCL device " << _parameters->clDevice + count - 1 << " not found (see -cllist)" << std::endl;
+				throw cl::Error( CL_DEVICE_NOT_FOUND, "clGetDeviceIDs" );
+			}
+
+			// only the selected devices are used
+			_clDevices = std::vector<cl::Device>( devices.begin() + _parameters->clDevice,
+												  devices.begin() + _parameters->clDevice + count );
+		}
 
 		// create context
 		_clContext = cl::Context( _clDevices );
 
-		// create command queue
-		_clQueue = cl::CommandQueue( _clContext, _clDevices[0] );
+		// create command queues, with timestamps for the profile
+		cl_command_queue_properties properties = _profiling ? CL_QUEUE_PROFILING_ENABLE : 0;
+
+		_clQueue         = cl::CommandQueue( _clContext, _clDevices[0], properties );
+		_clTransferQueue = cl::CommandQueue( _clContext, _clDevices[0], properties );
+
+		_clComputeUnits = _clDevices[0].getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+		_clDevices[0].getInfo( CL_DEVICE_NAME, &_clDeviceName );
+		std::cout << "OpenCL device: " << _clDeviceName << " (" << _clComputeUnits << " compute units)" << std::endl;
+
+		for( unsigned int i = 1; i < _clDevices.size(); ++i )
+		{
+			std::string name;
+			_clDevices[i].getInfo( CL_DEVICE_NAME, &name );
+			std::cout << "OpenCL device: " << name << " (" << _clDevices[i].getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() << " compute units)" << std::endl;
+		}
 	}
 	catch( cl::Error error )
 	{
@@ -43,6 +160,13 @@ CLManager::CLManager ( Parameters* parameters )
 //============================================================================
 CLManager::~CLManager ( )
 {
+	// the program may still be compiled, if the setup was aborted
+	if( _compileThread != 0 )
+	{
+		_compileThread->wait();
+		SAFE_DELETE( _compileThread );
+	}
+
 	// cleanup kernel source
 	for( std::vector<std::string*>::iterator it = _clSourceCode.begin(); it != _clSourceCode.end(); ++it )
 	{
@@ -52,65 +176,166 @@ CLManager::~CLManager ( )
 
 
 // -------------------------------------------------
-//	kernel loading functions
+//	device selection functions
 // -------------------------------------------------
 
 //============================================================================
-void CLManager::loadKernels ( )
+cl_device_type CLManager::getDeviceType ( int type )
 {
-	// TODO: cross platform way to find all files in a directory?
+	switch( type )
+	{
+		case DEVICE_GPU:			return CL_DEVICE_TYPE_GPU;
+		case DEVICE_CPU:			return CL_DEVICE_TYPE_CPU;
+		case DEVICE_ACCELERATOR:	return CL_DEVICE_TYPE_ACCELERATOR;
+		case DEVICE_ALL:			return CL_DEVICE_TYPE_ALL;
+		default:					return CL_DEVICE_TYPE_DEFAULT;
+	}
+}
 
-	#if VERBOSE
-		std::cout << "Compiling kernels..." << std::endl;
-	#endif
+//============================================================================
+std::vector<cl::Device> CLManager::createSubDevices
+	(
+		cl::Device&	device,
+		int			count
+	)
+{
+	#ifdef CL_VERSION_1_2
+		std::vector<cl::Device> subDevices;
 
-	// cl source codes
-	cl::Program::Sources source;
+		cl_device_partition_property properties[3];
 
-	// load simulation kernels from files
-	loadSource ( source, "kernels/auxiliary.cl" );
-	loadSource ( source, "kernels/boundaryConditions.cl" );
-	loadSource ( source, "kernels/deltaT.cl" );
-	loadSource ( source, "kernels/computeFG.cl" );
-	loadSource ( source, "kernels/rightHandSide.cl" );
-	loadSource ( source, "kernels/pressure.cl" );
-	loadSource ( source, "kernels/updateUV.cl" );
+		if( _parameters->clFission == FISSION_NUMA )
+		{
+			properties[0] = CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN;
+			properties[1] = CL_DEVICE_AFFINITY_DOMAIN_NUMA;
+		}
+		else
+		{
+			properties[0] = CL_DEVICE_PARTITION_EQUALLY;
+			properties[1] = _parameters->clFissionUnits;
+		}
+		properties[2] = 0;
 
-	// load visualization kernels from files
+		try
+		{
+			device.createSubDevices( properties, &subDevices );
+		}
+		catch( cl::Error error )
+		{
+			std::cerr << "CL ERROR while partitioning the device: " << error.what() << "(" << error.err() << ")" << std::endl;
+			throw error;
+		}
 
+		if( _parameters->clSubDevice + count > (int)subDevices.size() )
+		{
+			std::cerr << "OpenCL sub-device " << _parameters->clSubDevice + count - 1 << " not found, the device was split into "
+					  << subDevices.size() << " sub-devices" << std::endl;
+			throw cl::Error( CL_DEVICE_NOT_FOUND, "clCreateSubDevices" );
+		}
 
-	// create program
-	_clProgram = cl::Program( _clContext, source );
+		return std::vector<cl::Device>( subDevices.begin() + _parameters->clSubDevice,
+										subDevices.begin() + _parameters->clSubDevice + count );
+	#else
+		std::cerr << "Device fission requires OpenCL 1.2 headers" << std::endl;
+		throw cl::Error( CL_DEVICE_NOT_FOUND, "clCreateSubDevices" );
+	#endif
+}
 
-	// compile opencl source
+//============================================================================
+bool CLManager::listDevices ( )
+{
 	try
 	{
-		_clProgram.build( _clDevices );
+		std::vector<cl::Platform> platforms;
+		cl::Platform::get( &platforms );
+
+		for( unsigned int p = 0; p < platforms.size(); ++p )
+		{
+			std::string info;
+			platforms[p].getInfo( CL_PLATFORM_NAME, &info );
+			std::cout << "Platform " << p << ": " << info;
+			platforms[p].getInfo( CL_PLATFORM_VERSION, &info );
+			std::cout << " (" << info << ")" << std::endl;
+
+			// device indices count per type, as used by -cldevice
+			int types[] = { DEVICE_GPU, DEVICE_CPU, DEVICE_ACCELERATOR };
+			const char* typeNames[] = { "gpu", "cpu", "accelerator" };
+
+			for( int t = 0; t < 3; ++t )
+			{
+				std::vector<cl::Device> devices;
+
+				try
+				{
+					platforms[p].getDevices( getDeviceType( types[t] ), &devices );
+				}
+				catch( cl::Error error )
+				{
+					if( error.err() != CL_DEVICE_NOT_FOUND )
+						throw error;
+				}
+
+				for( unsigned int d = 0; d < devices.size(); ++d )
+				{
+					cl_uint units = devices[d].getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+					devices[d].getInfo( CL_DEVICE_NAME, &info );
+					std::cout << "  " << typeNames[t] << " " << d << ": " << info
+							  << " (" << units << " compute units)" << std::endl;
+				}
+			}
+		}
 	}
 	catch( cl::Error error )
 	{
-		// display kernel compile errors
-		if( error.err() == CL_BUILD_PROGRAM_FAILURE )
-		{
-			std::cerr << "CL kernel build error:" << std::endl <<
-						 _clProgram.getBuildInfo<CL_PROGRAM_BUILD_LOG>( _clDevices[0] ) << std::endl;
-		}
-		else
-		{
-			std::cerr << "CL ERROR while building kernels: " << error.err() << std::endl;
-		}
-		throw error;
+		std::cerr << "CL ERROR while listing devices: " << error.what() << "(" << error.err() << ")" << std::endl;
+		return false;
 	}
 
-	#if VERBOSE
-		std::cout << "Kernels compiled" << std::endl;
-	#endif
+	return true;
+}
+
+
+// -------------------------------------------------
+//	kernel loading functions
+// -------------------------------------------------
+
+//============================================================================
+void CLManager::startCompilation ( )
+{
+	if( _compileThread != 0 )
+	{
+		return;
+	}
+
+	_compileThread = new CLCompileThread( this );
+	_compileThread->start();
+}
+
+//============================================================================
+void CLManager::loadKernels ( )
+{
+	if( _compileThread != 0 )
+	{
+		// compilation was started in the background
+		_compileThread->wait();
+		SAFE_DELETE( _compileThread );
+	}
+	else
+	{
+		buildProgram();
+	}
+
+	if( _clBuildError != CL_SUCCESS )
+	{
+		throw cl::Error( _clBuildError, "clBuildProgram" );
+	}
 
 	//-----------------------
 	// load kernels
 	//-----------------------
 
-		_clKernels = std::vector<cl::Kernel>( 13 );
+		_clKernels = std::vector<cl::Kernel>( 31 );
 
 	#if VERBOSE
 		std::cout << "Binding kernels..." << std::endl;
@@ -124,12 +349,16 @@ void CLManager::loadKernels ( )
 		_clKernels[kernel::setBoundaryAndInterior] =
 				cl::Kernel( _clProgram, "setBoundaryAndInteriorKernel" );
 
-		// boundary condition kernels [2],[3]
-		_clKernels[kernel::setBoundaryConditions] =
-				cl::Kernel( _clProgram, "setBoundaryConditionsKernel"	);
+		// boundary condition kernel [3], the domain boundaries are set by [18],[19]
 		_clKernels[kernel::setArbitraryBoundaryConditions] =
 				cl::Kernel( _clProgram, "setArbitraryBoundaryConditionsKernel" );
 
+		// 1D boundary condition kernels for the domain boundaries [18],[19]
+		_clKernels[kernel::setHorizontalBoundaryConditions] =
+				cl::Kernel( _clProgram, "setHorizontalBoundaryConditionsKernel" );
+		_clKernels[kernel::setVerticalBoundaryConditions] =
+				cl::Kernel( _clProgram, "setVerticalBoundaryConditionsKernel" );
+
 		// problem specific kernel [4]
 		if ( _parameters->problem == "moving_lid" )
 		{
@@ -147,9 +376,11 @@ void CLManager::loadKernels ( )
 			_clKernels[kernel::problemSpecific] = cl::Kernel();
 		}*/
 
-		// kernel to find maximum UV value for delta t computation [5]
+		// kernels to find maximum UV value for delta t computation [5],[14]
 		_clKernels[kernel::getUVMaximum] =
 				cl::Kernel( _clProgram, "getUVMaximumKernel" );
+		_clKernels[kernel::getUVMaximumFinal] =
+				cl::Kernel( _clProgram, "getUVMaximumFinalKernel" );
 
 		// kernels for F and G computation [6],[7]
 		_clKernels[kernel::computeF] = cl::Kernel( _clProgram, "computeF" );
@@ -159,16 +390,54 @@ void CLManager::loadKernels ( )
 		_clKernels[kernel::rightHandSide] =
 				cl::Kernel( _clProgram, "rightHandSideKernel" );
 
-		// kernel for pressure equation step [9],[10],[11]
+		// fused kernel for F, G and the right hand side [17]
+		_clKernels[kernel::computeFGRHS] =
+				cl::Kernel( _clProgram, "computeFGRHSKernel" );
+
+		// kernel for pressure equation step [9],[11],[15],[16],
+		// the pressure boundary values are set by the red/black kernel
 		_clKernels[kernel::gaussSeidelRedBlack] =
 				cl::Kernel( _clProgram, "gaussSeidelRedBlackKernel" );
-		_clKernels[kernel::pressureBoundaryConditions] =
-				cl::Kernel( _clProgram, "pressureBoundaryConditionsKernel" );
 		_clKernels[kernel::pressureResidualReduction] =
 				cl::Kernel( _clProgram, "pressureResidualReductionKernel" );
+		_clKernels[kernel::pressureResidualSum] =
+				cl::Kernel( _clProgram, "pressureResidualSumKernel" );
+		_clKernels[kernel::gaussSeidelRedBlackTiled] =
+				cl::Kernel( _clProgram, "gaussSeidelRedBlackTiledKernel" );
 
 		// kernel for velocity update [12]
 		_clKernels[kernel::updateUV] = cl::Kernel( _clProgram, "updateUVKernel" );
+
+		// kernels for the pressure equation on the split red/black layout [20]-[25]
+		_clKernels[kernel::splitRedBlack] =
+				cl::Kernel( _clProgram, "splitRedBlackKernel" );
+		_clKernels[kernel::splitRedBlackFlag] =
+				cl::Kernel( _clProgram, "splitRedBlackFlagKernel" );
+		_clKernels[kernel::mergeRedBlack] =
+				cl::Kernel( _clProgram, "mergeRedBlackKernel" );
+		_clKernels[kernel::gaussSeidelRedBlackSplit] =
+				cl::Kernel( _clProgram, "gaussSeidelRedBlackSplitKernel" );
+		_clKernels[kernel::pressureResidualSplitReduction] =
+				cl::Kernel( _clProgram, "pressureResidualSplitReductionKernel" );
+		_clKernels[kernel::updateUVSplit] =
+				cl::Kernel( _clProgram, "updateUVSplitKernel" );
+
+		// kernel for interactive obstacle drawing [26]
+		_clKernels[kernel::drawObstacleLine] =
+				cl::Kernel( _clProgram, "drawObstacleLineKernel" );
+
+		// kernels for the device controlled pressure iteration [27]-[30]
+		_clKernels[kernel::gaussSeidelRedBlackControlled] =
+				cl::Kernel( _clProgram, "gaussSeidelRedBlackControlledKernel" );
+		_clKernels[kernel::pressureConvergence] =
+				cl::Kernel( _clProgram, "pressureConvergenceKernel" );
+		_clKernels[kernel::pressureResidualReductionControlled] =
+				cl::Kernel( _clProgram, "pressureResidualReductionControlledKernel" );
+		_clKernels[kernel::pressureResidualSumControlled] =
+				cl::Kernel( _clProgram, "pressureResidualSumControlledKernel" );
+
+		// kernel for region outputs [13]
+		_clKernels[kernel::regionOutput] = cl::Kernel( _clProgram, "regionOutputKernel" );
 	}
 	catch( cl::Error error )
 	{
@@ -177,72 +446,1037 @@ void CLManager::loadKernels ( )
 	}
 
 
-	// get work group size
-	_clWorkgroupSize = _clKernels[0].getWorkGroupInfo< CL_KERNEL_WORK_GROUP_SIZE >( _clDevices[0] );
+	// names for the profile, the problem specific kernel may be missing
+	_clKernelNames = std::vector<std::string>( _clKernels.size() );
+
+	for( unsigned int i = 0; i < _clKernels.size(); ++i )
+	{
+		if( _clKernels[i]() != NULL )
+		{
+			_clKernelNames[i] = _clKernels[i].getInfo<CL_KERNEL_FUNCTION_NAME>();
+		}
+	}
+
+	// work group size for the kernels with explicit local ranges,
+	// the reductions need a power of two
+	int fixedKernels[] = {
+		kernel::getUVMaximum,
+		kernel::getUVMaximumFinal,
+		kernel::pressureResidualReduction,
+		kernel::pressureResidualSum,
+		kernel::pressureResidualSplitReduction,
+		kernel::pressureResidualReductionControlled,
+		kernel::pressureResidualSumControlled,
+		kernel::computeFGRHS,
+		kernel::gaussSeidelRedBlackTiled
+	};
+
+	// with several devices, the size must be supported by all of them
+	int maximum = _clDevices[0].getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+
+	for( unsigned int d = 0; d < _clDevices.size(); ++d )
+	{
+		maximum = std::min( maximum, (int)_clDevices[d].getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>() );
+
+		for( unsigned int i = 0; i < sizeof(fixedKernels) / sizeof(int); ++i )
+		{
+			maximum = std::min( maximum, (int)_clKernels[fixedKernels[i]].getWorkGroupInfo< CL_KERNEL_WORK_GROUP_SIZE >( _clDevices[d] ) );
+		}
+	}
+
+	_clWorkgroupSize = 1;
+	while( 2 * _clWorkgroupSize <= maximum )
+	{
+		_clWorkgroupSize *= 2;
+	}
+
+	// launch configurations are created with the first launch of each kernel
+	_launchConfigs = std::vector< std::vector<LaunchConfig> >( _clKernels.size() );
+
+	if( _parameters->autotune )
+	{
+		loadTuningDatabase();
+	}
 }
 
 //============================================================================
-void CLManager::loadSource
-	(
-		cl::Program::Sources &sources,
-		std::string fileName
-	)
+void CLManager::buildProgram ( )
 {
-	// read file
-	std::ifstream cl_file( fileName.c_str() );
+	// TODO: cross platform way to find all files in a directory?
 
-	// using a pointer and new, because the strings have been deleted to soon and where damaged until compilation
-	// remember to delete them after compilation or in destructor!
-	std::string *cl_sourcecode = new std::string ( std::istreambuf_iterator<char>( cl_file ), (std::istreambuf_iterator<char>()) );
-	_clSourceCode.push_back( cl_sourcecode );
+	#if VERBOSE
+		std::cout << "Compiling kernels..." << std::endl;
+	#endif
 
-	// add it to the source list
-	sources.push_back( std::make_pair( cl_sourcecode->c_str(), cl_sourcecode->length() ) );
+	// cl source codes
+	cl::Program::Sources source;
+
+	// load simulation kernels from files
+	loadSource ( source, "kernels/auxiliary.cl" );
+	loadSource ( source, "kernels/boundaryConditions.cl" );
+	loadSource ( source, "kernels/deltaT.cl" );
+	loadSource ( source, "kernels/computeFG.cl" );
+	loadSource ( source, "kernels/rightHandSide.cl" );
+	loadSource ( source, "kernels/computeFGRHS.cl" );
+	loadSource ( source, "kernels/pressure.cl" );
+	loadSource ( source, "kernels/updateUV.cl" );
+	loadSource ( source, "kernels/pressureSplit.cl" );
+
+	// load interaction kernels from files
+	loadSource ( source, "kernels/obstacles.cl" );
+
+	// load visualization kernels from files
+	loadSource ( source, "kernels/regionOutput.cl" );
+
+
+	_clBuildError   = CL_SUCCESS;
+	_clBuildOptions = getBuildOptions();
+
+	try
+	{
+		std::string key = getCacheKey( source );
+
+		// use binaries of a previous run, if available
+		if( _parameters->kernelCache && loadProgramBinary( key ) )
+		{
+			#if VERBOSE
+				std::cout << "Kernels loaded from cache" << std::endl;
+			#endif
+
+			return;
+		}
+
+		// create program
+		_clProgram = cl::Program( _clContext, source );
+
+		// compile opencl source
+		try
+		{
+			_clProgram.build( _clDevices, _clBuildOptions.c_str() );
+		}
+		catch( cl::Error error )
+		{
+			// display kernel compile errors
+			if( error.err() == CL_BUILD_PROGRAM_FAILURE )
+			{
+				std::cerr << "CL kernel build error:" << std::endl <<
+							 _clProgram.getBuildInfo<CL_PROGRAM_BUILD_LOG>( _clDevices[0] ) << std::endl;
+			}
+			else
+			{
+				std::cerr << "CL ERROR while building kernels: " << error.err() << std::endl;
+			}
+			throw error;
+		}
+
+		if( _parameters->kernelCache )
+		{
+			saveProgramBinary( key );
+		}
+	}
+	catch( cl::Error error )
+	{
+		_clBuildError = error.err();
+		return;
+	}
+
+	#if VERBOSE
+		std::cout << "Kernels compiled" << std::endl;
+	#endif
 }
 
 //============================================================================
-cl::CommandQueue *CLManager::getQueue ( )
+// 64 bit FNV-1a hash, continuing from the given hash value
+static const cl_ulong FNV_OFFSET = 14695981039346656037ULL;
+
+static cl_ulong fnvHash ( const char* data, ::size_t size, cl_ulong hash )
 {
-	return &_clQueue;
+	for( ::size_t i = 0; i < size; ++i )
+	{
+		hash ^= (unsigned char) data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
 }
 
 //============================================================================
-cl::Context *CLManager::getContext()
+// appends the definition of a float constant, exactly representing the value
+static void defineConstant ( std::ostringstream& options, const char* name, CL_REAL value )
 {
-	return &_clContext;
+	options << " -D " << name << "=" << std::scientific << std::setprecision( 8 ) << value << "f";
 }
 
-
-// -------------------------------------------------
-//	kernel execution functions
-// -------------------------------------------------
+//============================================================================
+// appends the definition of an integer constant
+static void defineConstant ( std::ostringstream& options, const char* name, int value )
+{
+	options << " -D " << name << "=" << value;
+}
 
 //============================================================================
-cl::Kernel *CLManager::getKernel ( int kernelID )
+std::string CLManager::getBuildOptions ( )
 {
-	return &(_clKernels[kernelID]);
+	// the strips of the multi-device solver pass their own
+	// row ranges as ny to the reductions, see NavierStokesMultiGPU
+	if( !_parameters->specializeKernels || _parameters->clStrips > 1 )
+	{
+		return "";
+	}
+
+	// the kernels replace their arguments by these constants,
+	// so they must have the same values as the arguments
+	KernelConstants constants( _parameters );
+
+	std::ostringstream options;
+	options << "-D SPECIALIZED";
+
+	defineConstant( options, "CONST_NX",    constants.nx );
+	defineConstant( options, "CONST_NY",    constants.ny );
+	defineConstant( options, "CONST_DX",    _parameters->dx );
+	defineConstant( options, "CONST_DY",    _parameters->dy );
+	defineConstant( options, "CONST_DX2",   constants.dx2 );
+	defineConstant( options, "CONST_DY2",   constants.dy2 );
+	defineConstant( options, "CONST_EXPR",  constants.constant_expr );
+	defineConstant( options, "CONST_OMEGA", constants.omega );
+	defineConstant( options, "CONST_ALPHA", constants.alpha );
+	defineConstant( options, "CONST_RE",    _parameters->re );
+	defineConstant( options, "CONST_GX",    _parameters->gx );
+	defineConstant( options, "CONST_GY",    _parameters->gy );
+	defineConstant( options, "CONST_WN",    _parameters->wN );
+	defineConstant( options, "CONST_WE",    _parameters->wE );
+	defineConstant( options, "CONST_WS",    _parameters->wS );
+	defineConstant( options, "CONST_WW",    _parameters->wW );
+
+	return options.str();
 }
 
 //============================================================================
-cl_int CLManager::runRangeKernel
+std::string CLManager::getCacheKey
 	(
-		int kernelID,
-		const cl::NDRange &offset,
-		const cl::NDRange &global,
-		const cl::NDRange &local
+		const cl::Program::Sources& sources
 	)
 {
-	return _clQueue.enqueueNDRangeKernel ( _clKernels[kernelID], offset, global, local );
+	std::ostringstream key;
+	std::string        info;
+
+	// devices and drivers
+	_clPlatforms[_parameters->clPlatform].getInfo( CL_PLATFORM_NAME, &info );
+	key << info << "\n";
+
+	for( unsigned int i = 0; i < _clDevices.size(); ++i )
+	{
+		_clDevices[i].getInfo( CL_DEVICE_NAME, &info );
+		key << info << "\n";
+		_clDevices[i].getInfo( CL_DEVICE_VERSION, &info );
+		key << info << "\n";
+		_clDevices[i].getInfo( CL_DRIVER_VERSION, &info );
+		key << info << "\n";
+	}
+
+	// build options
+	key << _clBuildOptions << "\n";
+
+	// hash of the sources, the sources themselves would make the key too long
+	cl_ulong hash = FNV_OFFSET;
+
+	for( unsigned int i = 0; i < sources.size(); ++i )
+	{
+		hash = fnvHash( sources[i].first, sources[i].second, hash );
+	}
+
+	key << std::hex << hash;
+
+	return key.str();
 }
 
 //============================================================================
-cl_int CLManager::finish ( )
+// returns the file name of the cache entry for a key
+static std::string getCacheFileName ( const std::string& key )
 {
-	return _clQueue.finish();
+	std::ostringstream fileName;
+	fileName << "kernels/program_" << std::hex << fnvHash( key.c_str(), key.size(), FNV_OFFSET ) << ".bin";
+
+	return fileName.str();
 }
 
 //============================================================================
-int CLManager::getWorkgroupSize ( )
+bool CLManager::loadProgramBinary
+	(
+		const std::string& key
+	)
 {
-	return _clWorkgroupSize;
+	std::ifstream file( getCacheFileName( key ).c_str(), std::ios::binary );
+
+	if( !file.is_open() )
+	{
+		return false;
+	}
+
+	// sizes read from the file are checked against its length,
+	// so a damaged file is a cache miss instead of a huge allocation
+	file.seekg( 0, std::ios::end );
+	::size_t remaining = file.tellg();
+	file.seekg( 0, std::ios::beg );
+
+	// file layout: key, then size and data of the binary of each device
+	unsigned int keySize = 0;
+	file.read( (char*) &keySize, sizeof(keySize) );
+
+	if( !file.good() || keySize > remaining - sizeof(keySize) )
+	{
+		return false;
+	}
+
+	remaining -= sizeof(keySize) + keySize;
+
+	std::string fileKey( keySize, '\0' );
+	if( keySize > 0 )
+	{
+		file.read( &fileKey[0], keySize );
+	}
+
+	// different key with the same hash
+	if( !file.good() || fileKey != key )
+	{
+		return false;
+	}
+
+	std::vector< std::vector<char> > data( _clDevices.size() );
+	cl::Program::Binaries binaries;
+
+	for( unsigned int i = 0; i < _clDevices.size(); ++i )
+	{
+		::size_t size = 0;
+		file.read( (char*) &size, sizeof(size) );
+
+		if( !file.good() || size == 0 || remaining < sizeof(size) || size > remaining - sizeof(size) )
+		{
+			return false;
+		}
+
+		remaining -= sizeof(size) + size;
+
+		data[i].resize( size );
+		file.read( &data[i][0], size );
+
+		binaries.push_back( std::make_pair( (const void*) &data[i][0], size ) );
+	}
+
+	if( !file.good() )
+	{
+		return false;
+	}
+
+	// the driver may still reject the binary, then it is compiled from source
+	try
+	{
+		_clProgram = cl::Program( _clContext, _clDevices, binaries );
+		_clProgram.build( _clDevices, _clBuildOptions.c_str() );
+	}
+	catch( cl::Error error )
+	{
+		#if VERBOSE
+			std::cout << "Cached kernels rejected (" << error.err() << ")" << std::endl;
+		#endif
+
+		return false;
+	}
+
+	return true;
+}
+
+//============================================================================
+void CLManager::saveProgramBinary
+	(
+		const std::string& key
+	)
+{
+	std::vector< ::size_t > sizes;
+	_clProgram.getInfo( CL_PROGRAM_BINARY_SIZES, &sizes );
+
+	if( sizes.size() != _clDevices.size() )
+	{
+		return;
+	}
+
+	// the binaries are copied into memory allocated by the caller
+	std::vector< std::vector<unsigned char> > data( sizes.size() );
+	std::vector< unsigned char* > pointers( sizes.size() );
+
+	for( unsigned int i = 0; i < sizes.size(); ++i )
+	{
+		if( sizes[i] == 0 )
+		{
+			return;
+		}
+
+		data[i].resize( sizes[i] );
+		pointers[i] = &data[i][0];
+	}
+
+	if( clGetProgramInfo( _clProgram(), CL_PROGRAM_BINARIES,
+						  sizeof(unsigned char*) * pointers.size(), &pointers[0], NULL ) != CL_SUCCESS )
+	{
+		return;
+	}
+
+	// write to a temporary file first, so other processes never read a partial binary.
+	// the process id keeps concurrent runs from writing to the same temporary file
+	std::string fileName = getCacheFileName( key );
+	std::ostringstream tempName;
+	tempName << fileName << "." << QCoreApplication::applicationPid() << ".tmp";
+
+	std::ofstream file( tempName.str().c_str(), std::ios::binary );
+
+	if( !file.is_open() )
+	{
+		std::cerr << "Could not write kernel cache \"" << fileName << "\"" << std::endl;
+		return;
+	}
+
+	unsigned int keySize = key.size();
+	file.write( (const char*) &keySize, sizeof(keySize) );
+	file.write( key.c_str(), keySize );
+
+	for( unsigned int i = 0; i < sizes.size(); ++i )
+	{
+		file.write( (const char*) &sizes[i], sizeof(sizes[i]) );
+		file.write( (const char*) &data[i][0], sizes[i] );
+	}
+
+	file.close();
+
+	if( file.fail() || rename( tempName.str().c_str(), fileName.c_str() ) != 0 )
+	{
+		remove( tempName.str().c_str() );
+	}
+}
+
+//============================================================================
+void CLManager::loadSource
+	(
+		cl::Program::Sources &sources,
+		std::string fileName
+	)
+{
+	// read file
+	std::ifstream cl_file( fileName.c_str() );
+
+	// using a pointer and new, because the strings have been deleted to soon and where damaged until compilation
+	// remember to delete them after compilation or in destructor!
+	std::string *cl_sourcecode = new std::string ( std::istreambuf_iterator<char>( cl_file ), (std::istreambuf_iterator<char>()) );
+	_clSourceCode.push_back( cl_sourcecode );
+
+	// add it to the source list
+	sources.push_back( std::make_pair( cl_sourcecode->c_str(), cl_sourcecode->length() ) );
+}
+
+//============================================================================
+cl::CommandQueue *CLManager::getQueue ( )
+{
+	return &_clQueue;
+}
+
+//============================================================================
+cl::CommandQueue *CLManager::getTransferQueue ( )
+{
+	return &_clTransferQueue;
+}
+
+//============================================================================
+cl::Context *CLManager::getContext()
+{
+	return &_clContext;
+}
+
+//============================================================================
+std::vector<cl::Device>* CLManager::getDevices ( )
+{
+	return &_clDevices;
+}
+
+
+// -------------------------------------------------
+//	work group size tuning
+// -------------------------------------------------
+
+//============================================================================
+LaunchConfig& CLManager::getLaunchConfig
+	(
+		int					kernelID,
+		const cl::NDRange&	global
+	)
+{
+	::size_t size[2];
+	size[0] = global[0];
+	size[1] = global.dimensions() > 1 ? global[1] : 0;
+
+	// usually there is only one global range per kernel
+	std::vector<LaunchConfig>& configs = _launchConfigs[kernelID];
+
+	for( unsigned int i = 0; i < configs.size(); ++i )
+	{
+		if( configs[i].global[0] == size[0] && configs[i].global[1] == size[1] )
+		{
+			return configs[i];
+		}
+	}
+
+	LaunchConfig config;
+	config.global[0] = size[0];
+	config.global[1] = size[1];
+	config.tuned     = false;
+	config.run       = 0;
+
+	std::map<std::string, cl::NDRange>::iterator entry = _tuningDatabase.find( getTuningKey( kernelID, size ) );
+
+	if( entry != _tuningDatabase.end() )
+	{
+		config.local = entry->second;
+		config.tuned = true;
+	}
+	else
+	{
+		createCandidates( kernelID, config );
+	}
+
+	configs.push_back( config );
+
+	return configs.back();
+}
+
+//============================================================================
+std::string CLManager::getTuningKey
+	(
+		int				kernelID,
+		const ::size_t*	global
+	)
+{
+	std::ostringstream key;
+
+	key << _clDeviceName << "\t"
+		<< _clKernels[kernelID].getInfo<CL_KERNEL_FUNCTION_NAME>() << "\t"
+		<< global[0] << "\t" << global[1];
+
+	return key.str();
+}
+
+//============================================================================
+void CLManager::createCandidates
+	(
+		int				kernelID,
+		LaunchConfig&	config
+	)
+{
+	::size_t maximum = _clKernels[kernelID].getWorkGroupInfo< CL_KERNEL_WORK_GROUP_SIZE >( _clDevices[0] );
+
+	std::vector< ::size_t > itemSizes;
+	_clDevices[0].getInfo( CL_DEVICE_MAX_WORK_ITEM_SIZES, &itemSizes );
+
+	// the choice of the runtime competes as well
+	config.candidates.push_back( cl::NullRange );
+
+	if( config.global[1] == 0 )
+	{
+		for( ::size_t width = 32; width <= 512; width *= 2 )
+		{
+			if( width <= config.global[0] && width <= maximum && width <= itemSizes[0] )
+			{
+				config.candidates.push_back( cl::NDRange( width ) );
+			}
+		}
+	}
+	else
+	{
+		// square tiles and wide tiles for coalesced rows
+		::size_t shapes[][2] = {
+			{  8,  8 }, { 16,  8 }, { 16, 16 }, { 32,  4 }, { 32,  8 },
+			{ 32, 16 }, { 64,  1 }, { 64,  4 }, { 128, 1 }, { 256, 1 }
+		};
+
+		for( unsigned int i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i )
+		{
+			::size_t width  = shapes[i][0];
+			::size_t height = shapes[i][1];
+
+			// no shapes exceeding the range, e.g. for the problem specific boundaries
+			// with a single row or column
+			if( width > config.global[0] || height > config.global[1] )
+				continue;
+
+			if( width * height <= maximum && width <= itemSizes[0] && height <= itemSizes[1] )
+			{
+				config.candidates.push_back( cl::NDRange( width, height ) );
+			}
+		}
+	}
+
+	config.times = std::vector<qint64>( config.candidates.size(), -1 );
+}
+
+//============================================================================
+cl_int CLManager::runTuningKernel
+	(
+		int					kernelID,
+		const cl::NDRange&	offset,
+		const cl::NDRange&	global,
+		LaunchConfig&		config
+	)
+{
+	// each launch benchmarks the next candidate, so tuning does not change the results
+	unsigned int candidate = config.run % config.candidates.size();
+	const cl::NDRange& local = config.candidates[candidate];
+
+	cl_int result = CL_SUCCESS;
+
+	_clQueue.finish();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	try
+	{
+		result = _clQueue.enqueueNDRangeKernel ( _clKernels[kernelID], offset, roundGlobalRange( global, local ), local,
+												 NULL, profileEvent( _clKernelNames[kernelID], "kernel" ) );
+		_clQueue.finish();
+
+		qint64 time = timer.nsecsElapsed();
+
+		if( config.times[candidate] < 0 || time < config.times[candidate] )
+		{
+			config.times[candidate] = time;
+		}
+	}
+	catch( cl::Error error )
+	{
+		// candidate not supported, e.g. too many resources requested
+		result = _clQueue.enqueueNDRangeKernel ( _clKernels[kernelID], offset, global, cl::NullRange,
+												 NULL, profileEvent( _clKernelNames[kernelID], "kernel" ) );
+
+		config.times[candidate] = -2;
+	}
+
+	++config.run;
+
+	if( config.run < TUNING_RUNS * config.candidates.size() )
+	{
+		return result;
+	}
+
+	// select the fastest candidate
+	int best = 0;
+
+	for( unsigned int i = 1; i < config.candidates.size(); ++i )
+	{
+		if( config.times[i] >= 0 && ( config.times[best] < 0 || config.times[i] < config.times[best] ) )
+		{
+			best = i;
+		}
+	}
+
+	config.local = config.candidates[best];
+	config.tuned = true;
+
+	#if VERBOSE
+		std::cout << "Tuned " << _clKernels[kernelID].getInfo<CL_KERNEL_FUNCTION_NAME>()
+				  << ": " << config.local.dimensions() << "D local range" << std::endl;
+	#endif
+
+	config.candidates.clear();
+	config.times.clear();
+
+	_tuningDatabase[ getTuningKey( kernelID, config.global ) ] = config.local;
+	saveTuningDatabase();
+
+	return result;
+}
+
+//============================================================================
+cl::NDRange CLManager::roundGlobalRange
+	(
+		const cl::NDRange&	global,
+		const cl::NDRange&	local
+	)
+{
+	if( local.dimensions() == 0 )
+	{
+		return global;
+	}
+
+	if( global.dimensions() == 1 )
+	{
+		return cl::NDRange( ( global[0] + local[0] - 1 ) / local[0] * local[0] );
+	}
+
+	return cl::NDRange( ( global[0] + local[0] - 1 ) / local[0] * local[0],
+						( global[1] + local[1] - 1 ) / local[1] * local[1] );
+}
+
+//============================================================================
+// database file: one line per configuration with the device name,
+// kernel name, global range and local range, separated by tabs.
+// A local range of 0 0 leaves the choice to the runtime.
+void CLManager::loadTuningDatabase ( )
+{
+	std::ifstream file( "kernels/worksizes.txt" );
+
+	std::string line;
+
+	while( std::getline( file, line ) )
+	{
+		// device and kernel names may contain spaces
+		std::string::size_type device = line.find( '\t' );
+		std::string::size_type kernel = device == std::string::npos ? device : line.find( '\t', device + 1 );
+
+		if( kernel == std::string::npos )
+			continue;
+
+		std::istringstream values( line.substr( kernel + 1 ) );
+		::size_t global[2], local[2];
+
+		if( !( values >> global[0] >> global[1] >> local[0] >> local[1] ) )
+			continue;
+
+		std::ostringstream key;
+		key << line.substr( 0, kernel ) << "\t" << global[0] << "\t" << global[1];
+
+		if( local[0] == 0 )
+			_tuningDatabase[key.str()] = cl::NullRange;
+		else if( local[1] == 0 )
+			_tuningDatabase[key.str()] = cl::NDRange( local[0] );
+		else
+			_tuningDatabase[key.str()] = cl::NDRange( local[0], local[1] );
+	}
+}
+
+//============================================================================
+void CLManager::saveTuningDatabase ( )
+{
+	// write to a temporary file first, so other processes never read a partial database.
+	// the process id keeps concurrent runs from writing to the same temporary file
+	std::ostringstream tempName;
+	tempName << "kernels/worksizes.txt." << QCoreApplication::applicationPid() << ".tmp";
+
+	std::ofstream file( tempName.str().c_str() );
+
+	if( !file.is_open() )
+	{
+		std::cerr << "Could not write tuning database \"kernels/worksizes.txt\"" << std::endl;
+		return;
+	}
+
+	for( std::map<std::string, cl::NDRange>::iterator it = _tuningDatabase.begin(); it != _tuningDatabase.end(); ++it )
+	{
+		const cl::NDRange& local = it->second;
+
+		file << it->first << "\t"
+			 << ( local.dimensions() > 0 ? local[0] : 0 ) << "\t"
+			 << ( local.dimensions() > 1 ? local[1] : 0 ) << "\n";
+	}
+
+	file.close();
+
+	if( file.fail() || rename( tempName.str().c_str(), "kernels/worksizes.txt" ) != 0 )
+	{
+		remove( tempName.str().c_str() );
+	}
+}
+
+
+// -------------------------------------------------
+//	kernel execution functions
+// -------------------------------------------------
+
+//============================================================================
+cl::Kernel *CLManager::getKernel ( int kernelID )
+{
+	return &(_clKernels[kernelID]);
+}
+
+//============================================================================
+cl_int CLManager::runRangeKernel
+	(
+		int kernelID,
+		const cl::NDRange &offset,
+		const cl::NDRange &global,
+		const cl::NDRange &local
+	)
+{
+	// explicit local ranges are used as given
+	if( !_parameters->autotune || local.dimensions() != 0 ||
+		global.dimensions() == 0 || global.dimensions() > 2 )
+	{
+		return _clQueue.enqueueNDRangeKernel ( _clKernels[kernelID], offset, global, local,
+											   NULL, profileEvent( _clKernelNames[kernelID], "kernel" ) );
+	}
+
+	LaunchConfig& config = getLaunchConfig( kernelID, global );
+
+	if( !config.tuned )
+	{
+		return runTuningKernel( kernelID, offset, global, config );
+	}
+
+	return _clQueue.enqueueNDRangeKernel ( _clKernels[kernelID], offset, roundGlobalRange( global, config.local ), config.local,
+										   NULL, profileEvent( _clKernelNames[kernelID], "kernel" ) );
+}
+
+//============================================================================
+void CLManager::createKernels
+	(
+		std::vector<cl::Kernel>& kernels
+	)
+{
+	kernels = std::vector<cl::Kernel>( _clKernels.size() );
+
+	try
+	{
+		for( unsigned int i = 0; i < _clKernels.size(); ++i )
+		{
+			// the problem specific kernel may be missing
+			if( !_clKernelNames[i].empty() )
+			{
+				kernels[i] = cl::Kernel( _clProgram, _clKernelNames[i].c_str() );
+			}
+		}
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while kernel binding: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+cl_int CLManager::finish ( )
+{
+	return _clQueue.finish();
+}
+
+//============================================================================
+int CLManager::getWorkgroupSize ( )
+{
+	return _clWorkgroupSize;
+}
+
+//============================================================================
+int CLManager::getComputeUnits ( )
+{
+	return _clComputeUnits;
+}
+
+
+// -------------------------------------------------
+//	profiling functions
+// -------------------------------------------------
+
+//============================================================================
+bool CLManager::isProfiling ( )
+{
+	return _profiling;
+}
+
+//============================================================================
+cl::Event* CLManager::profileEvent
+	(
+		const std::string&	name,
+		const char*			category,
+		int					queue
+	)
+{
+	if( !_profiling )
+	{
+		return NULL;
+	}
+
+	if( _profileEvents.size() >= PROFILE_BATCH )
+	{
+		evaluateProfile();
+	}
+
+	ProfileRecord record;
+	record.name     = name;
+	record.category = category;
+	record.queue    = queue;
+	record.start    = 0;
+	record.end      = 0;
+
+	// a deque keeps the address of the event valid while others are added
+	_profileEvents.push_back( record );
+
+	return &_profileEvents.back().event;
+}
+
+//============================================================================
+void CLManager::recordEvent
+	(
+		const cl::Event&	event,
+		const std::string&	name,
+		const char*			category,
+		int					queue
+	)
+{
+	cl::Event* record = profileEvent( name, category, queue );
+
+	if( record != NULL )
+	{
+		*record = event;
+	}
+}
+
+//============================================================================
+void CLManager::evaluateProfile ( )
+{
+	// the timestamps are available once the commands are complete
+	_clQueue.finish();
+	_clTransferQueue.finish();
+
+	while( !_profileEvents.empty() )
+	{
+		ProfileRecord& record = _profileEvents.front();
+
+		// events of failed enqueues were never set
+		if( record.event() != NULL )
+		{
+			record.start = record.event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+			record.end   = record.event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+			record.event = cl::Event();
+
+			cl_ulong duration = record.end - record.start;
+
+			std::map<std::string, ProfileStatistics>::iterator it = _profileStatistics.find( record.name );
+
+			if( it == _profileStatistics.end() )
+			{
+				ProfileStatistics statistics;
+				statistics.category = record.category;
+				statistics.count    = 1;
+				statistics.total    = duration;
+				statistics.minimum  = duration;
+				statistics.maximum  = duration;
+
+				_profileStatistics[record.name] = statistics;
+			}
+			else
+			{
+				ProfileStatistics& statistics = it->second;
+
+				statistics.count++;
+				statistics.total  += duration;
+				statistics.minimum = std::min( statistics.minimum, duration );
+				statistics.maximum = std::max( statistics.maximum, duration );
+			}
+
+			if( _profileTrace.size() < PROFILE_TRACE_LIMIT )
+			{
+				_profileTrace.push_back( record );
+			}
+		}
+
+		_profileEvents.pop_front();
+	}
+}
+
+//============================================================================
+void CLManager::writeProfile ( )
+{
+	if( !_profiling )
+	{
+		return;
+	}
+
+	evaluateProfile();
+
+	if( _profileTrace.empty() )
+	{
+		return;
+	}
+
+	//-----------------------
+	// statistics
+	//-----------------------
+
+	// time of the device between the first and the last command,
+	// and the time it was busy with commands of the main queue
+	cl_ulong first = _profileTrace[0].start;
+	cl_ulong last  = _profileTrace[0].end;
+	cl_ulong busy  = 0;
+	cl_ulong busyUntil = 0;
+
+	for( unsigned int i = 0; i < _profileTrace.size(); ++i )
+	{
+		const ProfileRecord& record = _profileTrace[i];
+
+		first = std::min( first, record.start );
+		last  = std::max( last,  record.end );
+
+		// commands of the main queue run in order
+		if( record.queue == 0 )
+		{
+			cl_ulong start = std::max( record.start, busyUntil );
+
+			if( record.end > start )
+				busy += record.end - start;
+
+			busyUntil = std::max( busyUntil, record.end );
+		}
+	}
+
+	std::cout << "=======================\n"
+			  << "OpenCL profile (times in ms)\n"
+			  << "name\tcategory\tcount\ttotal\taverage\tminimum\tmaximum\n";
+
+	for( std::map<std::string, ProfileStatistics>::iterator it = _profileStatistics.begin(); it != _profileStatistics.end(); ++it )
+	{
+		const ProfileStatistics& statistics = it->second;
+
+		std::cout << it->first << "\t"
+				  << statistics.category << "\t"
+				  << statistics.count << "\t"
+				  << statistics.total   * 1e-6 << "\t"
+				  << statistics.total   * 1e-6 / statistics.count << "\t"
+				  << statistics.minimum * 1e-6 << "\t"
+				  << statistics.maximum * 1e-6 << "\n";
+	}
+
+	std::cout << "Profiled interval:            " << ( last - first ) * 1e-6 << " ms\n"
+			  << "    Main queue busy:          " << busy * 1e-6 << " ms\n"
+			  << "    Main queue idle:          " << ( last - first - busy ) * 1e-6 << " ms\n"
+			  << "=======================" << std::endl;
+
+	//-----------------------
+	// timeline
+	//-----------------------
+
+	std::ofstream file( _parameters->profileFile.c_str() );
+
+	if( !file.is_open() )
+	{
+		std::cerr << "Could not write profile \"" << _parameters->profileFile << "\"" << std::endl;
+		return;
+	}
+
+	// complete events ("X") with timestamps in microseconds,
+	// one thread per queue
+	file << "{\"traceEvents\":[\n"
+		 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main queue\"}},\n"
+		 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"transfer queue\"}}";
+
+	file << std::fixed << std::setprecision( 3 );
+
+	for( unsigned int i = 0; i < _profileTrace.size(); ++i )
+	{
+		const ProfileRecord& record = _profileTrace[i];
+
+		file << ",\n{\"name\":\"" << record.name
+			 << "\",\"cat\":\"" << record.category
+			 << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << record.queue
+			 << ",\"ts\":" << ( record.start - first ) * 1e-3
+			 << ",\"dur\":" << ( record.end - record.start ) * 1e-3 << "}";
+	}
+
+	file << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+	std::cout << "Profile timeline written to " << _parameters->profileFile << std::endl;
 }
@@ -11,6 +11,9 @@
 #include "Parameters.h"
 #include <CL/cl.hpp>
 #include <CL/opencl.h>
+#include <QThread>
+#include <map>
+#include <deque>
 
 //********************************************************************
 //**    additional types
@@ -29,7 +32,7 @@ namespace kernel
 	{
 		setKernel                      = 0,
 		setBoundaryAndInterior         = 1,
-		setBoundaryConditions          = 2,
+		setBoundaryConditions          = 2,		// not bound, replaced by [18],[19]
 		setArbitraryBoundaryConditions = 3,
 		problemSpecific                = 4,
 		getUVMaximum                   = 5,
@@ -37,19 +40,155 @@ namespace kernel
 		computeG                       = 7,
 		rightHandSide                  = 8,
 		gaussSeidelRedBlack            = 9,
-		pressureBoundaryConditions     = 10,
+		pressureBoundaryConditions     = 10,	// not bound, done by gaussSeidelRedBlack
 		pressureResidualReduction      = 11,
-		updateUV                       = 12
+		updateUV                       = 12,
+		regionOutput                   = 13,
+		getUVMaximumFinal              = 14,
+		pressureResidualSum            = 15,
+		gaussSeidelRedBlackTiled       = 16,
+		computeFGRHS                   = 17,
+		setHorizontalBoundaryConditions = 18,
+		setVerticalBoundaryConditions  = 19,
+		splitRedBlack                  = 20,
+		splitRedBlackFlag              = 21,
+		mergeRedBlack                  = 22,
+		gaussSeidelRedBlackSplit       = 23,
+		pressureResidualSplitReduction = 24,
+		updateUVSplit                  = 25,
+		drawObstacleLine               = 26,
+		gaussSeidelRedBlackControlled  = 27,
+		pressureConvergence            = 28,
+		pressureResidualReductionControlled = 29,
+		pressureResidualSumControlled  = 30
 	};
 }
 
+//====================================================================
+/*! \struct KernelConstants
+	\brief Problem constants passed to the kernels
+
+	The values are passed as kernel arguments and, if the kernels are
+	specialized, also baked into the program as build options.
+	Computing them in one place keeps both ways identical.
+*/
+//====================================================================
+
+struct KernelConstants
+{
+	int			nx,				//! dimension in x direction (including boundaries)
+				ny;				//! dimension in y direction (including boundaries)
+
+	CL_REAL		dx2,			//! 1 / dx^2
+				dy2;			//! 1 / dy^2
+	CL_REAL		constant_expr;	//! omega / ( 2 / dx^2 + 2 / dy^2 ) for SOR
+	CL_REAL		omega;			//! ( 1 - omega ) for SOR
+	CL_REAL		alpha;			//! upwind differencing factor for F and G
+
+	KernelConstants ( Parameters* parameters )
+	{
+		nx = parameters->nx + 2;
+		ny = parameters->ny + 2;
+
+		alpha = 0.9; // TODO: select
+
+		dx2 = 1.0 / ( parameters->dx * parameters->dx );
+		dy2 = 1.0 / ( parameters->dy * parameters->dy );
+
+		//constant_expr = 1.0 / ( 2.0 * dx2 + 2.0 * dy2 );
+		constant_expr = parameters->omega / ( 2.0 * dx2 + 2.0 * dy2 );
+		omega         = 1.0 - parameters->omega;
+	}
+};
+
+//====================================================================
+/*! \struct LaunchConfig
+	\brief Local range of a kernel for one global range
+
+	Found by benchmarking candidate local ranges on the first launches
+	of the kernel, or read from the tuning database.
+*/
+//====================================================================
+
+struct LaunchConfig
+{
+	::size_t					global[2];		//! global range this configuration belongs to (second is 0 for 1D ranges)
+	cl::NDRange					local;			//! best local range, cl::NullRange leaves the choice to the runtime
+	bool						tuned;			//! false while the candidates are benchmarked
+
+	std::vector<cl::NDRange>	candidates;		//! local ranges to benchmark
+	std::vector<qint64>			times;			//! fastest run of each candidate in ns, -1 if not run yet
+	unsigned int				run;			//! number of benchmark runs so far
+};
+
+//====================================================================
+/*! \struct ProfileRecord
+	\brief Profiled command of one of the queues
+*/
+//====================================================================
+
+struct ProfileRecord
+{
+	std::string		name;		//! kernel name or transfer description
+	const char*		category;	//! kernel, read, write, copy or map
+	int				queue;		//! 0: main queue, 1: transfer queue
+	cl::Event		event;		//! event of the command, empty after evaluation
+	cl_ulong		start;		//! device time of the start in ns
+	cl_ulong		end;		//! device time of the end in ns
+};
+
+//====================================================================
+/*! \struct ProfileStatistics
+	\brief Accumulated durations of all commands with the same name
+*/
+//====================================================================
+
+struct ProfileStatistics
+{
+	const char*		category;
+	unsigned int	count;
+	cl_ulong		total;		//! in ns
+	cl_ulong		minimum;	//! in ns
+	cl_ulong		maximum;	//! in ns
+};
+
+class CLManager;
+
+//====================================================================
+/*! \class CLCompileThread
+	\brief Background thread building the CL program
+*/
+//====================================================================
+
+class CLCompileThread : public QThread
+{
+	protected:
+		CLManager* _manager;	//! manager owning the program
+
+	public:
+		CLCompileThread ( CLManager* manager );
+
+	protected:
+		void run ( );
+};
+
 //====================================================================
 /*! \class CLManager
 	\brief Class handling the CL setup
+
+	The compiled program is cached in the kernel directory as a
+	binary, keyed by the devices, their driver versions, the build
+	options and the kernel sources. Later starts load the binary
+	instead of compiling the sources.
+
+	The program can be built in a background thread (startCompilation),
+	loadKernels waits for it before binding the kernels.
 */
 //====================================================================
 class CLManager
 {
+	friend class CLCompileThread;
+
 	protected:
 		// -------------------------------------------------
 		//	member variables
@@ -65,13 +204,32 @@ class CLManager
 
 		cl::Context					_clContext;
 		cl::CommandQueue			_clQueue;
+		cl::CommandQueue			_clTransferQueue;	//! second queue for transfers overlapping the simulation
 
 		// kernels
 		std::vector<std::string*>	_clSourceCode;
 		std::vector<cl::Kernel>		_clKernels;
 		cl::Program					_clProgram;
 
+		std::string					_clBuildOptions;	//! options passed to the compiler
+		CLCompileThread*			_compileThread;		//! thread building the program, if started
+		cl_int						_clBuildError;		//! error of the last build, CL_SUCCESS otherwise
+
 		int							_clWorkgroupSize;	//! maximum size of a work group
+		std::string					_clDeviceName;		//! name of the selected device
+
+		// work group size tuning
+		std::vector< std::vector<LaunchConfig> >	_launchConfigs;		//! configurations per kernel ID
+		std::map<std::string, cl::NDRange>			_tuningDatabase;	//! best local ranges of all devices, kernels and grid sizes
+
+		int							_clComputeUnits;	//! number of compute units of the device
+
+		// profiling
+		bool										_profiling;			//! commands are profiled
+		std::vector<std::string>					_clKernelNames;		//! function names per kernel ID
+		std::deque<ProfileRecord>					_profileEvents;		//! commands not yet evaluated
+		std::vector<ProfileRecord>					_profileTrace;		//! evaluated commands for the timeline
+		std::map<std::string, ProfileStatistics>	_profileStatistics;	//! statistics per command name
 
 			//! @}
 
@@ -83,6 +241,8 @@ class CLManager
 			//! @{
 
 			//! \param pointer to parameters struct
+			//! The device is selected by the platform, device type,
+			//! device index and fission parameters.
 
 		CLManager ( Parameters* parameters );
 
@@ -90,13 +250,33 @@ class CLManager
 
 			//! @}
 
+		// -------------------------------------------------
+		//	device selection functions
+		// -------------------------------------------------
+			//! @name device selection functions
+			//! @{
+
+			//! \brief prints all platforms and devices to console,
+			//! with the indices used for the device selection
+			//! \returns false, if the devices could not be queried
+
+		static bool listDevices ( );
+
+			//! @}
+
 		// -------------------------------------------------
 		//	kernel loading functions
 		// -------------------------------------------------
 			//! @name kernel loading functions
 			//! @{
 
+			//! \brief starts building the program in a background thread
+			//! The kernels can be bound with loadKernels afterwards.
+
+		void	startCompilation ( );
+
 			//! \brief loads and compiles all required kernels
+			//! If the compilation was started before, waits for it to finish.
 
 		void	loadKernels ( );
 
@@ -111,6 +291,132 @@ class CLManager
 
 			//! @}
 
+	protected:
+		// -------------------------------------------------
+		//	device selection helpers
+		// -------------------------------------------------
+			//! @name device selection helpers
+			//! @{
+
+			//! \brief converts a DEVICE_* constant to the CL device type
+
+		static cl_device_type getDeviceType ( int type );
+
+			//! \brief partitions the device as given by the parameters
+			//! \param device to partition
+			//! \param number of sub-devices to use, starting at the selected one
+			//! \returns the selected sub-devices
+
+		std::vector<cl::Device> createSubDevices
+			(
+				cl::Device&	device,
+				int			count
+			);
+
+			//! @}
+
+		// -------------------------------------------------
+		//	work group size tuning
+		// -------------------------------------------------
+			//! @name work group size tuning
+			//! @{
+
+			//! \brief returns the launch configuration of a kernel for a global range
+			//! New configurations are taken from the tuning database or tuned.
+
+		LaunchConfig&	getLaunchConfig (
+							int					kernelID,
+							const cl::NDRange&	global
+						);
+
+			//! \brief returns the key of a configuration in the tuning database
+
+		std::string		getTuningKey (
+							int				kernelID,
+							const ::size_t*	global
+						);
+
+			//! \brief fills the candidate local ranges of a configuration to tune
+
+		void			createCandidates (
+							int				kernelID,
+							LaunchConfig&	config
+						);
+
+			//! \brief enqueues a kernel while tuning, measuring the time of the launch
+
+		cl_int			runTuningKernel (
+							int					kernelID,
+							const cl::NDRange&	offset,
+							const cl::NDRange&	global,
+							LaunchConfig&		config
+						);
+
+			//! \brief rounds the global range up to a multiple of the local range
+
+		static cl::NDRange	roundGlobalRange (
+								const cl::NDRange&	global,
+								const cl::NDRange&	local
+							);
+
+			//! \brief waits for all commands and moves the profiled events
+			//! to the statistics and the timeline
+
+		void			evaluateProfile ( );
+
+			//! \brief reads the tuned local ranges from kernels/worksizes.txt
+
+		void			loadTuningDatabase ( );
+
+			//! \brief writes the tuned local ranges to kernels/worksizes.txt
+
+		void			saveTuningDatabase ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	program building functions
+		// -------------------------------------------------
+			//! @name program building functions
+			//! @{
+
+			//! \brief loads the sources and builds the program, either from
+			//! the cached binaries or from source. Does not throw, errors are
+			//! stored in _clBuildError, because it may run in a separate thread.
+
+		void	buildProgram ( );
+
+			//! \brief returns the compiler options. If the kernels are
+			//! specialized, the problem constants are defined as macros.
+
+		std::string	getBuildOptions ( );
+
+			//! \brief returns the cache key identifying the program binaries
+			//! \param sources of the program
+
+		std::string	getCacheKey (
+						const cl::Program::Sources& sources
+					);
+
+			//! \brief creates the program from a cached binary
+			//! \param cache key of the program
+			//! \returns true, if a matching binary was found and built
+
+		bool	loadProgramBinary (
+						const std::string&	key
+					);
+
+			//! \brief writes the binaries of the built program to the cache
+			//! \param cache key of the program
+
+		void	saveProgramBinary (
+						const std::string&	key
+					);
+
+			//! @}
+
+	public:
+
 
 		// -------------------------------------------------
 		//	get functions
@@ -124,14 +430,32 @@ class CLManager
 
 		cl::CommandQueue* getQueue ( );
 
+			//! \brief Returns a reference to the transfer queue object
+			//! Commands in this queue may run concurrently to the main queue,
+			//! so they must be synchronized with events.
+
+		cl::CommandQueue* getTransferQueue ( );
+
 			//! \brief Returns a reference to the context object
 
 		cl::Context* getContext ( );
 
-			//! \brief Returns the size of a workgroup on the device
+			//! \brief Returns the selected devices, more than one if the
+			//! domain is split into strips (-clstrips). The main queue and
+			//! the transfer queue use the first one.
+
+		std::vector<cl::Device>* getDevices ( );
+
+			//! \brief Returns the size of a workgroup supported by all kernels
+			//! launched with explicit local ranges (reductions and tiled kernels).
+			//! It is a power of two.
 
 		int getWorkgroupSize ( );
 
+			//! \brief Returns the number of compute units of the device
+
+		int getComputeUnits ( );
+
 			//! @}
 
 		// -------------------------------------------------
@@ -145,7 +469,18 @@ class CLManager
 
 		cl::Kernel* getKernel( int kernelID );
 
+			//! \brief Creates another set of the kernels, indexed by kernel ID
+			//! Kernel arguments are stored per kernel object, so solvers working
+			//! on several sets of buffers need a set of kernels for each.
+			//! Must be called after loadKernels.
+
+		void createKernels ( std::vector<cl::Kernel>& kernels );
+
 			//! \brief Enqueues a range kernel on the device
+			//! If no local range is given, the tuned local range is used
+			//! and the global range is rounded up to a multiple of it.
+			//! Kernels launched this way must ignore work items outside
+			//! the global range.
 
 		cl_int runRangeKernel
 			(
@@ -160,6 +495,46 @@ class CLManager
 		cl_int finish ( );
 
 			//! @}
+
+		// -------------------------------------------------
+		//	profiling functions
+		// -------------------------------------------------
+			//! @name profiling functions
+			//! @{
+
+			//! \brief returns true, if the commands are profiled (-clprofile)
+
+		bool		isProfiling ( );
+
+			//! \brief returns an event to pass to an enqueue function, so the
+			//! command is profiled. Returns NULL if profiling is disabled.
+			//! The event must be used before the next call.
+			//! \param name of the command in the statistics and the timeline
+			//! \param category: kernel, read, write, copy or map
+			//! \param 0 for commands of the main queue, 1 for the transfer queue
+
+		cl::Event*	profileEvent (
+						const std::string&	name,
+						const char*			category,
+						int					queue = 0
+					);
+
+			//! \brief adds an existing event to the profile, e.g. one used
+			//! for synchronization. Does nothing if profiling is disabled.
+
+		void		recordEvent (
+						const cl::Event&	event,
+						const std::string&	name,
+						const char*			category,
+						int					queue = 0
+					);
+
+			//! \brief prints the statistics per kernel and transfer to console
+			//! and writes the timeline in chrome trace format (chrome://tracing)
+
+		void		writeProfile ( );
+
+			//! @}
 };
 
 #endif // CLMANAGER_H
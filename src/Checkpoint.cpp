@@ -0,0 +1,231 @@
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "Checkpoint.h"
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <QFile>
+
+//********************************************************************
+//**    checkpoint file header
+//********************************************************************
+
+#define CHECKPOINT_MAGIC	"NSCHKPT"
+#define CHECKPOINT_VERSION	2
+
+// 48 bytes, so the following arrays are aligned
+struct CheckpointHeader
+{
+	char			magic[8];		// CHECKPOINT_MAGIC
+	int				version;		// CHECKPOINT_VERSION
+	int				realSize;		// sizeof(REAL) of the writing program
+	int				nx;				// number of interior cells in x-direction
+	int				ny;				// number of interior cells in y-direction
+	double			time;			// simulated time
+	double			dt;				// last time step size
+	unsigned int	iteration;		// number of simulated time steps
+	unsigned int	numOutputs;		// number of next output times following the arrays
+};
+
+//********************************************************************
+//**    implementation
+//********************************************************************
+
+//============================================================================
+bool Checkpoint::write
+	(
+		std::string					fileName,
+		NavierStokesSolver*			solver,
+		Parameters*					parameters,
+		double						time,
+		unsigned int				iteration,
+		const std::vector<double>&	nextOutputs
+	)
+{
+	int size = ( parameters->nx + 2 ) * ( parameters->ny + 2 );
+
+	CheckpointHeader header;
+	memset( &header, 0, sizeof( header ) );
+
+	strncpy( header.magic, CHECKPOINT_MAGIC, sizeof( header.magic ) );
+	header.version   = CHECKPOINT_VERSION;
+	header.realSize  = sizeof( REAL );
+	header.nx        = parameters->nx;
+	header.ny        = parameters->ny;
+	header.time      = time;
+	header.dt        = parameters->dt;
+	header.iteration = iteration;
+	header.numOutputs = nextOutputs.size();
+
+	//-----------------------
+	// write temporary file
+	//-----------------------
+
+	std::string tmpFileName = fileName + ".tmp";
+
+	FILE* file = fopen( tmpFileName.c_str(), "wb" );
+
+	if( !file )
+	{
+		std::cerr << "Failed to open checkpoint file \"" << tmpFileName << "\" for writing!" << std::endl;
+		return false;
+	}
+
+	// host arrays are continuous, so each array is written at once
+	fwrite( &header, sizeof( header ), 1, file );
+	fwrite( *solver->getU_CPU(),    sizeof( REAL ),          size, file );
+	fwrite( *solver->getV_CPU(),    sizeof( REAL ),          size, file );
+	fwrite( *solver->getP_CPU(),    sizeof( REAL ),          size, file );
+	fwrite( *solver->getFLAG_CPU(), sizeof( unsigned char ), size, file );
+
+	if( !nextOutputs.empty() )
+	{
+		fwrite( &nextOutputs[0], sizeof( double ), nextOutputs.size(), file );
+	}
+
+	// make sure the data is on disk before replacing the old checkpoint
+	bool success = fflush( file ) == 0 && !ferror( file ) && fsync( fileno( file ) ) == 0;
+
+	success = ( fclose( file ) == 0 ) && success;
+
+	if( !success )
+	{
+		std::cerr << "Failed to write checkpoint file \"" << tmpFileName << "\"!" << std::endl;
+		remove( tmpFileName.c_str() );
+		return false;
+	}
+
+	//-----------------------
+	// replace old checkpoint
+	//-----------------------
+
+	// rename is atomic, either the old or the new checkpoint exists
+	if( rename( tmpFileName.c_str(), fileName.c_str() ) != 0 )
+	{
+		std::cerr << "Failed to rename checkpoint file \"" << tmpFileName << "\" to \"" << fileName << "\"!" << std::endl;
+		remove( tmpFileName.c_str() );
+		return false;
+	}
+
+	#if VERBOSE
+		std::cout << "Wrote checkpoint for iteration " << iteration << std::endl;
+	#endif
+
+	return true;
+}
+
+//============================================================================
+bool Checkpoint::restore
+	(
+		std::string				fileName,
+		NavierStokesSolver*		solver,
+		Parameters*				parameters,
+		double*					time,
+		unsigned int*			iteration,
+		std::vector<double>*	nextOutputs
+	)
+{
+	int nx1  = parameters->nx + 1;
+	int ny1  = parameters->ny + 1;
+	int size = ( parameters->nx + 2 ) * ( parameters->ny + 2 );
+
+	//-----------------------
+	// map file
+	//-----------------------
+
+	QFile file( QString::fromStdString( fileName ) );
+
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		std::cerr << "Could not open checkpoint file \"" << fileName << "\"" << std::endl;
+		return false;
+	}
+
+	qint64 expectedSize = sizeof( CheckpointHeader )
+						+ 3 * size * sizeof( REAL )
+						+ size * sizeof( unsigned char );
+
+	if( file.size() < (qint64)sizeof( CheckpointHeader ) )
+	{
+		std::cerr << "Checkpoint file \"" << fileName << "\" is corrupted." << std::endl;
+		return false;
+	}
+
+	uchar* data = file.map( 0, file.size() );
+
+	if( !data )
+	{
+		std::cerr << "Could not map checkpoint file \"" << fileName << "\"" << std::endl;
+		return false;
+	}
+
+	//-----------------------
+	// check header
+	//-----------------------
+
+	const CheckpointHeader* header = (const CheckpointHeader*)data;
+
+	if( strncmp( header->magic, CHECKPOINT_MAGIC, sizeof( header->magic ) ) != 0 ||
+		header->version != CHECKPOINT_VERSION )
+	{
+		std::cerr << "\"" << fileName << "\" is no valid checkpoint file." << std::endl;
+		file.unmap( data );
+		return false;
+	}
+
+	expectedSize += header->numOutputs * sizeof( double );
+
+	if( header->realSize != sizeof( REAL ) ||
+		header->nx != parameters->nx ||
+		header->ny != parameters->ny ||
+		file.size() != expectedSize )
+	{
+		std::cerr << "Checkpoint \"" << fileName << "\" does not match the grid size of the parameter file." << std::endl;
+		file.unmap( data );
+		return false;
+	}
+
+	//-----------------------
+	// load state
+	//-----------------------
+
+	const REAL* U = (const REAL*)( data + sizeof( CheckpointHeader ) );
+	const REAL* V = U + size;
+	const REAL* P = V + size;
+	const unsigned char* FLAG = (const unsigned char*)( P + size );
+
+	if( !solver->loadState( U, V, P, FLAG ) )
+	{
+		file.unmap( data );
+		return false;
+	}
+
+	// update obstacle map for obstacle drawing
+	for( int y = 1; y < ny1; ++y )
+	{
+		for( int x = 1; x < nx1; ++x )
+		{
+			parameters->obstacleMap[y][x] = FLAG[ y * ( parameters->nx + 2 ) + x ] == C_F;
+		}
+	}
+
+	// the doubles following FLAG may be unaligned
+	nextOutputs->resize( header->numOutputs );
+
+	if( header->numOutputs > 0 )
+	{
+		memcpy( &(*nextOutputs)[0], FLAG + size, header->numOutputs * sizeof( double ) );
+	}
+
+	*time           = header->time;
+	*iteration      = header->iteration;
+	parameters->dt  = header->dt;
+
+	file.unmap( data );
+	file.close();
+
+	return true;
+}
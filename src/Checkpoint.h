@@ -0,0 +1,83 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "Definitions.h"
+#include "Parameters.h"
+#include "solver/navierStokesSolver.h"
+#include <string>
+#include <vector>
+
+//====================================================================
+/*! \class Checkpoint
+	\brief Class for writing and restoring binary checkpoints
+
+	A checkpoint consists of a fixed size header followed by the
+	raw arrays U, V, P (REAL) and FLAG (unsigned char), each of
+	size (nx+2)*(ny+2). The header is padded to keep the arrays
+	aligned, so they can be used directly from a memory mapped file.
+	The next output times of the viewer and the region writers
+	(double) follow the arrays, so a restarted simulation writes
+	its outputs at the same steps as an uninterrupted one.
+*/
+//====================================================================
+
+class Checkpoint
+{
+	public:
+		// -------------------------------------------------
+		//	static checkpoint functions
+		// -------------------------------------------------
+			//! @name static checkpoint functions
+			//! @{
+
+			//! \brief writes the current simulation state to a checkpoint file
+			//! The file is written to a temporary file first and renamed afterwards,
+			//! so an existing checkpoint is never left in an incomplete state.
+			//! \param file name of the checkpoint
+			//! \param pointer to the solver
+			//! \param pointer to parameter structure
+			//! \param simulated time
+			//! \param number of simulated time steps
+			//! \param next output times of the viewer and the region writers
+			//! \returns true if the checkpoint was written, false otherwise
+
+		static bool write
+			(
+				std::string					fileName,
+				NavierStokesSolver*			solver,
+				Parameters*					parameters,
+				double						time,
+				unsigned int				iteration,
+				const std::vector<double>&	nextOutputs
+			);
+
+			//! \brief restores the simulation state from a checkpoint file
+			//! The file is memory mapped and passed to the solver without
+			//! intermediate copies. The obstacle map in the parameters is
+			//! updated to match the restored flags.
+			//! \param file name of the checkpoint
+			//! \param pointer to the initialised solver
+			//! \param pointer to parameter structure
+			//! \param pointer to variable receiving the simulated time
+			//! \param pointer to variable receiving the number of simulated time steps
+			//! \param pointer to vector receiving the next output times
+			//! \returns true if the state was restored, false otherwise
+
+		static bool restore
+			(
+				std::string				fileName,
+				NavierStokesSolver*		solver,
+				Parameters*				parameters,
+				double*					time,
+				unsigned int*			iteration,
+				std::vector<double>*	nextOutputs
+			);
+
+			//! @}
+};
+
+#endif // CHECKPOINT_H
@@ -8,6 +8,11 @@
 #define BW 16
 #define BH 16
 
+// number of simulations advanced together by the ensemble solver.
+// The fields of all members are interleaved per cell, so this should
+// be a multiple of the SIMD width (4 for SSE, 8 for AVX, 16 for AVX-512)
+#define ENSEMBLE_WIDTH 8
+
 // defining data type as float, as double is not supported by all GPUs
 //#define REAL float
 typedef float REAL;
@@ -43,6 +48,38 @@ typedef float REAL;
 #define PERIODIC	4	// not supported
 
 
+// vtk file formats
+#define VTK_LEGACY		0	// legacy ASCII format
+#define VTK_XML			1	// XML image data with appended raw binary data
+#define VTK_XML_ZLIB	2	// XML image data with appended zlib compressed data
+#define VTK_SERIES		3	// all snapshots in a single time series file
+
+
+// lossy compression of time series snapshots
+#define COMPRESSION_NONE		0	// fields are stored unchanged
+#define COMPRESSION_ABSOLUTE	1	// maximum absolute error per value
+#define COMPRESSION_RELATIVE	2	// maximum error relative to the value range of each field
+
+
+// downsampling filters of region outputs
+#define REGION_STRIDE	0	// first cell of each block
+#define REGION_BOX		1	// average of each block
+
+
+// OpenCL device selection
+#define DEVICE_DEFAULT		0	// first GPU, any device if there is no GPU
+#define DEVICE_GPU			1
+#define DEVICE_CPU			2
+#define DEVICE_ACCELERATOR	3
+#define DEVICE_ALL			4	// any device type
+
+
+// OpenCL device fission
+#define FISSION_NONE		0	// the whole device is used
+#define FISSION_EQUALLY		1	// sub-devices with a given number of compute units
+#define FISSION_NUMA		2	// one sub-device per NUMA node (e.g. one socket)
+
+
 
 
 
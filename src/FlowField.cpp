@@ -0,0 +1,192 @@
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "FlowField.h"
+#include <stdlib.h>
+
+//********************************************************************
+//**    implementation
+//********************************************************************
+
+// -------------------------------------------------
+//	constructor / destructor
+// -------------------------------------------------
+
+//============================================================================
+FlowField::FlowField
+	(
+		int					nx,
+		int					ny,
+		FlowFieldDevice*	device
+	)
+{
+	_nx     = nx + 2;
+	_ny     = ny + 2;
+	_device = device;
+
+	_transferredBytes = 0;
+
+	// arrays of pointers to rows, the actual data is continuous
+	_U    = (REAL**)malloc( _ny * sizeof( REAL* ) );
+	_V    = (REAL**)malloc( _ny * sizeof( REAL* ) );
+	_P    = (REAL**)malloc( _ny * sizeof( REAL* ) );
+	_FLAG = (unsigned char**)malloc( _ny * sizeof( unsigned char* ) );
+
+	_U[0]    = (REAL*)malloc( _nx * _ny * sizeof( REAL ) );
+	_V[0]    = (REAL*)malloc( _nx * _ny * sizeof( REAL ) );
+	_P[0]    = (REAL*)malloc( _nx * _ny * sizeof( REAL ) );
+	_FLAG[0] = (unsigned char*)malloc( _nx * _ny * sizeof( unsigned char ) );
+
+	for( int y = 1; y < _ny; ++y )
+	{
+		_U[y]    = _U[0]    + y * _nx;
+		_V[y]    = _V[0]    + y * _nx;
+		_P[y]    = _P[0]    + y * _nx;
+		_FLAG[y] = _FLAG[0] + y * _nx;
+	}
+
+	// nothing is initialized yet, the first writer decides
+	for( int i = 0; i < field::numFields; ++i )
+	{
+		_hostValid[i]   = true;
+		_deviceValid[i] = true;
+	}
+}
+
+//============================================================================
+FlowField::~FlowField ( )
+{
+	free( _U[0] );
+	free( _V[0] );
+	free( _P[0] );
+	free( _FLAG[0] );
+
+	free( _U );
+	free( _V );
+	free( _P );
+	free( _FLAG );
+}
+
+
+// -------------------------------------------------
+//	host access
+// -------------------------------------------------
+
+//============================================================================
+REAL** FlowField::getU ( )
+{
+	synchronizeHost( field::U );
+	return _U;
+}
+
+//============================================================================
+REAL** FlowField::getV ( )
+{
+	synchronizeHost( field::V );
+	return _V;
+}
+
+//============================================================================
+REAL** FlowField::getP ( )
+{
+	synchronizeHost( field::P );
+	return _P;
+}
+
+//============================================================================
+unsigned char** FlowField::getFLAG ( )
+{
+	synchronizeHost( field::FLAG );
+	return _FLAG;
+}
+
+//============================================================================
+void FlowField::hostModified
+	(
+		int fieldID
+	)
+{
+	_hostValid[fieldID]   = true;
+	_deviceValid[fieldID] = _device == 0;
+}
+
+
+// -------------------------------------------------
+//	device synchronization
+// -------------------------------------------------
+
+//============================================================================
+void FlowField::deviceModified
+	(
+		int fieldID
+	)
+{
+	_deviceValid[fieldID] = true;
+	_hostValid[fieldID]   = false;
+}
+
+//============================================================================
+void FlowField::synchronizeDevice ( )
+{
+	for( int i = 0; i < field::numFields; ++i )
+	{
+		if( !_deviceValid[i] )
+		{
+			_device->uploadField( i, getHostMemory( i ) );
+
+			_transferredBytes += getFieldSize( i );
+			_deviceValid[i]    = true;
+		}
+	}
+}
+
+//============================================================================
+long unsigned int FlowField::getTransferredBytes ( )
+{
+	return _transferredBytes;
+}
+
+
+// -------------------------------------------------
+//	auxiliary functions
+// -------------------------------------------------
+
+//============================================================================
+void FlowField::synchronizeHost
+	(
+		int fieldID
+	)
+{
+	if( _hostValid[fieldID] )
+		return;
+
+	_device->downloadField( fieldID, getHostMemory( fieldID ) );
+
+	_transferredBytes    += getFieldSize( fieldID );
+	_hostValid[fieldID]   = true;
+}
+
+//============================================================================
+void* FlowField::getHostMemory
+	(
+		int fieldID
+	)
+{
+	switch( fieldID )
+	{
+		case field::U: return _U[0];
+		case field::V: return _V[0];
+		case field::P: return _P[0];
+		default:       return _FLAG[0];
+	}
+}
+
+//============================================================================
+int FlowField::getFieldSize
+	(
+		int fieldID
+	)
+{
+	return _nx * _ny * ( fieldID == field::FLAG ? sizeof( unsigned char ) : sizeof( REAL ) );
+}
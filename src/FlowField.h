@@ -0,0 +1,180 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "Definitions.h"
+
+//====================================================================
+//! Field Identifiers
+
+namespace field
+{
+	enum FieldIDs
+	{
+		U         = 0,	//! horizontal velocity
+		V         = 1,	//! vertical velocity
+		P         = 2,	//! pressure
+		FLAG      = 3,	//! obstacle flags
+		numFields = 4
+	};
+}
+
+//====================================================================
+/*! \class FlowFieldDevice
+	\brief Interface for solvers keeping the fields in device memory
+*/
+//====================================================================
+
+class FlowFieldDevice
+{
+	public:
+		virtual ~FlowFieldDevice ( ) { }
+
+			//! \brief copies a field from device to host memory
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		virtual void downloadField ( int fieldID, void* host ) = 0;
+
+			//! \brief copies a field from host to device memory
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		virtual void uploadField ( int fieldID, const void* host ) = 0;
+};
+
+//====================================================================
+/*! \class FlowField
+	\brief Host copies of the simulation fields with lazy
+	synchronization
+
+	For each field it is tracked whether the host and the device
+	copy are current. Fields are only transferred when the stale
+	copy is accessed, so time steps without output or interaction
+	do not cause any host-device traffic.
+
+	Usage by the solver:
+	 - deviceModified after kernels changed a field
+	 - synchronizeDevice before kernels read the fields
+	 - getX for read access, hostModified after changing host data
+*/
+//====================================================================
+
+class FlowField
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		int					_nx,						//! number of cells in x-direction incl. boundaries
+							_ny;						//! number of cells in y-direction incl. boundaries
+
+		REAL				**_U,						//! host copy of horizontal velocity
+							**_V,						//! host copy of vertical velocity
+							**_P;						//! host copy of pressure
+
+		unsigned char		**_FLAG;					//! host copy of obstacle flags
+
+		FlowFieldDevice*	_device;					//! device side of the fields, 0 if host only
+
+		bool				_hostValid[field::numFields];	//! host copy is current
+		bool				_deviceValid[field::numFields];	//! device copy is current
+
+		long unsigned int	_transferredBytes;			//! total number of bytes transferred
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param number of interior cells in x-direction
+			//! \param number of interior cells in y-direction
+			//! \param device side of the fields, 0 if the fields only exist in host memory
+
+		FlowField
+			(
+				int					nx,
+				int					ny,
+				FlowFieldDevice*	device = 0
+			);
+
+		~FlowField ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	host access
+		// -------------------------------------------------
+			//! @name host access
+			//! @{
+
+			//! \brief gives read access to a host copy, downloads it if it is stale
+			//! Call hostModified after changing the returned data.
+			//! \returns pointer to the field array
+
+		REAL**			getU ( );
+		REAL**			getV ( );
+		REAL**			getP ( );
+		unsigned char**	getFLAG ( );
+
+			//! \brief marks the device copy of a field as stale after changing the host copy
+			//! \param field id (see namespace field)
+
+		void			hostModified ( int fieldID );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	device synchronization
+		// -------------------------------------------------
+			//! @name device synchronization
+			//! @{
+
+			//! \brief marks the host copy of a field as stale after kernels changed it
+			//! \param field id (see namespace field)
+
+		void			deviceModified ( int fieldID );
+
+			//! \brief uploads all fields whose device copy is stale
+
+		void			synchronizeDevice ( );
+
+			//! \returns total number of bytes transferred between host and device
+
+		long unsigned int getTransferredBytes ( );
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief downloads a field if its host copy is stale
+
+		void			synchronizeHost ( int fieldID );
+
+			//! \returns continuous host memory of a field
+
+		void*			getHostMemory ( int fieldID );
+
+			//! \returns size of a field in bytes
+
+		int				getFieldSize ( int fieldID );
+
+			//! @}
+};
+
+#endif // FLOWFIELD_H
@@ -7,6 +7,7 @@
 
 #include "Definitions.h"
 #include <string>
+#include <vector>
 #include <stdlib.h>
 
 /*
@@ -17,6 +18,39 @@
  * 4 = periodic
  */
 
+//====================================================================
+/*! \struct OutputRegion
+	\brief Rectangular part of the domain written with its own
+	output interval, optionally downsampled
+*/
+//====================================================================
+
+struct OutputRegion
+{
+	std::string	name;			//! prefix of the output files
+	int			x0,				//! first interior cell in x-direction
+				y0,				//! first interior cell in y-direction
+				x1,				//! last interior cell in x-direction
+				y1;				//! last interior cell in y-direction
+	int			factor;			//! downsampling factor (1: full resolution)
+	int			filter;			//! downsampling filter (REGION_STRIDE or REGION_BOX)
+	double		interval;		//! output interval in simulated time
+
+		//! \returns number of output cells in x-direction
+
+	int getWidth ( ) const
+	{
+		return ( x1 - x0 + factor ) / factor;
+	}
+
+		//! \returns number of output cells in y-direction
+
+	int getHeight ( ) const
+	{
+		return ( y1 - y0 + factor ) / factor;
+	}
+};
+
 //====================================================================
 /*! \struct Parameters
 	\brief Structure containing all parameters required for the
@@ -33,10 +67,38 @@ struct Parameters
 		//! @{
 
 	bool		useGPU;			//! flag indicating wether to use GPU or CPU
+	bool		useEnsemble;	//! flag indicating wether to use the batched ensemble CPU solver
+	double		hybridFraction;	//! initial fraction of rows computed by CPU threads next to the OpenCL device (0: disabled)
+	bool		kernelCache;	//! flag indicating wether compiled kernels are cached on disk
+	bool		autotune;		//! flag indicating wether local work sizes are tuned
+	std::string	profileFile;	//! file for the OpenCL profile timeline, no profiling if empty
+
+	int			clPlatform;		//! index of the OpenCL platform
+	int			clDeviceType;	//! type of the OpenCL device (DEVICE_DEFAULT, _GPU, _CPU, _ACCELERATOR or _ALL)
+	int			clDevice;		//! index of the OpenCL device among the devices of that type
+	int			clFission;		//! partitioning of the device (FISSION_NONE, _EQUALLY or _NUMA)
+	int			clFissionUnits;	//! compute units per sub-device for FISSION_EQUALLY
+	int			clSubDevice;	//! index of the sub-device to use
+	int			clStrips;		//! number of devices or sub-devices the domain is split across
+	bool		clListDevices;	//! only list the available OpenCL devices
 
 	bool		VTKWriteFiles;	//! indicates if vtk files should be written
 	double		VTKInterval;	//! interval of vtk outputs
 	double		VTKTimeLimit;	//! time limit for simulation if vtk files are written
+	int			VTKFormat;		//! vtk file format (VTK_LEGACY, VTK_XML, VTK_XML_ZLIB or VTK_SERIES)
+	int			asyncBuffers;	//! number of buffers for asynchronous file output (0: synchronous)
+
+	int			compressionMode;		//! lossy compression of series snapshots (COMPRESSION_NONE, _ABSOLUTE or _RELATIVE)
+	double		compressionTolerance;	//! maximum absolute or relative error of compressed values
+
+	std::string	checkpointFile;		//! checkpoint file name, empty if no checkpoints are written
+	int			checkpointSteps;	//! number of time steps between checkpoints (0: use wall time)
+	double		checkpointWallTime;	//! wall clock seconds between checkpoints
+	std::string	restartFile;		//! checkpoint to restart from, empty for a new simulation
+
+	std::string	convertFile;	//! time series file to convert to vtk files instead of simulating
+
+	std::vector<OutputRegion> outputRegions;	//! additional outputs of parts of the domain
 
 		//! @}
 
@@ -62,6 +124,11 @@ struct Parameters
 
 	// pressure-iteration data
 	int			it_max;			//! maximal number of pressure iterations per time step
+	int			residualInterval;	//! GPU: iterations between asynchronous residual checks (0: synchronous check each iteration)
+	int			tileIterations;		//! GPU: iterations per launch of the tiled SOR kernel (0: untiled kernels)
+	int			splitPressure;		//! pressure iteration on separate arrays for red and black cells (0: natural layout)
+	int			specializeKernels;	//! GPU: compile the problem constants into the kernels (0: pass them as arguments)
+	int			deviceConvergence;	//! GPU: the device stops the pressure iteration on convergence (0: checked by the host)
 
 	REAL		epsilon,		//! stopping tolerance eps for pressure iteration
 				omega,			//! relaxation parameter for SOR iteration
@@ -90,6 +157,18 @@ struct Parameters
 
 		//! @}
 
+	// -------------------------------------------------
+	//	ensemble parameters
+	// -------------------------------------------------
+		//! @name ensemble parameters
+		//! @{
+
+	std::vector<REAL> ensembleRe;		//! Reynolds numbers of the ensemble members
+	std::vector<REAL> ensembleVelocity;	//! lid or inflow velocities of the ensemble members
+	int			ensembleOutput;			//! index of the ensemble member passed to the viewer
+
+		//! @}
+
 	// -------------------------------------------------
 	//	constructor / destructor
 	// -------------------------------------------------
@@ -100,9 +179,34 @@ struct Parameters
 	{
 		// program parameters
 		useGPU        = true;
+		useEnsemble   = false;
+		hybridFraction = 0.0;
+		kernelCache   = true;
+		autotune      = true;
+
+		clPlatform     = 0;
+		clDeviceType   = DEVICE_DEFAULT;
+		clDevice       = 0;
+		clFission      = FISSION_NONE;
+		clFissionUnits = 0;
+		clSubDevice    = 0;
+		clStrips       = 1;
+		clListDevices  = false;
 		VTKWriteFiles = false;
 		VTKInterval   = 0.1;
 		VTKTimeLimit  = 10.0;
+		VTKFormat     = VTK_LEGACY;
+		asyncBuffers  = 0;
+
+		compressionMode      = COMPRESSION_NONE;
+		compressionTolerance = 0.0;
+
+		checkpointFile     = "";
+		checkpointSteps    = 0;
+		checkpointWallTime = 0.0;
+		restartFile        = "";
+
+		convertFile   = "";
 
 		// simulation parameters
 		xlength       = 1.0;
@@ -114,6 +218,11 @@ struct Parameters
 		dt            = 0.02;
 		tau			  = 0.5;
 		it_max        = 100;
+		residualInterval = 0;
+		tileIterations   = 0;
+		splitPressure    = 0;
+		specializeKernels = 0;
+		deviceConvergence = 0;
 		epsilon       = 0.001;
 		omega         = 1.7;
 		gamma         = 0.9;
@@ -130,6 +239,9 @@ struct Parameters
 		problem       = "moving_lid";
 		obstacleFile  = "";
 		obstacleMap   = 0;
+
+		// ensemble parameters
+		ensembleOutput = 0;
 	}
 
 		//! \brief required to free obstacle memory properly
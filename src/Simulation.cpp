@@ -3,8 +3,12 @@
 //********************************************************************
 
 #include "Simulation.h"
+#include "Checkpoint.h"
 #include "solver/navierStokesCPU.h"
 #include "solver/navierStokesGPU.h"
+#include "solver/navierStokesMultiGPU.h"
+#include "solver/navierStokesHybrid.h"
+#include "solver/navierStokesEnsembleCPU.h"
 #include <iostream>
 
 //********************************************************************
@@ -12,12 +16,12 @@
 //********************************************************************
 
 //============================================================================
-Simulation::Simulation ( Parameters* parameters, Viewer* viewer )
+Simulation::Simulation ( Parameters* parameters, Viewer* viewer, CLManager* clManager )
 {
 	_parameters = parameters;
 	_viewer     = viewer;
 
-	_clManager  = 0;
+	_clManager  = clManager;
 
 	_running    = false;
 
@@ -26,19 +30,42 @@ Simulation::Simulation ( Parameters* parameters, Viewer* viewer )
 
 	_pressureIterations    = 0;
 
+	_snapshotPending       = false;
+	_snapshotTime          = 0.0;
+	_snapshotDt            = 0.0;
+	_snapshotIteration     = 0;
+
 	_elapsedSimulationTime = 0;
 	_elapsedTotalTime      = 0;
 
 
 	// TODO: stop using hardcoded flag
-	if( parameters->useGPU )
+	if( parameters->useGPU && parameters->clStrips > 1 )
 	{
-		std::cout << "Simulating on GPU" << std::endl;
+		std::cout << "Simulating on " << parameters->clStrips << " OpenCL devices" << std::endl;
+
+		_solver = new NavierStokesMultiGPU( parameters, _clManager );
+	}
+	else if( parameters->useGPU && parameters->hybridFraction > 0.0 )
+	{
+		std::cout << "Simulating on CPU and GPU" << std::endl;
 
-		_clManager = new CLManager( parameters );
+		_solver = new NavierStokesHybrid( parameters, _clManager );
+	}
+	else if( parameters->useGPU )
+	{
+		std::cout << "Simulating on GPU" << std::endl;
 
 		_solver = new NavierStokesGPU( parameters, _clManager );
 	}
+	else if( parameters->useEnsemble )
+	{
+		NavierStokesEnsembleCPU* ensemble = new NavierStokesEnsembleCPU( parameters );
+
+		std::cout << "Simulating ensemble of " << ensemble->getNumMembers() << " members on CPU" << std::endl;
+
+		_solver = ensemble;
+	}
 	else
 	{
 		std::cout << "Simulating on CPU" << std::endl;
@@ -53,13 +80,50 @@ Simulation::Simulation ( Parameters* parameters, Viewer* viewer )
 	}
 
 	_solver->initialize();
+
+	for( unsigned int i = 0; i < parameters->outputRegions.size(); ++i )
+	{
+		_regionWriters.push_back( new RegionWriter( parameters, parameters->outputRegions[i] ) );
+	}
+
+	// continue a previous simulation
+	if( !parameters->restartFile.empty() )
+	{
+		std::vector<double> nextOutputs;
+
+		if( !Checkpoint::restore( parameters->restartFile, _solver, parameters, &_time, &_iterations, &nextOutputs ) )
+		{
+			throw "Could not restart from checkpoint.";
+		}
+
+		// the outputs continue at the same steps as without the restart
+		if( nextOutputs.size() == 1 + _regionWriters.size() )
+		{
+			_viewer->setNextOutput( nextOutputs[0] );
+
+			for( unsigned int i = 0; i < _regionWriters.size(); ++i )
+			{
+				_regionWriters[i]->setNextOutput( nextOutputs[i + 1] );
+			}
+		}
+		else
+		{
+			std::cerr << "Output regions differ from the checkpoint, the output schedule is restarted." << std::endl;
+		}
+
+		std::cout << "Restarted from checkpoint at iteration " << _iterations << " (time " << _time << ")" << std::endl;
+	}
 }
 
 //============================================================================
 Simulation::~Simulation ( )
 {
+	for( unsigned int i = 0; i < _regionWriters.size(); ++i )
+	{
+		SAFE_DELETE( _regionWriters[i] );
+	}
+
 	SAFE_DELETE( _solver );
-	SAFE_DELETE( _clManager );
 }
 
 //============================================================================
@@ -73,7 +137,9 @@ void Simulation::run ( )
 	// start performance measurement
 	_totalTimer.start();
 
-	while( _running && ( !_parameters->VTKWriteFiles || _time < _parameters->VTKTimeLimit ) )
+	_checkpointTimer.start();
+
+	while( _running && !_solver->isFinished( _time ) )
 	{
 		#if VERBOSE
 			std::cout << "Simulating iteration " << _iterations << " at time " << _time << std::endl;
@@ -89,29 +155,96 @@ void Simulation::run ( )
 		_pressureIterations    += numPressureIterations;
 
 		// update simulated time
-		_time += _parameters->dt;
+		_time = _solver->advanceTime( _time );
+
+		// the snapshot of the previous step was transferred during this step
+		if( _snapshotPending )
+		{
+			renderSnapshot();
+		}
 
 		// update visualisation
-		// todo: use flow field class instead of parameters
-		_viewer->renderFrame(
-				_solver->getU_CPU(),
-				_solver->getV_CPU(),
-				_solver->getP_CPU(),
-				_time,
-				_iterations
-			);
+		if( _viewer->isOutputRequired( _time ) )
+		{
+			if( _solver->requestSnapshot() )
+			{
+				// rendered after the next step
+				_snapshotPending   = true;
+				_snapshotTime      = _time;
+				_snapshotDt        = _parameters->dt;
+				_snapshotIteration = _iterations;
+			}
+			else
+			{
+				_viewer->renderFrame(
+						_solver->getU_CPU(),
+						_solver->getV_CPU(),
+						_solver->getP_CPU(),
+						_time,
+						_parameters->dt,
+						_iterations
+					);
+			}
+		}
+
+		// region outputs, only the extracted data is copied to the host
+		for( unsigned int i = 0; i < _regionWriters.size(); ++i )
+		{
+			if( _regionWriters[i]->isOutputRequired( _time ) )
+			{
+				_solver->getRegion_CPU( _regionWriters[i]->getRegion(), _regionWriters[i]->getData() );
+				_regionWriters[i]->writeFile( _iterations );
+			}
+		}
 
 		emit simulatedFrame( numPressureIterations );
 
 		++_iterations;
+
+		// write checkpoint after a number of steps or a wall clock interval
+		if( !_parameters->checkpointFile.empty() &&
+			(	( _parameters->checkpointSteps > 0 && _iterations % _parameters->checkpointSteps == 0 ) ||
+				( _parameters->checkpointSteps == 0 && _checkpointTimer.elapsed() >= _parameters->checkpointWallTime * 1000 ) ) )
+		{
+			std::vector<double> nextOutputs( 1, _viewer->getNextOutput() );
+
+			for( unsigned int i = 0; i < _regionWriters.size(); ++i )
+			{
+				nextOutputs.push_back( _regionWriters[i]->getNextOutput() );
+			}
+
+			Checkpoint::write( _parameters->checkpointFile, _solver, _parameters, _time, _iterations, nextOutputs );
+
+			_checkpointTimer.restart();
+		}
 	}
 
+	// wait for pending output
+	if( _snapshotPending )
+	{
+		renderSnapshot();
+	}
+
+	_viewer->finalize();
+
 	// update total time measurement
 	_elapsedTotalTime += _totalTimer.elapsed();
 
 	emit simulationStopped();
 }
 
+//============================================================================
+void Simulation::renderSnapshot ( )
+{
+	REAL **U, **V, **P;
+
+	_solver->getSnapshot_CPU( &U, &V, &P );
+
+	_viewer->renderFrame( U, V, P, _snapshotTime, _snapshotDt, _snapshotIteration );
+
+	_snapshotPending = false;
+}
+
 void Simulation::simulationTrigger()
 {
 	if( _running )
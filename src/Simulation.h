@@ -9,6 +9,7 @@
 #include "Parameters.h"
 #include "solver/navierStokesSolver.h"
 #include "viewer/Viewer.h"
+#include "viewer/RegionWriter.h"
 #include "CLManager.h"
 #include <QThread>
 #include <QElapsedTimer>
@@ -35,7 +36,9 @@ class Simulation : public QThread
 
 		Viewer*				_viewer;				//! pointer to the viewer
 
-		CLManager*			_clManager;				//! the object handling the CL setup if GPU solver is used
+		std::vector<RegionWriter*> _regionWriters;	//! writers for the region outputs of the parameter file
+
+		CLManager*			_clManager;				//! the object handling the CL setup if GPU solver is used, not owned
 
 		bool                _running;				//! flag indicating if the simulation is currently running
 		unsigned int		_iterations;			//! counter for the total number of simulated timesteps
@@ -47,6 +50,13 @@ class Simulation : public QThread
 		qint64				_elapsedTotalTime;		//! time spent for simulation and visualization
 		qint64				_elapsedSimulationTime;	//! time spent for simulation only
 
+		QElapsedTimer		_checkpointTimer;		//! wall clock time since the last checkpoint
+
+		bool				_snapshotPending;		//! a snapshot is being transferred for rendering
+		double				_snapshotTime;			//! simulated time of the pending snapshot
+		double				_snapshotDt;			//! time step size of the pending snapshot
+		unsigned int		_snapshotIteration;		//! iteration of the pending snapshot
+
 			//! @}
 
 	public:
@@ -58,8 +68,10 @@ class Simulation : public QThread
 
 			//! \param pointer to parameters struct
 			//! \param pointer to viewer object
+			//! \param pointer to the CL manager, required for the GPU solver.
+			//!        The kernel compilation may already have been started.
 
-		Simulation ( Parameters* parameters, Viewer* viewer );
+		Simulation ( Parameters* parameters, Viewer* viewer, CLManager* clManager );
 
 		~Simulation ( );
 
@@ -105,6 +117,10 @@ class Simulation : public QThread
 
 		void run ( );
 
+			//! \brief waits for the pending snapshot and passes it to the viewer
+
+		void renderSnapshot ( );
+
 			//! @}
 
 	public slots:
@@ -9,11 +9,79 @@
 #include <string.h>
 #include <sstream>
 #include <locale>
+#include <math.h>
 
 //********************************************************************
 //**    implementation
 //********************************************************************
 
+//============================================================================
+// converts an OpenCL device type name (gpu, cpu, accelerator, all)
+bool parseDeviceType
+	(
+		const char*	name,
+		int*		type
+	)
+{
+	if( strcmp( name, "gpu" ) == 0 )
+		*type = DEVICE_GPU;
+	else if( strcmp( name, "cpu" ) == 0 )
+		*type = DEVICE_CPU;
+	else if( strcmp( name, "accelerator" ) == 0 )
+		*type = DEVICE_ACCELERATOR;
+	else if( strcmp( name, "all" ) == 0 )
+		*type = DEVICE_ALL;
+	else
+		return false;
+
+	return true;
+}
+
+//============================================================================
+// converts a device fission mode (numa or a number of compute units)
+bool parseFission
+	(
+		const char*	value,
+		Parameters*	parameters
+	)
+{
+	if( strcmp( value, "numa" ) == 0 )
+	{
+		parameters->clFission = FISSION_NUMA;
+		return true;
+	}
+
+	int units = atoi( value );
+
+	if( units <= 0 )
+	{
+		return false;
+	}
+
+	parameters->clFission      = FISSION_EQUALLY;
+	parameters->clFissionUnits = units;
+
+	return true;
+}
+
+//============================================================================
+// returns true if the string is a non-negative index
+bool isIndex ( const char* value )
+{
+	if( *value == 0 )
+	{
+		return false;
+	}
+
+	for( ; *value != 0; ++value )
+	{
+		if( *value < '0' || *value > '9' )
+			return false;
+	}
+
+	return true;
+}
+
 //============================================================================
 bool InputParser::readParameters
 	(
@@ -22,6 +90,67 @@ bool InputParser::readParameters
 		Parameters*	parameters
 	)
 {
+	//-------------------------------
+	// read environment variables
+	//-------------------------------
+
+	// OpenCL device selection, overridden by the command line
+
+	const char* env;
+
+	if( ( env = getenv( "FLOWSIM_CL_PLATFORM" ) ) != 0 )
+	{
+		if( !isIndex( env ) )
+		{
+			std::cerr << "Invalid FLOWSIM_CL_PLATFORM \"" << env << "\"" << std::endl;
+			return false;
+		}
+		parameters->clPlatform = atoi( env );
+	}
+
+	if( ( env = getenv( "FLOWSIM_CL_DEVICE_TYPE" ) ) != 0 && !parseDeviceType( env, &parameters->clDeviceType ) )
+	{
+		std::cerr << "Invalid FLOWSIM_CL_DEVICE_TYPE \"" << env << "\"" << std::endl;
+		return false;
+	}
+
+	if( ( env = getenv( "FLOWSIM_CL_DEVICE" ) ) != 0 )
+	{
+		if( !isIndex( env ) )
+		{
+			std::cerr << "Invalid FLOWSIM_CL_DEVICE \"" << env << "\"" << std::endl;
+			return false;
+		}
+		parameters->clDevice = atoi( env );
+	}
+
+	if( ( env = getenv( "FLOWSIM_CL_FISSION" ) ) != 0 && !parseFission( env, parameters ) )
+	{
+		std::cerr << "Invalid FLOWSIM_CL_FISSION \"" << env << "\"" << std::endl;
+		return false;
+	}
+
+	if( ( env = getenv( "FLOWSIM_CL_SUBDEVICE" ) ) != 0 )
+	{
+		if( !isIndex( env ) )
+		{
+			std::cerr << "Invalid FLOWSIM_CL_SUBDEVICE \"" << env << "\"" << std::endl;
+			return false;
+		}
+		parameters->clSubDevice = atoi( env );
+	}
+
+	if( ( env = getenv( "FLOWSIM_CL_STRIPS" ) ) != 0 )
+	{
+		if( !isIndex( env ) || atoi( env ) < 1 )
+		{
+			std::cerr << "Invalid FLOWSIM_CL_STRIPS \"" << env << "\"" << std::endl;
+			return false;
+		}
+		parameters->clStrips = atoi( env );
+	}
+
+
 	//-------------------------------
 	// parse command line parameters
 	//-------------------------------
@@ -58,11 +187,256 @@ bool InputParser::readParameters
 				return false;
 			}
 		}
+		else if( strcmp( argv[arg], "-vtkformat" ) == 0 )
+		{
+			if( arg + 1 < argc && strcmp( argv[arg+1], "legacy" ) == 0 )
+			{
+				parameters->VTKFormat = VTK_LEGACY;
+			}
+			else if( arg + 1 < argc && strcmp( argv[arg+1], "xml" ) == 0 )
+			{
+				parameters->VTKFormat = VTK_XML;
+			}
+			else if( arg + 1 < argc && strcmp( argv[arg+1], "xmlz" ) == 0 )
+			{
+				parameters->VTKFormat = VTK_XML_ZLIB;
+			}
+			else if( arg + 1 < argc && strcmp( argv[arg+1], "series" ) == 0 )
+			{
+				parameters->VTKFormat = VTK_SERIES;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+
+			arg += 2;
+		}
+		else if( strcmp( argv[arg], "-async" ) == 0 )
+		{
+			// optional number of buffers, double buffering by default
+			parameters->asyncBuffers = 2;
+			++arg;
+
+			if( arg < argc && atoi( argv[arg] ) > 0 )
+			{
+				parameters->asyncBuffers = atoi( argv[arg] );
+				++arg;
+			}
+		}
+		else if( strcmp( argv[arg], "-compress" ) == 0 )
+		{
+			if( arg + 2 < argc &&
+				( strcmp( argv[arg+1], "abs" ) == 0 || strcmp( argv[arg+1], "rel" ) == 0 ) )
+			{
+				parameters->compressionMode = strcmp( argv[arg+1], "abs" ) == 0
+											? COMPRESSION_ABSOLUTE
+											: COMPRESSION_RELATIVE;
+
+				std::istringstream argument_istr( argv[arg+2] );
+				argument_istr.imbue( std::locale("C") );
+				argument_istr >> parameters->compressionTolerance;
+
+				if( parameters->compressionTolerance <= 0.0 )
+				{
+					printUsage( argv[0] );
+					return false;
+				}
+
+				arg += 3;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
 		else if( strcmp( argv[arg], "-cpu" ) == 0 )
 		{
 			parameters->useGPU = false;
 			++arg;
 		}
+		else if( strcmp( argv[arg], "-checkpoint" ) == 0 )
+		{
+			if( arg + 2 < argc )
+			{
+				parameters->checkpointFile = argv[++arg];
+
+				// interval is given in time steps or in seconds with suffix s
+				std::istringstream argument_istr( argv[++arg] );
+				argument_istr.imbue( std::locale("C") );
+
+				double interval = 0.0;
+				char   unit     = 0;
+
+				argument_istr >> interval >> unit;
+
+				// a number of time steps must be a whole number of at least 1,
+				// 0 would select the wall clock mode
+				if( interval <= 0.0 || ( unit != 0 && unit != 's' ) ||
+					( unit == 0 && ( interval < 1.0 || interval != floor( interval ) ) ) )
+				{
+					printUsage( argv[0] );
+					return false;
+				}
+
+				if( unit == 's' )
+				{
+					parameters->checkpointSteps    = 0;
+					parameters->checkpointWallTime = interval;
+				}
+				else
+				{
+					parameters->checkpointSteps    = (int)interval;
+				}
+
+				++arg;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-convert" ) == 0 )
+		{
+			if( arg + 1 < argc )
+			{
+				parameters->convertFile = argv[++arg];
+				++arg;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-restart" ) == 0 )
+		{
+			if( arg + 1 < argc )
+			{
+				parameters->restartFile = argv[++arg];
+				++arg;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-cllist" ) == 0 )
+		{
+			parameters->clListDevices = true;
+			++arg;
+		}
+		else if( strcmp( argv[arg], "-clplatform" ) == 0 )
+		{
+			if( arg + 1 < argc && isIndex( argv[arg+1] ) )
+			{
+				parameters->clPlatform = atoi( argv[arg+1] );
+				arg += 2;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-cldevice" ) == 0 )
+		{
+			if( arg + 1 < argc && parseDeviceType( argv[arg+1], &parameters->clDeviceType ) )
+			{
+				arg += 2;
+
+				// optional index among the devices of this type
+				parameters->clDevice = 0;
+				if( arg < argc && isIndex( argv[arg] ) )
+				{
+					parameters->clDevice = atoi( argv[arg] );
+					++arg;
+				}
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-clfission" ) == 0 )
+		{
+			if( arg + 1 < argc && parseFission( argv[arg+1], parameters ) )
+			{
+				arg += 2;
+
+				// optional index of the sub-device
+				parameters->clSubDevice = 0;
+				if( arg < argc && isIndex( argv[arg] ) )
+				{
+					parameters->clSubDevice = atoi( argv[arg] );
+					++arg;
+				}
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-clstrips" ) == 0 )
+		{
+			if( arg + 1 < argc && isIndex( argv[arg+1] ) && atoi( argv[arg+1] ) >= 1 )
+			{
+				parameters->clStrips = atoi( argv[arg+1] );
+				arg += 2;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-clprofile" ) == 0 )
+		{
+			if( argc > arg + 1 )
+			{
+				parameters->profileFile = argv[arg + 1];
+				arg += 2;
+			}
+			else
+			{
+				printUsage( argv[0] );
+				return false;
+			}
+		}
+		else if( strcmp( argv[arg], "-noautotune" ) == 0 )
+		{
+			parameters->autotune = false;
+			++arg;
+		}
+		else if( strcmp( argv[arg], "-nokernelcache" ) == 0 )
+		{
+			parameters->kernelCache = false;
+			++arg;
+		}
+		else if( strcmp( argv[arg], "-hybrid" ) == 0 )
+		{
+			// optional initial fraction of rows computed by the CPU
+			parameters->hybridFraction = 0.2;
+			++arg;
+
+			if( arg < argc && atof( argv[arg] ) > 0.0 && atof( argv[arg] ) < 1.0 )
+			{
+				parameters->hybridFraction = atof( argv[arg] );
+				++arg;
+			}
+		}
+		else if( strcmp( argv[arg], "-ensemble" ) == 0 )
+		{
+			parameters->useGPU      = false;
+			parameters->useEnsemble = true;
+			++arg;
+		}
 		else if( argv[arg][0] != '-' && !parameterFileNameSet )
 		{
 			parameterFileName = argv[arg];
@@ -77,6 +451,32 @@ bool InputParser::readParameters
 	}
 
 
+	// grid size and output format are all required for conversion
+	// and no parameters at all for listing the devices
+	if( !parameters->convertFile.empty() || parameters->clListDevices )
+	{
+		return true;
+	}
+
+	if( parameters->useEnsemble && ( !parameters->checkpointFile.empty() || !parameters->restartFile.empty() ) )
+	{
+		std::cerr << "Checkpoints are not supported by the ensemble solver." << std::endl;
+		return false;
+	}
+
+	if( parameters->hybridFraction > 0.0 && parameters->clStrips > 1 )
+	{
+		std::cerr << "The hybrid solver uses a single OpenCL device (-hybrid can not be combined with -clstrips)." << std::endl;
+		return false;
+	}
+
+	if( parameters->compressionMode != COMPRESSION_NONE && parameters->VTKFormat != VTK_SERIES )
+	{
+		std::cerr << "Compression is only supported for time series files (-vtkformat series)." << std::endl;
+		return false;
+	}
+
+
 	//-------------------------------
 	// parse parameter file
 	//-------------------------------
@@ -170,6 +570,31 @@ bool InputParser::readParameters
 				parameters->it_max = i_buffer;
 				++numReadValues;
 			}
+			else if ( buffer == "residual_interval" )
+			{
+				file >> i_buffer;
+				parameters->residualInterval = i_buffer;
+			}
+			else if ( buffer == "tile_iterations" )
+			{
+				file >> i_buffer;
+				parameters->tileIterations = i_buffer;
+			}
+			else if ( buffer == "split_pressure" )
+			{
+				file >> i_buffer;
+				parameters->splitPressure = i_buffer;
+			}
+			else if ( buffer == "specialize_kernels" )
+			{
+				file >> i_buffer;
+				parameters->specializeKernels = i_buffer;
+			}
+			else if ( buffer == "device_convergence" )
+			{
+				file >> i_buffer;
+				parameters->deviceConvergence = i_buffer;
+			}
 			else if ( buffer == "epsilon" )
 			{
 				file >> d_buffer;
@@ -269,6 +694,70 @@ bool InputParser::readParameters
 				file >> s_buffer;
 				parameters->obstacleFile = s_buffer;
 			}
+
+			//=================================
+			// ensemble parameters
+			//=================================
+			else if ( buffer == "ensemble_re" || buffer == "ensemble_velocity" )
+			{
+				std::vector<REAL>* values = buffer == "ensemble_re"
+										  ? &parameters->ensembleRe
+										  : &parameters->ensembleVelocity;
+
+				// all values of the ensemble are given in one line
+				std::string s_buffer;
+				std::getline( file, s_buffer );
+
+				// give back line break to be consumed below
+				if( !file.eof() )
+					file.unget();
+
+				std::istringstream values_istr( s_buffer );
+				values_istr.imbue( std::locale("C") );
+
+				values->clear();
+				while( values_istr >> d_buffer )
+				{
+					values->push_back( d_buffer );
+				}
+
+				if( values->empty() || values->size() > ENSEMBLE_WIDTH )
+				{
+					std::cerr << "Parameter \"" << buffer << "\" needs 1 to " << ENSEMBLE_WIDTH << " values." << std::endl;
+					file.close();
+					return false;
+				}
+			}
+			else if ( buffer == "ensemble_output" )
+			{
+				file >> i_buffer;
+				parameters->ensembleOutput = i_buffer;
+			}
+
+			//=================================
+			// region outputs
+			//=================================
+			else if ( buffer == "output_region" )
+			{
+				// name x0 y0 x1 y1 factor stride|box interval
+				OutputRegion region;
+				std::string  filter;
+
+				file >> region.name
+					 >> region.x0 >> region.y0 >> region.x1 >> region.y1
+					 >> region.factor >> filter >> region.interval;
+
+				if( file.fail() || ( filter != "stride" && filter != "box" ) )
+				{
+					std::cerr << "Parameter \"output_region\" needs name, x0, y0, x1, y1, factor, stride|box and interval." << std::endl;
+					file.close();
+					return false;
+				}
+
+				region.filter = filter == "box" ? REGION_BOX : REGION_STRIDE;
+
+				parameters->outputRegions.push_back( region );
+			}
 			else // unknown parameter
 			{
 				std::cerr << "Unknown parameter \"" << buffer << "\". Please check your input file!" << std::endl;
@@ -321,21 +810,45 @@ bool InputParser::readParameters
 	parameters->dx = parameters->xlength / (REAL)parameters->nx;
 	parameters->dy = parameters->ylength / (REAL)parameters->ny;
 
-	//-------------------------------
-	// read obstacle map
-	//-------------------------------
+	// the halo of the tiled SOR kernel grows with the iterations and must fit into shared memory
+	if( parameters->tileIterations < 0 || parameters->tileIterations > 4 )
+	{
+		std::cerr << "Parameter \"tile_iterations\" must be between 0 and 4." << std::endl;
+		return false;
+	}
 
-	if ( !readObstacleMap(
-			 &(parameters->obstacleMap),
-			 parameters->nx,
-			 parameters->ny,
-			 parameters->obstacleFile )
-		 )
+	// the tiled kernel works on the natural layout
+	if( parameters->splitPressure && parameters->tileIterations > 0 )
 	{
-		std::cerr << "Error reading obstacle map." << std::endl;
+		std::cerr << "Parameters \"split_pressure\" and \"tile_iterations\" can not be combined." << std::endl;
 		return false;
 	}
 
+	// the controlled sweep kernel works on the natural layout, one iteration per launch
+	if( parameters->deviceConvergence && ( parameters->splitPressure || parameters->tileIterations > 0 ) )
+	{
+		std::cerr << "Parameter \"device_convergence\" can not be combined with \"split_pressure\" or \"tile_iterations\"." << std::endl;
+		return false;
+	}
+
+	// regions must lie within the interior cells
+	for( unsigned int i = 0; i < parameters->outputRegions.size(); ++i )
+	{
+		OutputRegion& region = parameters->outputRegions[i];
+
+		if( region.x0 < 1 || region.x1 > parameters->nx || region.x0 > region.x1 ||
+			region.y0 < 1 || region.y1 > parameters->ny || region.y0 > region.y1 ||
+			region.factor < 1 || region.interval < 0.0 )
+		{
+			std::cerr << "Output region \"" << region.name << "\" is invalid for a grid of "
+					  << parameters->nx << "x" << parameters->ny << " cells." << std::endl;
+			return false;
+		}
+	}
+
+	// the obstacle map is read separately (readObstacleMap), so the
+	// kernels can be compiled meanwhile
+
 	// done
 	return true;
 }
@@ -612,7 +1125,12 @@ void InputParser::printParameters
 			  << "Time step Δt:\t"	              << parameters->dt << "\n"
 			  << "Safety factor τ:\t"             << parameters->tau << "\n\n"
 
-			  << "Max. SOR iterations:\t"         << parameters->it_max << "\n\n"
+			  << "Max. SOR iterations:\t"         << parameters->it_max << "\n"
+			  << "Residual interval:\t"           << parameters->residualInterval << "\n"
+			  << "Tiled SOR iterations:\t"        << parameters->tileIterations << "\n"
+			  << "Split red/black layout:\t"     << parameters->splitPressure << "\n"
+			  << "Specialized kernels:\t"        << parameters->specializeKernels << "\n"
+			  << "Device convergence:\t"         << parameters->deviceConvergence << "\n\n"
 
 			  << "ε:\t"                           << parameters->epsilon << "\n"
 			  << "ω:\t"                           << parameters->omega << "\n"
@@ -635,10 +1153,63 @@ void InputParser::printParameters
 			  << "Problem:\t"                     << parameters->problem << "\n"
 			  << "Obstacle map:\t"                << parameters->obstacleFile << std::endl;
 
+	if( parameters->useEnsemble )
+	{
+		std::cout << "\nEnsemble Reynolds numbers:\t";
+		for( unsigned int i = 0; i < parameters->ensembleRe.size(); ++i )
+			std::cout << parameters->ensembleRe[i] << " ";
+
+		std::cout << "\nEnsemble velocities:\t";
+		for( unsigned int i = 0; i < parameters->ensembleVelocity.size(); ++i )
+			std::cout << parameters->ensembleVelocity[i] << " ";
+
+		std::cout << "\nEnsemble output member:\t" << parameters->ensembleOutput << std::endl;
+	}
+
+	if( !parameters->checkpointFile.empty() )
+	{
+		std::cout << "\nCheckpoint file:\t" << parameters->checkpointFile << "\n"
+				  << "Checkpoint interval:\t";
+
+		if( parameters->checkpointSteps > 0 )
+			std::cout << parameters->checkpointSteps << " time steps" << std::endl;
+		else
+			std::cout << parameters->checkpointWallTime << " s" << std::endl;
+	}
+
+	if( !parameters->restartFile.empty() )
+	{
+		std::cout << "\nRestart from:\t" << parameters->restartFile << std::endl;
+	}
+
 	if( parameters->VTKWriteFiles )
 	{
 		std::cout << "\nVTK interval:\t" << parameters->VTKInterval << "\n"
-				  << "VTK time limit:\t" << parameters->VTKTimeLimit << std::endl;
+				  << "VTK time limit:\t" << parameters->VTKTimeLimit << "\n"
+				  << "VTK format:\t"
+				  << ( parameters->VTKFormat == VTK_XML      ? "XML image data" :
+					   parameters->VTKFormat == VTK_XML_ZLIB ? "XML image data, zlib compressed" :
+					   parameters->VTKFormat == VTK_SERIES   ? "time series file" :
+															   "legacy ASCII" ) << std::endl;
+
+		if( parameters->compressionMode != COMPRESSION_NONE )
+			std::cout << "Lossy compression:\t"
+					  << ( parameters->compressionMode == COMPRESSION_ABSOLUTE ? "absolute" : "relative" )
+					  << " error " << parameters->compressionTolerance << std::endl;
+
+		if( parameters->asyncBuffers > 0 )
+			std::cout << "Asynchronous output buffers:\t" << parameters->asyncBuffers << std::endl;
+	}
+
+	for( unsigned int i = 0; i < parameters->outputRegions.size(); ++i )
+	{
+		const OutputRegion& region = parameters->outputRegions[i];
+
+		std::cout << "\nOutput region:\t" << region.name << "\n"
+				  << "Cells:\t\t" << region.x0 << "," << region.y0 << " - " << region.x1 << "," << region.y1 << "\n"
+				  << "Downsampling:\t" << region.factor
+				  << ( region.filter == REGION_BOX ? " (box filter)" : " (stride)" ) << "\n"
+				  << "Interval:\t" << region.interval << std::endl;
 	}
 
 	std::cout << "====================" << std::endl;
@@ -650,6 +1221,8 @@ void InputParser::printUsage
 		char* programName
 	)
 {
-	std::cout << "Usage: " << programName << " [-vtk interval time_limit] [-cpu] parameter_file"
+	std::cout << "Usage: " << programName << " [-vtk interval time_limit] [-vtkformat legacy|xml|xmlz|series] [-compress abs|rel tolerance] [-async [buffers]] [-cpu] [-ensemble] [-hybrid [fraction]] [-nokernelcache] [-noautotune] [-clprofile file] [-clplatform index] [-cldevice gpu|cpu|accelerator|all [index]] [-clfission units|numa [index]] [-clstrips count] [-checkpoint file interval[s]] [-restart file] parameter_file"
+			  << "\n       " << programName << " -convert series_file [-vtkformat legacy|xml|xmlz]"
+			  << "\n       " << programName << " -cllist"
 			  << std::endl;
 }
@@ -27,6 +27,7 @@ class InputParser
 
 			//! \brief parses the command line parameters and reads
 			//! the parameters from a given config file
+			//! The obstacle map is not read, see readObstacleMap
 			//! \param number of command line arguments
 			//! \param array of command line arguments
 			//! \param pointer to parameter structure to fill with the imported values
@@ -12,6 +12,13 @@ __kernel void setKernel
 		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx    = CONST_NX;
+		ny    = CONST_NY;
+		pitch = CONST_NX;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * pitch + x;
@@ -34,6 +41,13 @@ __kernel void setBoundaryAndInteriorKernel
 		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx    = CONST_NX;
+		ny    = CONST_NY;
+		pitch = CONST_NX;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * pitch + x;
@@ -39,6 +39,16 @@ __kernel void setBoundaryConditionsKernel
 //		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		wN = CONST_WN;
+		wE = CONST_WE;
+		wS = CONST_WS;
+		wW = CONST_WW;
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -150,6 +160,148 @@ __kernel void setBoundaryConditionsKernel
 	}
 }
 
+//============================================================================
+// 1D variant of the southern and northern part of setBoundaryConditionsKernel,
+// one work item per column, to be called with a range of nx.
+// Must be called before setVerticalBoundaryConditionsKernel to give the same
+// corner values as setBoundaryConditionsKernel.
+__kernel void setHorizontalBoundaryConditionsKernel
+	(
+		__global float*	u_g,
+		__global float*	v_g,
+		int				wN,		// boundary condition for northern boundaries
+		int				wS,		// boundary condition for southern boundaries
+		int				nx,		// dimension in x direction (including boundaries)
+		int				ny		// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		wN = CONST_WN;
+		wS = CONST_WS;
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int x = get_global_id( 0 );
+
+	if( x == 0 || x >= nx-1 )
+		return;
+
+	//-----------------------
+	// southern boundary
+	//-----------------------
+
+	if( wS == NO_SLIP )
+	{
+		u_g[ x ] = -u_g[ nx + x ];
+		v_g[ x ] = 0.0;
+	}
+	else if( wS == FREE_SLIP )
+	{
+		u_g[ x ] = u_g[ nx + x ];
+		v_g[ x ] = 0.0;
+	}
+	else if( wS == OUTFLOW )
+	{
+		u_g[ x ] = u_g[ nx + x ];
+		v_g[ x ] = v_g[ nx + x ];
+	}
+
+	//-----------------------
+	// northern boundary
+	//-----------------------
+
+	// last interior row
+	const unsigned int idx = ( ny - 2 ) * nx + x;
+
+	if( wN == NO_SLIP )
+	{
+		u_g[ idx + nx  ] = -u_g[ idx ];
+		v_g[ idx ]       = 0.0;
+	}
+	else if( wN == FREE_SLIP )
+	{
+		u_g[ idx + nx ] = u_g[ idx ];
+		v_g[ idx ]      = 0.0;
+	}
+	else if( wN == OUTFLOW )
+	{
+		u_g[ idx + nx ] = u_g[ idx ];
+		v_g[ idx ]      = v_g[ idx - nx ];
+	}
+}
+
+//============================================================================
+// 1D variant of the western and eastern part of setBoundaryConditionsKernel,
+// one work item per row, to be called with a range of ny.
+__kernel void setVerticalBoundaryConditionsKernel
+	(
+		__global float*	u_g,
+		__global float*	v_g,
+		int				wE,		// boundary condition for eastern boundaries
+		int				wW,		// boundary condition for western boundaries
+		int				nx,		// dimension in x direction (including boundaries)
+		int				ny		// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		wE = CONST_WE;
+		wW = CONST_WW;
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int y = get_global_id( 0 );
+
+	if( y == 0 || y >= ny-1 )
+		return;
+
+	//-----------------------
+	// western boundary
+	//-----------------------
+
+	if( wW == NO_SLIP )
+	{
+		u_g[ y*nx ] = 0.0;
+		v_g[ y*nx ] = -v_g[ y*nx + 1 ];
+	}
+	else if( wW == FREE_SLIP )
+	{
+		u_g[ y*nx ] = 0.0;
+		v_g[ y*nx ] = v_g[ y*nx + 1 ];
+	}
+	else if( wW == OUTFLOW )
+	{
+		u_g[ y*nx ] = u_g[ y*nx + 1 ];
+		v_g[ y*nx ] = v_g[ y*nx + 1 ];
+	}
+
+	//-----------------------
+	// eastern boundary
+	//-----------------------
+
+	// last interior column
+	const unsigned int idx = y * nx + nx - 2;
+
+	if( wE == NO_SLIP )
+	{
+		u_g[ idx ]     = 0.0;
+		v_g[ idx + 1 ] = -v_g[ idx ];
+	}
+	else if( wE == FREE_SLIP )
+	{
+		u_g[ idx ]    = 0.0;
+		v_g[ idx + 1] = v_g[ idx ];
+	}
+	else if( wE == OUTFLOW )
+	{
+		u_g[ idx ]    = u_g[ idx - 1 ];
+		v_g[ idx + 1] = v_g[ idx ];
+	}
+}
+
 //============================================================================
 // todo: terrible inefficient => optimize
 // todo: call with range nx-2, ny-2 and offset 1,1
@@ -163,6 +315,12 @@ __kernel void setArbitraryBoundaryConditionsKernel
 //		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -247,7 +405,7 @@ __kernel void setArbitraryBoundaryConditionsKernel
 // -------------------------------------------------
 
 //============================================================================
-// todo: call only for one row
+// called for the first row only (range nx x 1)
 
 __kernel void setMovingLidBoundaryConditionsKernel
 	(
@@ -257,6 +415,12 @@ __kernel void setMovingLidBoundaryConditionsKernel
 //		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	//const unsigned int idx = y * nx + x;
@@ -272,7 +436,7 @@ __kernel void setMovingLidBoundaryConditionsKernel
 }
 
 //============================================================================
-// todo: call only for one column
+// called for the first column only (range 1 x ny)
 
 __kernel void setChannelBoundaryConditionsKernel
 	(
@@ -282,6 +446,12 @@ __kernel void setChannelBoundaryConditionsKernel
 //		int				pitch
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	//const unsigned int idx = y * nx + x;
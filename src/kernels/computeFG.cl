@@ -168,6 +168,95 @@ float duv_dy (
 
 //============================================================================
 
+// F of cell (x, y) as written by computeF, for 0 < y < ny - 1
+
+float computeFCell
+	(
+		__global float*			u_g,
+		__global float*			v_g,
+		__global unsigned char*	flag_g,
+		float					gx,
+		float					dt,
+		float					re,
+		float					alpha,
+		float					dx,
+		float					dy,
+		int						x,
+		int						y,
+		int						nx
+	)
+{
+	const int idx = y * nx + x;
+
+	// compute F between fluid cells only
+	// (second cell test for not to overwrite boundary values)
+	if( x > 0 && x < nx - 1 &&
+		flag_g[idx] == C_F && flag_g[idx + 1] == C_F )
+	{
+		return
+			u_g[idx] + dt *
+			(
+				(
+					d2m_dx2 ( u_g, dx, idx ) +
+					d2m_dy2 ( u_g, dy, idx, nx )
+				) / re
+				- du2_dx ( u_g, dx, alpha, idx )
+				- duv_dy ( u_g, v_g, dy, alpha, idx, nx )
+				+ gx
+			);
+	}
+
+	// according to formula 3.42
+	return u_g[idx];
+}
+
+//============================================================================
+
+// G of cell (x, y) as written by computeG, for 0 < x < nx - 1
+
+float computeGCell
+	(
+		__global float*			u_g,
+		__global float*			v_g,
+		__global unsigned char*	flag_g,
+		float					gy,
+		float					dt,
+		float					re,
+		float					alpha,
+		float					dx,
+		float					dy,
+		int						x,
+		int						y,
+		int						nx,
+		int						ny
+	)
+{
+	const int idx = y * nx + x;
+
+	// compute G between fluid cells only
+	// (second cell test for not to overwrite boundary values)
+	if( y > 0 && y < ny - 1 &&
+		flag_g[idx] == C_F && flag_g[idx + nx] == C_F )
+	{
+		return
+			v_g[idx] + dt *
+			(
+				(
+					d2m_dx2 ( v_g, dx, idx ) +
+					d2m_dy2 ( v_g, dy, idx, nx )
+				) / re
+				- dv2_dy ( v_g, dx, alpha, idx, nx )
+				- duv_dx ( u_g, v_g, dy, alpha, idx, nx )
+				+ gy
+			);
+	}
+
+	// according to formula 3.42
+	return v_g[idx];
+}
+
+//============================================================================
+
 // todo: change u, v and flag to constant memory
 // todo: try local shared memory for u and v
 // todo: reduce kernel range according to guards
@@ -188,6 +277,17 @@ __kernel void computeF
 		int						ny				// dimension in y direction (including boundaries)
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		gx    = CONST_GX;
+		re    = CONST_RE;
+		alpha = CONST_ALPHA;
+		dx    = CONST_DX;
+		dy    = CONST_DY;
+		nx    = CONST_NX;
+		ny    = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -196,34 +296,7 @@ __kernel void computeF
 	if( y > 0 &&
 		y < ny - 1 )
 	{
-		 if( x > 0 &&
-			x < nx - 1 )
-		{
-			// compute F between fluid cells only
-			if( flag_g[idx] == C_F && flag_g[idx + 1] == C_F ) // second cell test for not to overwrite boundary values
-			{
-				f_g[idx] =
-					u_g[idx] + dt *
-					(
-						(
-							d2m_dx2 ( u_g, dx, idx ) +
-							d2m_dy2 ( u_g, dy, idx, nx )
-						) / re
-						- du2_dx ( u_g, dx, alpha, idx )
-						- duv_dy ( u_g, v_g, dy, alpha, idx, nx )
-						+ gx
-					);
-			}
-			else
-			{
-				// according to formula 3.42
-				f_g[idx]   = u_g[idx];
-			}
-		}
-		else
-		{
-			f_g[idx]   = u_g[idx];
-		}
+		f_g[idx] = computeFCell( u_g, v_g, flag_g, gx, dt, re, alpha, dx, dy, x, y, nx );
 	}
 }
 
@@ -248,6 +321,17 @@ __kernel void computeG
 		int						ny				// dimension in y direction (including boundaries)
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		gy    = CONST_GY;
+		re    = CONST_RE;
+		alpha = CONST_ALPHA;
+		dx    = CONST_DX;
+		dy    = CONST_DY;
+		nx    = CONST_NX;
+		ny    = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -256,35 +340,7 @@ __kernel void computeG
 	if( x > 0 &&
 		x < nx - 1 )
 	{
-		if( y > 0 &&
-			y < ny - 1 )
-		{
-			// compute G between fluid cells only
-			if( flag_g[idx] == C_F && flag_g[idx + nx] == C_F ) // second cell test for not to overwrite boundary values
-			{
-				g_g[idx] =
-					v_g[idx] + dt *
-					(
-						(
-							d2m_dx2 ( v_g, dx, idx ) +
-							d2m_dy2 ( v_g, dy, idx, nx )
-						) / re
-						- dv2_dy ( v_g, dx, alpha, idx, nx )
-						- duv_dx ( u_g, v_g, dy, alpha, idx, nx )
-						+ gy
-					);
-			}
-			else
-			{
-				// according to formula 3.42
-				g_g[idx]   = v_g[idx];
-			}
-		}
-		else
-		{
-			g_g[idx]   = v_g[idx];
-		}
+		g_g[idx] = computeGCell( u_g, v_g, flag_g, gy, dt, re, alpha, dx, dy, x, y, nx, ny );
 	}
-
 }
 
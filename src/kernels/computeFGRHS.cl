@@ -0,0 +1,116 @@
+// -------------------------------------------------
+//	fused kernel for F, G and the right hand side
+// -------------------------------------------------
+
+// uses computeFCell and computeGCell of computeFG.cl
+
+//============================================================================
+
+// computes F and G like computeF and computeG and the right hand side like
+// rightHandSideKernel in one launch. F and G are still written, as
+// updateUVKernel needs them for every cell, but the right hand side is
+// computed from the values in shared memory instead of reading them back.
+// The work items of the first column and row of each work group additionally
+// compute F of the left and G of the lower neighbour cell.
+// The global range must cover the domain including boundaries in whole work groups.
+
+__kernel void computeFGRHSKernel
+	(
+		__global float*			u_g,			// horizontal velocity
+		__global float*			v_g,			// vertical velocity
+		__global unsigned char*	flag_g,			// array with fluid/boundary cell flags
+		__global float*			f_g,			// storage array for F
+		__global float*			g_g,			// storage array for G
+		__global float*			rhs_g,			// storage array for right hand side
+		__local  float*			f_s,			// shared memory for F: (local width + 1) * local height
+		__local  float*			g_s,			// shared memory for G: local width * (local height + 1)
+		float					gx,				// body force in x direction (gravity)
+		float					gy,				// body force in y direction (gravity)
+		float					dt,				// time step size
+		float					re,				// Reynolds number
+		float					alpha,
+		float					dx,				// length delta x of on cell in x-direction
+		float					dy,				// length delta y of on cell in y-direction
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		gx    = CONST_GX;
+		gy    = CONST_GY;
+		re    = CONST_RE;
+		alpha = CONST_ALPHA;
+		dx    = CONST_DX;
+		dy    = CONST_DY;
+		nx    = CONST_NX;
+		ny    = CONST_NY;
+	#endif
+
+	const int x   = get_global_id( 0 );
+	const int y   = get_global_id( 1 );
+	const int idx = y * nx + x;
+
+	const int lx  = get_local_id( 0 );
+	const int ly  = get_local_id( 1 );
+	const int lsx = get_local_size( 0 );
+
+	const bool inside = x < nx && y < ny;
+
+	// cells where computeF and computeG write
+	const bool hasF = inside && y > 0 && y < ny - 1;
+	const bool hasG = inside && x > 0 && x < nx - 1;
+
+	float f = 0.0f;
+	float g = 0.0f;
+
+	//-----------------------
+	// F and G
+	//-----------------------
+
+	if( hasF )
+	{
+		f = computeFCell( u_g, v_g, flag_g, gx, dt, re, alpha, dx, dy, x, y, nx );
+		f_g[idx] = f;
+	}
+
+	if( hasG )
+	{
+		g = computeGCell( u_g, v_g, flag_g, gy, dt, re, alpha, dx, dy, x, y, nx, ny );
+		g_g[idx] = g;
+	}
+
+	f_s[ly * (lsx + 1) + lx + 1] = f;
+	g_s[(ly + 1) * lsx + lx]     = g;
+
+	// neighbours left of and below the work group
+	if( lx == 0 )
+	{
+		f_s[ly * (lsx + 1)] = ( hasF && x > 0 ) ?
+				computeFCell( u_g, v_g, flag_g, gx, dt, re, alpha, dx, dy, x - 1, y, nx ) : 0.0f;
+	}
+
+	if( ly == 0 )
+	{
+		g_s[lx] = ( hasG && y > 0 ) ?
+				computeGCell( u_g, v_g, flag_g, gy, dt, re, alpha, dx, dy, x, y - 1, nx, ny ) : 0.0f;
+	}
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	//-----------------------
+	// right hand side
+	//-----------------------
+
+	if( x > 0 &&
+		y > 0 &&
+		x < nx - 1 &&
+		y < ny - 1 )
+	{
+		rhs_g[idx] = ( 1.0 / dt ) *
+			(
+				( f_s[ly * (lsx + 1) + lx + 1] - f_s[ly * (lsx + 1) + lx] ) / dx +
+				( g_s[(ly + 1) * lsx + lx]     - g_s[ly * lsx + lx]       ) / dy
+			);
+	}
+}
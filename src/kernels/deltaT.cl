@@ -5,9 +5,13 @@
 //============================================================================
 
 /*
- * this is not a ranged kernel and is to be called for just one workgroup
- * todo: seems to be very inefficient
- * todo: determine optimal work size N: N = x^2, N<=max_work_size, SIZE<=max_work_size ? N>=SIZE
+ * this is an 1D kernel, called with any number of workgroups
+ *
+ * first stage of the maximum computation: each workgroup writes the maxima
+ * of its part of the grid to results[2 * group id] and results[2 * group id + 1].
+ * If called with a single workgroup, results[0] and results[1] are the maxima
+ * of the whole grid, otherwise the partial maxima are combined by
+ * getUVMaximumFinalKernel.
  *
  * only for arrays without pitch
  * uses a two step reduction algorithm
@@ -18,17 +22,24 @@ __kernel void getUVMaximumKernel
 	(
 		__global float*	u_g,
 		__global float*	v_g,
-		__global float* results,		// result of max (Array with length 2: [u_max, v_max])
+		__global float* results,		// result of max (Array with length 2 * number of groups: [u_max, v_max, ...])
 		__local  float* u_s,			// dynamically allocated shared memory for workgroup
 		__local  float* v_s,			// dynamically allocated shared memory for workgroup
 		int				nx,				// dimension in x direction (including boundaries)
 		int				ny				// dimension in y direction (including boundaries)
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int idx_global	= get_global_id(0);
 	const unsigned int idx_local	= get_local_id(0);
 	const unsigned int limit 		= nx * ny;
 	const unsigned int local_size 	= get_local_size(0);
+	const unsigned int global_size	= get_global_size(0);
 
 	float local_max_u = -INFINITY;
 	float local_max_v = -INFINITY;
@@ -46,7 +57,7 @@ __kernel void getUVMaximumKernel
 		temp = fabs( v_g[i] );
 		local_max_v = ( temp > local_max_v ) ? temp : local_max_v;	// todo: use fmax
 
-		i += local_size;
+		i += global_size;
 	}
 
 	// local result
@@ -82,6 +93,60 @@ __kernel void getUVMaximumKernel
 	}
 
 	// write back results
+	if( idx_local == 0 )
+	{
+		results[2 * get_group_id(0)]     = u_s[0];
+		results[2 * get_group_id(0) + 1] = v_s[0];
+	}
+}
+
+
+//============================================================================
+
+/*
+ * second stage of the maximum computation,
+ * to be called with a range of the size of one workgroup
+ *
+ * combines the partial maxima of getUVMaximumKernel
+ */
+
+__kernel void getUVMaximumFinalKernel
+	(
+		__global float*	partials_g,		// partial maxima of the first stage: [u_max, v_max, ...]
+		__global float* results,		// result of max (Array with length 2: [u_max, v_max])
+		__local  float* u_s,			// dynamically allocated shared memory for workgroup
+		__local  float* v_s,			// dynamically allocated shared memory for workgroup
+		int				count			// number of partial results (workgroups of the first stage)
+	)
+{
+	const unsigned int idx_local	= get_local_id(0);
+	const unsigned int local_size 	= get_local_size(0);
+
+	float local_max_u = -INFINITY;
+	float local_max_v = -INFINITY;
+
+	for( unsigned int i = idx_local; i < count; i += local_size )
+	{
+		local_max_u = fmax( local_max_u, partials_g[2 * i] );
+		local_max_v = fmax( local_max_v, partials_g[2 * i + 1] );
+	}
+
+	u_s[idx_local] = local_max_u;
+	v_s[idx_local] = local_max_v;
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	for( unsigned int offset = local_size / 2; offset > 0; offset /= 2 )
+	{
+		if( idx_local < offset )
+		{
+			u_s[idx_local] = fmax( u_s[idx_local], u_s[idx_local + offset] );
+			v_s[idx_local] = fmax( v_s[idx_local], v_s[idx_local + offset] );
+		}
+
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
+
 	if( idx_local == 0 )
 	{
 		results[0] = u_s[0];
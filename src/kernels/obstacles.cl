@@ -0,0 +1,157 @@
+// -------------------------------------------------
+//	kernels for interactive obstacle drawing
+// -------------------------------------------------
+
+// boundary flags for arbitrary geometries
+// for explanation, see Definitions.h
+#define C_F		0x10
+#define C_B		0x00
+
+#define B_N		0x01
+#define B_S		0x02
+#define B_W		0x04
+#define B_E		0x08
+
+//============================================================================
+// draws a line of obstacles directly into the device fields, the same way
+// NavierStokesGPU::drawObstacles did on the host copies. Only the end points
+// are passed, so drawing does not transfer any field data.
+//
+// The cells of a line depend on each other (flags of later squares look at
+// the cells set before), so the line is drawn by a single work item.
+// Lines are short compared to the domain, so this is still much cheaper than
+// uploading the fields.
+//
+// The host obstacle map is mirrored by the flags: a cell is fluid if its
+// flag is C_F.
+
+__kernel void drawObstacleLineKernel
+	(
+		__global float*			u_g,			// horizontal velocity
+		__global float*			v_g,			// vertical velocity
+		__global float*			p_g,			// pressure
+		__global unsigned char*	flag_g,			// boundary cell flags
+		int						x0,				// first x offset of the line
+		int						y0,				// first y offset of the line
+		int						x1,				// last x offset of the line
+		int						y1,				// last y offset of the line
+		int						nx				// dimension in x direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+	#endif
+
+	if( get_global_id( 0 ) != 0 )
+		return;
+
+	// using bresenham's algorithm
+
+	int dx    = abs( x1 - x0 );		// difference in x direction
+	int dy    = abs( y1 - y0 );		// difference in y direction
+	int sx    = x0 < x1 ? 1 : -1;	// define step direction
+	int sy    = y0 < y1 ? 1 : -1;	// define step direction
+	int error = dx - dy;			// initial error value
+	int e2;
+
+	while( true )
+	{
+		int idx = y0 * nx + x0;		// south west corner of the painted square
+
+		//-----------------------
+		// update obstacle flags
+		//-----------------------
+
+		// south west corner
+		flag_g[idx] = C_B
+				+ B_N
+				+ B_S * ( y0 > 1 ? flag_g[idx - nx] == C_F : 1 )
+				+ B_W * ( x0 > 1 ? flag_g[idx - 1] == C_F : 1 )
+				+ B_E;
+
+		// south east corner
+		flag_g[idx + 1] = C_B
+				+ B_N
+				+ B_S * ( y0 > 1 ? flag_g[idx - nx + 1] == C_F : 1 )
+				+ B_W
+				+ B_E * ( flag_g[idx + 2] == C_F );
+
+		// north west corner
+		flag_g[idx + nx] = C_B
+				+ B_N * ( flag_g[idx + 2 * nx] == C_F )
+				+ B_S
+				+ B_W * ( x0 > 1 ? flag_g[idx + nx - 1] == C_F : 1 )
+				+ B_E;
+
+		// north east corner
+		flag_g[idx + nx + 1] = C_B
+				+ B_N
+				+ B_S * ( flag_g[idx + 2 * nx + 1] == C_F )
+				+ B_W
+				+ B_E * ( flag_g[idx + nx + 2] == C_F );
+
+
+		//-----------------------
+		// reset velocities
+		//-----------------------
+
+		u_g[idx]          = v_g[idx]          = 0.0;
+		u_g[idx + 1]      = v_g[idx + 1]      = 0.0;
+		u_g[idx + nx]     = v_g[idx + nx]     = 0.0;
+		u_g[idx + nx + 1] = v_g[idx + nx + 1] = 0.0;
+
+		// without reseting the results of the surrounding cells
+		// the results are quite unphysical
+		if( y0 > 1 )
+		{
+			u_g[idx - nx]     = v_g[idx - nx]     = 0.0;
+			u_g[idx - nx + 1] = v_g[idx - nx + 1] = 0.0;
+		}
+		u_g[idx + 2 * nx]     = v_g[idx + 2 * nx]     = 0.0;
+		u_g[idx + 2 * nx + 1] = v_g[idx + 2 * nx + 1] = 0.0;
+
+		if( x0 > 1 )
+		{
+			u_g[idx - 1]      = v_g[idx - 1]      = 0.0;
+			u_g[idx + nx - 1] = v_g[idx + nx - 1] = 0.0;
+		}
+
+		u_g[idx + 2]      = v_g[idx + 2]      = 0.0;
+		u_g[idx + nx + 2] = v_g[idx + nx + 2] = 0.0;
+
+
+		//-----------------------
+		// reset pressure
+		//-----------------------
+
+		p_g[idx]          = 0.0;
+		p_g[idx + 1]      = 0.0;
+		p_g[idx + nx]     = 0.0;
+		p_g[idx + nx + 1] = 0.0;
+
+
+		//-----------------------
+		// next line step
+		//-----------------------
+
+		if( x0 == x1 && y0 == y1 )
+		{
+			break;
+		}
+
+		e2 = error * 2;
+
+		if( e2 > -dy )
+		{
+			error = error - dy;
+			x0 = x0 + sx;
+		}
+
+		if( e2 < dx )
+		{
+			error = error + dx;
+			y0 = y0 + sy;
+		}
+	}
+}
@@ -18,10 +18,14 @@
 #define B_SE	0x0A
 
 //============================================================================
-// uses red/black pattern for parallelisation
-// todo: constant/texture memory for FLAG and RHS
-// todo: shared memory for P
-__kernel void gaussSeidelRedBlackKernel
+
+// red/black update of cell (x, y) as done by gaussSeidelRedBlackKernel
+//
+// If boundary is set, cells next to the domain boundary also set the boundary
+// value as pressureBoundaryConditionsKernel does. Only these cells read the
+// boundary value, so the separate boundary launch after each iteration is not needed.
+
+void gaussSeidelRedBlackCell
 	(
 		__global float*			p_g,			// pressure array
 		__global unsigned char*	flag_g,			// boundary cell flags
@@ -32,11 +36,12 @@ __kernel void gaussSeidelRedBlackKernel
 		float					constant_expr,	// constant expression 1.0 / ( 2.0 / dx2 + 2.0 / dy2 )
 		float					omega,			// (1.0 - omega) for SOR
 		int						nx,				// dimension in x direction (including boundaries)
-		int						ny				// dimension in y direction (including boundaries)
+		int						ny,				// dimension in y direction (including boundaries)
+		int						boundary,		// 1 to set the pressure boundary values, 0 otherwise
+		unsigned int			x,
+		unsigned int			y
 	)
 {
-	const unsigned int x   = get_global_id( 0 );
-	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
 
 	if( ((x + y) & 1) == red &&			// = ( (x + y) % 2 ) == red
@@ -88,13 +93,94 @@ __kernel void gaussSeidelRedBlackKernel
 				p_g[idx] = (p_g[idx + nx] + p_g[idx - 1]) * 0.5;
 				break;
 		}
+
+		// neumann boundary conditions, see pressureBoundaryConditionsKernel
+		if( boundary )
+		{
+			if( x == 1 )		p_g[idx - 1]  = p_g[idx];
+			if( x == nx - 2 )	p_g[idx + 1]  = p_g[idx];
+			if( y == 1 )		p_g[idx - nx] = p_g[idx];
+			if( y == ny - 2 )	p_g[idx + nx] = p_g[idx];
+		}
 	}
 }
 
+//============================================================================
+// uses red/black pattern for parallelisation
+// todo: constant/texture memory for FLAG and RHS
+// todo: shared memory for P
+__kernel void gaussSeidelRedBlackKernel
+	(
+		__global float*			p_g,			// pressure array
+		__global unsigned char*	flag_g,			// boundary cell flags
+		__global float*			rhs_g,			// storage array for righ hand side
+		float					dx2,			// sqare of length delta x of on cell in x-direction
+		float					dy2,			// sqare of length delta y of on cell in y-direction
+		int						red,			// 1 for red, 0 for black
+		float					constant_expr,	// constant expression 1.0 / ( 2.0 / dx2 + 2.0 / dy2 )
+		float					omega,			// (1.0 - omega) for SOR
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny,				// dimension in y direction (including boundaries)
+		int						boundary		// 1 to set the pressure boundary values, 0 otherwise
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx2           = CONST_DX2;
+		dy2           = CONST_DY2;
+		constant_expr = CONST_EXPR;
+		omega         = CONST_OMEGA;
+		nx            = CONST_NX;
+		ny            = CONST_NY;
+	#endif
+
+	gaussSeidelRedBlackCell( p_g, flag_g, rhs_g, dx2, dy2, red, constant_expr, omega,
+							 nx, ny, boundary, get_global_id( 0 ), get_global_id( 1 ) );
+}
+
+//============================================================================
+// gaussSeidelRedBlackKernel for the device controlled pressure iteration:
+// does nothing once pressureConvergenceKernel has found the iteration
+// converged, so all sweeps of a time step can be enqueued at once.
+__kernel void gaussSeidelRedBlackControlledKernel
+	(
+		__global float*			p_g,			// pressure array
+		__global unsigned char*	flag_g,			// boundary cell flags
+		__global float*			rhs_g,			// storage array for righ hand side
+		float					dx2,			// sqare of length delta x of on cell in x-direction
+		float					dy2,			// sqare of length delta y of on cell in y-direction
+		int						red,			// 1 for red, 0 for black
+		float					constant_expr,	// constant expression 1.0 / ( 2.0 / dx2 + 2.0 / dy2 )
+		float					omega,			// (1.0 - omega) for SOR
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny,				// dimension in y direction (including boundaries)
+		int						boundary,		// 1 to set the pressure boundary values, 0 otherwise
+		__global const int*		control_g		// [0]: converged flag, [1]: number of iterations
+	)
+{
+	if( control_g[0] )
+	{
+		return;
+	}
+
+	#ifdef SPECIALIZED
+		dx2           = CONST_DX2;
+		dy2           = CONST_DY2;
+		constant_expr = CONST_EXPR;
+		omega         = CONST_OMEGA;
+		nx            = CONST_NX;
+		ny            = CONST_NY;
+	#endif
+
+	gaussSeidelRedBlackCell( p_g, flag_g, rhs_g, dx2, dy2, red, constant_expr, omega,
+							 nx, ny, boundary, get_global_id( 0 ), get_global_id( 1 ) );
+}
+
 
 //============================================================================
 // todo: use 1D kernel and proper range (terribly inefficient right now)
 // todo: only neumann, implement dirichlet and periodic boundary conditions
+// not needed if gaussSeidelRedBlackKernel sets the boundary values
 
 __kernel void pressureBoundaryConditionsKernel
 	(
@@ -104,6 +190,12 @@ __kernel void pressureBoundaryConditionsKernel
 		int				ny				// dimension in y direction (including boundaries)
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -130,18 +222,19 @@ __kernel void pressureBoundaryConditionsKernel
 
 //============================================================================
 /*
- * this is an 1D kernel and is to be called with a range of the size of one workgroup
- * todo: seems to be inefficient
+ * this is an 1D kernel, called with any number of workgroups
  * todo: constant/texture memory for P, FLAG and RHS
- * todo: determine optimal work size N: N = x^2, N<=max_work_size, SIZE<=max_work_size ? N>=SIZE
  *
- * returns the sum of all squared elements of the pressure array
+ * first stage of the residual computation: each workgroup writes the sum
+ * of the squared residuals of its part of the grid to result[group id].
+ * If called with a single workgroup, result[0] is the total sum,
+ * otherwise the partial sums are added by pressureResidualSumKernel.
  *
  * uses a two step reduction algorithm
  * see http://developer.amd.com/resources/documentation-articles/articles-whitepapers/opencl-optimization-case-study-simple-reductions/
  */
 
-__kernel void pressureResidualReductionKernel
+void pressureResidualReduction
 	(
 		__global float*	        p_g,			// pressure array
 		__global float*	        rhs_g,			// storage array for right hand side
@@ -158,6 +251,7 @@ __kernel void pressureResidualReductionKernel
 	const unsigned int idx_local	= get_local_id(0);
 	const unsigned int limit 		= nx * ny;
 	const unsigned int local_size 	= get_local_size(0);
+	const unsigned int global_size	= get_global_size(0);
 
 	float local_sum = 0.0;
 
@@ -187,7 +281,7 @@ __kernel void pressureResidualReductionKernel
 			local_sum += temp * temp;
 		}
 
-		i += local_size;
+		i += global_size;
 	}
 
 	// local result
@@ -215,8 +309,392 @@ __kernel void pressureResidualReductionKernel
 	}
 
 	// write back results
+	if( idx_local == 0 )
+	{
+		result[get_group_id(0)] = residual_s[0];
+	}
+}
+
+//============================================================================
+__kernel void pressureResidualReductionKernel
+	(
+		__global float*	        p_g,			// pressure array
+		__global float*	        rhs_g,			// storage array for right hand side
+		__global unsigned char*	flag_g,			// boundary cell flags
+		__global float*	        result,			// result buffer for residual
+		__local  float*         residual_s,		// dynamically allocated shared memory for workgroup
+		float                   dx2,			// sqare of length delta x of on cell in x-direction
+		float                   dy2,			// sqare of length delta y of on cell in y-direction
+		int                     nx,				// dimension in x direction (including boundaries)
+		int                     ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx2 = CONST_DX2;
+		dy2 = CONST_DY2;
+		nx  = CONST_NX;
+		ny  = CONST_NY;
+	#endif
+
+	pressureResidualReduction( p_g, rhs_g, flag_g, result, residual_s, dx2, dy2, nx, ny );
+}
+
+//============================================================================
+// pressureResidualReductionKernel for the device controlled pressure
+// iteration, does nothing once the iteration has converged. The flag is
+// the same for all work items, so either all or none reach the barriers.
+__kernel void pressureResidualReductionControlledKernel
+	(
+		__global float*	        p_g,			// pressure array
+		__global float*	        rhs_g,			// storage array for right hand side
+		__global unsigned char*	flag_g,			// boundary cell flags
+		__global float*	        result,			// result buffer for residual
+		__local  float*         residual_s,		// dynamically allocated shared memory for workgroup
+		float                   dx2,			// sqare of length delta x of on cell in x-direction
+		float                   dy2,			// sqare of length delta y of on cell in y-direction
+		int                     nx,				// dimension in x direction (including boundaries)
+		int                     ny,				// dimension in y direction (including boundaries)
+		__global const int*     control_g		// [0]: converged flag, [1]: number of iterations
+	)
+{
+	if( control_g[0] )
+	{
+		return;
+	}
+
+	#ifdef SPECIALIZED
+		dx2 = CONST_DX2;
+		dy2 = CONST_DY2;
+		nx  = CONST_NX;
+		ny  = CONST_NY;
+	#endif
+
+	pressureResidualReduction( p_g, rhs_g, flag_g, result, residual_s, dx2, dy2, nx, ny );
+}
+
+
+//============================================================================
+/*
+ * second stage of the residual computation,
+ * to be called with a range of the size of one workgroup
+ *
+ * adds the partial sums of pressureResidualReductionKernel
+ */
+
+void pressureResidualSum
+	(
+		__global float*	partials_g,		// partial sums, one per workgroup of the first stage
+		__global float*	result,			// result buffer for residual
+		__local  float*	residual_s,		// dynamically allocated shared memory for workgroup
+		int				count			// number of partial sums
+	)
+{
+	const unsigned int idx_local	= get_local_id(0);
+	const unsigned int local_size 	= get_local_size(0);
+
+	float local_sum = 0.0;
+
+	for( unsigned int i = idx_local; i < count; i += local_size )
+	{
+		local_sum += partials_g[i];
+	}
+
+	residual_s[idx_local] = local_sum;
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	for( unsigned int offset = local_size / 2; offset > 0; offset /= 2 )
+	{
+		if( idx_local < offset )
+		{
+			residual_s[idx_local] += residual_s[idx_local + offset];
+		}
+
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
+
 	if( idx_local == 0 )
 	{
 		result[0] = residual_s[0];
 	}
 }
+
+//============================================================================
+__kernel void pressureResidualSumKernel
+	(
+		__global float*	partials_g,		// partial sums, one per workgroup of the first stage
+		__global float*	result,			// result buffer for residual
+		__local  float*	residual_s,		// dynamically allocated shared memory for workgroup
+		int				count			// number of partial sums
+	)
+{
+	pressureResidualSum( partials_g, result, residual_s, count );
+}
+
+//============================================================================
+// pressureResidualSumKernel for the device controlled pressure iteration,
+// does nothing once the iteration has converged
+__kernel void pressureResidualSumControlledKernel
+	(
+		__global float*	partials_g,		// partial sums, one per workgroup of the first stage
+		__global float*	result,			// result buffer for residual
+		__local  float*	residual_s,		// dynamically allocated shared memory for workgroup
+		int				count,			// number of partial sums
+		__global const int*	control_g	// [0]: converged flag, [1]: number of iterations
+	)
+{
+	if( control_g[0] )
+	{
+		return;
+	}
+
+	pressureResidualSum( partials_g, result, residual_s, count );
+}
+
+
+//============================================================================
+/*
+ * convergence check of the device controlled pressure iteration,
+ * to be called with a single work item after pressureResidualSumKernel
+ *
+ * counts the iterations done since the last check and sets the converged
+ * flag if the residual is below epsilon. Once set, the flag is kept and
+ * gaussSeidelRedBlackControlledKernel does nothing, so the host only reads
+ * the number of iterations at the end of the time step.
+ */
+
+__kernel void pressureConvergenceKernel
+	(
+		__global const float*	residual_g,		// sum of squared residuals
+		__global int*			control_g,		// [0]: converged flag, [1]: number of iterations
+		int						iterations,		// iterations since the last check
+		float					epsilon,		// threshold for the residual
+		int						cells			// number of interior cells
+	)
+{
+	if( control_g[0] )
+	{
+		return;
+	}
+
+	control_g[1] += iterations;
+
+	// same norm as computed on the host
+	if( sqrt( residual_g[0] / cells ) <= epsilon )
+	{
+		control_g[0] = 1;
+	}
+}
+
+
+//============================================================================
+/*
+ * tiled variant of gaussSeidelRedBlackKernel, doing several complete
+ * iterations (black cells, red cells, boundary values) in one launch
+ *
+ * each workgroup loads its tile of the pressure, flag and right hand side
+ * arrays plus a halo of 3 cells per iteration into shared memory. Every step
+ * (black, red, boundary) makes one more ring of the loaded block invalid, so
+ * after all iterations the inner tile equals the result of the untiled
+ * kernels and is written to p_out_g. Neighbouring tiles overlap and compute
+ * the halo redundantly instead of communicating.
+ *
+ * p_in_g and p_out_g must be different buffers, as other workgroups
+ * still read the old values of the halo.
+ * The global range must cover the domain including boundaries in whole workgroups.
+ */
+
+__kernel void gaussSeidelRedBlackTiledKernel
+	(
+		__global float*			p_in_g,			// pressure array before the iterations
+		__global float*			p_out_g,		// pressure array after the iterations
+		__global unsigned char*	flag_g,			// boundary cell flags
+		__global float*			rhs_g,			// storage array for righ hand side
+		__local  float*			p_s,			// shared memory for tile and halo: (local size + 2 * halo)^2 floats
+		__local  float*			rhs_s,			// shared memory, as p_s
+		__local  unsigned char*	flag_s,			// shared memory, as p_s
+		float					dx2,			// sqare of length delta x of on cell in x-direction
+		float					dy2,			// sqare of length delta y of on cell in y-direction
+		float					constant_expr,	// constant expression 1.0 / ( 2.0 / dx2 + 2.0 / dy2 )
+		float					omega,			// (1.0 - omega) for SOR
+		int						iterations,		// number of iterations
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx2           = CONST_DX2;
+		dy2           = CONST_DY2;
+		constant_expr = CONST_EXPR;
+		omega         = CONST_OMEGA;
+		nx            = CONST_NX;
+		ny            = CONST_NY;
+	#endif
+
+	const int halo = 3 * iterations;
+
+	const int lx0 = get_local_id( 0 );
+	const int ly0 = get_local_id( 1 );
+	const int lsx = get_local_size( 0 );
+	const int lsy = get_local_size( 1 );
+
+	// size of the block in shared memory
+	const int lw = lsx + 2 * halo;
+	const int lh = lsy + 2 * halo;
+
+	// global position of the first cell of the block
+	const int gx0 = get_group_id( 0 ) * lsx - halo;
+	const int gy0 = get_group_id( 1 ) * lsy - halo;
+
+	int lx, ly, gx, gy, l, g;
+
+	//-----------------------
+	// load block
+	//-----------------------
+
+	for( ly = ly0; ly < lh; ly += lsy )
+	{
+		for( lx = lx0; lx < lw; lx += lsx )
+		{
+			gx = gx0 + lx;
+			gy = gy0 + ly;
+			l  = ly * lw + lx;
+
+			if( gx >= 0 && gy >= 0 && gx < nx && gy < ny )
+			{
+				g = gy * nx + gx;
+
+				p_s[l]    = p_in_g[g];
+				rhs_s[l]  = rhs_g[g];
+				flag_s[l] = flag_g[g];
+			}
+			else
+			{
+				// outside of the domain, never used for valid cells
+				p_s[l]    = 0.0f;
+				rhs_s[l]  = 0.0f;
+				flag_s[l] = C_B;
+			}
+		}
+	}
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	//-----------------------
+	// iterations
+	//-----------------------
+
+	for( int it = 0; it < iterations; ++it )
+	{
+		// black and red cells
+		for( int red = 0; red < 2; ++red )
+		{
+			// the outermost ring of the block lacks neighbours and is skipped
+			for( ly = ly0 + 1; ly < lh - 1; ly += lsy )
+			{
+				for( lx = lx0 + 1; lx < lw - 1; lx += lsx )
+				{
+					gx = gx0 + lx;
+					gy = gy0 + ly;
+					l  = ly * lw + lx;
+
+					if( ((gx + gy) & 1) != red ||
+						gx <= 0 ||
+						gy <= 0 ||
+						gx >= nx - 1 ||
+						gy >= ny - 1 )
+					{
+						continue;
+					}
+
+					switch ( flag_s[l] )
+					{
+						case C_F:
+							p_s[l] =
+								omega * p_s[l] +
+								constant_expr * (
+									( p_s[l - 1] + p_s[l + 1] ) * dx2
+									+
+									( p_s[l - lw] + p_s[l + lw] ) * dy2
+									-
+									rhs_s[l]
+								);
+							break;
+
+						case B_N:
+							p_s[l] = p_s[l + lw];
+							break;
+						case B_S:
+							p_s[l] = p_s[l - lw];
+							break;
+						case B_W:
+							p_s[l] = p_s[l - 1];
+							break;
+						case B_E:
+							p_s[l] = p_s[l + 1];
+							break;
+						case B_NW:
+							p_s[l] = (p_s[l - lw] + p_s[l + 1]) * 0.5;
+							break;
+						case B_NE:
+							p_s[l] = (p_s[l + lw] + p_s[l + 1]) * 0.5;
+							break;
+						case B_SW:
+							p_s[l] = (p_s[l - lw] + p_s[l - 1]) * 0.5;
+							break;
+						case B_SE:
+							p_s[l] = (p_s[l + lw] + p_s[l - 1]) * 0.5;
+							break;
+					}
+				}
+			}
+
+			barrier( CLK_LOCAL_MEM_FENCE );
+		}
+
+		// boundary values, as pressureBoundaryConditionsKernel
+		for( ly = ly0 + 1; ly < lh - 1; ly += lsy )
+		{
+			for( lx = lx0 + 1; lx < lw - 1; lx += lsx )
+			{
+				gx = gx0 + lx;
+				gy = gy0 + ly;
+				l  = ly * lw + lx;
+
+				if( gx == 0 && gy > 0 && gy < ny-1 )
+				{
+					p_s[l] = p_s[l + 1];
+				}
+				else if( gx == nx-1 && gy > 0 && gy < ny-1 )
+				{
+					p_s[l] = p_s[l - 1];
+				}
+
+				if( gy == 0 && gx > 0 && gx < nx-1 )
+				{
+					p_s[l] = p_s[l + lw];
+				}
+				else if( gy == ny-1 && gx > 0 && gx < nx-1 )
+				{
+					p_s[l] = p_s[l - lw];
+				}
+			}
+		}
+
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
+
+	//-----------------------
+	// write back tile
+	//-----------------------
+
+	gx = get_global_id( 0 );
+	gy = get_global_id( 1 );
+
+	if( gx < nx && gy < ny )
+	{
+		p_out_g[gy * nx + gx] = p_s[(ly0 + halo) * lw + lx0 + halo];
+	}
+}
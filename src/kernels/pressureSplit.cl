@@ -0,0 +1,414 @@
+// -------------------------------------------------
+//	kernels for the pressure equation on separate
+//	arrays for red and black cells
+// -------------------------------------------------
+
+// boundary flags for arbitrary geometries
+// for explanation, see Definitions.h
+#define C_F		0x10
+#define C_B		0x00
+
+#define B_N		0x01
+#define B_S		0x02
+#define B_W		0x04
+#define B_E		0x08
+
+#define B_NW	0x05
+#define B_NE	0x09
+#define B_SW	0x06
+#define B_SE	0x0A
+
+// Layout:
+// cell (x,y) has the colour (x + y) & 1 (1 for red, 0 for black) and is
+// stored at y * w + x / 2 in the array of its colour, with w = (nx + 1) / 2.
+// All four neighbours of a cell have the other colour:
+//   west  (x-1,y): y * w + (x - 1) / 2
+//   east  (x+1,y): y * w + (x + 1) / 2
+//   south (x,y-1): (y - 1) * w + x / 2
+//   north (x,y+1): (y + 1) * w + x / 2
+// Neighbouring work items of a sweep access neighbouring elements,
+// instead of every other element of the natural layout.
+
+//============================================================================
+// index of cell (x,y) in the array of its colour
+
+int splitIndex ( int x, int y, int w )
+{
+	return y * w + ( x >> 1 );
+}
+
+//============================================================================
+// value of cell (x,y) of a field stored in split layout
+
+float splitValue
+	(
+		__global float*	black_g,
+		__global float*	red_g,
+		int				x,
+		int				y,
+		int				w
+	)
+{
+	return ( ( x + y ) & 1 ) ? red_g[splitIndex( x, y, w )] : black_g[splitIndex( x, y, w )];
+}
+
+
+//============================================================================
+// copies a field from the natural into the split layout,
+// called with the size of the domain including boundaries
+
+__kernel void splitRedBlackKernel
+	(
+		__global float*	natural_g,		// field in natural layout
+		__global float*	black_g,		// black cells of the field
+		__global float*	red_g,			// red cells of the field
+		int				nx,				// dimension in x direction (including boundaries)
+		int				ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int x = get_global_id( 0 );
+	const unsigned int y = get_global_id( 1 );
+
+	if( x < nx && y < ny )
+	{
+		const int w = ( nx + 1 ) >> 1;
+
+		if( ( x + y ) & 1 )
+			red_g[splitIndex( x, y, w )]   = natural_g[y * nx + x];
+		else
+			black_g[splitIndex( x, y, w )] = natural_g[y * nx + x];
+	}
+}
+
+//============================================================================
+// flag array version of splitRedBlackKernel
+
+__kernel void splitRedBlackFlagKernel
+	(
+		__global unsigned char*	natural_g,		// flags in natural layout
+		__global unsigned char*	black_g,		// flags of the black cells
+		__global unsigned char*	red_g,			// flags of the red cells
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int x = get_global_id( 0 );
+	const unsigned int y = get_global_id( 1 );
+
+	if( x < nx && y < ny )
+	{
+		const int w = ( nx + 1 ) >> 1;
+
+		if( ( x + y ) & 1 )
+			red_g[splitIndex( x, y, w )]   = natural_g[y * nx + x];
+		else
+			black_g[splitIndex( x, y, w )] = natural_g[y * nx + x];
+	}
+}
+
+//============================================================================
+// copies a field from the split into the natural layout,
+// called with the size of the domain including boundaries
+
+__kernel void mergeRedBlackKernel
+	(
+		__global float*	black_g,		// black cells of the field
+		__global float*	red_g,			// red cells of the field
+		__global float*	natural_g,		// field in natural layout
+		int				nx,				// dimension in x direction (including boundaries)
+		int				ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int x = get_global_id( 0 );
+	const unsigned int y = get_global_id( 1 );
+
+	if( x < nx && y < ny )
+	{
+		natural_g[y * nx + x] = splitValue( black_g, red_g, x, y, ( nx + 1 ) >> 1 );
+	}
+}
+
+
+//============================================================================
+// gaussSeidelRedBlackKernel on the split layout
+// called with a range of (nx + 1) / 2 x ny, one work item per cell of the colour
+//
+// The neighbours of the updated cells all have the other colour, so p_g is
+// only written and q_g only read, apart from the boundary values. These are
+// set by the cells next to the domain boundary, as in gaussSeidelRedBlackKernel
+// with boundary set.
+
+__kernel void gaussSeidelRedBlackSplitKernel
+	(
+		__global float*			p_black_g,		// pressure of the black cells
+		__global float*			p_red_g,		// pressure of the red cells
+		__global unsigned char*	flag_black_g,	// boundary cell flags of the black cells
+		__global unsigned char*	flag_red_g,		// boundary cell flags of the red cells
+		__global float*			rhs_black_g,	// right hand side of the black cells
+		__global float*			rhs_red_g,		// right hand side of the red cells
+		float					dx2,			// sqare of length delta x of on cell in x-direction
+		float					dy2,			// sqare of length delta y of on cell in y-direction
+		int						red,			// 1 for red, 0 for black
+		float					constant_expr,	// constant expression 1.0 / ( 2.0 / dx2 + 2.0 / dy2 )
+		float					omega,			// (1.0 - omega) for SOR
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx2           = CONST_DX2;
+		dy2           = CONST_DY2;
+		constant_expr = CONST_EXPR;
+		omega         = CONST_OMEGA;
+		nx            = CONST_NX;
+		ny            = CONST_NY;
+	#endif
+
+	const int k = get_global_id( 0 );
+	const int y = get_global_id( 1 );
+	const int x = 2 * k + ( ( y + red ) & 1 );
+	const int w = ( nx + 1 ) >> 1;
+
+	// cells of this colour and of the other colour
+	__global float*			p_g    = red ? p_red_g     : p_black_g;
+	__global float*			q_g    = red ? p_black_g   : p_red_g;
+	__global unsigned char*	flag_g = red ? flag_red_g  : flag_black_g;
+	__global float*			rhs_g  = red ? rhs_red_g   : rhs_black_g;
+
+	if( x > 0 &&
+		y > 0 &&
+		x < nx - 1 &&
+		y < ny - 1 )
+	{
+		const int idx   = y * w + k;
+		const int west  = y * w + ( ( x - 1 ) >> 1 );
+		const int east  = y * w + ( ( x + 1 ) >> 1 );
+		const int south = idx - w;
+		const int north = idx + w;
+
+		switch ( flag_g[idx] )
+		{
+			case C_F:
+
+				// calculate pressure in fluid cells
+				p_g[idx] =
+					omega * p_g[idx] +
+					constant_expr * (
+						( q_g[west] + q_g[east] ) * dx2
+						+
+						( q_g[south] + q_g[north] ) * dy2
+						-
+						rhs_g[idx]
+					);
+				break;
+
+				// set boundary pressure value for obstacle cells
+
+			case B_N:
+				p_g[idx] = q_g[north];
+				break;
+			case B_S:
+				p_g[idx] = q_g[south];
+				break;
+			case B_W:
+				p_g[idx] = q_g[west];
+				break;
+			case B_E:
+				p_g[idx] = q_g[east];
+				break;
+			case B_NW:
+				p_g[idx] = (q_g[south] + q_g[east]) * 0.5;
+				break;
+			case B_NE:
+				p_g[idx] = (q_g[north] + q_g[east]) * 0.5;
+				break;
+			case B_SW:
+				p_g[idx] = (q_g[south] + q_g[west]) * 0.5;
+				break;
+			case B_SE:
+				p_g[idx] = (q_g[north] + q_g[west]) * 0.5;
+				break;
+		}
+
+		// neumann boundary conditions, the boundary cells have the other colour
+		if( x == 1 )		q_g[west]  = p_g[idx];
+		if( x == nx - 2 )	q_g[east]  = p_g[idx];
+		if( y == 1 )		q_g[south] = p_g[idx];
+		if( y == ny - 2 )	q_g[north] = p_g[idx];
+	}
+}
+
+
+//============================================================================
+// pressureResidualReductionKernel on the split layout
+// first stage of the two stage reduction, see pressureResidualReductionKernel.
+// The partial sums are added by pressureResidualSumKernel.
+
+__kernel void pressureResidualSplitReductionKernel
+	(
+		__global float*	        p_black_g,		// pressure of the black cells
+		__global float*	        p_red_g,		// pressure of the red cells
+		__global float*	        rhs_black_g,	// right hand side of the black cells
+		__global float*	        rhs_red_g,		// right hand side of the red cells
+		__global unsigned char*	flag_black_g,	// boundary cell flags of the black cells
+		__global unsigned char*	flag_red_g,		// boundary cell flags of the red cells
+		__global float*	        result,			// result buffer for residual
+		__local  float*         residual_s,		// dynamically allocated shared memory for workgroup
+		float                   dx2,			// sqare of length delta x of on cell in x-direction
+		float                   dy2,			// sqare of length delta y of on cell in y-direction
+		int                     nx,				// dimension in x direction (including boundaries)
+		int                     ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx2 = CONST_DX2;
+		dy2 = CONST_DY2;
+		nx  = CONST_NX;
+		ny  = CONST_NY;
+	#endif
+
+	const unsigned int idx_global	= get_global_id(0);
+	const unsigned int idx_local	= get_local_id(0);
+	const unsigned int local_size 	= get_local_size(0);
+	const unsigned int global_size	= get_global_size(0);
+
+	const int w = ( nx + 1 ) >> 1;
+	const unsigned int colourSize = w * ny;
+	const unsigned int limit      = 2 * colourSize;
+
+	float local_sum = 0.0;
+
+	unsigned int i = idx_global;
+	float temp;
+
+	// the black cells first, then the red cells
+
+	while( i < limit )
+	{
+		const int red = i >= colourSize;
+		const int j   = i - red * colourSize;
+		const int y   = j / w;
+		const int x   = 2 * ( j % w ) + ( ( y + red ) & 1 );
+
+		__global float*			p_g    = red ? p_red_g    : p_black_g;
+		__global float*			q_g    = red ? p_black_g  : p_red_g;
+		__global unsigned char*	flag_g = red ? flag_red_g : flag_black_g;
+		__global float*			rhs_g  = red ? rhs_red_g  : rhs_black_g;
+
+		if( x > 0 &&
+			y > 0 &&
+			x < nx-1 &&
+			y < ny-1 &&			// guards
+			flag_g[j] == C_F	// residual for fluid cells only
+			)
+		{
+			temp =
+				  ( q_g[y * w + ( ( x + 1 ) >> 1 )] - 2.0 * p_g[j] + q_g[y * w + ( ( x - 1 ) >> 1 )] ) * dx2
+				+ ( q_g[j + w] - 2.0 * p_g[j] + q_g[j - w] ) * dy2
+				- rhs_g[j];
+
+			local_sum += temp * temp;
+		}
+
+		i += global_size;
+	}
+
+	// local result
+	residual_s[idx_local] = local_sum;
+
+	barrier( CLK_LOCAL_MEM_FENCE );
+
+	// collect results hierarchically
+	for( unsigned int offset = local_size / 2; offset > 0; offset /= 2 )
+	{
+		if( idx_local < offset )
+		{
+			residual_s[idx_local] += residual_s[idx_local + offset];
+		}
+
+		barrier( CLK_LOCAL_MEM_FENCE );
+	}
+
+	if( idx_local == 0 )
+	{
+		result[get_group_id(0)] = residual_s[0];
+	}
+}
+
+
+//============================================================================
+// updateUVKernel with the pressure in split layout
+
+__kernel void updateUVSplitKernel
+	(
+		__global float*			p_black_g,		// pressure of the black cells
+		__global float*			p_red_g,		// pressure of the red cells
+		__global float*			f_g,			// F
+		__global float*			g_g,			// G
+		__global unsigned char*	flag_g,			// array with fluid/boundary cell flags
+		__global float*			u_g,			// horizontal velocity
+		__global float*			v_g,			// vertical velocity
+		float					dt,				// time step size
+		float					dx,				// length delta x of on cell in x-direction
+		float					dy,				// length delta y of on cell in y-direction
+		int						nx,				// dimension in x direction (including boundaries)
+		int						ny				// dimension in y direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx = CONST_DX;
+		dy = CONST_DY;
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
+	const unsigned int x   = get_global_id( 0 );
+	const unsigned int y   = get_global_id( 1 );
+	const unsigned int idx = y * nx + x;
+	const int w = ( nx + 1 ) >> 1;
+
+	float dt_dx = dt / dx;
+	float dt_dy = dt / dy;
+
+	// guards
+	if( x > 0 &&
+		y > 0 &&
+		x < nx - 1 &&
+		y < ny - 1 )
+	{
+		float p = splitValue( p_black_g, p_red_g, x, y, w );
+
+		// update horizontal velocity U
+		if( x < nx - 2 && flag_g[idx] == C_F && flag_g[idx + 1] == C_F )
+		{
+			u_g[idx] = f_g[idx] - dt_dx * ( splitValue( p_black_g, p_red_g, x + 1, y, w ) - p );
+		}
+
+		// update vertical velocity V
+		if ( y < ny - 2 && flag_g[idx] == C_F && flag_g[idx + nx] == C_F )
+		{
+			v_g[idx] = g_g[idx] - dt_dy * ( splitValue( p_black_g, p_red_g, x, y + 1, w ) - p );
+		}
+	}
+}
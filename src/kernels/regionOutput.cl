@@ -0,0 +1,73 @@
+// -------------------------------------------------
+//	kernels for in-situ region output
+// -------------------------------------------------
+
+//============================================================================
+
+// extracts cell centered velocities and pressure of a rectangular region,
+// optionally downsampled by a factor. Each work item computes one output
+// cell from a block of factor x factor grid cells, either by taking the
+// first cell of the block (stride) or by averaging the block (box filter).
+// Blocks at the upper region borders may be smaller.
+// The output consists of three planes u, v and p of width * height values.
+
+__kernel void regionOutputKernel
+	(
+		__global float*	u_g,			// horizontal velocity
+		__global float*	v_g,			// vertical velocity
+		__global float*	p_g,			// pressure
+		__global float*	output_g,		// extracted region
+		int				x0,				// first cell of the region in x direction
+		int				y0,				// first cell of the region in y direction
+		int				x1,				// last cell of the region in x direction
+		int				y1,				// last cell of the region in y direction
+		int				factor,			// downsampling factor
+		int				box,			// 1 for box filter, 0 for stride
+		int				width,			// number of output cells in x direction
+		int				height,			// number of output cells in y direction
+		int				nx				// dimension in x direction (including boundaries)
+	)
+{
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		nx = CONST_NX;
+	#endif
+
+	const int x = get_global_id( 0 );
+	const int y = get_global_id( 1 );
+
+	if( x >= width || y >= height )
+		return;
+
+	int xStart = x0 + x * factor;
+	int yStart = y0 + y * factor;
+
+	int xStop = box ? min( xStart + factor - 1, x1 ) : xStart;
+	int yStop = box ? min( yStart + factor - 1, y1 ) : yStart;
+
+	float u = 0.0f;
+	float v = 0.0f;
+	float p = 0.0f;
+
+	for( int j = yStart; j <= yStop; ++j )
+	{
+		for( int i = xStart; i <= xStop; ++i )
+		{
+			int idx = j * nx + i;
+
+			// u and v are located on cell borders
+			u += 0.5f * ( u_g[idx - 1]  + u_g[idx] );
+			v += 0.5f * ( v_g[idx - nx] + v_g[idx] );
+			p += p_g[idx];
+		}
+	}
+
+	float scale = 1.0f / (float)( ( xStop - xStart + 1 ) * ( yStop - yStart + 1 ) );
+
+	int size = width * height;
+	int idx  = y * width + x;
+
+	output_g[idx]            = u * scale;
+	output_g[idx + size]     = v * scale;
+	output_g[idx + 2 * size] = p * scale;
+}
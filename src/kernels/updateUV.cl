@@ -25,6 +25,14 @@ __kernel void updateUVKernel
 		int						ny				// dimension in y direction (including boundaries)
 	)
 {
+	// problem constants known at compile time, see CLManager::getBuildOptions
+	#ifdef SPECIALIZED
+		dx = CONST_DX;
+		dy = CONST_DY;
+		nx = CONST_NX;
+		ny = CONST_NY;
+	#endif
+
 	const unsigned int x   = get_global_id( 0 );
 	const unsigned int y   = get_global_id( 1 );
 	const unsigned int idx = y * nx + x;
@@ -8,6 +8,10 @@
 
 //#include "viewer/SimplePGMWriter.h"
 #include "viewer/VTKWriter.h"
+#include "viewer/VTIWriter.h"
+#include "viewer/AsyncViewer.h"
+#include "viewer/TimeSeriesWriter.h"
+#include "viewer/TimeSeriesReader.h"
 
 
 #include <stdlib.h>
@@ -25,6 +29,7 @@ void cleanup ( );
 //********************************************************************
 
 Parameters  parameters;
+CLManager*  clManager  = 0;
 Simulation* simulation = 0;
 Viewer*	    viewer     = 0;
 MainWindow* window     = 0;
@@ -54,6 +59,48 @@ int main ( int argc, char* argv[] )
 		return 1;
 	}
 
+	// convert time series file to vtk files, no simulation
+	if ( !parameters.convertFile.empty() )
+	{
+		return TimeSeriesReader::convert( parameters.convertFile, &parameters ) ? 0 : 1;
+	}
+
+	// only list the available OpenCL devices, no simulation
+	if ( parameters.clListDevices )
+	{
+		return CLManager::listDevices() ? 0 : 1;
+	}
+
+	// compile the kernels in the background while the obstacle map is read
+	// and the gui is set up
+	if( parameters.useGPU )
+	{
+		try
+		{
+			clManager = new CLManager( &parameters );
+		}
+		catch( cl::Error error )
+		{
+			// reason has been printed already
+			return 1;
+		}
+
+		clManager->startCompilation();
+	}
+
+	// read obstacle map
+	if ( !InputParser::readObstacleMap(
+			 &(parameters.obstacleMap),
+			 parameters.nx,
+			 parameters.ny,
+			 parameters.obstacleFile )
+		 )
+	{
+		std::cerr << "Error reading obstacle map." << std::endl;
+		cleanup();
+		return 1;
+	}
+
 	// print parameter set to console
 	InputParser::printParameters ( &parameters );
 
@@ -78,7 +125,16 @@ int main ( int argc, char* argv[] )
 
 	if( parameters.VTKWriteFiles )
 	{
-		viewer = new VTKWriter( &parameters );
+		if( parameters.VTKFormat == VTK_LEGACY )
+			viewer = new VTKWriter( &parameters );
+		else if( parameters.VTKFormat == VTK_SERIES )
+			viewer = new TimeSeriesWriter( &parameters );
+		else
+			viewer = new VTIWriter( &parameters );
+
+		// write files in a background thread
+		if( parameters.asyncBuffers > 0 )
+			viewer = new AsyncViewer( &parameters, viewer, parameters.asyncBuffers );
 	}
 	else
 	{
@@ -99,7 +155,7 @@ int main ( int argc, char* argv[] )
 		// TODO: move check for valid obstacle map to inputParser
 		//       and remove this try/catch
 
-		simulation = new Simulation( &parameters, viewer );
+		simulation = new Simulation( &parameters, viewer, clManager );
 	}
 	catch( const char* error_message )
 	{
@@ -163,6 +219,12 @@ int main ( int argc, char* argv[] )
 
 	simulation->printPerformanceMeasurements();
 
+	// kernel and transfer times, if enabled by -clprofile
+	if( clManager )
+	{
+		clManager->writeProfile();
+	}
+
 	cleanup();
 
 	return application_return_value;
@@ -172,6 +234,7 @@ int main ( int argc, char* argv[] )
 void cleanup ( )
 {
 	SAFE_DELETE( simulation );
+	SAFE_DELETE( clManager );
 	SAFE_DELETE( window );
 	if( parameters.VTKWriteFiles )
 	{
@@ -4,8 +4,10 @@
 //********************************************************************
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <cmath>
+#include <algorithm>
 #include "navierStokesCPU.h"
 
 #include <iostream>
@@ -22,7 +24,14 @@
 NavierStokesCPU::NavierStokesCPU ( Parameters* parameters )
 	: NavierStokesSolver( parameters )
 {
+	_splitWidth = 0;
 
+	for( int i = 0; i < 2; ++i )
+	{
+		_PSplit[i]    = 0;
+		_RHSSplit[i]  = 0;
+		_FLAGSplit[i] = 0;
+	}
 }
 
 //============================================================================
@@ -37,6 +46,13 @@ NavierStokesCPU::~NavierStokesCPU()
 
 	free( _FLAG[0] );
 	free( _FLAG );
+
+	for( int i = 0; i < 2; ++i )
+	{
+		free( _PSplit[i] );
+		free( _RHSSplit[i] );
+		free( _FLAGSplit[i] );
+	}
 }
 
 // -------------------------------------------------
@@ -71,6 +87,21 @@ void NavierStokesCPU::initialize ( )
 	setHostMatrix ( _U, 1, _parameters->nx, 1, _parameters->ny, _parameters->ui );
 	setHostMatrix ( _V, 1, _parameters->nx, 1, _parameters->ny, _parameters->vi );
 	setHostMatrix ( _P, 1, _parameters->nx, 1, _parameters->ny, _parameters->pi );
+
+	// separate arrays for red and black cells
+	if( _parameters->splitPressure )
+	{
+		_splitWidth = ( _parameters->nx + 3 ) / 2;
+
+		int splitSize = _splitWidth * ( _parameters->ny + 2 );
+
+		for( int i = 0; i < 2; ++i )
+		{
+			_PSplit[i]    = (REAL*)malloc( splitSize * sizeof( REAL ) );
+			_RHSSplit[i]  = (REAL*)malloc( splitSize * sizeof( REAL ) );
+			_FLAGSplit[i] = (unsigned char*)malloc( splitSize * sizeof( unsigned char ) );
+		}
+	}
 }
 
 //============================================================================
@@ -201,6 +232,26 @@ bool NavierStokesCPU::setObstacleMap
 	return true;
 }
 
+//============================================================================
+bool NavierStokesCPU::loadState
+	(
+		const REAL* U,
+		const REAL* V,
+		const REAL* P,
+		const unsigned char* FLAG
+	)
+{
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	// all matrices are stored in continuous memory
+	memcpy( *_U,    U,    size * sizeof( REAL ) );
+	memcpy( *_V,    V,    size * sizeof( REAL ) );
+	memcpy( *_P,    P,    size * sizeof( REAL ) );
+	memcpy( *_FLAG, FLAG, size * sizeof( unsigned char ) );
+
+	return true;
+}
+
 // -------------------------------------------------
 //	execution
 // -------------------------------------------------
@@ -208,32 +259,51 @@ bool NavierStokesCPU::setObstacleMap
 //============================================================================
 int NavierStokesCPU::doSimulationStep ( )
 {
+	// whole domain, including boundaries
+	int ny2 = _parameters->ny + 2;
+
 	// get delta_t
 	computeDeltaT();
 
 	// set boundary values for u and v
-	setBoundaryConditions();
+	setBoundaryConditions( 0, ny2 );
 
-	setSpecificBoundaryConditions();
+	setSpecificBoundaryConditions( 0, ny2 );
 
 	// compute F(n) and G(n)
-	computeFG();
+	computeFG( 0, ny2 );
 
 	// compute right hand side of pressure equation
-	computeRightHandSide();
+	computeRightHandSide( 0, ny2 );
 
 	// poisson overrelaxation loop
 	REAL residual = INFINITY;
 
 	int sor_iterations = 0;
-	for ( ; sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon; ++sor_iterations )
+
+	if( _parameters->splitPressure )
+	{
+		// the other steps use the natural layout
+		splitRedBlack();
+
+		for ( ; sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon; ++sor_iterations )
+		{
+			residual = SORPoissonSplit();
+		}
+
+		mergeRedBlack();
+	}
+	else
 	{
-		// do SOR step (includes residual computation)
-		residual = SORPoisson();
+		for ( ; sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon; ++sor_iterations )
+		{
+			// do SOR step (includes residual computation)
+			residual = SORPoisson();
+		}
 	}
 
 	// compute U(n+1) and V(n+1)
-	adaptUV();
+	adaptUV( 0, ny2 );
 
 	return sor_iterations;
 }
@@ -401,44 +471,61 @@ REAL** NavierStokesCPU::getP_CPU ( )
 	return _P;
 }
 
+//============================================================================
+unsigned char** NavierStokesCPU::getFLAG_CPU ( )
+{
+	return _FLAG;
+}
+
 
 // -------------------------------------------------
 //	boundaries
 // -------------------------------------------------
 
 //============================================================================
-void NavierStokesCPU::setBoundaryConditions ( )
+void NavierStokesCPU::setBoundaryConditions
+	(
+		int firstRow,
+		int lastRow
+	)
 {
 	int nx1 = _parameters->nx + 1;
 	int ny1 = _parameters->ny + 1;
 
+	// interior rows of the range
+	int yStart = std::max( firstRow, 1 );
+	int yEnd   = std::min( lastRow, ny1 );
+
 	//-----------------------
 	// southern boundary
 	//-----------------------
 
-	switch( _parameters->wS )
+	if( firstRow == 0 )
 	{
-		case NO_SLIP:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[0][x] = -_U[1][x];
-				_V[0][x] = 0.0;
-			}
-			break;
-		case FREE_SLIP:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[0][x] = _U[1][x];
-				_V[0][x] = 0.0;
-			}
-			break;
-		case OUTFLOW:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[0][x] = _U[1][x];
-				_V[0][x] = _V[1][x];
-			}
-			break;
+		switch( _parameters->wS )
+		{
+			case NO_SLIP:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[0][x] = -_U[1][x];
+					_V[0][x] = 0.0;
+				}
+				break;
+			case FREE_SLIP:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[0][x] = _U[1][x];
+					_V[0][x] = 0.0;
+				}
+				break;
+			case OUTFLOW:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[0][x] = _U[1][x];
+					_V[0][x] = _V[1][x];
+				}
+				break;
+		}
 	}
 
 
@@ -446,29 +533,32 @@ void NavierStokesCPU::setBoundaryConditions ( )
 	// northern boundary
 	//-----------------------
 
-	switch( _parameters->wN )
+	if( lastRow == ny1 + 1 )
 	{
-		case NO_SLIP:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[ny1][x] = -_U[_parameters->ny][x];
-				_V[_parameters->ny][x] = 0.0;
-			}
-			break;
-		case FREE_SLIP:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[ny1][x] = _U[_parameters->ny][x];
-				_V[_parameters->ny][x] = 0.0;
-			}
-			break;
-		case OUTFLOW:
-			for( int x = 1; x < nx1; ++x )
-			{
-				_U[ny1][x] = _U[_parameters->ny][x];
-				_V[_parameters->ny][x] = _V[_parameters->ny-1][x];
-			}
-			break;
+		switch( _parameters->wN )
+		{
+			case NO_SLIP:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[ny1][x] = -_U[_parameters->ny][x];
+					_V[_parameters->ny][x] = 0.0;
+				}
+				break;
+			case FREE_SLIP:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[ny1][x] = _U[_parameters->ny][x];
+					_V[_parameters->ny][x] = 0.0;
+				}
+				break;
+			case OUTFLOW:
+				for( int x = 1; x < nx1; ++x )
+				{
+					_U[ny1][x] = _U[_parameters->ny][x];
+					_V[_parameters->ny][x] = _V[_parameters->ny-1][x];
+				}
+				break;
+		}
 	}
 
 
@@ -479,21 +569,21 @@ void NavierStokesCPU::setBoundaryConditions ( )
 	switch( _parameters->wW )
 	{
 		case NO_SLIP:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][0] = 0.0;
 				_V[y][0] = -_V[y][1];
 			}
 			break;
 		case FREE_SLIP:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][0] = 0.0;
 				_V[y][0] = _V[y][1];
 			}
 			break;
 		case OUTFLOW:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][0] = _U[y][1];
 				_V[y][0] = _V[y][1];
@@ -509,21 +599,21 @@ void NavierStokesCPU::setBoundaryConditions ( )
 	switch( _parameters->wE )
 	{
 		case NO_SLIP:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][_parameters->nx] = 0.0;
 				_V[y][nx1] = -_V[y][_parameters->nx];
 			}
 			break;
 		case FREE_SLIP:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][_parameters->nx] = 0.0;
 				_V[y][nx1] = _V[y][_parameters->nx];
 			}
 			break;
 		case OUTFLOW:
-			for( int y = 1; y < ny1; ++y )
+			for( int y = yStart; y < yEnd; ++y )
 			{
 				_U[y][_parameters->nx] = _U[y][_parameters->nx-1];
 				_V[y][nx1] = _V[y][_parameters->nx];
@@ -569,7 +659,7 @@ void NavierStokesCPU::setBoundaryConditions ( )
 	//       but leads to different values on the GPU.
 	//        => check if it really doesn't matter
 
-	for( int y = 1; y < ny1; ++y )
+	for( int y = yStart; y < yEnd; ++y )
 	{
 		for( int x = 1; x < nx1; ++x )
 		{
@@ -642,11 +732,15 @@ void NavierStokesCPU::setBoundaryConditions ( )
 }
 
 //============================================================================
-void NavierStokesCPU::setSpecificBoundaryConditions ( )
+void NavierStokesCPU::setSpecificBoundaryConditions
+	(
+		int firstRow,
+		int lastRow
+	)
 {
 	// todo: find sophisticated way to specifiy this in the input file
 
-	if ( _parameters->problem == "moving_lid" )
+	if ( _parameters->problem == "moving_lid" && firstRow == 0 )
 	{
 		//const REAL lid_velocity = 1.0;
 		for ( int x = 1; x < _parameters->nx + 1; ++x )
@@ -656,7 +750,7 @@ void NavierStokesCPU::setSpecificBoundaryConditions ( )
 	}
 	else if ( _parameters->problem == "channel" )
 	{
-		for ( int y = 1; y < _parameters->ny + 1; ++y )
+		for ( int y = std::max( firstRow, 1 ); y < std::min( lastRow, _parameters->ny + 1 ); ++y )
 		{
 			_U[y][0] = 1.0;
 		}
@@ -711,7 +805,11 @@ void NavierStokesCPU::computeDeltaT ( )
 }
 
 //============================================================================
-void NavierStokesCPU::computeFG ( )
+void NavierStokesCPU::computeFG
+	(
+		int firstRow,
+		int lastRow
+	)
 {
 	// y coordinates are counted from lower left edge
 
@@ -721,7 +819,11 @@ void NavierStokesCPU::computeFG ( )
 	int nx1 = _parameters->nx + 1;
 	int ny1 = _parameters->ny + 1;
 
-	for( int y = 1; y < ny1; ++y )
+	// interior rows of the range
+	int yStart = std::max( firstRow, 1 );
+	int yEnd   = std::min( lastRow, ny1 );
+
+	for( int y = yStart; y < yEnd; ++y )
 	{
 		for( int x = 1; x < nx1; ++x )
 		{
@@ -827,7 +929,7 @@ void NavierStokesCPU::computeFG ( )
 
 
 	// setting boundary values for f according to formula 3.42
-	for ( int y = 1; y < ny1; ++y )
+	for ( int y = yStart; y < yEnd; ++y )
 	{
 		_F[y][0]   = _U[y][0];
 		_F[y][_parameters->nx] = _U[y][_parameters->nx];
@@ -836,13 +938,20 @@ void NavierStokesCPU::computeFG ( )
 	// setting boundary values for g according to formula 3.42
 	for ( int x = 1; x < nx1; ++x )
 	{
-		_G[0][x]   = _V[0][x];
-		_G[_parameters->ny][x] = _V[_parameters->ny][x];
+		if( firstRow == 0 )
+			_G[0][x] = _V[0][x];
+
+		if( _parameters->ny < yEnd )
+			_G[_parameters->ny][x] = _V[_parameters->ny][x];
 	}
 }
 
 //============================================================================
-void NavierStokesCPU::computeRightHandSide ( )
+void NavierStokesCPU::computeRightHandSide
+	(
+		int firstRow,
+		int lastRow
+	)
 {
 	// compute right-hand side of poisson equation according to formula 3.38
 
@@ -850,7 +959,7 @@ void NavierStokesCPU::computeRightHandSide ( )
 	int nx1 = _parameters->nx + 1;
 	int ny1 = _parameters->ny + 1;
 
-	for ( int y = 1; y < ny1; ++y )
+	for ( int y = std::max( firstRow, 1 ); y < std::min( lastRow, ny1 ); ++y )
 	{
 		for ( int x = 1; x < nx1; ++x )
 		{
@@ -999,7 +1108,295 @@ REAL NavierStokesCPU::SORPoisson ( )
 }
 
 //============================================================================
-void NavierStokesCPU::adaptUV ( )
+REAL NavierStokesCPU::SORPoissonSplit ( )
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+	int w   = _splitWidth;
+
+	REAL dx2 = _parameters->dx * _parameters->dx;
+	REAL dy2 = _parameters->dy * _parameters->dy;
+
+	REAL dx2_inv = 1.0 / dx2;
+	REAL dy2_inv = 1.0 / dy2;
+
+	REAL relaxation    = _parameters->omega;
+	REAL constant_expr = _parameters->omega / ( 2.0 / dx2 + 2.0 / dy2 );
+
+	// cell (x,y) has the colour (x + y) & 1 and is stored at y * w + x / 2
+	// in the array of its colour. All neighbours have the other colour.
+
+	//-----------------------
+	// SOR step, black cells first
+	//-----------------------
+
+	for( int red = 0; red < 2; ++red )
+	{
+		for( int y = 1; y < ny1; ++y )
+		{
+			// x = 2 * k + s, the interior cells of this colour are k = 1 - s ... (nx - s) / 2
+			int s      = ( y + red ) & 1;
+			int kBegin = 1 - s;
+			int kEnd   = ( _parameters->nx - s ) / 2 + 1;
+
+			REAL*					p     = _PSplit[red]       + y * w;
+			const REAL*				west  = _PSplit[1 - red]   + y * w + s - 1;
+			const REAL*				east  = _PSplit[1 - red]   + y * w + s;
+			const REAL*				south = _PSplit[1 - red]   + ( y - 1 ) * w;
+			const REAL*				north = _PSplit[1 - red]   + ( y + 1 ) * w;
+			const REAL*				rhs   = _RHSSplit[red]     + y * w;
+			const unsigned char*	flag  = _FLAGSplit[red]    + y * w;
+
+			// fluid cells: (1 - omega) * p + constant_expr * ( ... ) written as a correction
+			// of p, masked by the flag instead of a branch to allow vectorization
+			for( int k = kBegin; k < kEnd; ++k )
+			{
+				REAL fluid = flag[k] == C_F;
+
+				REAL correction =
+					constant_expr * (
+						( west[k] + east[k] ) * dx2_inv
+						+
+						( south[k] + north[k] ) * dy2_inv
+						-
+						rhs[k]
+					)
+					- relaxation * p[k];
+
+				p[k] += fluid * correction;
+			}
+
+			// boundary pressure values for obstacle cells,
+			// they only read cells of the other colour
+			for( int k = kBegin; k < kEnd; ++k )
+			{
+				switch( flag[k] )
+				{
+					case B_N:  p[k] = north[k]; break;
+					case B_S:  p[k] = south[k]; break;
+					case B_W:  p[k] = west[k];  break;
+					case B_E:  p[k] = east[k];  break;
+					case B_NW: p[k] = ( south[k] + east[k] ) / 2; break;
+					case B_NE: p[k] = ( north[k] + east[k] ) / 2; break;
+					case B_SW: p[k] = ( south[k] + west[k] ) / 2; break;
+					case B_SE: p[k] = ( north[k] + west[k] ) / 2; break;
+				}
+			}
+		}
+	}
+
+	//-----------------------
+	// boundary values
+	//-----------------------
+
+	// only Neumann, see SORPoisson
+
+	for ( int x = 1; x < nx1; ++x )
+	{
+		_PSplit[x & 1][x >> 1] = _PSplit[( x + 1 ) & 1][w + ( x >> 1 )];
+		_PSplit[( x + ny1 ) & 1][ny1 * w + ( x >> 1 )] = _PSplit[( x + _parameters->ny ) & 1][_parameters->ny * w + ( x >> 1 )];
+	}
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		_PSplit[y & 1][y * w] = _PSplit[( y + 1 ) & 1][y * w];
+		_PSplit[( nx1 + y ) & 1][y * w + ( nx1 >> 1 )] = _PSplit[( _parameters->nx + y ) & 1][y * w + ( _parameters->nx >> 1 )];
+	}
+
+	//-----------------------
+	// residual
+	//-----------------------
+
+	// compute residual using L²-Norm (according to formula 3.45 and 3.46)
+
+	REAL tmp;
+	REAL sum = 0.0;
+	int numCells = 0;
+
+	for( int red = 0; red < 2; ++red )
+	{
+		for( int y = 1; y < ny1; ++y )
+		{
+			int s      = ( y + red ) & 1;
+			int kBegin = 1 - s;
+			int kEnd   = ( _parameters->nx - s ) / 2 + 1;
+
+			const REAL*				p     = _PSplit[red]       + y * w;
+			const REAL*				west  = _PSplit[1 - red]   + y * w + s - 1;
+			const REAL*				east  = _PSplit[1 - red]   + y * w + s;
+			const REAL*				south = _PSplit[1 - red]   + ( y - 1 ) * w;
+			const REAL*				north = _PSplit[1 - red]   + ( y + 1 ) * w;
+			const REAL*				rhs   = _RHSSplit[red]     + y * w;
+			const unsigned char*	flag  = _FLAGSplit[red]    + y * w;
+
+			for( int k = kBegin; k < kEnd; ++k )
+			{
+				if ( flag[k] == C_F )
+				{
+					tmp =
+						  ( ( east[k]  - p[k] ) - ( p[k] - west[k]  ) ) * dx2_inv
+						+ ( ( north[k] - p[k] ) - ( p[k] - south[k] ) ) * dy2_inv
+						- rhs[k];
+
+					sum += tmp * tmp;
+
+					++numCells;
+				}
+			}
+		}
+	}
+
+	return sqrt( sum / numCells );
+}
+
+//============================================================================
+void NavierStokesCPU::SORPoissonRedBlack
+	(
+		int red,
+		int firstRow,
+		int lastRow
+	)
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	REAL dx2 = _parameters->dx * _parameters->dx;
+	REAL dy2 = _parameters->dy * _parameters->dy;
+
+	REAL constant_expr = _parameters->omega / ( 2.0 / dx2 + 2.0 / dy2 );
+
+	for ( int y = std::max( firstRow, 1 ); y < std::min( lastRow, ny1 ); ++y )
+	{
+		// first cell of the colour in this row
+		for ( int x = 2 - ( ( y + red ) & 1 ); x < nx1; x += 2 )
+		{
+			switch ( _FLAG[y][x] )
+			{
+				case C_F:
+					_P[y][x] =
+						( 1.0 - _parameters->omega ) * _P[y][x] +
+						constant_expr * (
+							( _P[y][x-1] + _P[y][x+1] ) / dx2
+							+
+							( _P[y-1][x] + _P[y+1][x] ) / dy2
+							-
+							_RHS[y][x]
+						);
+					break;
+
+				// boundary pressure value for obstacle cells, as in gaussSeidelRedBlackKernel
+				case B_N:
+					_P[y][x] = _P[y+1][x];
+					break;
+				case B_S:
+					_P[y][x] = _P[y-1][x];
+					break;
+				case B_W:
+					_P[y][x] = _P[y][x-1];
+					break;
+				case B_E:
+					_P[y][x] = _P[y][x+1];
+					break;
+				case B_NW:
+					_P[y][x] = (_P[y-1][x] + _P[y][x+1]) / 2;
+					break;
+				case B_NE:
+					_P[y][x] = (_P[y+1][x] + _P[y][x+1]) / 2;
+					break;
+				case B_SW:
+					_P[y][x] = (_P[y-1][x] + _P[y][x-1]) / 2;
+					break;
+				case B_SE:
+					_P[y][x] = (_P[y+1][x] + _P[y][x-1]) / 2;
+					break;
+			}
+
+			// neumann boundary conditions, set by the cells next to the boundary
+			if( x == 1 )				_P[y][0]   = _P[y][x];
+			if( x == _parameters->nx )	_P[y][nx1] = _P[y][x];
+			if( y == 1 )				_P[0][x]   = _P[y][x];
+			if( y == _parameters->ny )	_P[ny1][x] = _P[y][x];
+		}
+	}
+}
+
+//============================================================================
+REAL NavierStokesCPU::pressureResidualSum
+	(
+		int firstRow,
+		int lastRow
+	)
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	REAL dx2 = _parameters->dx * _parameters->dx;
+	REAL dy2 = _parameters->dy * _parameters->dy;
+
+	REAL tmp;
+	REAL sum = 0.0;
+
+	// according to formula 3.45
+	for ( int y = std::max( firstRow, 1 ); y < std::min( lastRow, ny1 ); ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			if ( _FLAG[y][x] == C_F )
+			{
+				tmp =
+					  ( _P[y][x+1] - 2.0 * _P[y][x] + _P[y][x-1] ) / dx2
+					+ ( _P[y+1][x] - 2.0 * _P[y][x] + _P[y-1][x] ) / dy2
+					- _RHS[y][x];
+
+				sum += tmp * tmp;
+			}
+		}
+	}
+
+	return sum;
+}
+
+//============================================================================
+void NavierStokesCPU::splitRedBlack ( )
+{
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	for( int y = 0; y < ny2; ++y )
+	{
+		for( int x = 0; x < nx2; ++x )
+		{
+			int colour = ( x + y ) & 1;
+			int idx    = y * _splitWidth + ( x >> 1 );
+
+			_PSplit[colour][idx]    = _P[y][x];
+			_RHSSplit[colour][idx]  = _RHS[y][x];
+			_FLAGSplit[colour][idx] = _FLAG[y][x];
+		}
+	}
+}
+
+//============================================================================
+void NavierStokesCPU::mergeRedBlack ( )
+{
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	for( int y = 0; y < ny2; ++y )
+	{
+		for( int x = 0; x < nx2; ++x )
+		{
+			_P[y][x] = _PSplit[( x + y ) & 1][y * _splitWidth + ( x >> 1 )];
+		}
+	}
+}
+
+//============================================================================
+void NavierStokesCPU::adaptUV
+	(
+		int firstRow,
+		int lastRow
+	)
 {
 	// update u and v according to 3.34 and 3.35
 
@@ -1009,8 +1406,10 @@ void NavierStokesCPU::adaptUV ( )
 	REAL dt_dx = _parameters->dt / _parameters->dx;
 	REAL dt_dy = _parameters->dt / _parameters->dy;
 
+	int yStart = std::max( firstRow, 1 );
+
 	// update u. two nested loops because of different limits
-	for ( int y = 1; y < ny1; ++y )
+	for ( int y = yStart; y < std::min( lastRow, ny1 ); ++y )
 	{
 		for ( int x = 1; x < _parameters->nx; ++x )
 		{
@@ -1022,7 +1421,7 @@ void NavierStokesCPU::adaptUV ( )
 	}
 
 	// update v
-	for ( int y = 1; y < _parameters->ny; ++y )
+	for ( int y = yStart; y < std::min( lastRow, _parameters->ny ); ++y )
 	{
 		for ( int x = 1; x < nx1; ++x )
 		{
@@ -32,6 +32,12 @@ class NavierStokesCPU : public NavierStokesSolver
 
 		unsigned char **_FLAG;	//! obstacle map
 
+		// split red/black layout of the pressure iteration, [0] black cells, [1] red cells
+		int				_splitWidth;		//! cells of one colour per row, including boundaries
+		REAL			*_PSplit[2],		//! pressure
+						*_RHSSplit[2];		//! right-hand side
+		unsigned char	*_FLAGSplit[2];		//! obstacle map
+
 			//! @}
 
 	public:
@@ -68,6 +74,17 @@ class NavierStokesCPU : public NavierStokesSolver
 
 		bool	setObstacleMap ( bool** map );
 
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! \returns true if the state was loaded, false otherwise
+
+		bool	loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			);
+
 			//! @}
 
 
@@ -132,6 +149,11 @@ class NavierStokesCPU : public NavierStokesSolver
 
 		REAL** getP_CPU ( );
 
+			//! \brief gives access to the obstacle flags
+			//! \returns pointer to flag array
+
+		unsigned char** getFLAG_CPU ( );
+
 			//! @}
 
 
@@ -143,12 +165,16 @@ class NavierStokesCPU : public NavierStokesSolver
 			//! @{
 
 			//!  \brief sets the boundary values for U and V depending on wN, wS, wW and wE
+			//! The row ranges of this and the following functions include the
+			//! boundary rows, so 0 and ny + 2 process the whole domain.
+			//! \param first row
+			//! \param row after the last row
 
-		void	setBoundaryConditions ( );
+		void	setBoundaryConditions ( int firstRow, int lastRow );
 
 			//! \brief  TODO
 
-		void	setSpecificBoundaryConditions ( );
+		void	setSpecificBoundaryConditions ( int firstRow, int lastRow );
 
 			//! @}
 
@@ -165,20 +191,47 @@ class NavierStokesCPU : public NavierStokesSolver
 
 			//! \brief computes F and G
 
-		void	computeFG ( );
+		void	computeFG ( int firstRow, int lastRow );
 
 			//! \brief computes the right-hand side of the pressure equation
 
-		void	computeRightHandSide ( );
+		void	computeRightHandSide ( int firstRow, int lastRow );
 
 			//! \brief SOR iteration step for pressure Poisson equation
 			//! \returns residual
 
 		REAL	SORPoisson ( );
 
+			//! \brief red/black SOR iteration step on the split layout
+			//! The black and the red cells are stored in separate arrays, so the
+			//! inner loops run over contiguous memory and can be vectorized.
+			//! \returns residual
+
+		REAL	SORPoissonSplit ( );
+
+			//! \brief red or black half step of the SOR iteration, as done by
+			//! gaussSeidelRedBlackKernel, including the pressure boundary values.
+			//! Used if rows are shared with the GPU, see NavierStokesHybrid.
+			//! \param 1 for red cells, 0 for black cells
+
+		void	SORPoissonRedBlack ( int red, int firstRow, int lastRow );
+
+			//! \brief computes the squared residuals of the pressure equation
+			//! \returns sum of the squared residuals of the fluid cells
+
+		REAL	pressureResidualSum ( int firstRow, int lastRow );
+
+			//! \brief copies P, RHS and FLAG into the split layout
+
+		void	splitRedBlack ( );
+
+			//! \brief copies the pressure from the split layout back to P
+
+		void	mergeRedBlack ( );
+
 			//! \brief calculates new velocities
 
-		void	adaptUV ( );
+		void	adaptUV ( int firstRow, int lastRow );
 
 			//! @}
 
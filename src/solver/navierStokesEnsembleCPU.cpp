@@ -0,0 +1,1408 @@
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cmath>
+#include "navierStokesEnsembleCPU.h"
+
+#include <iostream>
+
+//********************************************************************
+//**    implementation
+//********************************************************************
+
+// all loops over ENSEMBLE_WIDTH are the innermost loops and access
+// consecutive memory, so they can be vectorised by the compiler.
+// Masked members are handled by selecting the old value instead of
+// branching, which keeps the loops free of control flow.
+
+// -------------------------------------------------
+//	constructor / destructor
+// -------------------------------------------------
+
+//============================================================================
+NavierStokesEnsembleCPU::NavierStokesEnsembleCPU ( Parameters* parameters )
+	: NavierStokesSolver( parameters )
+{
+	_nx2       = _parameters->nx + 2;
+	_rowStride = _nx2 * ENSEMBLE_WIDTH;
+
+	_numMembers = _parameters->ensembleRe.size() > _parameters->ensembleVelocity.size()
+				? _parameters->ensembleRe.size()
+				: _parameters->ensembleVelocity.size();
+
+	if( _numMembers < 1 )
+		_numMembers = 1;
+
+	if( _numMembers > ENSEMBLE_WIDTH )
+	{
+		throw "Too many ensemble members. Increase ENSEMBLE_WIDTH in Definitions.h!";
+	}
+
+	if( _parameters->ensembleOutput < 0 || _parameters->ensembleOutput >= _numMembers )
+	{
+		_parameters->ensembleOutput = 0;
+	}
+
+	// unused lanes are computed with the parameters of the
+	// first member to avoid invalid values, but stay masked
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		int member = l < _numMembers ? l : 0;
+
+		_re[l] = member < (int)_parameters->ensembleRe.size()
+			   ? _parameters->ensembleRe[member]
+			   : _parameters->re;
+
+		_velocity[l] = member < (int)_parameters->ensembleVelocity.size()
+					 ? _parameters->ensembleVelocity[member]
+					 : 1.0;
+
+		_dt[l]       = _parameters->dt;
+		_time[l]     = 0.0;
+		_active[l]   = l < _numMembers;
+		_iterate[l]  = false;
+		_residual[l] = 0.0;
+	}
+}
+
+//============================================================================
+NavierStokesEnsembleCPU::~NavierStokesEnsembleCPU()
+{
+	free( _U );
+	free( _V );
+	free( _P );
+	free( _RHS );
+	free( _F );
+	free( _G );
+
+	freeHostMatrix( _U_out );
+	freeHostMatrix( _V_out );
+	freeHostMatrix( _P_out );
+
+	free( _FLAG[0] );
+	free( _FLAG );
+}
+
+// -------------------------------------------------
+//	initialization
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesEnsembleCPU::initialize ( )
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	size_t size = _nx2 * ( _parameters->ny + 2 ) * ENSEMBLE_WIDTH * sizeof( REAL );
+
+	// allocate memory for matrices U, V, P, RHS, F, G
+
+	_U   = (REAL*)malloc( size );
+	_V   = (REAL*)malloc( size );
+	_P   = (REAL*)malloc( size );
+	_RHS = (REAL*)malloc( size );
+	_F   = (REAL*)malloc( size );
+	_G   = (REAL*)malloc( size );
+
+	// initialise matrices with 0.0
+
+	memset( _U,   0, size );
+	memset( _V,   0, size );
+	memset( _P,   0, size );
+	memset( _RHS, 0, size );
+	memset( _F,   0, size );
+	memset( _G,   0, size );
+
+	// initialise interior cells of U, V and P with given initial values
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			setCell( _U, x, y, _parameters->ui );
+			setCell( _V, x, y, _parameters->vi );
+			setCell( _P, x, y, _parameters->pi );
+		}
+	}
+
+	// host memory for the member passed to the viewer
+
+	_U_out = allocHostMatrix ( _nx2, _parameters->ny + 2 );
+	_V_out = allocHostMatrix ( _nx2, _parameters->ny + 2 );
+	_P_out = allocHostMatrix ( _nx2, _parameters->ny + 2 );
+}
+
+//============================================================================
+bool NavierStokesEnsembleCPU::setObstacleMap
+	(
+		bool** map
+	)
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	//-----------------------
+	// allocate memory for flag array
+	//-----------------------
+
+	_FLAG = (unsigned char**)malloc( ny2 * sizeof( unsigned char* ) );
+
+	// the actual data array. allocation for all rows at once to get continuous memory
+	unsigned char* data = (unsigned char*)malloc( nx2 * ny2 * sizeof( unsigned char ) );
+
+	_FLAG[0] = data;
+	for( int i = 1; i < ny2; ++i )
+	{
+		_FLAG[i] = data + i * nx2;
+	}
+
+
+	//-----------------------
+	// create geometry map
+	//-----------------------
+
+	// the geometry is shared by all members, see NavierStokesCPU for the flag layout
+
+	// compute interior cells
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			if( map[y][x] )
+			{
+				// cell is a fluid cell
+				_FLAG[y][x] = C_F;
+			}
+			else
+			{
+				// check for invalid boundary cell (between two fluid cells)
+				if( ( map[y-1][x] && map[y+1][x] ) || ( map[y][x-1] && map[y][x+1] ) )
+					return false;
+
+				// look for surrounding cells to get correct flag
+				_FLAG[y][x] = C_B
+						+ B_N * map[y+1][x]
+						+ B_S * map[y-1][x]
+						+ B_W * map[y][x-1]
+						+ B_E * map[y][x+1];
+			}
+		}
+	}
+
+	// compute boundary cells
+	for( int x = 1; x < nx1; ++x )
+	{
+		// southern boundary
+		_FLAG[0][x]	= C_B
+					+ B_N * map[1][x]
+					+ B_S
+					+ B_W
+					+ B_E;
+
+		// northern boundary
+		_FLAG[ny1][x] = C_B
+					  + B_N
+					  + B_S * map[_parameters->ny][x]
+					  + B_W
+					  + B_E;
+	}
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		// western boundary
+		_FLAG[y][0]	= C_B
+					+ B_N
+					+ B_S
+					+ B_W
+					+ B_E * map[y][1];
+
+		// eastern boundary
+		_FLAG[y][nx1] = C_B
+					  + B_N
+					  + B_S
+					  + B_W * map[y][_parameters->nx]
+					  + B_E;
+	}
+
+	// edge cells (not neccessary, but uninitialised cells are ugly)
+	_FLAG[0][0] = _FLAG[0][nx1] = _FLAG[ny1][0] = _FLAG[ny1][nx1] = 0x0F;
+
+	return true;
+}
+
+//============================================================================
+bool NavierStokesEnsembleCPU::loadState
+	(
+		const REAL*,
+		const REAL*,
+		const REAL*,
+		const unsigned char*
+	)
+{
+	// a checkpoint holds a single simulation, so the state
+	// of the other members could not be restored
+	std::cerr << "Checkpoints are not supported by the ensemble solver." << std::endl;
+
+	return false;
+}
+
+// -------------------------------------------------
+//	execution
+// -------------------------------------------------
+
+//============================================================================
+int NavierStokesEnsembleCPU::doSimulationStep ( )
+{
+	// members that have reached the time limit are masked
+	for( int l = 0; l < _numMembers; ++l )
+	{
+		_active[l] = !_parameters->VTKWriteFiles || _time[l] < _parameters->VTKTimeLimit;
+	}
+
+	// get delta_t for each member
+	computeDeltaT();
+
+	// set boundary values for u and v
+	setBoundaryConditions();
+
+	setSpecificBoundaryConditions();
+
+	// compute F(n) and G(n)
+	computeFG();
+
+	// compute right hand side of pressure equation
+	computeRightHandSide();
+
+	// poisson overrelaxation loop
+	// runs until the pressure iteration of all members has converged.
+	// converged members are masked, so each member gets the same number
+	// of iterations as it would in a separate simulation
+	int  iterations[ENSEMBLE_WIDTH];
+	bool iterating = true;
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		iterations[l] = 0;
+		_residual[l]  = INFINITY;
+	}
+
+	int sor_iterations = 0;
+	while( iterating )
+	{
+		iterating = false;
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			_iterate[l] =	_active[l] &&
+							iterations[l] < _parameters->it_max &&
+							fabs( _residual[l] ) > _parameters->epsilon;
+
+			iterating = iterating || _iterate[l];
+		}
+
+		if( !iterating )
+			break;
+
+		// do SOR step (includes residual computation)
+		SORPoisson();
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			iterations[l] += _iterate[l];
+		}
+
+		++sor_iterations;
+	}
+
+	// compute U(n+1) and V(n+1)
+	adaptUV();
+
+	//-----------------------
+	// advance time
+	//-----------------------
+
+	for( int l = 0; l < _numMembers; ++l )
+	{
+		if( _active[l] )
+		{
+			_time[l] += _dt[l];
+		}
+	}
+
+	return sor_iterations;
+}
+
+//============================================================================
+double NavierStokesEnsembleCPU::advanceTime ( double )
+{
+	// the output fields belong to the output member
+	return _time[_parameters->ensembleOutput];
+}
+
+//============================================================================
+bool NavierStokesEnsembleCPU::isFinished ( double )
+{
+	if( !_parameters->VTKWriteFiles )
+	{
+		return false;
+	}
+
+	for( int l = 0; l < _numMembers; ++l )
+	{
+		if( _time[l] < _parameters->VTKTimeLimit )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// -------------------------------------------------
+//	interaction
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesEnsembleCPU::drawObstacles
+	(
+		int x0,
+		int y0,
+		int x1,
+		int y1,
+		bool delete_flag
+	)
+{
+	if( delete_flag )
+	{
+		std::cout << "obstacle removing not implemented yet!" << std::endl;
+	}
+	else
+	{
+		//-----------------------
+		// draw line
+		//-----------------------
+
+		// using bresenham's algorithm
+
+		int dx    = abs( x1 - x0 );		// difference in x direction
+		int dy    = abs( y1 - y0 );		// difference in y direction
+		int sx    = x0 < x1 ? 1 : -1;	// define step direction
+		int sy    = y0 < y1 ? 1 : -1;	// define step direction
+		int error = dx - dy;			// initial error value
+		int e2;
+
+		while( true )
+		{
+			//-----------------------
+			// update obstacle flags
+			//-----------------------
+
+			// south west corner of painted square
+			_parameters->obstacleMap[y0][x0] = false;
+			_FLAG[y0][x0] = C_B
+					+ B_N
+					+ B_S * ( y0 > 1 ? _parameters->obstacleMap[y0-1][x0] : 1 )
+					+ B_W * ( x0 > 1 ? _parameters->obstacleMap[y0][x0-1] : 1 )
+					+ B_E;
+
+			// south east corner
+			_parameters->obstacleMap[y0][x0+1] = false;
+			_FLAG[y0][x0+1] = C_B
+					+ B_N
+					+ B_S * ( y0 > 1 ? _parameters->obstacleMap[y0-1][x0+1] : 1 )
+					+ B_W
+					+ B_E * _parameters->obstacleMap[y0][x0+2];
+
+			// north west corner
+			_parameters->obstacleMap[y0+1][x0] = false;
+			_FLAG[y0+1][x0] = C_B
+					+ B_N * _parameters->obstacleMap[y0+2][x0]
+					+ B_S
+					+ B_W * ( x0 > 1 ? _parameters->obstacleMap[y0+1][x0-1] : 1 )
+					+ B_E;
+
+			// north east corner
+			_parameters->obstacleMap[y0+1][x0+1] = false;
+			_FLAG[y0+1][x0+1] = C_B
+					+ B_N
+					+ B_S * _parameters->obstacleMap[y0+2][x0+1]
+					+ B_W
+					+ B_E * _parameters->obstacleMap[y0+1][x0+2];
+
+			//-----------------------
+			// reset velocities of all members
+			//-----------------------
+
+			for( int y = y0; y < y0 + 2; ++y )
+			{
+				for( int x = x0; x < x0 + 2; ++x )
+				{
+					setCell( _U, x, y, 0.0 );
+					setCell( _V, x, y, 0.0 );
+				}
+			}
+
+			// without reseting the results of the surrounding cells
+			// the results are quite unphysical
+			if( y0 > 1 )
+			{
+				setCell( _U, x0,   y0-1, 0.0 ); setCell( _V, x0,   y0-1, 0.0 );
+				setCell( _U, x0+1, y0-1, 0.0 ); setCell( _V, x0+1, y0-1, 0.0 );
+			}
+			setCell( _U, x0,   y0+2, 0.0 ); setCell( _V, x0,   y0+2, 0.0 );
+			setCell( _U, x0+1, y0+2, 0.0 ); setCell( _V, x0+1, y0+2, 0.0 );
+
+			if( x0 > 1 )
+			{
+				setCell( _U, x0-1, y0,   0.0 ); setCell( _V, x0-1, y0,   0.0 );
+				setCell( _U, x0-1, y0+1, 0.0 ); setCell( _V, x0-1, y0+1, 0.0 );
+			}
+
+			setCell( _U, x0+2, y0,   0.0 ); setCell( _V, x0+2, y0,   0.0 );
+			setCell( _U, x0+2, y0+1, 0.0 ); setCell( _V, x0+2, y0+1, 0.0 );
+
+			//-----------------------
+			// reset pressure
+			//-----------------------
+
+			setCell( _P, x0,   y0,   0.0 );
+			setCell( _P, x0+1, y0,   0.0 );
+			setCell( _P, x0,   y0+1, 0.0 );
+			setCell( _P, x0+1, y0+1, 0.0 );
+
+
+			//-----------------------
+			// next line step
+			//-----------------------
+
+			if( x0 == x1 && y0 == y1 )
+			{
+				break;
+			}
+
+			e2 = error * 2;
+
+			if( e2 > -dy )
+			{
+				error = error - dy;
+				x0 = x0 + sx;
+			}
+
+			if( e2 < dx )
+			{
+				error = error + dx;
+				y0 = y0 + sy;
+			}
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	data access
+// -------------------------------------------------
+
+//============================================================================
+REAL** NavierStokesEnsembleCPU::getU_CPU ( )
+{
+	extractMember( _U, _U_out );
+	return _U_out;
+}
+
+//============================================================================
+REAL** NavierStokesEnsembleCPU::getV_CPU ( )
+{
+	extractMember( _V, _V_out );
+	return _V_out;
+}
+
+//============================================================================
+REAL** NavierStokesEnsembleCPU::getP_CPU ( )
+{
+	extractMember( _P, _P_out );
+	return _P_out;
+}
+
+//============================================================================
+unsigned char** NavierStokesEnsembleCPU::getFLAG_CPU ( )
+{
+	return _FLAG;
+}
+
+//============================================================================
+int NavierStokesEnsembleCPU::getNumMembers ( )
+{
+	return _numMembers;
+}
+
+
+// -------------------------------------------------
+//	boundaries
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesEnsembleCPU::setBoundaryConditions ( )
+{
+	int nx  = _parameters->nx;
+	int ny  = _parameters->ny;
+	int nx1 = nx + 1;
+	int ny1 = ny + 1;
+
+	const int E = ENSEMBLE_WIDTH;	// offset of the eastern neighbour
+	const int N = _rowStride;		// offset of the northern neighbour
+
+	REAL *u, *v;
+
+	//-----------------------
+	// southern boundary
+	//-----------------------
+
+	for( int x = 1; x < nx1; ++x )
+	{
+		u = _U + cell( x, 0 );
+		v = _V + cell( x, 0 );
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			switch( _parameters->wS )
+			{
+				case NO_SLIP:
+					u[l] = _active[l] ? -u[l+N] : u[l];
+					v[l] = _active[l] ? 0.0     : v[l];
+					break;
+				case FREE_SLIP:
+					u[l] = _active[l] ? u[l+N]  : u[l];
+					v[l] = _active[l] ? 0.0     : v[l];
+					break;
+				case OUTFLOW:
+					u[l] = _active[l] ? u[l+N]  : u[l];
+					v[l] = _active[l] ? v[l+N]  : v[l];
+					break;
+			}
+		}
+	}
+
+
+	//-----------------------
+	// northern boundary
+	//-----------------------
+
+	for( int x = 1; x < nx1; ++x )
+	{
+		u = _U + cell( x, ny1 );
+		v = _V + cell( x, ny );
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			switch( _parameters->wN )
+			{
+				case NO_SLIP:
+					u[l] = _active[l] ? -u[l-N] : u[l];
+					v[l] = _active[l] ? 0.0     : v[l];
+					break;
+				case FREE_SLIP:
+					u[l] = _active[l] ? u[l-N]  : u[l];
+					v[l] = _active[l] ? 0.0     : v[l];
+					break;
+				case OUTFLOW:
+					u[l] = _active[l] ? u[l-N]  : u[l];
+					v[l] = _active[l] ? v[l-N]  : v[l];
+					break;
+			}
+		}
+	}
+
+
+	//-----------------------
+	// western boundary
+	//-----------------------
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		u = _U + cell( 0, y );
+		v = _V + cell( 0, y );
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			switch( _parameters->wW )
+			{
+				case NO_SLIP:
+					u[l] = _active[l] ? 0.0     : u[l];
+					v[l] = _active[l] ? -v[l+E] : v[l];
+					break;
+				case FREE_SLIP:
+					u[l] = _active[l] ? 0.0     : u[l];
+					v[l] = _active[l] ? v[l+E]  : v[l];
+					break;
+				case OUTFLOW:
+					u[l] = _active[l] ? u[l+E]  : u[l];
+					v[l] = _active[l] ? v[l+E]  : v[l];
+					break;
+			}
+		}
+	}
+
+
+	//-----------------------
+	// eastern boundary
+	//-----------------------
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		u = _U + cell( nx,  y );
+		v = _V + cell( nx1, y );
+
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+		{
+			switch( _parameters->wE )
+			{
+				case NO_SLIP:
+					u[l] = _active[l] ? 0.0     : u[l];
+					v[l] = _active[l] ? -v[l-E] : v[l];
+					break;
+				case FREE_SLIP:
+					u[l] = _active[l] ? 0.0     : u[l];
+					v[l] = _active[l] ? v[l-E]  : v[l];
+					break;
+				case OUTFLOW:
+					u[l] = _active[l] ? u[l-E]  : u[l];
+					v[l] = _active[l] ? v[l-E]  : v[l];
+					break;
+			}
+		}
+	}
+
+
+	//-----------------------
+	// boundary of arbitrary geometries
+	//-----------------------
+
+	// according to 3.51, 3.52 and 3.53
+	// see NavierStokesCPU::setBoundaryConditions for the flag layout
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		for( int x = 1; x < nx1; ++x )
+		{
+			u = _U + cell( x, y );
+			v = _V + cell( x, y );
+
+			switch( _FLAG[y][x] )
+			{
+				case C_F:
+					continue;
+					break;
+
+				case B_N: // northern obstacle boundary => fluid in the north
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l-E] = _active[l] ? -u[l+N-E] : u[l-E];
+						u[l]   = _active[l] ? -u[l+N]   : u[l];
+						v[l]   = _active[l] ? 0.0       : v[l];
+					}
+					break;
+
+				case B_S: // fluid in the south
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l-E] = _active[l] ? -u[l-N-E] : u[l-E];
+						u[l]   = _active[l] ? -u[l-N]   : u[l];
+						v[l-N] = _active[l] ? 0.0       : v[l-N];
+					}
+					break;
+
+				case B_W: // fluid in the west
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l-E] = _active[l] ? 0.0       : u[l-E];
+						v[l-N] = _active[l] ? -v[l-N-E] : v[l-N];
+						v[l]   = _active[l] ? -v[l-E]   : v[l];
+					}
+					break;
+
+				case B_E: // fluid in the east
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l]   = _active[l] ? 0.0       : u[l];
+						v[l-N] = _active[l] ? -v[l-N+E] : v[l-N];
+						v[l]   = _active[l] ? -v[l+E]   : v[l];
+					}
+					break;
+
+
+				case B_NW: // fluid in the north and west
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l]   = _active[l] ? -u[l+N]   : u[l];
+						u[l-E] = _active[l] ? 0.0       : u[l-E];
+
+						v[l]   = _active[l] ? 0.0       : v[l];
+						v[l-N] = _active[l] ? -v[l-N-E] : v[l-N];
+					}
+					break;
+
+				case B_NE: // fluid in the north and east
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l]   = _active[l] ? 0.0       : u[l];
+						u[l-E] = _active[l] ? -u[l+N-E] : u[l-E];
+
+						v[l]   = _active[l] ? 0.0       : v[l];
+						v[l-N] = _active[l] ? -v[l-N+E] : v[l-N];
+					}
+					break;
+
+				case B_SW: // fluid	in the south and west
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l]   = _active[l] ? -u[l-N]   : u[l];
+						u[l-E] = _active[l] ? 0.0       : u[l-E];
+
+						v[l]   = _active[l] ? -v[l-E]   : v[l];
+						v[l-N] = _active[l] ? 0.0       : v[l-N];
+					}
+					break;
+
+				case B_SE: // fluid	in the south and east
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						u[l]   = _active[l] ? 0.0       : u[l];
+						u[l-E] = _active[l] ? -u[l-N-E] : u[l-E];
+
+						v[l]   = _active[l] ? -v[l+E]   : v[l];
+						v[l-N] = _active[l] ? 0.0       : v[l-N];
+					}
+					break;
+			}
+		}
+	}
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::setSpecificBoundaryConditions ( )
+{
+	REAL* u;
+
+	if ( _parameters->problem == "moving_lid" )
+	{
+		// lid velocity of each member
+		for ( int x = 1; x < _parameters->nx + 1; ++x )
+		{
+			u = _U + cell( x, 0 );
+
+			for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			{
+				u[l] = _active[l] ? 2.0 * _velocity[l] - u[l + _rowStride] : u[l];
+			}
+		}
+	}
+	else if ( _parameters->problem == "channel" )
+	{
+		// inflow velocity of each member
+		for ( int y = 1; y < _parameters->ny + 1; ++y )
+		{
+			u = _U + cell( 0, y );
+
+			for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			{
+				u[l] = _active[l] ? _velocity[l] : u[l];
+			}
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	simulation
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesEnsembleCPU::computeDeltaT ( )
+{
+	// compute delta t according to formula 3.50 for each member
+
+	REAL u_max[ENSEMBLE_WIDTH], v_max[ENSEMBLE_WIDTH];
+	REAL opt_a, opt_x, opt_y, min;
+	REAL *u, *v;
+
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		u_max[l] = 0.0;
+		v_max[l] = 0.0;
+	}
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			u = _U + cell( x, y );
+			v = _V + cell( x, y );
+
+			for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			{
+				u_max[l] = fabs( u[l] ) > u_max[l] ? fabs( u[l] ) : u_max[l];
+				v_max[l] = fabs( v[l] ) > v_max[l] ? fabs( v[l] ) : v_max[l];
+			}
+		}
+	}
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		// compute the three options for the min-function
+		opt_a =   ( _re[l] / 2.0 )
+				* 1.0 / (
+					  1.0 / (_parameters->dx * _parameters->dx)
+					+ 1.0 / (_parameters->dy * _parameters->dy)
+				);
+		opt_x = _parameters->dx / fabs( u_max[l] );
+		opt_y = _parameters->dy / fabs( v_max[l] );
+
+		// get smallest value
+		min = opt_a < opt_x ? opt_a : opt_x;
+		min = min   < opt_y ? min   : opt_y;
+
+		// compute delta t
+		_dt[l] = _parameters->tau * min;
+	}
+
+	// the output member's step size is reported like in the other solvers
+	_parameters->dt = _dt[_parameters->ensembleOutput];
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::computeFG ( )
+{
+	// y coordinates are counted from lower left edge
+
+	REAL alpha = 0.9; // todo: select alpha
+
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	REAL *u, *v, *f, *g;
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		for( int x = 1; x < nx1; ++x )
+		{
+			u = _U + cell( x, y );
+			v = _V + cell( x, y );
+			f = _F + cell( x, y );
+			g = _G + cell( x, y );
+
+			//-----------------------
+			// compute F
+			//-----------------------
+
+			// according to formula 3.36
+
+			// compute F between fluid cells only
+			if( _FLAG[y][x] == C_F && _FLAG[y][x+1] == C_F )
+			{
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					f[l] =
+						u[l] + _dt[l] *
+						(
+							(
+								d2m_dx2 ( u + l ) +
+								d2m_dy2 ( u + l )
+							) / _re[l]
+							- du2_dx ( u + l, alpha )
+							- duv_dy ( u + l, v + l, alpha )
+							+ _parameters->gx
+						);
+				}
+			}
+			else
+			{
+				// according to formula 3.42
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					f[l] = u[l];
+				}
+			}
+
+
+			//-----------------------
+			// compute G
+			//-----------------------
+
+			// according to formula 3.37
+
+			// compute G between fluid cells only
+			if( _FLAG[y][x] == C_F && _FLAG[y+1][x] == C_F )
+			{
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					g[l] =
+						v[l] + _dt[l] *
+						(
+							(
+								d2m_dx2 ( v + l ) +
+								d2m_dy2 ( v + l )
+							) / _re[l]
+							- dv2_dy ( v + l, alpha )
+							- duv_dx ( u + l, v + l, alpha )
+							+ _parameters->gy
+						);
+				}
+			}
+			else
+			{
+				// according to formula 3.42
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					g[l] = v[l];
+				}
+			}
+		}
+	}
+
+	// setting boundary values for f according to formula 3.42
+	for ( int y = 1; y < ny1; ++y )
+	{
+		memcpy( _F + cell( 0, y ), _U + cell( 0, y ), ENSEMBLE_WIDTH * sizeof( REAL ) );
+		memcpy( _F + cell( _parameters->nx, y ), _U + cell( _parameters->nx, y ), ENSEMBLE_WIDTH * sizeof( REAL ) );
+	}
+
+	// setting boundary values for g according to formula 3.42
+	for ( int x = 1; x < nx1; ++x )
+	{
+		memcpy( _G + cell( x, 0 ), _V + cell( x, 0 ), ENSEMBLE_WIDTH * sizeof( REAL ) );
+		memcpy( _G + cell( x, _parameters->ny ), _V + cell( x, _parameters->ny ), ENSEMBLE_WIDTH * sizeof( REAL ) );
+	}
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::computeRightHandSide ( )
+{
+	// compute right-hand side of poisson equation according to formula 3.38
+
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	const int E = ENSEMBLE_WIDTH;
+	const int N = _rowStride;
+
+	REAL *f, *g, *rhs;
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			f   = _F   + cell( x, y );
+			g   = _G   + cell( x, y );
+			rhs = _RHS + cell( x, y );
+
+			for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			{
+				rhs[l] = ( 1 / _dt[l] ) *
+					(
+						( f[l] - f[l-E] ) / _parameters->dx +
+						( g[l] - g[l-N] ) / _parameters->dy
+					);
+			}
+		}
+	}
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::SORPoisson ( )
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	const int E = ENSEMBLE_WIDTH;
+	const int N = _rowStride;
+
+	REAL dx2 = _parameters->dx * _parameters->dx;
+	REAL dy2 = _parameters->dy * _parameters->dy;
+
+	// the epsilon-parameters in formula 3.44 are set to 1.0 according to page 38
+	REAL constant_expr = _parameters->omega / ( 2.0 / dx2 + 2.0 / dy2 );
+
+	REAL *p, *rhs;
+	REAL value;
+
+	//-----------------------
+	// SOR step
+	//-----------------------
+
+	// according to formula 3.44
+	// gauss seidel dependencies only exist within a member,
+	// so the members of a cell can be updated at once
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			p   = _P   + cell( x, y );
+			rhs = _RHS + cell( x, y );
+
+			switch ( _FLAG[y][x] )
+			{
+				// calculate pressure in fluid cells
+				case C_F:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+					{
+						value =
+							( 1.0 - _parameters->omega ) * p[l] +
+							constant_expr * (
+								( p[l-E] + p[l+E] ) / dx2
+								+
+								( p[l-N] + p[l+N] ) / dy2
+								-
+								rhs[l]
+							);
+						p[l] = _iterate[l] ? value : p[l];
+					}
+					break;
+
+				// set boundary pressure value for obstacle cells
+				case B_N:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? p[l+N] : p[l];
+					break;
+				case B_S:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? p[l-N] : p[l];
+					break;
+				case B_W:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? p[l-E] : p[l];
+					break;
+				case B_E:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? p[l+E] : p[l];
+					break;
+				case B_NW:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? (p[l-N] + p[l+E]) / 2 : p[l];
+					break;
+				case B_NE:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? (p[l+N] + p[l+E]) / 2 : p[l];
+					break;
+				case B_SW:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? (p[l-N] + p[l-E]) / 2 : p[l];
+					break;
+				case B_SE:
+					for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+						p[l] = _iterate[l] ? (p[l+N] + p[l-E]) / 2 : p[l];
+					break;
+			}
+		}
+	}
+
+	//-----------------------
+	// boundary values
+	//-----------------------
+
+	// according to formula 3.41, only Neumann
+
+	for ( int x = 1; x < nx1; ++x )
+	{
+		p = _P + cell( x, 0 );
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			p[l] = _iterate[l] ? p[l+N] : p[l];
+
+		p = _P + cell( x, ny1 );
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			p[l] = _iterate[l] ? p[l-N] : p[l];
+	}
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		p = _P + cell( 0, y );
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			p[l] = _iterate[l] ? p[l+E] : p[l];
+
+		p = _P + cell( nx1, y );
+		for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+			p[l] = _iterate[l] ? p[l-E] : p[l];
+	}
+
+	//-----------------------
+	// residual
+	//-----------------------
+
+	// compute residual using L²-Norm (according to formula 3.45 and 3.46)
+
+	REAL tmp;
+	REAL sum[ENSEMBLE_WIDTH];
+	int numCells = 0;
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		sum[l] = 0.0;
+	}
+
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			if ( _FLAG[y][x] == C_F )
+			{
+				p   = _P   + cell( x, y );
+				rhs = _RHS + cell( x, y );
+
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					tmp =
+						  ( ( p[l+E] - p[l] ) - ( p[l] - p[l-E] ) ) / dx2
+						+ ( ( p[l+N] - p[l] ) - ( p[l] - p[l-N] ) ) / dy2
+						- rhs[l];
+
+					sum[l] += tmp * tmp;
+				}
+
+				++numCells;
+			}
+		}
+	}
+
+	// compute L²-Norm for each member
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		_residual[l] = sqrt( sum[l] / numCells );
+	}
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::adaptUV ( )
+{
+	// update u and v according to 3.34 and 3.35
+
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+
+	const int E = ENSEMBLE_WIDTH;
+	const int N = _rowStride;
+
+	REAL dt_dx[ENSEMBLE_WIDTH], dt_dy[ENSEMBLE_WIDTH];
+	REAL *u, *v, *f, *g, *p;
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		dt_dx[l] = _dt[l] / _parameters->dx;
+		dt_dy[l] = _dt[l] / _parameters->dy;
+	}
+
+	// update u. two nested loops because of different limits
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < _parameters->nx; ++x )
+		{
+			if ( _FLAG[y][x] == C_F && _FLAG[y][x+1] == C_F )
+			{
+				u = _U + cell( x, y );
+				f = _F + cell( x, y );
+				p = _P + cell( x, y );
+
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					u[l] = _active[l] ? f[l] - dt_dx[l] * ( p[l+E] - p[l] ) : u[l];
+				}
+			}
+		}
+	}
+
+	// update v
+	for ( int y = 1; y < _parameters->ny; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			if ( _FLAG[y][x] == C_F && _FLAG[y+1][x] == C_F )
+			{
+				v = _V + cell( x, y );
+				g = _G + cell( x, y );
+				p = _P + cell( x, y );
+
+				for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+				{
+					v[l] = _active[l] ? g[l] - dt_dy[l] * ( p[l+N] - p[l] ) : v[l];
+				}
+			}
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	auxiliary functions
+// -------------------------------------------------
+
+//============================================================================
+inline int NavierStokesEnsembleCPU::cell ( int x, int y )
+{
+	return ( y * _nx2 + x ) * ENSEMBLE_WIDTH;
+}
+
+//============================================================================
+inline void NavierStokesEnsembleCPU::setCell ( REAL* field, int x, int y, REAL value )
+{
+	REAL* c = field + cell( x, y );
+
+	for( int l = 0; l < ENSEMBLE_WIDTH; ++l )
+	{
+		c[l] = value;
+	}
+}
+
+//============================================================================
+void NavierStokesEnsembleCPU::extractMember ( REAL* source, REAL** target )
+{
+	int ny2 = _parameters->ny + 2;
+
+	source += _parameters->ensembleOutput;
+
+	for( int y = 0; y < ny2; ++y )
+	{
+		for( int x = 0; x < _nx2; ++x )
+		{
+			target[y][x] = source[ cell( x, y ) ];
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	auxiliary functions for F & G
+// -------------------------------------------------
+
+// same as in NavierStokesCPU, with neighbours at a distance
+// of ENSEMBLE_WIDTH (x) and _rowStride (y)
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::d2m_dx2 ( REAL* m )
+{
+	const int E = ENSEMBLE_WIDTH;
+	return ( m[-E] - 2.0 * m[0] + m[E] ) / ( _parameters->dx * _parameters->dx );
+}
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::d2m_dy2 ( REAL* m )
+{
+	const int N = _rowStride;
+	return ( m[-N] - 2.0 * m[0] + m[N] ) / ( _parameters->dy * _parameters->dy );
+}
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::du2_dx  ( REAL* u, REAL alpha )
+{
+	const int E = ENSEMBLE_WIDTH;
+
+	return
+		(
+			(
+				( u[0] + u[E] ) *
+				( u[0] + u[E] )
+				-
+				( u[-E] + u[0] ) *
+				( u[-E] + u[0] )
+			)
+			+
+			alpha *
+			(
+				fabs( u[0] + u[E] ) *
+					( u[0] - u[E] )
+				-
+				fabs( u[-E] + u[0] ) *
+					( u[-E] - u[0] )
+			)
+		) / ( 4.0 * _parameters->dx);
+}
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::dv2_dy  ( REAL* v, REAL alpha )
+{
+	const int N = _rowStride;
+
+	return
+		(
+			(
+				( v[0] + v[N] ) *
+				( v[0] + v[N] )
+				-
+				( v[-N] + v[0] ) *
+				( v[-N] + v[0] )
+			)
+			+
+			alpha *
+			(
+				fabs( v[0] + v[N] ) *
+					( v[0] - v[N] )
+				-
+				fabs( v[-N] + v[0] ) *
+					( v[-N] - v[0] )
+			)
+		) / ( 4.0 * _parameters->dy );
+}
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::duv_dx  ( REAL* u, REAL* v, REAL alpha )
+{
+	const int E = ENSEMBLE_WIDTH;
+	const int N = _rowStride;
+
+	return
+		(
+			(
+				( u[0] + u[N] ) *
+				( v[0] + v[E] )
+				-
+				( u[-E] + u[N-E] ) *
+				( v[-E] + v[0] )
+			)
+			+
+			alpha *
+			(
+					fabs( u[0] + u[N] ) *
+						( v[0] - v[E] )
+					-
+					fabs( u[-E] + u[N-E] ) *
+						( v[-E] - v[0] )
+			)
+		) / ( 4.0 * _parameters->dx );
+}
+
+//============================================================================
+inline REAL NavierStokesEnsembleCPU::duv_dy  ( REAL* u, REAL* v, REAL alpha )
+{
+	const int E = ENSEMBLE_WIDTH;
+	const int N = _rowStride;
+
+	return
+		(
+			(
+				( v[0] + v[E] ) *
+				( u[0] + u[N] )
+				-
+				( v[-N] + v[-N+E] ) *
+				( u[-N] + u[0] )
+			)
+			+
+			alpha *
+			(
+				fabs( v[0] + v[E] ) *
+				   ( u[0] - u[N] )
+				-
+				fabs( v[-N] + v[-N+E] ) *
+				   ( u[-N] - u[0] )
+			)
+		) / ( 4.0 * _parameters->dy );
+}
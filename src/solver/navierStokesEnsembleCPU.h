@@ -0,0 +1,289 @@
+#ifndef NAVIERSTOKESENSEMBLECPU_H
+#define NAVIERSTOKESENSEMBLECPU_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "navierStokesSolver.h"
+
+//====================================================================
+/*! \class NavierStokesEnsembleCPU
+	\brief Class for solving an ensemble of independent simulations
+	on CPU at once
+
+	The fields of ENSEMBLE_WIDTH simulations are stored interleaved
+	per cell, so the innermost loop runs over the ensemble members
+	and can be vectorised by the compiler. Each member has its own
+	Reynolds number and lid/inflow velocity, time step size and
+	convergence state, all members share the same geometry.
+
+	Members that have reached the time limit or whose pressure
+	iteration has converged are masked and keep their values.
+	The viewer is given the member selected by ensembleOutput, along
+	with the simulated time of that member. The simulation runs until
+	all members have reached the time limit.
+*/
+//====================================================================
+
+class NavierStokesEnsembleCPU : public NavierStokesSolver
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		// interleaved CPU arrays: value of member l in cell (x,y)
+		// is stored at [ ( y * (nx+2) + x ) * ENSEMBLE_WIDTH + l ]
+		REAL	*_U,		//! velocity in x-direction
+				*_V,		//! velocity in y-direction
+				*_P,		//! pressure
+				*_RHS,		//! right-hand side for pressure iteration
+				*_F,
+				*_G;
+
+		unsigned char **_FLAG;	//! obstacle map, shared by all members
+
+		// host arrays for the member passed to the viewer
+		REAL	**_U_out,	//! horizontal velocity of the output member
+				**_V_out,	//! vertical velocity of the output member
+				**_P_out;	//! pressure of the output member
+
+		int		_numMembers;	//! number of used lanes
+		int		_nx2;			//! number of cells in x-direction including boundaries
+		int		_rowStride;		//! distance between two rows in the interleaved arrays
+
+		// per member data
+		REAL	_re[ENSEMBLE_WIDTH];		//! Reynolds number
+		REAL	_velocity[ENSEMBLE_WIDTH];	//! lid or inflow velocity
+		REAL	_dt[ENSEMBLE_WIDTH];		//! time step size
+		double	_time[ENSEMBLE_WIDTH];		//! simulated time
+		bool	_active[ENSEMBLE_WIDTH];	//! false if the member has reached the time limit
+		bool	_iterate[ENSEMBLE_WIDTH];	//! false if the pressure iteration has converged
+		REAL	_residual[ENSEMBLE_WIDTH];	//! residual of the last pressure iteration
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+
+		NavierStokesEnsembleCPU ( Parameters* parameters );
+
+		~NavierStokesEnsembleCPU ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	initialization
+		// -------------------------------------------------
+			//! @name initialisation
+			//! @{
+
+			//! \brief allocates and initialises simulation memory
+
+		void	initialize ( );
+
+			//! \brief takes the obstacle map and creates geometry information for each cell
+			//! true stands for fluid cells and false for boundary cells
+			//! Maps must have no obstacle cell between two fluid cells to be valid.
+			//! An additional boundary will be applied.
+			//! \param obstacle map (domain size)
+			//! \returns true if the obstacle map is valid, false otherwise
+
+		bool	setObstacleMap ( bool** map );
+
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! \returns true if the state was loaded, false otherwise
+
+		bool	loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	execution
+		// -------------------------------------------------
+			//! @name execution
+			//! @{
+
+			//! \brief simulates the next timestep for all active members
+			//! \returns maximum number of iterations used to solve the pressure equation
+
+		int		doSimulationStep ( );
+
+			//! \brief gives the simulated time of the output member
+			//! \param ignored, the time of each member is tracked by the solver
+			//! \returns simulated time of the output member
+
+		double	advanceTime ( double );
+
+			//! \brief checks whether all members have reached the time limit
+			//! \returns true if no member is active any more
+
+		bool	isFinished ( double );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	interaction
+		// -------------------------------------------------
+			//! @name interaction
+			//! @{
+
+			//! \brief inserts or removes a line of obstacles in all members
+			//! four cells will be marked as obstacles to prevent
+			//! obstacles from lying between two fluid cells
+			//! \param first x offset of the obstacle to draw
+			//! \param first y offset of the obstacle to draw
+			//! \param last x offset of the obstacle to draw
+			//! \param last y offset of the obstacle to draw
+			//! \param drawing mode, true if a wall ist to be teared down instead of created
+
+		void drawObstacles (
+				int x0,
+				int y0,
+				int x1,
+				int y1,
+				bool delete_flag
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	data access
+		// -------------------------------------------------
+			//! @name data access
+			//! @{
+
+			//! \brief gives access to the horizontal velocity component of the output member
+			//! \returns pointer to horizontal velocity array
+
+		REAL** getU_CPU ( );
+
+			//! \brief gives access to the vertical velocity component of the output member
+			//! \returns pointer to vertical velocity array
+
+		REAL** getV_CPU ( );
+
+			//! \brief gives access to the pressure of the output member
+			//! \returns pointer to pressure array
+
+		REAL** getP_CPU ( );
+
+			//! \brief gives access to the obstacle flags
+			//! \returns pointer to flag array
+
+		unsigned char** getFLAG_CPU ( );
+
+			//! \returns number of simulated ensemble members
+
+		int	getNumMembers ( );
+
+			//! @}
+
+
+	protected:
+		// -------------------------------------------------
+		//	boundaries
+		// -------------------------------------------------
+			//! @name boundaries
+			//! @{
+
+			//!  \brief sets the boundary values for U and V depending on wN, wS, wW and wE
+
+		void	setBoundaryConditions ( );
+
+			//! \brief sets the lid or inflow velocity of each member
+
+		void	setSpecificBoundaryConditions ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	simulation
+		// -------------------------------------------------
+			//! @name simulation
+			//! @{
+
+			//! \brief calculates the stepsize for next time step of each member
+			//! According to formula 3.50
+
+		void	computeDeltaT ( );
+
+			//! \brief computes F and G
+
+		void	computeFG ( );
+
+			//! \brief computes the right-hand side of the pressure equation
+
+		void	computeRightHandSide ( );
+
+			//! \brief SOR iteration step for pressure Poisson equation
+			//! Members with _iterate[l] == false are not updated.
+			//! The residual of each member is stored in _residual.
+
+		void	SORPoisson ( );
+
+			//! \brief calculates new velocities of the active members
+
+		void	adaptUV ( );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief offset of the first member of a cell in the interleaved arrays
+
+		inline int	cell ( int x, int y );
+
+			//! \brief assigns a value to a cell in all members
+
+		inline void	setCell ( REAL* field, int x, int y, REAL value );
+
+			//! \brief copies the output member of an interleaved array to a host matrix
+
+		void	extractMember ( REAL* source, REAL** target );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	auxiliary functions for F & G computation
+		// -------------------------------------------------
+			//! @name auxiliary functions for F and G computations
+			//! pointers address the value of one member in the current cell
+			//! @{
+
+		inline REAL d2m_dx2 ( REAL* m );
+		inline REAL d2m_dy2 ( REAL* m );
+
+		inline REAL du2_dx  ( REAL* u, REAL alpha );
+		inline REAL dv2_dy  ( REAL* v, REAL alpha );
+
+		inline REAL duv_dx  ( REAL* u, REAL* v, REAL alpha );
+		inline REAL duv_dy  ( REAL* u, REAL* v, REAL alpha );
+
+			//! @}
+};
+
+#endif // NAVIERSTOKESENSEMBLECPU_H
@@ -6,7 +6,9 @@
 #include "navierStokesGPU.h"
 
 #include <iostream>
+#include <string.h>
 #include <math.h>
+#include <algorithm>
 
 //********************************************************************
 //**    implementation
@@ -28,25 +30,68 @@ NavierStokesGPU::NavierStokesGPU
 	_clContext = clManager->getContext();
 	_clQueue   = clManager->getQueue();
 
+	_clTransferQueue = clManager->getTransferQueue();
+
 	_pitch = 0;
 
+	_regionSize = 0;
+
+	// host copies of the fields
+	_field = new FlowField( _parameters->nx, _parameters->ny, this );
+
+	// staging buffers are allocated with the first snapshot
+	_staging_host[0] = _staging_host[1] = _staging_host[2] = 0;
+	_snapshotPending = false;
+
 	// load and compile kernels
 	_clManager->loadKernels();
 
 	// define global thread range
 	_clRange = cl::NDRange( _parameters->nx + 2, _parameters->ny + 2 );
 	_clWorkgroupSize = _clManager->getWorkgroupSize();
+
+	// first reduction stage: a few workgroups per compute unit, but no more
+	// than the second stage can combine in one pass or the grid can fill
+	int cells = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	_reductionGroups = std::min( 4 * _clManager->getComputeUnits(), _clWorkgroupSize );
+	_reductionGroups = std::min( _reductionGroups, ( cells + _clWorkgroupSize - 1 ) / _clWorkgroupSize );
+	_reductionGroups = std::max( _reductionGroups, 1 );
+
+	// tiled kernels: BW x BH work groups, if the device allows
+	int tileWidth  = BW;
+	int tileHeight = std::max( 1, std::min( BH, _clWorkgroupSize / BW ) );
+
+	_clTileLocal = cl::NDRange( tileWidth, tileHeight );
+	_clTileRange = cl::NDRange(
+			( ( _parameters->nx + 2 + tileWidth  - 1 ) / tileWidth  ) * tileWidth,
+			( ( _parameters->ny + 2 + tileHeight - 1 ) / tileHeight ) * tileHeight
+		);
+
+	// split layout: one work item per cell of a colour
+	_clSplitRange = cl::NDRange( ( _parameters->nx + 3 ) / 2, _parameters->ny + 2 );
 }
 
 //============================================================================
 NavierStokesGPU::~NavierStokesGPU ( )
 {
 	// free buffer memory
-	freeHostMatrix( _U_host );
-	freeHostMatrix( _V_host );
-	freeHostMatrix( _P_host );
-	free( _FLAG_host[0] );
-	free( _FLAG_host );
+	SAFE_DELETE( _field );
+
+	// pinned memory must not be released during a readback
+	if( _snapshotPending )
+		_snapshotEvent.wait();
+
+	for( int i = 0; i < 3; ++i )
+	{
+		if( _staging_host[i] )
+		{
+			_clQueue->enqueueUnmapMemObject( _staging_g[i], _staging_host[i][0] );
+			free( _staging_host[i] );
+		}
+	}
+
+	_clQueue->finish();
 }
 
 // -------------------------------------------------
@@ -81,6 +126,35 @@ void NavierStokesGPU::initialize ( )
 	_F_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
 	_G_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
 
+	// partial results of the first reduction stage
+	_residualPartials_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * _reductionGroups );
+	_uvPartials_g       = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * _reductionGroups * 2 );
+
+	if( _parameters->tileIterations > 0 )
+	{
+		_PTiled_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+	}
+
+	if( _parameters->splitPressure )
+	{
+		// (nx + 3) / 2 cells of each colour per row, including boundaries
+		int splitSize = ( ( nx2 + 1 ) / 2 ) * ny2;
+
+		for( int i = 0; i < 2; ++i )
+		{
+			_PSplit_g[i]    = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * splitSize );
+			_RHSSplit_g[i]  = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * splitSize );
+			_FLAGSplit_g[i] = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(unsigned char) * splitSize );
+		}
+	}
+
+	// final reduction results, read back by the host
+	_residual_g  = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) );
+	_uvMaximum_g = cl::Buffer ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) * 2 );
+
+	// converged flag and number of iterations, reset before each pressure iteration
+	_convergence_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(cl_int) * 2 );
+
 	//_FLAG_g
 
 
@@ -121,6 +195,11 @@ void NavierStokesGPU::initialize ( )
 
 	_clManager->runRangeKernel ( kernel::setBoundaryAndInterior, cl::NullRange, _clRange, cl::NullRange );
 
+	if( _parameters->splitPressure )
+	{
+		enqueueRedBlackSplit( kernel::splitRedBlack, _P_g, _PSplit_g );
+	}
+
 
 	//-----------------------
 	// initialise RHS, F and G with 0.0
@@ -146,17 +225,11 @@ void NavierStokesGPU::initialize ( )
 
 
 
-	//-----------------------
-	// allocate host memory for U, V and P buffers for communication
-	//-----------------------
-
-	#if VERBOSE
-		std::cout << "allocating host buffers..." << std::endl;
-	#endif
-
-	_U_host = allocHostMatrix ( nx2, ny2 );
-	_V_host = allocHostMatrix ( nx2, ny2 );
-	_P_host = allocHostMatrix ( nx2, ny2 );
+	// the host copies are outdated now, the flags are uploaded
+	_field->deviceModified( field::U );
+	_field->deviceModified( field::V );
+	_field->deviceModified( field::P );
+	_field->synchronizeDevice();
 
 
 	// set kernel arguments for frequently called kernels
@@ -184,17 +257,8 @@ bool NavierStokesGPU::setObstacleMap
 	// todo: use constant memory
 
 
-	//-----------------------
-	// allocate memory for flag array
-	//-----------------------
-
-	_FLAG_host    = (unsigned char**)malloc( ny2 * sizeof( unsigned char* ) );
-	_FLAG_host[0] = (unsigned char*)malloc( nx2 * ny2 * sizeof( unsigned char ) );
-
-	for( int i = 1; i < ny2; ++i )
-	{
-		_FLAG_host[i] = *_FLAG_host + i * nx2;
-	}
+	// host memory is provided by the flow field
+	unsigned char** FLAG = _field->getFLAG();
 
 
 	//-----------------------
@@ -212,7 +276,7 @@ bool NavierStokesGPU::setObstacleMap
 			{
 				// cell is a fluid cell
 				// neighbour cells do not matter
-				_FLAG_host[y][x] = C_F;
+				FLAG[y][x] = C_F;
 			}
 			else
 			{
@@ -224,7 +288,7 @@ bool NavierStokesGPU::setObstacleMap
 					return false;
 
 				// look for surrounding cells to get correct flag
-				_FLAG_host[y][x] = C_B
+				FLAG[y][x] = C_B
 						+ B_N * map[y+1][x]
 						+ B_S * map[y-1][x]
 						+ B_W * map[y][x-1]
@@ -237,14 +301,14 @@ bool NavierStokesGPU::setObstacleMap
 	for( int x = 1; x < nx1; ++x )
 	{
 		// southern boundary
-		_FLAG_host[0][x] = C_B
+		FLAG[0][x] = C_B
 					+ B_N * map[1][x]
 					+ B_S
 					+ B_W
 					+ B_E;
 
 		// northern boundary
-		_FLAG_host[ny1][x] = C_B
+		FLAG[ny1][x] = C_B
 					  + B_N
 					  + B_S * map[_parameters->ny][x]
 					  + B_W
@@ -254,14 +318,14 @@ bool NavierStokesGPU::setObstacleMap
 	for( int y = 1; y < ny1; ++y )
 	{
 		// western boundary
-		_FLAG_host[y][0] = C_B
+		FLAG[y][0] = C_B
 					+ B_N
 					+ B_S
 					+ B_W
 					+ B_E * map[y][1];
 
 		// eastern boundary
-		_FLAG_host[y][nx1] = C_B
+		FLAG[y][nx1] = C_B
 					  + B_N
 					  + B_S
 					  + B_W * map[y][_parameters->nx]
@@ -269,26 +333,64 @@ bool NavierStokesGPU::setObstacleMap
 	}
 
 	// edge cells (not neccessary, but uninitialised memory is ugly)
-	_FLAG_host[0][0] = _FLAG_host[0][nx1] = _FLAG_host[ny1][0] = _FLAG_host[ny1][nx1] = 0x0F;
+	FLAG[0][0] = FLAG[0][nx1] = FLAG[ny1][0] = FLAG[ny1][nx1] = 0x0F;
 
 
 	//-----------------------
 	// copy to device memory
 	//-----------------------
 
-	// allocate memory and copy to device
+	// allocate memory, the flags are copied with the next device synchronization
 	// todo: use pitched memory
 	_FLAG_g   = cl::Buffer (
 					*_clContext,
-					CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
-					nx2 * ny2 * sizeof( unsigned char ),
-					*_FLAG_host
+					CL_MEM_READ_ONLY,
+					nx2 * ny2 * sizeof( unsigned char )
 				);
 
+	_field->hostModified( field::FLAG );
+
 	return true;
 }
 
 
+//============================================================================
+bool NavierStokesGPU::loadState
+	(
+		const REAL* U,
+		const REAL* V,
+		const REAL* P,
+		const unsigned char* FLAG
+	)
+{
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	// the source memory might be unmapped after returning, so it is copied to the host copies
+	memcpy( *_field->getU(),    U,    size * sizeof( REAL ) );
+	memcpy( *_field->getV(),    V,    size * sizeof( REAL ) );
+	memcpy( *_field->getP(),    P,    size * sizeof( REAL ) );
+	memcpy( *_field->getFLAG(), FLAG, size * sizeof( unsigned char ) );
+
+	_field->hostModified( field::U );
+	_field->hostModified( field::V );
+	_field->hostModified( field::P );
+	_field->hostModified( field::FLAG );
+
+	try
+	{
+		_field->synchronizeDevice();
+
+		_clQueue->finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while loading simulation state: " << error.what() << "(" << error.err() << ")" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
 // -------------------------------------------------
 //	execution
 // -------------------------------------------------
@@ -296,6 +398,9 @@ bool NavierStokesGPU::setObstacleMap
 //============================================================================
 int NavierStokesGPU::doSimulationStep()
 {
+	// upload fields changed on host side, e.g. by obstacle drawing
+	_field->synchronizeDevice();
+
 	//-----------------------
 	// get delta_t
 	//-----------------------
@@ -325,25 +430,14 @@ int NavierStokesGPU::doSimulationStep()
 
 
 	//-----------------------
-	// compute F(n) and G(n)
-	//-----------------------
-
-	#if VERBOSE
-		std::cout << "computing F and G..." << std::endl;
-	#endif
-
-	computeFG();
-
-
-	//-----------------------
-	// compute right hand side of pressure equation
+	// compute F(n), G(n) and right hand side of pressure equation
 	//-----------------------
 
 	#if VERBOSE
-		std::cout << "computing right hand side of pressure equation..." << std::endl;
+		std::cout << "computing F, G and RHS..." << std::endl;
 	#endif
 
-	computeRightHandSide();
+	computeFGAndRightHandSide();
 
 
 	//-----------------------
@@ -354,13 +448,31 @@ int NavierStokesGPU::doSimulationStep()
 		std::cout << "poisson overrelaxation loop..." << std::endl;
 	#endif
 
-	REAL residual = INFINITY;
-
 	int sor_iterations = 0;
-	for ( ; sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon; ++sor_iterations )
+
+	if( _parameters->deviceConvergence )
+	{
+		sor_iterations = SORPoissonDeviceControlled();
+	}
+	else if( _parameters->residualInterval > 0 )
+	{
+		sor_iterations = SORPoissonPipelined();
+	}
+	else
 	{
-		// do SOR step (includes residual computation)
-		residual =  SORPoisson();
+		REAL residual = INFINITY;
+
+		while( sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon )
+		{
+			// the tiled kernel does several iterations per step, but not more than it_max
+			int step = _parameters->tileIterations > 0 ?
+						std::min( _parameters->tileIterations, _parameters->it_max - sor_iterations ) : 1;
+
+			// do SOR step (includes residual computation)
+			residual =  SORPoisson( step );
+
+			sor_iterations += step;
+		}
 	}
 
 	#if VERBOSE
@@ -378,6 +490,11 @@ int NavierStokesGPU::doSimulationStep()
 
 	adaptUV();
 
+	// host copies are updated when they are accessed
+	_field->deviceModified( field::U );
+	_field->deviceModified( field::V );
+	_field->deviceModified( field::P );
+
 	return sor_iterations;
 }
 
@@ -404,103 +521,73 @@ void NavierStokesGPU::drawObstacles
 	else
 	{
 		//-----------------------
-		// draw line
+		// draw line into the fields on the device
 		//-----------------------
 
-		// using bresenham's algorithm
-
-		int dx    = abs( x1 - x0 );		// difference in x direction
-		int dy    = abs( y1 - y0 );		// difference in y direction
-		int sx    = x0 < x1 ? 1 : -1;	// define step direction
-		int sy    = y0 < y1 ? 1 : -1;	// define step direction
-		int error = dx - dy;			// initial error value
-		int e2;
+		// only the end points are transferred, see drawObstacleLineKernel
+		int nx2 = _parameters->nx + 2;
 
-		while( true )
+		try
 		{
-			//-----------------------
-			// update obstacle flags
-			//-----------------------
-
-			// the host memory arrays can be used, as this drawing takes place
-			// between visualization and simulation and host and device memory
-			// contents are currently identical
-
-			// south west corner of painted square
-			_parameters->obstacleMap[y0][x0] = false;
-			_FLAG_host[y0][x0] = C_B
-					+ B_N
-					+ B_S * ( y0 > 1 ? _parameters->obstacleMap[y0-1][x0] : 1 )
-					+ B_W * ( x0 > 1 ? _parameters->obstacleMap[y0][x0-1] : 1 )
-					+ B_E;
-
-			// south east corner
-			_parameters->obstacleMap[y0][x0+1] = false;
-			_FLAG_host[y0][x0+1] = C_B
-					+ B_N
-					+ B_S * ( y0 > 1 ? _parameters->obstacleMap[y0-1][x0+1] : 1 )
-					+ B_W
-					+ B_E * _parameters->obstacleMap[y0][x0+2];
-
-			// north west corner
-			_parameters->obstacleMap[y0+1][x0] = false;
-			_FLAG_host[y0+1][x0] = C_B
-					+ B_N * _parameters->obstacleMap[y0+2][x0]
-					+ B_S
-					+ B_W * ( x0 > 1 ? _parameters->obstacleMap[y0+1][x0-1] : 1 )
-					+ B_E;
-
-			// north east corner
-			_parameters->obstacleMap[y0+1][x0+1] = false;
-			_FLAG_host[y0+1][x0+1] = C_B
-					+ B_N
-					+ B_S * _parameters->obstacleMap[y0+2][x0+1]
-					+ B_W
-					+ B_E * _parameters->obstacleMap[y0+1][x0+2];
+			// fields changed on host side must be on the device first
+			_field->synchronizeDevice();
 
+			// the kernel resets the pressure in the natural layout
+			enqueuePressureMerge();
 
-			//-----------------------
-			// reset velocities
-			//-----------------------
-
-			_U_host[y0][x0]     = _V_host[y0][x0]     = 0.0;
-			_U_host[y0][x0+1]   = _V_host[y0][x0+1]   = 0.0;
-			_U_host[y0+1][x0]   = _V_host[y0+1][x0]   = 0.0;
-			_U_host[y0+1][x0+1] = _V_host[y0+1][x0+1] = 0.0;
-
-			// without reseting the results of the surrounding cells
-			// the results are quite unphysical
-			if( y0 > 1 )
-			{
-				_U_host[y0-1][x0]   = _V_host[y0-1][x0]   = 0.0;
-				_U_host[y0-1][x0+1] = _V_host[y0-1][x0+1] = 0.0;
-			}
-			_U_host[y0+2][x0]   = _V_host[y0+2][x0]   = 0.0;
-			_U_host[y0+2][x0+1] = _V_host[y0+2][x0+1] = 0.0;
+			cl::Kernel* kernel = _clManager->getKernel( kernel::drawObstacleLine );
 
-			if( x0 > 1 )
+			kernel->setArg( 0, _U_g );
+			kernel->setArg( 1, _V_g );
+			kernel->setArg( 2, _P_g );
+			kernel->setArg( 3, _FLAG_g );
+			kernel->setArg( 4, sizeof(int), &x0 );
+			kernel->setArg( 5, sizeof(int), &y0 );
+			kernel->setArg( 6, sizeof(int), &x1 );
+			kernel->setArg( 7, sizeof(int), &y1 );
+			kernel->setArg( 8, sizeof(int), &nx2 );
+
+			_clManager->runRangeKernel( kernel::drawObstacleLine, cl::NullRange, cl::NDRange( 1 ), cl::NullRange );
+
+			if( _parameters->splitPressure )
 			{
-				_U_host[y0][x0-1]   = _V_host[y0][x0-1]   = 0.0;
-				_U_host[y0+1][x0-1] = _V_host[y0+1][x0-1] = 0.0;
+				enqueueRedBlackSplit( kernel::splitRedBlack,     _P_g,    _PSplit_g );
+				enqueueRedBlackSplit( kernel::splitRedBlackFlag, _FLAG_g, _FLAGSplit_g );
 			}
+		}
+		catch( cl::Error error )
+		{
+			std::cerr << "CL ERROR while drawing obstacles: " << error.what() << "(" << error.err() << ")" << std::endl;
+			throw error;
+		}
 
-			_U_host[y0][x0+2]   = _V_host[y0][x0+2]   = 0.0;
-			_U_host[y0+1][x0+2] = _V_host[y0+1][x0+2] = 0.0;
+		// host copies are updated when they are accessed
+		_field->deviceModified( field::U );
+		_field->deviceModified( field::V );
+		_field->deviceModified( field::P );
+		_field->deviceModified( field::FLAG );
 
 
-			//-----------------------
-			// reset pressure
-			//-----------------------
+		//-----------------------
+		// update obstacle map
+		//-----------------------
 
-			_P_host[y0][x0]     = 0.0;
-			_P_host[y0][x0+1]   = 0.0;
-			_P_host[y0+1][x0]   = 0.0;
-			_P_host[y0+1][x0+1] = 0.0;
+		// the viewer draws the obstacles from the host map,
+		// same line as on the device using bresenham's algorithm
 
+		int dx    = abs( x1 - x0 );		// difference in x direction
+		int dy    = abs( y1 - y0 );		// difference in y direction
+		int sx    = x0 < x1 ? 1 : -1;	// define step direction
+		int sy    = y0 < y1 ? 1 : -1;	// define step direction
+		int error = dx - dy;			// initial error value
+		int e2;
 
-			//-----------------------
-			// next line step
-			//-----------------------
+		while( true )
+		{
+			_parameters->obstacleMap[y0][x0]     = false;
+			_parameters->obstacleMap[y0][x0+1]   = false;
+			_parameters->obstacleMap[y0+1][x0]   = false;
+			_parameters->obstacleMap[y0+1][x0+1] = false;
 
 			if( x0 == x1 && y0 == y1 )
 			{
@@ -521,80 +608,6 @@ void NavierStokesGPU::drawObstacles
 				y0 = y0 + sy;
 			}
 		}
-
-
-		//-----------------------
-		// copy to device
-		//-----------------------
-
-		// copy flags, velocities and pressure to device memory
-
-		/*cl::size_t<3> origin, region;
-
-		origin[0] = x;
-		origin[1] = y;
-		origin[2] = 0;
-
-		region[0] = 2;
-		region[1] = 2;
-		region[2] = 0;*/
-
-		cl::Event event;
-
-		/*_clQueue->enqueueWriteBufferRect(
-				_FLAG_g,				// target buffer
-				CL_TRUE,					// blocking write
-				origin,					// offset in target buffer
-				origin,					// offset in source buffer
-				region,					// dimensions of region to copy
-				_parameters->nx + 2,	// buffer row pitch
-				0,						// buffer slice pitch (3D)
-				_parameters->nx + 2,	// host row pitch
-				0,						// host slice pitch (3D)
-				*_FLAG_host,				// pointer to host source memory
-				NULL,
-				&event
-			);*/
-
-		// TODO: use writeBufferRect instead of copy whole buffers
-		_clQueue->enqueueWriteBuffer(
-				_FLAG_g,
-				CL_TRUE,
-				0,
-				(_parameters->nx + 2) * (_parameters->ny + 2) * sizeof( unsigned char ),
-				*_FLAG_host,
-				NULL,
-				&event
-			);
-		_clQueue->enqueueWriteBuffer(
-				_U_g,
-				CL_TRUE,
-				0,
-				(_parameters->nx + 2) * (_parameters->ny + 2) * sizeof( CL_REAL ),
-				*_U_host,
-				NULL,
-				&event
-			);
-		_clQueue->enqueueWriteBuffer(
-				_V_g,
-				CL_TRUE,
-				0,
-				(_parameters->nx + 2) * (_parameters->ny + 2) * sizeof( CL_REAL ),
-				*_V_host,
-				NULL,
-				&event
-			);
-		_clQueue->enqueueWriteBuffer(
-				_P_g,
-				CL_TRUE,
-				0,
-				(_parameters->nx + 2) * (_parameters->ny + 2) * sizeof( CL_REAL ),
-				*_P_host,
-				NULL,
-				&event
-			);
-
-		event.wait();
 	}
 }
 
@@ -606,158 +619,359 @@ void NavierStokesGPU::drawObstacles
 //============================================================================
 REAL **NavierStokesGPU::getU_CPU ( )
 {
-	// copy data from device to host
-	// beware: the host array has type REAL**
-	_clQueue->enqueueReadBuffer(
-				_U_g,		// device buffer
-				CL_TRUE,	// blocking
-				0,			// offset
-				sizeof(CL_REAL) * (_parameters->nx + 2) * (_parameters->ny + 2), // size
-				*_U_host	// host buffer
-			);
-
-	_clQueue->finish();
-
-	return _U_host;
+	// copied from device to host only if the host copy is outdated
+	return _field->getU();
 }
 
 //============================================================================
 REAL **NavierStokesGPU::getV_CPU ( )
 {
-	// copy data from device to host
-	// beware: the host array has type REAL**
-	_clQueue->enqueueReadBuffer (
-				_V_g,
-				CL_TRUE,
-				0,
-				sizeof(CL_REAL) * (_parameters->nx + 2) * (_parameters->ny + 2),
-				*_V_host
-			);
-
-	_clQueue->finish();
-
-	return _V_host;
+	return _field->getV();
 }
 
 //============================================================================
 REAL **NavierStokesGPU::getP_CPU ( )
 {
-	// copy data from device to host
-	// beware: the host array has type REAL**
-	_clQueue->enqueueReadBuffer (
-				_P_g,
-				CL_TRUE,
-				0,
-				sizeof(CL_REAL) * (_parameters->nx + 2) * (_parameters->ny + 2),
-				*_P_host
-			);
-
-	_clQueue->finish();
-
-	return _P_host;
+	return _field->getP();
 }
 
-
-// -------------------------------------------------
-//	boundaries
-// -------------------------------------------------
+//============================================================================
+unsigned char** NavierStokesGPU::getFLAG_CPU ( )
+{
+	return _field->getFLAG();
+}
 
 //============================================================================
-void NavierStokesGPU::setBoundaryConditions ( )
+void NavierStokesGPU::downloadField
+	(
+		int		fieldID,
+		void*	host
+	)
 {
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
 	try
 	{
-		// kernel arguments are set in setKernelArguments()
-
-		// call kernel setBoundaryConditionsKernel
-		_clManager->runRangeKernel ( kernel::setBoundaryConditions, cl::NullRange, _clRange, cl::NullRange );
-
-		// wait for completion
-		_clQueue->finish();
-
-		// call kernel setArbitraryBoundaryConditionsKernel
-		_clManager->runRangeKernel ( kernel::setArbitraryBoundaryConditions, cl::NullRange, _clRange, cl::NullRange );
+		// the pressure iteration works on the split layout
+		if( fieldID == field::P )
+			enqueuePressureMerge();
 
-		// wait for completion
-		_clQueue->finish();
+		// beware: the host array has type REAL**
+		switch( fieldID )
+		{
+			case field::U:    _clQueue->enqueueReadBuffer( _U_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "read U", "read" ) ); break;
+			case field::V:    _clQueue->enqueueReadBuffer( _V_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "read V", "read" ) ); break;
+			case field::P:    _clQueue->enqueueReadBuffer( _P_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "read P", "read" ) ); break;
+			case field::FLAG: _clQueue->enqueueReadBuffer( _FLAG_g, CL_TRUE, 0, sizeof(unsigned char) * size, host, NULL, _clManager->profileEvent( "read FLAG", "read" ) ); break;
+		}
 	}
 	catch( cl::Error error )
 	{
-		std::cerr << "CL ERROR while applying boundary conditions: " << error.what() << "(" << error.err() << ")" << std::endl;
+		std::cerr << "CL ERROR while reading field from device: " << error.what() << "(" << error.err() << ")" << std::endl;
 		throw error;
 	}
 }
 
 //============================================================================
-void NavierStokesGPU::setSpecificBoundaryConditions ( )
+void NavierStokesGPU::uploadField
+	(
+		int			fieldID,
+		const void*	host
+	)
 {
-	if ( _parameters->problem == "moving_lid" || _parameters->problem == "channel" )
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	try
 	{
-		try
+		// blocking, as the host copy may be changed right after
+		switch( fieldID )
 		{
-			// the problem specific kernel is determined during kernel compilation
-			_clManager->runRangeKernel ( kernel::problemSpecific, cl::NullRange, _clRange, cl::NullRange );
-
-			// wait for completion
-			_clQueue->finish();
+			case field::U:    _clQueue->enqueueWriteBuffer( _U_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "write U", "write" ) ); break;
+			case field::V:    _clQueue->enqueueWriteBuffer( _V_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "write V", "write" ) ); break;
+			case field::P:    _clQueue->enqueueWriteBuffer( _P_g,    CL_TRUE, 0, sizeof(CL_REAL) * size,       host, NULL, _clManager->profileEvent( "write P", "write" ) ); break;
+			case field::FLAG: _clQueue->enqueueWriteBuffer( _FLAG_g, CL_TRUE, 0, sizeof(unsigned char) * size, host, NULL, _clManager->profileEvent( "write FLAG", "write" ) ); break;
 		}
-		catch( cl::Error error )
+
+		if( _parameters->splitPressure )
 		{
-			std::cerr << "CL ERROR while applying problem specific boundary conditions: " << error.what() << "(" << error.err() << ")" << std::endl;
-			throw error;
+			switch( fieldID )
+			{
+				case field::P:    enqueueRedBlackSplit( kernel::splitRedBlack,     _P_g,    _PSplit_g );    break;
+				case field::FLAG: enqueueRedBlackSplit( kernel::splitRedBlackFlag, _FLAG_g, _FLAGSplit_g ); break;
+			}
 		}
 	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while writing field to device: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
 }
 
-
-// -------------------------------------------------
-//	simulation
-// -------------------------------------------------
-
 //============================================================================
-void NavierStokesGPU::computeDeltaT ( )
+bool NavierStokesGPU::requestSnapshot ( )
 {
-	// results of UV reduction kernel: { max_u, max_v }
-	REAL results[2] = { 0.0, 0.0 };
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	cl::Buffer* fields[3] = { &_U_g, &_V_g, &_P_g };
 
 	try
 	{
-		// allocate memory for UV maximum result
-		// todo: move to constructor?
-		cl::Buffer results_g ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) * 2 );
+		if( !_staging_host[0] )
+			allocateSnapshotBuffers();
 
-		// set result buffer as kernel argument
-		_clManager->getKernel( kernel::getUVMaximum )->setArg( 2, results_g );
+		// fields changed on host side must be on the device first
+		_field->synchronizeDevice();
 
-		// call min/max reduction kernel
-		// todo: determine optimal work size N: N = x^2, N<=max_work_size, SIZE<=max_work_size ? N>=SIZE
-		_clManager->runRangeKernel (
-					kernel::getUVMaximum,
-					cl::NullRange,
-					cl::NDRange( _clWorkgroupSize ),
-					cl::NDRange( _clWorkgroupSize )		// make sure that all GPU cores are in one workgroup for optimal reduction speed
+		// the snapshot buffers are still read by the previous readback
+		if( _snapshotPending )
+			_snapshotEvent.wait();
+
+		enqueuePressureMerge();
+
+		// device side copy, the next time step can overwrite the fields
+		// after it, as the main queue is in order
+		cl::Event copied;
+
+		for( int i = 0; i < 3; ++i )
+		{
+			_clQueue->enqueueCopyBuffer(
+					*fields[i],
+					_snapshot_g[i],
+					0,
+					0,
+					sizeof(CL_REAL) * size,
+					NULL,
+					i == 2 ? &copied : _clManager->profileEvent( "snapshot copy", "copy" )
 				);
+		}
 
-		// wait for completion
-		_clQueue->finish();
+		_clManager->recordEvent( copied, "snapshot copy", "copy" );
 
-		// retrieve reduction result
-		_clQueue->enqueueReadBuffer( results_g, CL_TRUE, 0, sizeof(CL_REAL) * 2, results );
+		_clQueue->flush();
+
+		// readback overlaps with the next time step on the main queue
+		std::vector<cl::Event> waitList( 1, copied );
+
+		for( int i = 0; i < 3; ++i )
+		{
+			_clTransferQueue->enqueueReadBuffer(
+					_snapshot_g[i],
+					CL_FALSE,				// non-blocking
+					0,
+					sizeof(CL_REAL) * size,
+					_staging_host[i][0],	// pinned memory
+					&waitList,
+					i == 2 ? &_snapshotEvent : _clManager->profileEvent( "snapshot read", "read", 1 )
+				);
+		}
+
+		_clManager->recordEvent( _snapshotEvent, "snapshot read", "read", 1 );
+
+		_clTransferQueue->flush();
 	}
 	catch( cl::Error error )
 	{
-		std::cerr << "CL ERROR while computing Δt: " << error.what() << "(" << error.err() << ")" << std::endl;
+		std::cerr << "CL ERROR while requesting snapshot: " << error.what() << "(" << error.err() << ")" << std::endl;
 		throw error;
 	}
 
-	// compute the three options for the min-function
-	REAL opt_a, opt_x, opt_y, min;
+	_snapshotPending = true;
 
-	opt_a =   ( _parameters->re / 2.0 )
-			* 1.0 / (
-				  1.0 / (_parameters->dx * _parameters->dx)
-				+ 1.0 / (_parameters->dy * _parameters->dy)
-			);
+	return true;
+}
+
+//============================================================================
+void NavierStokesGPU::getSnapshot_CPU
+	(
+		REAL*** U,
+		REAL*** V,
+		REAL*** P
+	)
+{
+	// transfer queue is in order, so the last read completes the snapshot
+	if( _snapshotPending )
+	{
+		_snapshotEvent.wait();
+		_snapshotPending = false;
+	}
+
+	*U = _staging_host[0];
+	*V = _staging_host[1];
+	*P = _staging_host[2];
+}
+
+//============================================================================
+void NavierStokesGPU::getRegion_CPU
+	(
+		const OutputRegion&	region,
+		REAL*				data
+	)
+{
+	int width  = region.getWidth();
+	int height = region.getHeight();
+	int size   = 3 * width * height;
+	int box    = region.filter == REGION_BOX;
+	int nx2    = _parameters->nx + 2;
+
+	try
+	{
+		// fields changed on host side must be on the device first
+		_field->synchronizeDevice();
+
+		enqueuePressureMerge();
+
+		// the buffer grows to the largest region
+		if( size > _regionSize )
+		{
+			_region_g   = cl::Buffer( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) * size );
+			_regionSize = size;
+		}
+
+		cl::Kernel* kernel = _clManager->getKernel( kernel::regionOutput );
+
+		kernel->setArg(  0, _U_g );
+		kernel->setArg(  1, _V_g );
+		kernel->setArg(  2, _P_g );
+		kernel->setArg(  3, _region_g );
+		kernel->setArg(  4, sizeof(int), &region.x0 );
+		kernel->setArg(  5, sizeof(int), &region.y0 );
+		kernel->setArg(  6, sizeof(int), &region.x1 );
+		kernel->setArg(  7, sizeof(int), &region.y1 );
+		kernel->setArg(  8, sizeof(int), &region.factor );
+		kernel->setArg(  9, sizeof(int), &box );
+		kernel->setArg( 10, sizeof(int), &width );
+		kernel->setArg( 11, sizeof(int), &height );
+		kernel->setArg( 12, sizeof(int), &nx2 );
+
+		_clManager->runRangeKernel(
+				kernel::regionOutput,
+				cl::NullRange,
+				cl::NDRange( width, height ),
+				cl::NullRange
+			);
+
+		// only the reduced region is transferred
+		_clQueue->enqueueReadBuffer( _region_g, CL_TRUE, 0, sizeof(CL_REAL) * size, data,
+									 NULL, _clManager->profileEvent( "read region", "read" ) );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while extracting region \"" << region.name << "\": " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+
+// -------------------------------------------------
+//	boundaries
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesGPU::setBoundaryConditions ( )
+{
+	try
+	{
+		// kernel arguments are set in setKernelArguments()
+
+		// call 1D kernels for the domain boundaries, one work item per column or row.
+		// The vertical kernel depends on the corner values of the horizontal one,
+		// the in order queue keeps them apart.
+		_clManager->runRangeKernel ( kernel::setHorizontalBoundaryConditions, cl::NullRange, cl::NDRange( _parameters->nx + 2 ), cl::NullRange );
+		_clManager->runRangeKernel ( kernel::setVerticalBoundaryConditions,   cl::NullRange, cl::NDRange( _parameters->ny + 2 ), cl::NullRange );
+
+		// wait for completion
+		_clQueue->finish();
+
+		// call kernel setArbitraryBoundaryConditionsKernel
+		_clManager->runRangeKernel ( kernel::setArbitraryBoundaryConditions, cl::NullRange, _clRange, cl::NullRange );
+
+		// wait for completion
+		_clQueue->finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while applying boundary conditions: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+void NavierStokesGPU::setSpecificBoundaryConditions ( )
+{
+	if ( _parameters->problem == "moving_lid" || _parameters->problem == "channel" )
+	{
+		try
+		{
+			// the problem specific kernel is determined during kernel compilation,
+			// it only sets the first row (moving lid) or column (channel)
+			cl::NDRange range = ( _parameters->problem == "moving_lid" ) ?
+					cl::NDRange( _parameters->nx + 2, 1 ) :
+					cl::NDRange( 1, _parameters->ny + 2 );
+
+			_clManager->runRangeKernel ( kernel::problemSpecific, cl::NullRange, range, cl::NullRange );
+
+			// wait for completion
+			_clQueue->finish();
+		}
+		catch( cl::Error error )
+		{
+			std::cerr << "CL ERROR while applying problem specific boundary conditions: " << error.what() << "(" << error.err() << ")" << std::endl;
+			throw error;
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	simulation
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesGPU::computeDeltaT ( )
+{
+	// results of UV reduction kernel: { max_u, max_v }
+	REAL results[2] = { 0.0, 0.0 };
+
+	try
+	{
+		// call max reduction kernel, each workgroup reduces a part of the grid
+		_clManager->runRangeKernel (
+					kernel::getUVMaximum,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize * _reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+		// combine the maxima of the workgroups
+		_clManager->runRangeKernel (
+					kernel::getUVMaximumFinal,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+		// wait for completion
+		_clQueue->finish();
+
+		// retrieve reduction result
+		_clQueue->enqueueReadBuffer( _uvMaximum_g, CL_TRUE, 0, sizeof(CL_REAL) * 2, results,
+									 NULL, _clManager->profileEvent( "read maximum velocities", "read" ) );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while computing Δt: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// compute the three options for the min-function
+	REAL opt_a, opt_x, opt_y, min;
+
+	opt_a =   ( _parameters->re / 2.0 )
+			* 1.0 / (
+				  1.0 / (_parameters->dx * _parameters->dx)
+				+ 1.0 / (_parameters->dy * _parameters->dy)
+			);
 	opt_x = _parameters->dx / fabs( results[0] ); // results[0] = u_max
 	opt_y = _parameters->dy / fabs( results[1] ); // results[1] = v_max
 
@@ -818,7 +1032,34 @@ void NavierStokesGPU::computeRightHandSide ( )
 }
 
 //============================================================================
-REAL NavierStokesGPU::SORPoisson()
+void NavierStokesGPU::computeFGAndRightHandSide ( )
+{
+	try
+	{
+		// set missing kernel arguments
+		_clManager->getKernel( kernel::computeFGRHS )->setArg( 10, sizeof(CL_REAL), &_parameters->dt );
+
+		// call fused kernel, F and G of a work group are kept in shared memory for the RHS
+		_clManager->runRangeKernel ( kernel::computeFGRHS, cl::NullRange, _clTileRange, _clTileLocal );
+
+		// the pressure iteration reads the right hand side in split layout
+		if( _parameters->splitPressure )
+		{
+			enqueueRedBlackSplit( kernel::splitRedBlack, _RHS_g, _RHSSplit_g );
+		}
+
+		// wait for completion
+		_clQueue->finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while computing F, G and RHS: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+REAL NavierStokesGPU::SORPoisson ( int iterations )
 {
 	// this solver does not use overrelaxation for gauß-seidel,
 	// as it may not converge with the symmetrical red/black parallelisation
@@ -830,74 +1071,64 @@ REAL NavierStokesGPU::SORPoisson()
 
 	try
 	{
-		//-----------------------
-		// gauß seidel step
-		//-----------------------
-
-		int red = 0;
-
-		// call gaussSeidelRedBlackKernel
-		// todo: use correct range and offset for kernel call to exclude boundaries
-
-		// set red flag as kernel argument
-		_clManager->getKernel( kernel::gaussSeidelRedBlack )->setArg( 5, sizeof(int), &red );
-
-		// call kernel for black cells
-		_clManager->runRangeKernel ( kernel::gaussSeidelRedBlack, cl::NullRange, _clRange, cl::NullRange );
+		if( _parameters->tileIterations > 0 )
+		{
+			// several iterations in shared memory, including boundary values
+			enqueuePressureIterations( iterations );
+		}
+		else if( _parameters->splitPressure )
+		{
+			// black and red sweep on the compacted arrays
+			enqueuePressureIterations( 1 );
+		}
+		else
+		{
+			//-----------------------
+			// gauß seidel step
+			//-----------------------
 
-		// wait for completion
-		_clQueue->finish();
+			int red = 0;
 
-		// set flag for red cells
-		red = 1;
-		_clManager->getKernel( kernel::gaussSeidelRedBlack )->setArg( 5, sizeof(int), &red );
+			// call gaussSeidelRedBlackKernel
+			// todo: use correct range and offset for kernel call to exclude boundaries
 
-		// call kernel for red cells
-		_clManager->runRangeKernel ( kernel::gaussSeidelRedBlack, cl::NullRange, _clRange, cl::NullRange );
+			// set red flag as kernel argument
+			_clManager->getKernel( kernel::gaussSeidelRedBlack )->setArg( 5, sizeof(int), &red );
 
-		// wait for completion
-		_clQueue->finish();
+			// call kernel for black cells
+			_clManager->runRangeKernel ( kernel::gaussSeidelRedBlack, cl::NullRange, _clRange, cl::NullRange );
 
+			// wait for completion
+			_clQueue->finish();
 
-		//-----------------------
-		// boundary values
-		//-----------------------
+			// set flag for red cells
+			red = 1;
+			_clManager->getKernel( kernel::gaussSeidelRedBlack )->setArg( 5, sizeof(int), &red );
 
-		// call pressureBoundaryConditionsKernel
-		// todo: use better range (1D wit max(nx,ny))
+			// call kernel for red cells
+			_clManager->runRangeKernel ( kernel::gaussSeidelRedBlack, cl::NullRange, _clRange, cl::NullRange );
 
-		_clManager->runRangeKernel ( kernel::pressureBoundaryConditions, cl::NullRange, _clRange, cl::NullRange );
+			// wait for completion
+			_clQueue->finish();
 
-		// wait for completion
-		_clQueue->finish();
+			// the boundary values are set by the cells next to the boundary
+		}
 
 
 		//-----------------------
 		// residual
 		//-----------------------
 
-		// allocate output buffer
-		// todo: move to constructor?
-		cl::Buffer result_g ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) );
 		REAL result = 0.0;
 
-		// set output buffer as kernel argument
-		_clManager->getKernel( kernel::pressureResidualReduction )->setArg( 3, result_g );
-
-		// call pressureResidualReductionKernel
-		// todo: determine optimal work size N: N = x^2, N<=max_work_size, SIZE<=max_work_size ? N>=SIZE
-		_clManager->runRangeKernel (
-						kernel::pressureResidualReduction,
-						cl::NullRange,
-						cl::NDRange( _clWorkgroupSize ),
-						cl::NDRange( _clWorkgroupSize )		// make sure that all GPU cores are in one workgroup for optimal reduction speed
-					);
+		enqueueResidualReduction();
 
 		// wait for completion
 		_clQueue->finish();
 
 		// get result
-		_clQueue->enqueueReadBuffer( result_g, CL_TRUE, 0, sizeof(CL_REAL) , &result );
+		_clQueue->enqueueReadBuffer( _residual_g, CL_TRUE, 0, sizeof(CL_REAL) , &result,
+									 NULL, _clManager->profileEvent( "read residual", "read" ) );
 
 		// compute residual
 		residual = sqrt( result / (_parameters->nx * _parameters->ny) );
@@ -911,16 +1142,298 @@ REAL NavierStokesGPU::SORPoisson()
 	return residual;
 }
 
+//============================================================================
+int NavierStokesGPU::SORPoissonPipelined ( )
+{
+	int iterations = 0;
+	int batch      = 0;		// number of the current batch, selects the host residual
+
+	cl::Event residualRead[2];
+
+	try
+	{
+		while( iterations < _parameters->it_max )
+		{
+			//-----------------------
+			// enqueue batch of sweeps
+			//-----------------------
+
+			int sweeps = std::min( _parameters->residualInterval, _parameters->it_max - iterations );
+
+			iterations += enqueuePressureIterations( sweeps );
+
+			//-----------------------
+			// enqueue residual
+			//-----------------------
+
+			int current = batch % 2;
+
+			// the queue is in order, so the read of the previous batch
+			// is done before the result buffer is overwritten
+			enqueueResidualReduction();
+
+			_clQueue->enqueueReadBuffer(
+					_residual_g,
+					CL_FALSE,
+					0,
+					sizeof(CL_REAL),
+					&_residual_host[current],
+					NULL,
+					&residualRead[current]
+				);
+
+			_clManager->recordEvent( residualRead[current], "read residual", "read" );
+
+			// start execution, the host continues with the next batch
+			_clQueue->flush();
+
+			//-----------------------
+			// check previous batch
+			//-----------------------
+
+			// the next batch is already queued while the device works on this one,
+			// so at most one batch is done after convergence
+			if( batch > 0 )
+			{
+				int previous = 1 - current;
+
+				residualRead[previous].wait();
+
+				if( sqrt( _residual_host[previous] / (_parameters->nx * _parameters->ny) ) <= _parameters->epsilon )
+					break;
+			}
+
+			++batch;
+		}
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR during pipelined pressure iteration: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	return iterations;
+}
+
+//============================================================================
+int NavierStokesGPU::SORPoissonDeviceControlled ( )
+{
+	// written by the queue before the first sweep, so it must not live on the stack
+	static const cl_int reset[2] = { 0, 0 };
+
+	// targets of the asynchronous reads of the current and the previous batch
+	cl_int control[2][2] = { { 0, 0 }, { 0, 0 } };
+	cl_int result[2]     = { 0, 0 };
+
+	cl::Event controlRead[2];
+
+	int interval   = _parameters->residualInterval > 0 ? _parameters->residualInterval : DEVICE_CONVERGENCE_INTERVAL;
+	int iterations = 0;
+	int batch      = 0;		// number of the current batch, selects the host copy of the flag
+
+	try
+	{
+		_clQueue->enqueueWriteBuffer( _convergence_g, CL_FALSE, 0, sizeof(cl_int) * 2, reset,
+									  NULL, _clManager->profileEvent( "reset convergence", "write" ) );
+
+		cl::Kernel* gaussSeidel = _clManager->getKernel( kernel::gaussSeidelRedBlackControlled );
+		cl::Kernel* convergence = _clManager->getKernel( kernel::pressureConvergence );
+
+		while( iterations < _parameters->it_max )
+		{
+			//-----------------------
+			// enqueue batch of sweeps, no-ops after convergence
+			//-----------------------
+
+			int sweeps = std::min( interval, _parameters->it_max - iterations );
+
+			for( int i = 0; i < sweeps; ++i )
+			{
+				for( int red = 0; red < 2; ++red )
+				{
+					gaussSeidel->setArg( 5, sizeof(int), &red );
+					_clManager->runRangeKernel( kernel::gaussSeidelRedBlackControlled, cl::NullRange, _clRange, cl::NullRange );
+				}
+			}
+
+			iterations += sweeps;
+
+			//-----------------------
+			// residual check on the device
+			//-----------------------
+
+			enqueueResidualReduction( true );
+
+			convergence->setArg( 2, sizeof(int), &sweeps );
+			_clManager->runRangeKernel( kernel::pressureConvergence, cl::NullRange, cl::NDRange( 1 ), cl::NDRange( 1 ) );
+
+			int current = batch % 2;
+
+			_clQueue->enqueueReadBuffer(
+					_convergence_g,
+					CL_FALSE,
+					0,
+					sizeof(cl_int) * 2,
+					control[current],
+					NULL,
+					&controlRead[current]
+				);
+
+			_clManager->recordEvent( controlRead[current], "read convergence", "read" );
+
+			// start execution while the next batch is enqueued
+			_clQueue->flush();
+
+			//-----------------------
+			// check previous batch
+			//-----------------------
+
+			// the batch enqueued after convergence does nothing on the device
+			if( batch > 0 )
+			{
+				int previous = 1 - current;
+
+				controlRead[previous].wait();
+
+				if( control[previous][0] )
+					break;
+			}
+
+			++batch;
+		}
+
+		// the number of iterations is counted on the device
+		_clQueue->enqueueReadBuffer( _convergence_g, CL_TRUE, 0, sizeof(cl_int) * 2, result,
+									 NULL, _clManager->profileEvent( "read iterations", "read" ) );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR during device controlled pressure iteration: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	return result[1];
+}
+
+//============================================================================
+int NavierStokesGPU::enqueuePressureIterations ( int iterations )
+{
+	if( _parameters->tileIterations > 0 )
+	{
+		cl::Kernel* gaussSeidelTiled = _clManager->getKernel( kernel::gaussSeidelRedBlackTiled );
+
+		for( int done = 0; done < iterations; done += _parameters->tileIterations )
+		{
+			// the last launch only does the remaining iterations, with a smaller halo
+			// in the shared memory allocated for tileIterations
+			int count = std::min( _parameters->tileIterations, iterations - done );
+
+			if( count != _parameters->tileIterations )
+			{
+				gaussSeidelTiled->setArg( 11, sizeof(int), &count );
+			}
+
+			_clManager->runRangeKernel( kernel::gaussSeidelRedBlackTiled, cl::NullRange, _clTileRange, _clTileLocal );
+
+			// kernel arguments are copied on enqueueing, so the default can be restored without waiting
+			if( count != _parameters->tileIterations )
+			{
+				gaussSeidelTiled->setArg( 11, sizeof(int), &_parameters->tileIterations );
+			}
+
+			// other work groups read the halo of a tile, so the result can not be written in place
+			_clQueue->enqueueCopyBuffer( _PTiled_g, _P_g, 0, 0, sizeof(CL_REAL) * ( _parameters->nx + 2 ) * ( _parameters->ny + 2 ),
+										 NULL, _clManager->profileEvent( "copy tiled pressure", "copy" ) );
+		}
+
+		return iterations;
+	}
+
+	if( _parameters->splitPressure )
+	{
+		cl::Kernel* gaussSeidelSplit = _clManager->getKernel( kernel::gaussSeidelRedBlackSplit );
+
+		for( int i = 0; i < iterations; ++i )
+		{
+			for( int red = 0; red < 2; ++red )
+			{
+				gaussSeidelSplit->setArg( 8, sizeof(int), &red );
+				_clManager->runRangeKernel( kernel::gaussSeidelRedBlackSplit, cl::NullRange, _clSplitRange, cl::NullRange );
+			}
+		}
+
+		return iterations;
+	}
+
+	cl::Kernel* gaussSeidel = _clManager->getKernel( kernel::gaussSeidelRedBlack );
+
+	for( int i = 0; i < iterations; ++i )
+	{
+		// kernel arguments are copied on enqueueing,
+		// so the red flag can be changed without waiting
+		for( int red = 0; red < 2; ++red )
+		{
+			gaussSeidel->setArg( 5, sizeof(int), &red );
+			_clManager->runRangeKernel( kernel::gaussSeidelRedBlack, cl::NullRange, _clRange, cl::NullRange );
+		}
+	}
+
+	return iterations;
+}
+
+//============================================================================
+void NavierStokesGPU::enqueueResidualReduction ( bool controlled )
+{
+	int reduction = kernel::pressureResidualReduction;
+	int sum       = kernel::pressureResidualSum;
+
+	if( controlled )
+	{
+		reduction = kernel::pressureResidualReductionControlled;
+		sum       = kernel::pressureResidualSumControlled;
+	}
+	else if( _parameters->splitPressure )
+	{
+		reduction = kernel::pressureResidualSplitReduction;
+	}
+
+	// first stage: each workgroup sums up the squared residuals of a part of the grid
+	_clManager->runRangeKernel (
+					reduction,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize * _reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+	// second stage: one workgroup adds the partial sums
+	_clManager->runRangeKernel (
+					sum,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+}
+
 //============================================================================
 void NavierStokesGPU::adaptUV ( )
 {
 	try
 	{
-		// set missing kernel arguments
-		_clManager->getKernel( kernel::updateUV )->setArg( 6, sizeof(CL_REAL), &_parameters->dt );
+		if( _parameters->splitPressure )
+		{
+			// the pressure is read from the split layout
+			_clManager->getKernel( kernel::updateUVSplit )->setArg( 7, sizeof(CL_REAL), &_parameters->dt );
 
-		// call kernel for RHS computation
-		_clManager->runRangeKernel ( kernel::updateUV, cl::NullRange, _clRange, cl::NullRange );
+			_clManager->runRangeKernel ( kernel::updateUVSplit, cl::NullRange, _clRange, cl::NullRange );
+		}
+		else
+		{
+			// set missing kernel arguments
+			_clManager->getKernel( kernel::updateUV )->setArg( 6, sizeof(CL_REAL), &_parameters->dt );
+
+			// call kernel for RHS computation
+			_clManager->runRangeKernel ( kernel::updateUV, cl::NullRange, _clRange, cl::NullRange );
+		}
 
 		// wait for completion
 		_clQueue->finish();
@@ -938,21 +1451,99 @@ void NavierStokesGPU::adaptUV ( )
 // -------------------------------------------------
 
 //============================================================================
-void NavierStokesGPU::setKernelArguments ( )
+void NavierStokesGPU::enqueueRedBlackSplit
+	(
+		int			kernelID,
+		cl::Buffer&	natural,
+		cl::Buffer*	split
+	)
 {
-	// domain size including boundaries
 	int nx = _parameters->nx + 2;
 	int ny = _parameters->ny + 2;
 
-	REAL alphaFG = 0.9; // TODO: select
+	cl::Kernel* kernel = _clManager->getKernel( kernelID );
+
+	kernel->setArg( 0, natural );
+	kernel->setArg( 1, split[0] );
+	kernel->setArg( 2, split[1] );
+	kernel->setArg( 3, sizeof(int), &nx );
+	kernel->setArg( 4, sizeof(int), &ny );
+
+	_clManager->runRangeKernel( kernelID, cl::NullRange, _clRange, cl::NullRange );
+}
+
+//============================================================================
+void NavierStokesGPU::enqueuePressureMerge ( )
+{
+	if( !_parameters->splitPressure )
+		return;
+
+	int nx = _parameters->nx + 2;
+	int ny = _parameters->ny + 2;
+
+	cl::Kernel* kernel = _clManager->getKernel( kernel::mergeRedBlack );
+
+	kernel->setArg( 0, _PSplit_g[0] );
+	kernel->setArg( 1, _PSplit_g[1] );
+	kernel->setArg( 2, _P_g );
+	kernel->setArg( 3, sizeof(int), &nx );
+	kernel->setArg( 4, sizeof(int), &ny );
+
+	_clManager->runRangeKernel( kernel::mergeRedBlack, cl::NullRange, _clRange, cl::NullRange );
+}
+
+//============================================================================
+void NavierStokesGPU::allocateSnapshotBuffers ( )
+{
+	int nx2  = _parameters->nx + 2;
+	int ny2  = _parameters->ny + 2;
+	int size = nx2 * ny2;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		_snapshot_g[i] = cl::Buffer( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+
+		// page locked host memory allows DMA transfers without an extra copy
+		_staging_g[i] = cl::Buffer( *_clContext, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, sizeof(CL_REAL) * size );
+
+		// stays mapped until destruction
+		REAL* staging = (REAL*)_clQueue->enqueueMapBuffer(
+				_staging_g[i],
+				CL_TRUE,
+				CL_MAP_READ | CL_MAP_WRITE,
+				0,
+				sizeof(CL_REAL) * size
+			);
+
+		_staging_host[i] = (REAL**)malloc( ny2 * sizeof( REAL* ) );
+
+		for( int y = 0; y < ny2; ++y )
+		{
+			_staging_host[i][y] = staging + y * nx2;
+		}
+	}
+}
+
+//============================================================================
+void NavierStokesGPU::setKernelArguments ( )
+{
+	// problem constants, also baked into specialized kernels
+	KernelConstants constants( _parameters );
+
+	// domain size including boundaries
+	int nx = constants.nx;
+	int ny = constants.ny;
+
+	REAL alphaFG = constants.alpha;
 
 	// constant values for pressure equation
-	float dx2 = 1.0 / (_parameters->dx * _parameters->dx);
-	float dy2 =	1.0 / (_parameters->dy * _parameters->dy);
+	float dx2 = constants.dx2;
+	float dy2 = constants.dy2;
+
+	REAL constant_expr = constants.constant_expr;
+	REAL omega         = constants.omega;
 
-	//REAL constant_expr = 1.0 / ( 2.0 * dx2 + 2.0 * dy2 );
-	REAL constant_expr = _parameters->omega / ( 2.0 * dx2 + 2.0 * dy2 );
-	REAL omega = 1.0 - _parameters->omega;
+	int setPressureBoundary = 1;
 
 	#if VERBOSE
 		std::cout << "Setting kernel arguments..." << std::endl;
@@ -962,16 +1553,22 @@ void NavierStokesGPU::setKernelArguments ( )
 	{
 		cl::Kernel* kernel;
 
-		// set kernel arguments for setBoundaryConditionsKernel
-		kernel = _clManager->getKernel( kernel::setBoundaryConditions );
+		// set kernel arguments for the 1D domain boundary kernels
+		kernel = _clManager->getKernel( kernel::setHorizontalBoundaryConditions );
 		kernel->setArg( 0, _U_g );
 		kernel->setArg( 1, _V_g );
 		kernel->setArg( 2, sizeof(int), &(_parameters->wN) ); // northern boundary condition
-		kernel->setArg( 3, sizeof(int), &(_parameters->wE) ); // eastern boundary condition
-		kernel->setArg( 4, sizeof(int), &(_parameters->wS) ); // southern boundary condition
-		kernel->setArg( 5, sizeof(int), &(_parameters->wW) ); // western boundary condition
-		kernel->setArg( 6, sizeof(int), &nx );
-		kernel->setArg( 7, sizeof(int), &ny );
+		kernel->setArg( 3, sizeof(int), &(_parameters->wS) ); // southern boundary condition
+		kernel->setArg( 4, sizeof(int), &nx );
+		kernel->setArg( 5, sizeof(int), &ny );
+
+		kernel = _clManager->getKernel( kernel::setVerticalBoundaryConditions );
+		kernel->setArg( 0, _U_g );
+		kernel->setArg( 1, _V_g );
+		kernel->setArg( 2, sizeof(int), &(_parameters->wE) ); // eastern boundary condition
+		kernel->setArg( 3, sizeof(int), &(_parameters->wW) ); // western boundary condition
+		kernel->setArg( 4, sizeof(int), &nx );
+		kernel->setArg( 5, sizeof(int), &ny );
 
 		// set kernel arguments for setArbitraryBoundaryConditionsKernel
 		kernel = _clManager->getKernel( kernel::setArbitraryBoundaryConditions );
@@ -994,12 +1591,19 @@ void NavierStokesGPU::setKernelArguments ( )
 		kernel = _clManager->getKernel( kernel::getUVMaximum );
 		kernel->setArg( 0, _U_g );
 		kernel->setArg( 1, _V_g );
-		// argument 2: result buffer: { REAL u_max, REAL v_max }
+		kernel->setArg( 2, _uvPartials_g );
 		kernel->setArg( 3, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for U
 		kernel->setArg( 4, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for V
 		kernel->setArg( 5, sizeof(int), &nx );
 		kernel->setArg( 6, sizeof(int), &ny );
 
+		kernel = _clManager->getKernel( kernel::getUVMaximumFinal );
+		kernel->setArg( 0, _uvPartials_g );
+		kernel->setArg( 1, _uvMaximum_g );
+		kernel->setArg( 2, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for U
+		kernel->setArg( 3, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for V
+		kernel->setArg( 4, sizeof(int), &_reductionGroups );
+
 		// kernel arguments for F and G computation
 		kernel = _clManager->getKernel( kernel::computeF );
 		kernel->setArg( 0,  _U_g );
@@ -1040,6 +1644,26 @@ void NavierStokesGPU::setKernelArguments ( )
 		kernel->setArg( 6, sizeof(int), &nx );
 		kernel->setArg( 7, sizeof(int), &ny );
 
+		// kernel arguments for the fused F, G and RHS computation
+		kernel = _clManager->getKernel( kernel::computeFGRHS );
+		kernel->setArg( 0,  _U_g );
+		kernel->setArg( 1,  _V_g );
+		kernel->setArg( 2,  _FLAG_g );
+		kernel->setArg( 3,  _F_g );
+		kernel->setArg( 4,  _G_g );
+		kernel->setArg( 5,  _RHS_g );
+		kernel->setArg( 6,  sizeof(CL_REAL) * ( _clTileLocal[0] + 1 ) * _clTileLocal[1], NULL ); // shared memory for F
+		kernel->setArg( 7,  sizeof(CL_REAL) * _clTileLocal[0] * ( _clTileLocal[1] + 1 ), NULL ); // shared memory for G
+		kernel->setArg( 8,  sizeof(CL_REAL), &(_parameters->gx) );
+		kernel->setArg( 9,  sizeof(CL_REAL), &(_parameters->gy) );
+		// kernel->setArg( 10, sizeof(CL_REAL), &_dt ); // set before kernel call
+		kernel->setArg( 11, sizeof(CL_REAL), &(_parameters->re) );
+		kernel->setArg( 12, sizeof(CL_REAL), &alphaFG );
+		kernel->setArg( 13, sizeof(CL_REAL), &(_parameters->dx) );
+		kernel->setArg( 14, sizeof(CL_REAL), &(_parameters->dy) );
+		kernel->setArg( 15, sizeof(int), &nx );
+		kernel->setArg( 16, sizeof(int), &ny );
+
 		// kernel arguments for gauß seidel step in pressure solving
 		kernel = _clManager->getKernel( kernel::gaussSeidelRedBlack );
 		kernel->setArg( 0, _P_g );
@@ -1052,26 +1676,144 @@ void NavierStokesGPU::setKernelArguments ( )
 		kernel->setArg( 7, sizeof(CL_REAL), &omega );
 		kernel->setArg( 8, sizeof(int), &nx );
 		kernel->setArg( 9, sizeof(int), &ny );
+		kernel->setArg( 10, sizeof(int), &setPressureBoundary ); // replaces pressureBoundaryConditionsKernel
 
-		// kernel arguments for updating pressure boundary conditions
-		kernel = _clManager->getKernel( kernel::pressureBoundaryConditions );
-		kernel->setArg( 0, _P_g );
-		// kernel->setArg( 1, sizeof(int), &problemId ); // todo: id of the problem
-		kernel->setArg( 1, sizeof(int), &nx );
-		kernel->setArg( 2, sizeof(int), &ny );
+		// kernel arguments for the device controlled pressure iteration
+		if( _parameters->deviceConvergence )
+		{
+			int cells = _parameters->nx * _parameters->ny;
+
+			kernel = _clManager->getKernel( kernel::gaussSeidelRedBlackControlled );
+			kernel->setArg( 0, _P_g );
+			kernel->setArg( 1, _FLAG_g );
+			kernel->setArg( 2, _RHS_g );
+			kernel->setArg( 3, sizeof(CL_REAL), &dx2 );
+			kernel->setArg( 4, sizeof(CL_REAL), &dy2 );
+			// kernel->setArg( 5, sizeof(int), &red ); // red/black flag, set before kernel call
+			kernel->setArg( 6, sizeof(CL_REAL), &constant_expr );
+			kernel->setArg( 7, sizeof(CL_REAL), &omega );
+			kernel->setArg( 8, sizeof(int), &nx );
+			kernel->setArg( 9, sizeof(int), &ny );
+			kernel->setArg( 10, sizeof(int), &setPressureBoundary );
+			kernel->setArg( 11, _convergence_g );
+
+			kernel = _clManager->getKernel( kernel::pressureConvergence );
+			kernel->setArg( 0, _residual_g );
+			kernel->setArg( 1, _convergence_g );
+			// kernel->setArg( 2, sizeof(int), &sweeps ); // iterations since the last check, set before kernel call
+			kernel->setArg( 3, sizeof(CL_REAL), &(_parameters->epsilon) );
+			kernel->setArg( 4, sizeof(int), &cells );
+
+			// residual reduction, skipped after convergence
+			kernel = _clManager->getKernel( kernel::pressureResidualReductionControlled );
+			kernel->setArg( 0, _P_g );
+			kernel->setArg( 1, _RHS_g );
+			kernel->setArg( 2, _FLAG_g );
+			kernel->setArg( 3, _residualPartials_g );
+			kernel->setArg( 4, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for reduction
+			kernel->setArg( 5, sizeof(CL_REAL), &dx2 );
+			kernel->setArg( 6, sizeof(CL_REAL), &dy2 );
+			kernel->setArg( 7, sizeof(int), &nx );
+			kernel->setArg( 8, sizeof(int), &ny );
+			kernel->setArg( 9, _convergence_g );
+
+			kernel = _clManager->getKernel( kernel::pressureResidualSumControlled );
+			kernel->setArg( 0, _residualPartials_g );
+			kernel->setArg( 1, _residual_g );
+			kernel->setArg( 2, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for reduction
+			kernel->setArg( 3, sizeof(int), &_reductionGroups );
+			kernel->setArg( 4, _convergence_g );
+		}
+
+		// kernel arguments for the tiled pressure iteration
+		if( _parameters->tileIterations > 0 )
+		{
+			// shared memory for the tile and a halo of 3 cells per iteration
+			int halo = 3 * _parameters->tileIterations;
+			int blockSize = ( _clTileLocal[0] + 2 * halo ) * ( _clTileLocal[1] + 2 * halo );
+
+			kernel = _clManager->getKernel( kernel::gaussSeidelRedBlackTiled );
+			kernel->setArg( 0,  _P_g );
+			kernel->setArg( 1,  _PTiled_g );
+			kernel->setArg( 2,  _FLAG_g );
+			kernel->setArg( 3,  _RHS_g );
+			kernel->setArg( 4,  sizeof(CL_REAL) * blockSize, NULL );
+			kernel->setArg( 5,  sizeof(CL_REAL) * blockSize, NULL );
+			kernel->setArg( 6,  sizeof(unsigned char) * blockSize, NULL );
+			kernel->setArg( 7,  sizeof(CL_REAL), &dx2 );
+			kernel->setArg( 8,  sizeof(CL_REAL), &dy2 );
+			kernel->setArg( 9,  sizeof(CL_REAL), &constant_expr );
+			kernel->setArg( 10, sizeof(CL_REAL), &omega );
+			kernel->setArg( 11, sizeof(int), &_parameters->tileIterations );
+			kernel->setArg( 12, sizeof(int), &nx );
+			kernel->setArg( 13, sizeof(int), &ny );
+		}
+
+		// kernel arguments for the pressure iteration on the split red/black layout
+		if( _parameters->splitPressure )
+		{
+			kernel = _clManager->getKernel( kernel::gaussSeidelRedBlackSplit );
+			kernel->setArg( 0,  _PSplit_g[0] );
+			kernel->setArg( 1,  _PSplit_g[1] );
+			kernel->setArg( 2,  _FLAGSplit_g[0] );
+			kernel->setArg( 3,  _FLAGSplit_g[1] );
+			kernel->setArg( 4,  _RHSSplit_g[0] );
+			kernel->setArg( 5,  _RHSSplit_g[1] );
+			kernel->setArg( 6,  sizeof(CL_REAL), &dx2 );
+			kernel->setArg( 7,  sizeof(CL_REAL), &dy2 );
+			// kernel->setArg( 8, sizeof(int), &red ); // red/black flag, set before kernel call
+			kernel->setArg( 9,  sizeof(CL_REAL), &constant_expr );
+			kernel->setArg( 10, sizeof(CL_REAL), &omega );
+			kernel->setArg( 11, sizeof(int), &nx );
+			kernel->setArg( 12, sizeof(int), &ny );
+
+			kernel = _clManager->getKernel( kernel::pressureResidualSplitReduction );
+			kernel->setArg( 0,  _PSplit_g[0] );
+			kernel->setArg( 1,  _PSplit_g[1] );
+			kernel->setArg( 2,  _RHSSplit_g[0] );
+			kernel->setArg( 3,  _RHSSplit_g[1] );
+			kernel->setArg( 4,  _FLAGSplit_g[0] );
+			kernel->setArg( 5,  _FLAGSplit_g[1] );
+			kernel->setArg( 6,  _residualPartials_g );
+			kernel->setArg( 7,  sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for reduction
+			kernel->setArg( 8,  sizeof(CL_REAL), &dx2 );
+			kernel->setArg( 9,  sizeof(CL_REAL), &dy2 );
+			kernel->setArg( 10, sizeof(int), &nx );
+			kernel->setArg( 11, sizeof(int), &ny );
+
+			kernel = _clManager->getKernel( kernel::updateUVSplit );
+			kernel->setArg( 0,  _PSplit_g[0] );
+			kernel->setArg( 1,  _PSplit_g[1] );
+			kernel->setArg( 2,  _F_g );
+			kernel->setArg( 3,  _G_g );
+			kernel->setArg( 4,  _FLAG_g );
+			kernel->setArg( 5,  _U_g );
+			kernel->setArg( 6,  _V_g );
+			// kernel->setArg( 7, sizeof(CL_REAL), &_dt ); // set before kernel call
+			kernel->setArg( 8,  sizeof(CL_REAL), &(_parameters->dx) );
+			kernel->setArg( 9,  sizeof(CL_REAL), &(_parameters->dy) );
+			kernel->setArg( 10, sizeof(int), &nx );
+			kernel->setArg( 11, sizeof(int), &ny );
+		}
 
 		// kernel arguments for pressure iteration residual computation
 		kernel = _clManager->getKernel( kernel::pressureResidualReduction );
 		kernel->setArg( 0, _P_g );
 		kernel->setArg( 1, _RHS_g );
 		kernel->setArg( 2, _FLAG_g );
-		// argument 3: result buffer: REAL sum
+		kernel->setArg( 3, _residualPartials_g );
 		kernel->setArg( 4, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for reduction
 		kernel->setArg( 5, sizeof(CL_REAL), &dx2 );
 		kernel->setArg( 6, sizeof(CL_REAL), &dy2 );
 		kernel->setArg( 7, sizeof(int), &nx );
 		kernel->setArg( 8, sizeof(int), &ny );
 
+		kernel = _clManager->getKernel( kernel::pressureResidualSum );
+		kernel->setArg( 0, _residualPartials_g );
+		kernel->setArg( 1, _residual_g );
+		kernel->setArg( 2, sizeof(CL_REAL) * _clWorkgroupSize, NULL); // dynamically allocated local shared memory for reduction
+		kernel->setArg( 3, sizeof(int), &_reductionGroups );
+
 		// kernel arguments for UV update
 		kernel = _clManager->getKernel( kernel::updateUV );
 		kernel->setArg( 0,  _P_g );
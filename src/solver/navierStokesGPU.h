@@ -7,6 +7,11 @@
 
 #include "navierStokesSolver.h"
 #include "../CLManager.h"
+#include "../FlowField.h"
+
+// iterations between two convergence checks of the device controlled
+// pressure iteration if no residual interval is given
+#define DEVICE_CONVERGENCE_INTERVAL 10
 
 //====================================================================
 /*! \class NavierStokesGPU
@@ -15,7 +20,7 @@
 */
 //====================================================================
 
-class NavierStokesGPU : public NavierStokesSolver
+class NavierStokesGPU : public NavierStokesSolver, public FlowFieldDevice
 {
 	protected:
 		// -------------------------------------------------
@@ -31,17 +36,49 @@ class NavierStokesGPU : public NavierStokesSolver
 					_RHS_g,				//! right-hand side for pressure iteration
 					_F_g,
 					_G_g,
-					_FLAG_g;			//! obstacle map
+					_FLAG_g,			//! obstacle map
+					_region_g;			//! extracted region for region outputs
+
+		int			_regionSize;		//! number of values _region_g can hold
 
 
 		int			_pitch;				//! pitch for GPU memory
 
-		// host arrays for data exchange
-		REAL	**_U_host,				//! pointer to host memory for horizontal velocity
-				**_V_host,				//! pointer to host memory for vertical velocity
-				**_P_host;				//! pointer to host memory for pressure
+		// host copies of U, V, P and FLAG, transferred only on access
+		FlowField*	_field;				//! host memory for data exchange
+
+		// asynchronous snapshots of U, V and P
+		cl::Buffer	_snapshot_g[3];		//! device copies of the fields at snapshot time
+		cl::Buffer	_staging_g[3];		//! pinned host memory (CL_MEM_ALLOC_HOST_PTR)
+		REAL**		_staging_host[3];	//! row pointers into the mapped pinned memory
+		cl::Event	_snapshotEvent;		//! completion of the snapshot readback
+		bool		_snapshotPending;	//! a snapshot readback has been started
+
+		// pipelined pressure iteration
+		CL_REAL		_residual_host[2];	//! targets of the asynchronous residual reads of the current and the previous batch
+
+		// two stage reductions
+		int			_reductionGroups;	//! number of work groups of the first reduction stage
+		cl::Buffer	_residualPartials_g,//! partial residual sums, one per work group
+					_uvPartials_g;		//! partial UV maxima { u_max, v_max } per work group
+
+		// tiled pressure iteration and F, G, RHS computation
+		cl::Buffer	_PTiled_g;			//! pressure output of the tiled kernel, copied back to _P_g
+		cl::NDRange	_clTileRange,		//! global range of the tiled kernels, whole work groups covering the domain
+					_clTileLocal;		//! work group size of the tiled kernels
 
-		unsigned char **_FLAG_host;		//! pointer to host memory for obstacle flags
+		// scratch buffers for reduction results, allocated and bound to the kernels once
+		cl::Buffer	_residual_g,		//! sum of squared residuals
+					_uvMaximum_g;		//! { u_max, v_max }
+
+		// device controlled pressure iteration
+		cl::Buffer	_convergence_g;		//! { converged flag, number of iterations }
+
+		// split red/black layout of the pressure iteration, [0] black cells, [1] red cells
+		cl::Buffer	_PSplit_g[2],		//! pressure, _P_g is only updated for output
+					_RHSSplit_g[2],		//! right-hand side, split after each computation
+					_FLAGSplit_g[2];	//! obstacle map, split after each upload
+		cl::NDRange	_clSplitRange;		//! range of the split sweep, one work item per cell of a colour
 
 
 		// OpenCL data
@@ -52,6 +89,7 @@ class NavierStokesGPU : public NavierStokesSolver
 			// context and queue allow use of cl functions without extra methods in the manager
 		cl::Context*		_clContext;			//! pointer to CL context
 		cl::CommandQueue*	_clQueue;			//! pointer to CL queue
+		cl::CommandQueue*	_clTransferQueue;	//! pointer to CL queue for snapshot readbacks
 
 			//! @}
 
@@ -94,6 +132,17 @@ class NavierStokesGPU : public NavierStokesSolver
 
 		bool	setObstacleMap ( bool** map );
 
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! \returns true if the state was loaded, false otherwise
+
+		bool	loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			);
+
 			//! @}
 
 
@@ -144,23 +193,70 @@ class NavierStokesGPU : public NavierStokesSolver
 			//! @{
 
 			//! \brief gives access to the horizontal velocity component
-			//! The velocity is copied from device to host memory before returned.
+			//! The velocity is copied from device to host memory if the host copy is outdated.
 			//! \returns pointer to horizontal velocity array
 
 		REAL** getU_CPU ( );
 
 			//! \brief gives access to the vertical velocity component
-			//! The velocity is copied from device to host memory before returned.
+			//! The velocity is copied from device to host memory if the host copy is outdated.
 			//! \returns pointer to vertical velocity array
 
 		REAL** getV_CPU ( );
 
 			//! \brief gives access to the pressure
-			//! The pressure is copied from device to host memory before returned.
+			//! The pressure is copied from device to host memory if the host copy is outdated.
 			//! \returns pointer to pressure array
 
 		REAL** getP_CPU ( );
 
+			//! \brief gives access to the obstacle flags
+			//! \returns pointer to flag array
+
+		unsigned char** getFLAG_CPU ( );
+
+			//! \brief copies a field from device to host memory, used by the flow field
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		void downloadField ( int fieldID, void* host );
+
+			//! \brief copies a field from host to device memory, used by the flow field
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		void uploadField ( int fieldID, const void* host );
+
+			//! \brief copies U, V and P to pinned host memory in the background
+			//! The fields are copied to snapshot buffers on the device, which are
+			//! read on the transfer queue while the next time step is computed.
+			//! \returns true
+
+		bool requestSnapshot ( );
+
+			//! \brief waits for the snapshot readback
+			//! \param returns pointer to horizontal velocity array
+			//! \param returns pointer to vertical velocity array
+			//! \param returns pointer to pressure array
+
+		void getSnapshot_CPU
+			(
+				REAL*** U,
+				REAL*** V,
+				REAL*** P
+			);
+
+			//! \brief extracts a region on the device
+			//! Only the reduced region is copied to host memory.
+			//! \param region to extract
+			//! \param target for the u, v and p planes
+
+		void getRegion_CPU
+			(
+				const OutputRegion&	region,
+				REAL*				data
+			);
+
 			//! @}
 
 
@@ -200,10 +296,66 @@ class NavierStokesGPU : public NavierStokesSolver
 
 		void	computeRightHandSide ( );
 
+			//! \brief computes F, G and the right-hand side of the pressure equation
+			//! in one kernel launch, replaces computeFG and computeRightHandSide
+
+		void	computeFGAndRightHandSide ( );
+
 			//! \brief SOR iteration step for pressure Poisson equation
+			//! \param number of iterations done by the tiled kernel
 			//! \returns residual
 
-		REAL	SORPoisson ( );
+		REAL	SORPoisson ( int iterations = 1 );
+
+			//! \brief pressure iteration without host synchronization
+			//! Batches of residualInterval red/black sweeps are enqueued without
+			//! waiting. The residual of each batch is read asynchronously while the
+			//! next batch runs, the host only waits for it to decide on convergence.
+			//! \returns number of iterations
+
+		int		SORPoissonPipelined ( );
+
+			//! \brief pressure iteration stopped by the device
+			//! Batches of residualInterval (or DEVICE_CONVERGENCE_INTERVAL) iterations
+			//! are enqueued, each followed by a residual check on the device. Once the
+			//! residual is below epsilon, the sweeps and residual checks do nothing.
+			//! The converged flag is read asynchronously, so the host stops enqueueing
+			//! one batch after convergence without waiting for the device in between.
+			//! \returns number of iterations
+
+		int		SORPoissonDeviceControlled ( );
+
+			//! \brief enqueues pressure iterations (black cells, red cells, boundary values)
+			//! without waiting for completion. The tiled kernel does up to
+			//! tileIterations per launch, the last launch only the remainder.
+			//! \param number of iterations
+			//! \returns number of iterations enqueued
+
+		int		enqueuePressureIterations ( int iterations );
+
+			//! \brief enqueues the two stage reduction of the squared residuals
+			//! The sum is written to _residual_g and stays on the device.
+			//! \param true to skip the reduction once the device controlled
+			//!        pressure iteration has converged
+
+		void	enqueueResidualReduction ( bool controlled = false );
+
+			//! \brief copies a field into the split red/black layout
+			//! \param kernel id, splitRedBlack or splitRedBlackFlag
+			//! \param field in natural layout
+			//! \param black and red target arrays
+
+		void	enqueueRedBlackSplit
+			(
+				int			kernelID,
+				cl::Buffer&	natural,
+				cl::Buffer*	split
+			);
+
+			//! \brief copies the pressure from the split layout to _P_g
+			//! Does nothing if the split layout is not used.
+
+		void	enqueuePressureMerge ( );
 
 			//! \brief calculates new velocities
 
@@ -227,6 +379,10 @@ class NavierStokesGPU : public NavierStokesSolver
 
 		void	setKernelArguments ( );
 
+			//! \brief allocates snapshot and pinned staging buffers on first use
+
+		void	allocateSnapshotBuffers ( );
+
 			//! @}
 };
 
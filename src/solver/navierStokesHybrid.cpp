@@ -0,0 +1,851 @@
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "navierStokesHybrid.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <iostream>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+//====================================================================
+/*! \class HybridTask
+	\brief Computes a phase for one block of the host strip in the
+	thread pool
+*/
+//====================================================================
+
+class HybridTask : public QRunnable
+{
+	protected:
+		NavierStokesHybrid*	_solver;
+		HostBlock*			_block;
+		int					_phase;
+		int					_red;
+
+	public:
+		HybridTask ( NavierStokesHybrid* solver, HostBlock* block, int phase, int red )
+		{
+			_solver = solver;
+			_block  = block;
+			_phase  = phase;
+			_red    = red;
+		}
+
+		void run ( )
+		{
+			_solver->runHostPhase( *_block, _phase, _red );
+
+			_block->finished = _solver->_phaseTimer.nsecsElapsed();
+		}
+};
+
+//********************************************************************
+//**    implementation
+//********************************************************************
+
+// -------------------------------------------------
+//	constructor / destructor
+// -------------------------------------------------
+
+//============================================================================
+NavierStokesHybrid::NavierStokesHybrid
+	(
+		Parameters* parameters,
+		CLManager* clManager
+	)
+	: NavierStokesCPU ( parameters )
+{
+	_clManager = clManager;
+	_clContext = clManager->getContext();
+
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	// load and compile kernels
+	_clManager->loadKernels();
+
+	_clWorkgroupSize = _clManager->getWorkgroupSize();
+
+	try
+	{
+		_device.device = (*_clManager->getDevices())[0];
+		_device.queue  = cl::CommandQueue( *_clContext, _device.device );
+
+		// kernel arguments are set for the buffers of the strip
+		_clManager->createKernels( _device.kernels );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while creating the device strip: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// first reduction stage: a few workgroups per compute unit, see NavierStokesGPU.
+	// computed for the whole domain, as the strip changes its size
+	int cells = nx2 * ny2;
+	int units = _device.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+	_device.reductionGroups = std::min( 4 * units, _clWorkgroupSize );
+	_device.reductionGroups = std::min( _device.reductionGroups, ( cells + _clWorkgroupSize - 1 ) / _clWorkgroupSize );
+	_device.reductionGroups = std::max( _device.reductionGroups, 1 );
+
+	// initial size of the host strip, at least two rows on each side
+	_device.first = (int)( ny2 * _parameters->hybridFraction + 0.5 );
+	_device.first = std::max( 2, std::min( _device.first, ny2 - 2 ) );
+	_device.last  = ny2;
+
+	// one core waits for the device
+	_pool.setMaxThreadCount( std::max( QThread::idealThreadCount() - 1, 1 ) );
+
+	createHostBlocks();
+
+	_hostTime    = 0;
+	_deviceTime  = 0;
+	_balanceStep = 0;
+
+	_hostOutdated[field::U] = false;
+	_hostOutdated[field::V] = false;
+	_hostOutdated[field::P] = false;
+}
+
+//============================================================================
+NavierStokesHybrid::~NavierStokesHybrid ( )
+{
+	_pool.waitForDone();
+
+	_device.queue.finish();
+}
+
+// -------------------------------------------------
+//	initialization
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesHybrid::initialize ( )
+{
+	// host fields with initial values
+	NavierStokesCPU::initialize();
+
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+	int ny2  = _parameters->ny + 2;
+
+	#if VERBOSE
+		std::cout << "allocating and initializing device buffers..." << std::endl;
+	#endif
+
+	try
+	{
+		// the device holds the whole fields, only the rows of its strip are current
+		_device.U_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+		_device.V_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+		_device.P_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+		_device.RHS_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+		_device.F_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+		_device.G_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+
+		_device.residualPartials_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * _device.reductionGroups );
+		_device.uvPartials_g       = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * _device.reductionGroups * 2 );
+
+		_device.residual_g  = cl::Buffer ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) );
+		_device.uvMaximum_g = cl::Buffer ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) * 2 );
+
+		// same initial values as on the host
+		writeRows( _device.U_g,   _U,   0, ny2 );
+		writeRows( _device.V_g,   _V,   0, ny2 );
+		writeRows( _device.P_g,   _P,   0, ny2 );
+		writeRows( _device.RHS_g, _RHS, 0, ny2 );
+		writeRows( _device.F_g,   _F,   0, ny2 );
+		writeRows( _device.G_g,   _G,   0, ny2 );
+
+		// set kernel arguments for all kernels
+		NavierStokesMultiGPU::setKernelArguments( _device, _parameters, _clWorkgroupSize );
+
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while initializing the device strip: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+bool NavierStokesHybrid::setObstacleMap
+	(
+		bool **map
+	)
+{
+	if( !NavierStokesCPU::setObstacleMap( map ) )
+	{
+		return false;
+	}
+
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	//-----------------------
+	// copy to device memory
+	//-----------------------
+
+	try
+	{
+		_device.FLAG_g = cl::Buffer (
+				*_clContext,
+				CL_MEM_READ_WRITE,
+				size * sizeof( unsigned char )
+			);
+
+		_device.queue.enqueueWriteBuffer( _device.FLAG_g, CL_TRUE, 0, size * sizeof( unsigned char ), *_FLAG );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while copying obstacle map: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	return true;
+}
+
+//============================================================================
+bool NavierStokesHybrid::loadState
+	(
+		const REAL* U,
+		const REAL* V,
+		const REAL* P,
+		const unsigned char* FLAG
+	)
+{
+	NavierStokesCPU::loadState( U, V, P, FLAG );
+
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+	int ny2  = _parameters->ny + 2;
+
+	try
+	{
+		writeRows( _device.U_g, _U, 0, ny2 );
+		writeRows( _device.V_g, _V, 0, ny2 );
+		writeRows( _device.P_g, _P, 0, ny2 );
+
+		_device.queue.enqueueWriteBuffer( _device.FLAG_g, CL_FALSE, 0, size * sizeof( unsigned char ), *_FLAG );
+
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while loading simulation state: " << error.what() << "(" << error.err() << ")" << std::endl;
+		return false;
+	}
+
+	_hostOutdated[field::U] = false;
+	_hostOutdated[field::V] = false;
+	_hostOutdated[field::P] = false;
+
+	return true;
+}
+
+// -------------------------------------------------
+//	execution
+// -------------------------------------------------
+
+//============================================================================
+int NavierStokesHybrid::doSimulationStep()
+{
+	// adjust the strips to the measured times
+	balance();
+
+	computeDeltaT();
+
+	// set boundary values for u and v
+	runPhase( PHASE_BOUNDARY );
+	exchangeHalos( halo::U | halo::V );
+
+	// compute F(n) and G(n), the right hand side reads G of the row below
+	runPhase( PHASE_FG );
+	exchangeHalos( halo::G );
+
+	runPhase( PHASE_RHS );
+
+
+	//-----------------------
+	// poisson overrelaxation loop
+	//-----------------------
+
+	// the residual needs a synchronization, so it is
+	// only checked every residualInterval sweeps if given
+	int interval = std::max( _parameters->residualInterval, 1 );
+
+	int  sor_iterations = 0;
+	REAL residual       = INFINITY;
+
+	while( sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon )
+	{
+		// red cells read the black cells of the other strip
+		for( int red = 0; red < 2; ++red )
+		{
+			runPhase( PHASE_SOR, red );
+			exchangeHalos( halo::P );
+		}
+
+		++sor_iterations;
+
+		if( sor_iterations % interval == 0 || sor_iterations == _parameters->it_max )
+		{
+			residual = computeResidual();
+		}
+	}
+
+
+	//-----------------------
+	// compute U(n+1) and V(n+1)
+	//-----------------------
+
+	runPhase( PHASE_UV );
+	exchangeHalos( halo::U | halo::V );
+
+	// the rows of the device are copied when they are accessed
+	_hostOutdated[field::U] = true;
+	_hostOutdated[field::V] = true;
+	_hostOutdated[field::P] = true;
+
+	return sor_iterations;
+}
+
+
+// -------------------------------------------------
+//	interaction
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesHybrid::drawObstacles
+	(
+		int x0,
+		int y0,
+		int x1,
+		int y1,
+		bool delete_flag
+	)
+{
+	// the obstacles are drawn into the whole host fields
+	getU_CPU();
+	getV_CPU();
+	getP_CPU();
+
+	NavierStokesCPU::drawObstacles( x0, y0, x1, y1, delete_flag );
+
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+	int ny2  = _parameters->ny + 2;
+
+	try
+	{
+		writeRows( _device.U_g, _U, 0, ny2 );
+		writeRows( _device.V_g, _V, 0, ny2 );
+		writeRows( _device.P_g, _P, 0, ny2 );
+
+		_device.queue.enqueueWriteBuffer( _device.FLAG_g, CL_FALSE, 0, size * sizeof( unsigned char ), *_FLAG );
+
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while drawing obstacles: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+
+// -------------------------------------------------
+//	data access
+// -------------------------------------------------
+
+//============================================================================
+REAL** NavierStokesHybrid::getU_CPU ( )
+{
+	if( _hostOutdated[field::U] )
+	{
+		readRows( _device.U_g, _U, _device.first, _device.last );
+		_device.queue.finish();
+
+		_hostOutdated[field::U] = false;
+	}
+
+	return _U;
+}
+
+//============================================================================
+REAL** NavierStokesHybrid::getV_CPU ( )
+{
+	if( _hostOutdated[field::V] )
+	{
+		readRows( _device.V_g, _V, _device.first, _device.last );
+		_device.queue.finish();
+
+		_hostOutdated[field::V] = false;
+	}
+
+	return _V;
+}
+
+//============================================================================
+REAL** NavierStokesHybrid::getP_CPU ( )
+{
+	if( _hostOutdated[field::P] )
+	{
+		readRows( _device.P_g, _P, _device.first, _device.last );
+		_device.queue.finish();
+
+		_hostOutdated[field::P] = false;
+	}
+
+	return _P;
+}
+
+
+// -------------------------------------------------
+//	simulation
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesHybrid::computeDeltaT ( )
+{
+	runPhase( PHASE_UV_MAXIMUM );
+
+	// combine the maxima of the device and the host blocks
+	REAL u_max = fabs( _deviceResults[0] );
+	REAL v_max = fabs( _deviceResults[1] );
+
+	for( unsigned int i = 0; i < _blocks.size(); ++i )
+	{
+		u_max = std::max( u_max, _blocks[i].results[0] );
+		v_max = std::max( v_max, _blocks[i].results[1] );
+	}
+
+	// compute the three options for the min-function
+	REAL opt_a, opt_x, opt_y, min;
+
+	opt_a =   ( _parameters->re / 2.0 )
+			* 1.0 / (
+				  1.0 / (_parameters->dx * _parameters->dx)
+				+ 1.0 / (_parameters->dy * _parameters->dy)
+			);
+	opt_x = _parameters->dx / u_max;
+	opt_y = _parameters->dy / v_max;
+
+	// get smallest value
+	min = opt_a < opt_x ? opt_a : opt_x;
+	min = min   < opt_y ? min   : opt_y;
+
+	// compute delta t
+	_parameters->dt = _parameters->tau * min;
+}
+
+//============================================================================
+REAL NavierStokesHybrid::computeResidual ( )
+{
+	runPhase( PHASE_RESIDUAL );
+
+	REAL sum = _deviceResults[0];
+
+	for( unsigned int i = 0; i < _blocks.size(); ++i )
+	{
+		sum += _blocks[i].results[0];
+	}
+
+	// same norm as the GPU solver
+	return sqrt( sum / (_parameters->nx * _parameters->ny) );
+}
+
+//============================================================================
+void NavierStokesHybrid::runPhase
+	(
+		int phase,
+		int red
+	)
+{
+	_phaseTimer.start();
+
+	try
+	{
+		enqueueDevicePhase( phase, red );
+
+		// start the device before the host threads take the cores
+		_device.queue.flush();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while enqueueing device strip: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// obstacle cells write the row below, so the boundary
+	// conditions are set by a single thread
+	if( phase == PHASE_BOUNDARY )
+	{
+		_pool.start( new HybridTask( this, &_boundaryBlock, phase, red ) );
+	}
+	else
+	{
+		for( unsigned int i = 0; i < _blocks.size(); ++i )
+		{
+			_pool.start( new HybridTask( this, &_blocks[i], phase, red ) );
+		}
+	}
+
+	try
+	{
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while computing device strip: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	_deviceTime += _phaseTimer.nsecsElapsed();
+
+	_pool.waitForDone();
+
+	// the host strip is done when its last block is done
+	qint64 hostTime = _boundaryBlock.finished;
+
+	if( phase != PHASE_BOUNDARY )
+	{
+		hostTime = 0;
+
+		for( unsigned int i = 0; i < _blocks.size(); ++i )
+		{
+			hostTime = std::max( hostTime, _blocks[i].finished );
+		}
+	}
+
+	_hostTime += hostTime;
+}
+
+//============================================================================
+void NavierStokesHybrid::enqueueDevicePhase
+	(
+		int phase,
+		int red
+	)
+{
+	int nx2 = _parameters->nx + 2;
+
+	cl::NDRange offset( 0, _device.first );
+	cl::NDRange range( nx2, _device.last - _device.first );
+
+	switch( phase )
+	{
+		case PHASE_UV_MAXIMUM:
+
+			// the offset skips the rows of the host strip
+			_device.queue.enqueueNDRangeKernel(
+					_device.kernels[kernel::getUVMaximum],
+					cl::NDRange( nx2 * _device.first ),
+					cl::NDRange( _clWorkgroupSize * _device.reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			_device.queue.enqueueNDRangeKernel(
+					_device.kernels[kernel::getUVMaximumFinal],
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			_device.queue.enqueueReadBuffer( _device.uvMaximum_g, CL_FALSE, 0, sizeof(CL_REAL) * 2, _deviceResults );
+			break;
+
+		case PHASE_BOUNDARY:
+
+			// the southern boundary is written on the device as well, but never read there
+			runDeviceKernel( kernel::setHorizontalBoundaryConditions, cl::NullRange, cl::NDRange( nx2 ) );
+			runDeviceKernel( kernel::setVerticalBoundaryConditions, cl::NDRange( _device.first ), cl::NDRange( _device.last - _device.first ) );
+			runDeviceKernel( kernel::setArbitraryBoundaryConditions, offset, range );
+
+			// moving lid: first row, channel: first column
+			if ( _parameters->problem == "moving_lid" || _parameters->problem == "channel" )
+			{
+				int width = ( _parameters->problem == "moving_lid" ) ? nx2 : 1;
+
+				runDeviceKernel( kernel::problemSpecific, offset, cl::NDRange( width, _device.last - _device.first ) );
+			}
+			break;
+
+		case PHASE_FG:
+			_device.kernels[kernel::computeF].setArg( 5, sizeof(CL_REAL), &_parameters->dt );
+			_device.kernels[kernel::computeG].setArg( 5, sizeof(CL_REAL), &_parameters->dt );
+
+			runDeviceKernel( kernel::computeF, offset, range );
+			runDeviceKernel( kernel::computeG, offset, range );
+			break;
+
+		case PHASE_RHS:
+			_device.kernels[kernel::rightHandSide].setArg( 3, sizeof(CL_REAL), &_parameters->dt );
+
+			runDeviceKernel( kernel::rightHandSide, offset, range );
+			break;
+
+		case PHASE_SOR:
+			_device.kernels[kernel::gaussSeidelRedBlack].setArg( 5, sizeof(int), &red );
+
+			runDeviceKernel( kernel::gaussSeidelRedBlack, offset, range );
+			break;
+
+		case PHASE_RESIDUAL:
+			_device.queue.enqueueNDRangeKernel(
+					_device.kernels[kernel::pressureResidualReduction],
+					cl::NDRange( nx2 * _device.first ),
+					cl::NDRange( _clWorkgroupSize * _device.reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			_device.queue.enqueueNDRangeKernel(
+					_device.kernels[kernel::pressureResidualSum],
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			_device.queue.enqueueReadBuffer( _device.residual_g, CL_FALSE, 0, sizeof(CL_REAL), _deviceResults );
+			break;
+
+		case PHASE_UV:
+			_device.kernels[kernel::updateUV].setArg( 6, sizeof(CL_REAL), &_parameters->dt );
+
+			runDeviceKernel( kernel::updateUV, offset, range );
+			break;
+	}
+}
+
+//============================================================================
+void NavierStokesHybrid::runHostPhase
+	(
+		HostBlock&	block,
+		int			phase,
+		int			red
+	)
+{
+	int nx2 = _parameters->nx + 2;
+
+	switch( phase )
+	{
+		case PHASE_UV_MAXIMUM:
+
+			// all cells, as getUVMaximumKernel
+			block.results[0] = 0.0;
+			block.results[1] = 0.0;
+
+			for( int y = block.first; y < block.last; ++y )
+			{
+				for( int x = 0; x < nx2; ++x )
+				{
+					block.results[0] = std::max( block.results[0], (REAL)fabs( _U[y][x] ) );
+					block.results[1] = std::max( block.results[1], (REAL)fabs( _V[y][x] ) );
+				}
+			}
+			break;
+
+		case PHASE_BOUNDARY:
+			setBoundaryConditions( block.first, block.last );
+			setSpecificBoundaryConditions( block.first, block.last );
+			break;
+
+		case PHASE_FG:
+			computeFG( block.first, block.last );
+			break;
+
+		case PHASE_RHS:
+			computeRightHandSide( block.first, block.last );
+			break;
+
+		case PHASE_SOR:
+			SORPoissonRedBlack( red, block.first, block.last );
+			break;
+
+		case PHASE_RESIDUAL:
+			block.results[0] = pressureResidualSum( block.first, block.last );
+			break;
+
+		case PHASE_UV:
+			adaptUV( block.first, block.last );
+			break;
+	}
+}
+
+
+// -------------------------------------------------
+//	auxiliary functions
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesHybrid::runDeviceKernel
+	(
+		int					kernelID,
+		const cl::NDRange&	offset,
+		const cl::NDRange&	global
+	)
+{
+	_device.queue.enqueueNDRangeKernel( _device.kernels[kernelID], offset, global, cl::NullRange );
+}
+
+//============================================================================
+void NavierStokesHybrid::exchangeHalos ( int fields )
+{
+	int border = _device.first;
+
+	try
+	{
+		if( fields & halo::U )
+		{
+			readRows ( _device.U_g, _U, border, border + 1 );
+			writeRows( _device.U_g, _U, border - 1, border );
+		}
+
+		if( fields & halo::V )
+		{
+			readRows ( _device.V_g, _V, border, border + 1 );
+			writeRows( _device.V_g, _V, border - 1, border );
+		}
+
+		if( fields & halo::P )
+		{
+			readRows ( _device.P_g, _P, border, border + 1 );
+			writeRows( _device.P_g, _P, border - 1, border );
+		}
+
+		// only read by the right hand side of the row above
+		if( fields & halo::G )
+		{
+			writeRows( _device.G_g, _G, border - 1, border );
+		}
+
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while exchanging halo rows: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+void NavierStokesHybrid::readRows
+	(
+		cl::Buffer&	buffer,
+		REAL**		host,
+		int			firstRow,
+		int			lastRow
+	)
+{
+	::size_t rowSize = sizeof(CL_REAL) * ( _parameters->nx + 2 );
+
+	_device.queue.enqueueReadBuffer( buffer, CL_FALSE, rowSize * firstRow, rowSize * ( lastRow - firstRow ), host[firstRow] );
+}
+
+//============================================================================
+void NavierStokesHybrid::writeRows
+	(
+		cl::Buffer&	buffer,
+		REAL**		host,
+		int			firstRow,
+		int			lastRow
+	)
+{
+	::size_t rowSize = sizeof(CL_REAL) * ( _parameters->nx + 2 );
+
+	_device.queue.enqueueWriteBuffer( buffer, CL_FALSE, rowSize * firstRow, rowSize * ( lastRow - firstRow ), host[firstRow] );
+}
+
+//============================================================================
+void NavierStokesHybrid::balance ( )
+{
+	if( ++_balanceStep < HYBRID_BALANCE_STEPS )
+	{
+		return;
+	}
+
+	int ny2 = _parameters->ny + 2;
+
+	// rows per time on both sides
+	double hostSpeed   = (double)_device.first / std::max( _hostTime, (qint64)1 );
+	double deviceSpeed = (double)( ny2 - _device.first ) / std::max( _deviceTime, (qint64)1 );
+
+	_balanceStep = 0;
+	_hostTime    = 0;
+	_deviceTime  = 0;
+
+	// rows of the host strip for equal times
+	int target = (int)( ny2 * hostSpeed / ( hostSpeed + deviceSpeed ) + 0.5 );
+
+	// half way, as the measured times include the synchronization
+	// and are not proportional to the number of rows
+	int border = _device.first + ( target - _device.first ) / 2;
+
+	border = std::max( 2, std::min( border, ny2 - 2 ) );
+
+	if( border != _device.first )
+	{
+		#if VERBOSE
+			std::cout << "Hybrid solver: host strip " << _device.first << " -> " << border << " rows" << std::endl;
+		#endif
+
+		moveBorder( border );
+	}
+}
+
+//============================================================================
+void NavierStokesHybrid::moveBorder ( int border )
+{
+	try
+	{
+		if( border > _device.first )
+		{
+			// rows taken by the host, and the new halo row
+			readRows( _device.U_g, _U, _device.first, border + 1 );
+			readRows( _device.V_g, _V, _device.first, border + 1 );
+			readRows( _device.P_g, _P, _device.first, border + 1 );
+		}
+		else
+		{
+			// rows taken by the device, and the new halo row
+			writeRows( _device.U_g, _U, border - 1, _device.first );
+			writeRows( _device.V_g, _V, border - 1, _device.first );
+			writeRows( _device.P_g, _P, border - 1, _device.first );
+		}
+
+		_device.queue.finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while moving the strip border: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	_device.first = border;
+
+	createHostBlocks();
+}
+
+//============================================================================
+void NavierStokesHybrid::createHostBlocks ( )
+{
+	int rows  = _device.first;
+	int count = std::min( _pool.maxThreadCount(), rows );
+
+	_blocks = std::vector<HostBlock>( count );
+
+	for( int i = 0; i < count; ++i )
+	{
+		_blocks[i].first    = i * rows / count;
+		_blocks[i].last     = ( i + 1 ) * rows / count;
+		_blocks[i].finished = 0;
+	}
+
+	// including the first row of the device strip, as its
+	// obstacle cells write the last row of the host strip
+	_boundaryBlock.first    = 0;
+	_boundaryBlock.last     = rows + 1;
+	_boundaryBlock.finished = 0;
+}
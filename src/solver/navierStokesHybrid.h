@@ -0,0 +1,316 @@
+#ifndef NAVIERSTOKESHYBRID_H
+#define NAVIERSTOKESHYBRID_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "navierStokesCPU.h"
+#include "navierStokesMultiGPU.h"
+#include <QThreadPool>
+#include <QElapsedTimer>
+
+// number of time steps between two adjustments of the strip sizes
+#define HYBRID_BALANCE_STEPS 10
+
+//********************************************************************
+//**    additional types
+//********************************************************************
+
+//====================================================================
+/*! \struct HostBlock
+	\brief Rows of the host strip computed by one thread
+*/
+//====================================================================
+
+struct HostBlock
+{
+	int			first;			//! first row of the block (including boundaries)
+	int			last;			//! row after the last row of the block
+	REAL		results[2];		//! partial results of the reductions
+	qint64		finished;		//! time the thread finished the block, since the start of the phase
+};
+
+//====================================================================
+/*! \class NavierStokesHybrid
+	\brief Class for solving the Navier Stokes equations on the CPU
+	and an OpenCL device at the same time
+
+	The southern rows of the domain are computed by threads running
+	the stencils of NavierStokesCPU, the other rows by the kernels of
+	the GPU solver, launched with a global offset as in
+	NavierStokesMultiGPU. Both work on whole fields, so the rows at the
+	border of the strips are exchanged after each phase. The pressure
+	iteration uses the red/black order on both sides.
+
+	The time both sides need for their rows is measured, and every
+	HYBRID_BALANCE_STEPS time steps the border is moved towards equal
+	times.
+*/
+//====================================================================
+
+class NavierStokesHybrid : public NavierStokesCPU
+{
+	friend class HybridTask;
+
+	protected:
+		// -------------------------------------------------
+		//	additional types
+		// -------------------------------------------------
+
+		//! steps of a time step executed on both sides
+		enum Phase
+		{
+			PHASE_UV_MAXIMUM,
+			PHASE_BOUNDARY,
+			PHASE_FG,
+			PHASE_RHS,
+			PHASE_SOR,
+			PHASE_RESIDUAL,
+			PHASE_UV
+		};
+
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		// the device computes the rows [first, last) of its strip, the host the rows below
+		DeviceStrip				_device;			//! queue, kernels and buffers of the device
+
+		std::vector<HostBlock>	_blocks;			//! rows of the host strip, one block per thread
+		HostBlock				_boundaryBlock;		//! whole host strip, the boundary conditions are set by one thread
+		QThreadPool				_pool;				//! threads computing the host strip
+
+		QElapsedTimer			_phaseTimer;		//! started at the beginning of each phase
+		qint64					_hostTime,			//! time of the host strip since the last adjustment (ns)
+								_deviceTime;		//! time of the device strip since the last adjustment (ns)
+		int						_balanceStep;		//! time steps since the last adjustment
+
+		CL_REAL					_deviceResults[2];	//! reduction results of the device strip
+		bool					_hostOutdated[3];	//! device rows of U, V and P not copied to the host yet
+
+		// OpenCL data
+		CLManager*				_clManager;			//! pointer to the CL Manager
+		cl::Context*			_clContext;			//! pointer to CL context
+		int						_clWorkgroupSize;	//! work group size of the reductions
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+			//! \param pointer to cl manager object
+
+		NavierStokesHybrid
+			(
+				Parameters* parameters,
+				CLManager*  clManager
+			);
+
+		~NavierStokesHybrid ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	initialization
+		// -------------------------------------------------
+			//! @name initialisation
+			//! @{
+
+			//! \brief allocates and initialises simulation memory on host and device
+
+		void	initialize ( );
+
+			//! \brief takes the obstacle map and creates geometry information for each cell
+			//! See NavierStokesCPU, the flags are copied to the device.
+			//! \param obstacle map (domain size)
+			//! \returns true if the obstacle map is valid, false otherwise
+
+		bool	setObstacleMap ( bool** map );
+
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! \returns true if the state was loaded, false otherwise
+
+		bool	loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	execution
+		// -------------------------------------------------
+			//! @name execution
+			//! @{
+
+			//! \brief simulates the next timestep
+			//! \returns number of iterations used to solve the pressure equation
+
+		int		doSimulationStep ( );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	interaction
+		// -------------------------------------------------
+			//! @name interaction
+			//! @{
+
+			//! \brief inserts or removes a line of obstacles
+			//! The line is drawn on the host, the fields are copied to the device afterwards.
+			//! \param first x offset of the obstacle to draw
+			//! \param first y offset of the obstacle to draw
+			//! \param last x offset of the obstacle to draw
+			//! \param last y offset of the obstacle to draw
+			//! \param drawing mode, true if a wall ist to be teared down instead of created
+
+		void drawObstacles (
+				int x0,
+				int y0,
+				int x1,
+				int y1,
+				bool delete_flag
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	data access
+		// -------------------------------------------------
+			//! @name data access
+			//! @{
+
+			//! \brief gives access to the horizontal velocity component
+			//! The rows of the device are copied to the host if outdated.
+			//! \returns pointer to horizontal velocity array
+
+		REAL** getU_CPU ( );
+
+			//! \brief gives access to the vertical velocity component
+			//! \returns pointer to vertical velocity array
+
+		REAL** getV_CPU ( );
+
+			//! \brief gives access to the pressure
+			//! \returns pointer to pressure array
+
+		REAL** getP_CPU ( );
+
+			//! @}
+
+
+	protected:
+		// -------------------------------------------------
+		//	simulation
+		// -------------------------------------------------
+			//! @name simulation
+			//! @{
+
+			//! \brief calculates the stepsize for next time step
+			//! The maxima of both strips are combined on the host.
+
+		void	computeDeltaT ( );
+
+			//! \brief computes the residual of the pressure equation
+			//! \returns residual
+
+		REAL	computeResidual ( );
+
+			//! \brief executes a phase on the host and the device strip and
+			//! waits for both, measuring the time of each side
+			//! \param phase
+			//! \param red/black flag of PHASE_SOR
+
+		void	runPhase ( int phase, int red = 0 );
+
+			//! \brief enqueues the kernels of a phase for the device strip
+
+		void	enqueueDevicePhase ( int phase, int red );
+
+			//! \brief computes a phase for a block of the host strip, called by the threads
+
+		void	runHostPhase ( HostBlock& block, int phase, int red );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief enqueues a kernel of the device strip
+			//! \param kernel id
+			//! \param global offset
+			//! \param global range
+
+		void	runDeviceKernel
+			(
+				int					kernelID,
+				const cl::NDRange&	offset,
+				const cl::NDRange&	global
+			);
+
+			//! \brief copies the first row of the device strip to the host and
+			//! the last row of the host strip to the device
+			//! \param fields to exchange, combination of halo::HaloFields
+
+		void	exchangeHalos ( int fields );
+
+			//! \brief enqueues a copy of rows of a field from the device
+			//! \param device buffer
+			//! \param host matrix
+			//! \param first row
+			//! \param row after the last row
+
+		void	readRows
+			(
+				cl::Buffer&	buffer,
+				REAL**		host,
+				int			firstRow,
+				int			lastRow
+			);
+
+			//! \brief enqueues a copy of rows of a field to the device
+
+		void	writeRows
+			(
+				cl::Buffer&	buffer,
+				REAL**		host,
+				int			firstRow,
+				int			lastRow
+			);
+
+			//! \brief moves the border between host and device strip towards
+			//! equal times, every HYBRID_BALANCE_STEPS time steps
+
+		void	balance ( );
+
+			//! \brief moves the border between host and device strip
+			//! \param new first row of the device strip
+
+		void	moveBorder ( int border );
+
+			//! \brief divides the host strip into blocks for the threads
+
+		void	createHostBlocks ( );
+
+			//! @}
+};
+
+#endif // NAVIERSTOKESHYBRID_H
@@ -0,0 +1,1186 @@
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "navierStokesMultiGPU.h"
+
+#include <iostream>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+//********************************************************************
+//**    implementation
+//********************************************************************
+
+// -------------------------------------------------
+//	constructor / destructor
+// -------------------------------------------------
+
+//============================================================================
+NavierStokesMultiGPU::NavierStokesMultiGPU
+	(
+		Parameters* parameters,
+		CLManager* clManager
+	)
+	: NavierStokesSolver ( parameters )
+{
+	_clManager = clManager;
+	_clContext = clManager->getContext();
+
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	// host copies of the fields
+	_field = new FlowField( _parameters->nx, _parameters->ny, this );
+
+	// load and compile kernels for all devices
+	_clManager->loadKernels();
+
+	_clWorkgroupSize = _clManager->getWorkgroupSize();
+
+	std::vector<cl::Device>* devices = _clManager->getDevices();
+
+	// each strip needs at least two rows, so the cells next to the
+	// southern and northern boundary set the boundary of their own strip
+	int count = std::min( (int)devices->size(), ny2 / 2 );
+
+	if( count < (int)devices->size() )
+	{
+		std::cout << "The domain is split into " << count << " strips only" << std::endl;
+	}
+
+	_strips = std::vector<DeviceStrip>( count );
+
+	try
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			strip.device = (*devices)[i];
+			strip.queue  = cl::CommandQueue( *_clContext, strip.device );
+
+			// kernel arguments are set per strip
+			_clManager->createKernels( strip.kernels );
+
+			// rows of the strip, including the boundaries of the domain
+			strip.first = i * ny2 / count;
+			strip.last  = ( i + 1 ) * ny2 / count;
+
+			// first reduction stage: a few workgroups per compute unit, see NavierStokesGPU
+			int cells = nx2 * ( strip.last - strip.first );
+			int units = strip.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+			strip.reductionGroups = std::min( 4 * units, _clWorkgroupSize );
+			strip.reductionGroups = std::min( strip.reductionGroups, ( cells + _clWorkgroupSize - 1 ) / _clWorkgroupSize );
+			strip.reductionGroups = std::max( strip.reductionGroups, 1 );
+		}
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while creating the strips: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// a southern and a northern row per strip and halo field
+	_haloHost = std::vector<CL_REAL>( count * 4 * 2 * nx2 );
+}
+
+//============================================================================
+NavierStokesMultiGPU::~NavierStokesMultiGPU ( )
+{
+	finish();
+
+	SAFE_DELETE( _field );
+}
+
+// -------------------------------------------------
+//	initialization
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesMultiGPU::initialize ( )
+{
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+	int size = nx2 * ny2;
+
+	REAL initialBoundaryValue = 0.0;
+
+	#if VERBOSE
+		std::cout << "allocating and initializing device buffers..." << std::endl;
+	#endif
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			//-----------------------
+			// allocate memory for matrices U, V, P, RHS, F, G
+			//-----------------------
+
+			// every device holds the whole fields, only the rows of its strip are current
+			strip.U_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+			strip.V_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+			strip.P_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+			strip.RHS_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+			strip.F_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+			strip.G_g   = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * size );
+
+			strip.residualPartials_g = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * strip.reductionGroups );
+			strip.uvPartials_g       = cl::Buffer ( *_clContext, CL_MEM_READ_WRITE, sizeof(CL_REAL) * strip.reductionGroups * 2 );
+
+			strip.residual_g  = cl::Buffer ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) );
+			strip.uvMaximum_g = cl::Buffer ( *_clContext, CL_MEM_WRITE_ONLY, sizeof(CL_REAL) * 2 );
+
+
+			//-----------------------
+			// initialise U, V and P with given initial values (0.0 at borders)
+			//-----------------------
+
+			// the whole fields are initialised, so the halo rows are current
+			cl::Kernel* kernel = &strip.kernels[kernel::setBoundaryAndInterior];
+
+			kernel->setArg( 0, strip.U_g );
+			kernel->setArg( 1, sizeof(CL_REAL), &initialBoundaryValue ); // boundary value
+			kernel->setArg( 2, sizeof(CL_REAL), &_parameters->ui ); // interior value
+			kernel->setArg( 3, sizeof(int),     &nx2 );
+			kernel->setArg( 4, sizeof(int),     &ny2 );
+			kernel->setArg( 5, sizeof(int),     &nx2 );
+
+			runStripKernel( strip, kernel::setBoundaryAndInterior, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+
+			kernel->setArg( 0, strip.V_g );
+			kernel->setArg( 2, sizeof(CL_REAL), &_parameters->vi ); // interior value
+
+			runStripKernel( strip, kernel::setBoundaryAndInterior, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+
+			kernel->setArg( 0, strip.P_g );
+			kernel->setArg( 2, sizeof(CL_REAL), &_parameters->pi ); // interior value
+
+			runStripKernel( strip, kernel::setBoundaryAndInterior, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+
+
+			//-----------------------
+			// initialise RHS, F and G with 0.0
+			//-----------------------
+
+			kernel = &strip.kernels[kernel::setKernel];
+
+			kernel->setArg( 0, strip.RHS_g );
+			kernel->setArg( 1, sizeof(CL_REAL), &initialBoundaryValue );
+			kernel->setArg( 2, sizeof(int),  &nx2 );
+			kernel->setArg( 3, sizeof(int),  &ny2 );
+			kernel->setArg( 4, sizeof(int),  &nx2 );
+
+			runStripKernel( strip, kernel::setKernel, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+
+			kernel->setArg( 0, strip.F_g );
+			runStripKernel( strip, kernel::setKernel, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+
+			kernel->setArg( 0, strip.G_g );
+			runStripKernel( strip, kernel::setKernel, cl::NullRange, cl::NDRange( nx2, ny2 ), cl::NullRange );
+		}
+
+		// the host copies are outdated now, the flags are uploaded to all devices
+		_field->deviceModified( field::U );
+		_field->deviceModified( field::V );
+		_field->deviceModified( field::P );
+		_field->synchronizeDevice();
+
+		// set kernel arguments for frequently called kernels
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			setKernelArguments( _strips[i], _parameters, _clWorkgroupSize );
+		}
+
+		// wait for completion
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while initializing the strips: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+bool NavierStokesMultiGPU::setObstacleMap
+	(
+		bool **map
+	)
+{
+	int nx1 = _parameters->nx + 1;
+	int ny1 = _parameters->ny + 1;
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	// same flags as NavierStokesGPU::setObstacleMap, computed on the host
+	unsigned char** FLAG = _field->getFLAG();
+
+
+	//-----------------------
+	// create geometry map
+	//-----------------------
+
+	// compute interior cells
+	for ( int y = 1; y < ny1; ++y )
+	{
+		for ( int x = 1; x < nx1; ++x )
+		{
+			if( map[y][x] )
+			{
+				FLAG[y][x] = C_F;
+			}
+			else
+			{
+				// check for invalid boundary cell (between two fluid cells)
+				if( ( map[y-1][x] && map[y+1][x] ) || ( map[y][x-1] && map[y][x+1] ) )
+					return false;
+
+				FLAG[y][x] = C_B
+						+ B_N * map[y+1][x]
+						+ B_S * map[y-1][x]
+						+ B_W * map[y][x-1]
+						+ B_E * map[y][x+1];
+			}
+		}
+	}
+
+	// compute boundary cells
+	for( int x = 1; x < nx1; ++x )
+	{
+		FLAG[0][x]   = C_B + B_N * map[1][x] + B_S + B_W + B_E;
+		FLAG[ny1][x] = C_B + B_N + B_S * map[_parameters->ny][x] + B_W + B_E;
+	}
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		FLAG[y][0]   = C_B + B_N + B_S + B_W + B_E * map[y][1];
+		FLAG[y][nx1] = C_B + B_N + B_S + B_W * map[y][_parameters->nx] + B_E;
+	}
+
+	FLAG[0][0] = FLAG[0][nx1] = FLAG[ny1][0] = FLAG[ny1][nx1] = 0x0F;
+
+
+	//-----------------------
+	// copy to device memory
+	//-----------------------
+
+	// every device gets the whole map with the next device synchronization
+	for( unsigned int i = 0; i < _strips.size(); ++i )
+	{
+		_strips[i].FLAG_g = cl::Buffer (
+				*_clContext,
+				CL_MEM_READ_WRITE,
+				nx2 * ny2 * sizeof( unsigned char )
+			);
+	}
+
+	_field->hostModified( field::FLAG );
+
+	return true;
+}
+
+//============================================================================
+bool NavierStokesMultiGPU::loadState
+	(
+		const REAL* U,
+		const REAL* V,
+		const REAL* P,
+		const unsigned char* FLAG
+	)
+{
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	// the source memory might be unmapped after returning, so it is copied to the host copies
+	memcpy( *_field->getU(),    U,    size * sizeof( REAL ) );
+	memcpy( *_field->getV(),    V,    size * sizeof( REAL ) );
+	memcpy( *_field->getP(),    P,    size * sizeof( REAL ) );
+	memcpy( *_field->getFLAG(), FLAG, size * sizeof( unsigned char ) );
+
+	_field->hostModified( field::U );
+	_field->hostModified( field::V );
+	_field->hostModified( field::P );
+	_field->hostModified( field::FLAG );
+
+	try
+	{
+		_field->synchronizeDevice();
+
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while loading simulation state: " << error.what() << "(" << error.err() << ")" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// -------------------------------------------------
+//	execution
+// -------------------------------------------------
+
+//============================================================================
+int NavierStokesMultiGPU::doSimulationStep()
+{
+	// upload fields changed on host side, e.g. by obstacle drawing
+	_field->synchronizeDevice();
+
+	computeDeltaT();
+
+	setBoundaryConditions();
+
+	computeFGAndRightHandSide();
+
+
+	//-----------------------
+	// poisson overrelaxation loop
+	//-----------------------
+
+	// the residual needs a host synchronization of all devices,
+	// so it is only checked every residualInterval sweeps if given
+	int interval = std::max( _parameters->residualInterval, 1 );
+
+	int  sor_iterations = 0;
+	REAL residual       = INFINITY;
+
+	while( sor_iterations < _parameters->it_max && fabs( residual ) > _parameters->epsilon )
+	{
+		pressureSweep();
+		++sor_iterations;
+
+		if( sor_iterations % interval == 0 || sor_iterations == _parameters->it_max )
+		{
+			residual = computeResidual();
+		}
+	}
+
+
+	//-----------------------
+	// compute U(n+1) and V(n+1)
+	//-----------------------
+
+	adaptUV();
+
+	// host copies are updated when they are accessed
+	_field->deviceModified( field::U );
+	_field->deviceModified( field::V );
+	_field->deviceModified( field::P );
+
+	return sor_iterations;
+}
+
+
+// -------------------------------------------------
+//	interaction
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesMultiGPU::drawObstacles
+	(
+		int x0,
+		int y0,
+		int x1,
+		int y1,
+		bool delete_flag
+	)
+{
+	if( delete_flag )
+	{
+		std::cout << "obstacle removing not implemented yet!" << std::endl;
+		return;
+	}
+
+	//-----------------------
+	// draw line into the fields on all devices
+	//-----------------------
+
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		// fields changed on host side must be on the devices first
+		_field->synchronizeDevice();
+
+		// the flags are the same on all devices, so all of them draw the same line
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			cl::Kernel* kernel = &strip.kernels[kernel::drawObstacleLine];
+
+			kernel->setArg( 0, strip.U_g );
+			kernel->setArg( 1, strip.V_g );
+			kernel->setArg( 2, strip.P_g );
+			kernel->setArg( 3, strip.FLAG_g );
+			kernel->setArg( 4, sizeof(int), &x0 );
+			kernel->setArg( 5, sizeof(int), &y0 );
+			kernel->setArg( 6, sizeof(int), &x1 );
+			kernel->setArg( 7, sizeof(int), &y1 );
+			kernel->setArg( 8, sizeof(int), &nx2 );
+
+			runStripKernel( strip, kernel::drawObstacleLine, cl::NullRange, cl::NDRange( 1 ), cl::NullRange );
+		}
+
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while drawing obstacles: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// host copies are updated when they are accessed
+	_field->deviceModified( field::U );
+	_field->deviceModified( field::V );
+	_field->deviceModified( field::P );
+	_field->deviceModified( field::FLAG );
+
+
+	//-----------------------
+	// update obstacle map
+	//-----------------------
+
+	// same line as on the devices using bresenham's algorithm
+
+	int dx    = abs( x1 - x0 );
+	int dy    = abs( y1 - y0 );
+	int sx    = x0 < x1 ? 1 : -1;
+	int sy    = y0 < y1 ? 1 : -1;
+	int error = dx - dy;
+	int e2;
+
+	while( true )
+	{
+		_parameters->obstacleMap[y0][x0]     = false;
+		_parameters->obstacleMap[y0][x0+1]   = false;
+		_parameters->obstacleMap[y0+1][x0]   = false;
+		_parameters->obstacleMap[y0+1][x0+1] = false;
+
+		if( x0 == x1 && y0 == y1 )
+		{
+			break;
+		}
+
+		e2 = error * 2;
+
+		if( e2 > -dy )
+		{
+			error = error - dy;
+			x0 = x0 + sx;
+		}
+
+		if( e2 < dx )
+		{
+			error = error + dx;
+			y0 = y0 + sy;
+		}
+	}
+}
+
+
+// -------------------------------------------------
+//	data access
+// -------------------------------------------------
+
+//============================================================================
+REAL **NavierStokesMultiGPU::getU_CPU ( )
+{
+	return _field->getU();
+}
+
+//============================================================================
+REAL **NavierStokesMultiGPU::getV_CPU ( )
+{
+	return _field->getV();
+}
+
+//============================================================================
+REAL **NavierStokesMultiGPU::getP_CPU ( )
+{
+	return _field->getP();
+}
+
+//============================================================================
+unsigned char** NavierStokesMultiGPU::getFLAG_CPU ( )
+{
+	return _field->getFLAG();
+}
+
+//============================================================================
+void NavierStokesMultiGPU::downloadField
+	(
+		int		fieldID,
+		void*	host
+	)
+{
+	int nx2 = _parameters->nx + 2;
+
+	::size_t cellSize = fieldID == field::FLAG ? sizeof(unsigned char) : sizeof(CL_REAL);
+
+	try
+	{
+		// each device has the current values of its own rows only
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			cl::Buffer* buffer = 0;
+
+			switch( fieldID )
+			{
+				case field::U:    buffer = &strip.U_g;    break;
+				case field::V:    buffer = &strip.V_g;    break;
+				case field::P:    buffer = &strip.P_g;    break;
+				case field::FLAG: buffer = &strip.FLAG_g; break;
+			}
+
+			::size_t offset = cellSize * nx2 * strip.first;
+
+			strip.queue.enqueueReadBuffer(
+					*buffer,
+					CL_FALSE,
+					offset,
+					cellSize * nx2 * ( strip.last - strip.first ),
+					(char*)host + offset
+				);
+		}
+
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while reading field from devices: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+void NavierStokesMultiGPU::uploadField
+	(
+		int			fieldID,
+		const void*	host
+	)
+{
+	int size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 );
+
+	::size_t cellSize = fieldID == field::FLAG ? sizeof(unsigned char) : sizeof(CL_REAL);
+
+	try
+	{
+		// the whole field, so the halo rows are current as well
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			cl::Buffer* buffer = 0;
+
+			switch( fieldID )
+			{
+				case field::U:    buffer = &strip.U_g;    break;
+				case field::V:    buffer = &strip.V_g;    break;
+				case field::P:    buffer = &strip.P_g;    break;
+				case field::FLAG: buffer = &strip.FLAG_g; break;
+			}
+
+			strip.queue.enqueueWriteBuffer( *buffer, CL_FALSE, 0, cellSize * size, host );
+		}
+
+		// the host copy may be changed right after
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while writing field to devices: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+
+// -------------------------------------------------
+//	simulation
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesMultiGPU::computeDeltaT ( )
+{
+	// results of the UV reduction of each strip: { max_u, max_v }
+	std::vector<CL_REAL> results( 2 * _strips.size(), 0.0 );
+
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			// the offset skips the rows before the strip, the kernel
+			// stops at the last row of the strip (passed as ny)
+			runStripKernel(
+					strip,
+					kernel::getUVMaximum,
+					cl::NDRange( nx2 * strip.first ),
+					cl::NDRange( _clWorkgroupSize * strip.reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			runStripKernel(
+					strip,
+					kernel::getUVMaximumFinal,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			strip.queue.enqueueReadBuffer( strip.uvMaximum_g, CL_FALSE, 0, sizeof(CL_REAL) * 2, &results[2 * i] );
+		}
+
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while computing Δt: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// combine the maxima of the strips
+	REAL u_max = 0.0;
+	REAL v_max = 0.0;
+
+	for( unsigned int i = 0; i < _strips.size(); ++i )
+	{
+		u_max = std::max( u_max, (REAL)fabs( results[2 * i] ) );
+		v_max = std::max( v_max, (REAL)fabs( results[2 * i + 1] ) );
+	}
+
+	// compute the three options for the min-function
+	REAL opt_a, opt_x, opt_y, min;
+
+	opt_a =   ( _parameters->re / 2.0 )
+			* 1.0 / (
+				  1.0 / (_parameters->dx * _parameters->dx)
+				+ 1.0 / (_parameters->dy * _parameters->dy)
+			);
+	opt_x = _parameters->dx / u_max;
+	opt_y = _parameters->dy / v_max;
+
+	// get smallest value
+	min = opt_a < opt_x ? opt_a : opt_x;
+	min = min   < opt_y ? min   : opt_y;
+
+	// compute delta t
+	_parameters->dt = _parameters->tau * min;
+}
+
+//============================================================================
+void NavierStokesMultiGPU::setBoundaryConditions ( )
+{
+	int nx2 = _parameters->nx + 2;
+	int ny2 = _parameters->ny + 2;
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			// the boundary values of the halo rows are computed as well,
+			// they only depend on cells of the same row
+			int first = std::max( strip.first - 1, 0 );
+			int last  = std::min( strip.last + 1, ny2 );
+
+			// the horizontal kernel only writes the rows next to the southern
+			// and northern boundary, which are owned or halo rows of a strip
+			// only if it also owns the row it reads from
+			runStripKernel( strip, kernel::setHorizontalBoundaryConditions, cl::NullRange, cl::NDRange( nx2 ), cl::NullRange );
+			runStripKernel( strip, kernel::setVerticalBoundaryConditions, cl::NDRange( first ), cl::NDRange( last - first ), cl::NullRange );
+
+			// obstacle cells also write the row below, so the strip
+			// includes the cells of the northern halo row
+			runStripKernel(
+					strip,
+					kernel::setArbitraryBoundaryConditions,
+					cl::NDRange( 0, strip.first ),
+					cl::NDRange( nx2, std::min( strip.last + 1, ny2 ) - strip.first ),
+					cl::NullRange
+				);
+
+			// moving lid: first row, channel: first column
+			if ( _parameters->problem == "moving_lid" || _parameters->problem == "channel" )
+			{
+				int width = ( _parameters->problem == "moving_lid" ) ? nx2 : 1;
+
+				runStripKernel( strip, kernel::problemSpecific, cl::NDRange( 0, first ), cl::NDRange( width, last - first ), cl::NullRange );
+			}
+		}
+
+		// F and G read the neighbouring rows
+		exchangeHalos( halo::U | halo::V );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while applying boundary conditions: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+void NavierStokesMultiGPU::computeFGAndRightHandSide ( )
+{
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			// set missing kernel arguments
+			strip.kernels[kernel::computeF].setArg( 5, sizeof(CL_REAL), &_parameters->dt );
+			strip.kernels[kernel::computeG].setArg( 5, sizeof(CL_REAL), &_parameters->dt );
+			strip.kernels[kernel::rightHandSide].setArg( 3, sizeof(CL_REAL), &_parameters->dt );
+
+			cl::NDRange offset( 0, strip.first );
+			cl::NDRange range( nx2, strip.last - strip.first );
+
+			runStripKernel( strip, kernel::computeF, offset, range, cl::NullRange );
+			runStripKernel( strip, kernel::computeG, offset, range, cl::NullRange );
+		}
+
+		// the right hand side reads G of the row below
+		exchangeHalos( halo::G );
+
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			runStripKernel( strip, kernel::rightHandSide, cl::NDRange( 0, strip.first ), cl::NDRange( nx2, strip.last - strip.first ), cl::NullRange );
+		}
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while computing F, G and RHS: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+void NavierStokesMultiGPU::pressureSweep ( )
+{
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		// red cells read the black cells of the neighbouring strips,
+		// so the pressure is exchanged after each colour
+		for( int red = 0; red < 2; ++red )
+		{
+			for( unsigned int i = 0; i < _strips.size(); ++i )
+			{
+				DeviceStrip& strip = _strips[i];
+
+				strip.kernels[kernel::gaussSeidelRedBlack].setArg( 5, sizeof(int), &red );
+
+				runStripKernel( strip, kernel::gaussSeidelRedBlack, cl::NDRange( 0, strip.first ), cl::NDRange( nx2, strip.last - strip.first ), cl::NullRange );
+			}
+
+			exchangeHalos( halo::P );
+		}
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR during pressure iteration: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+//============================================================================
+REAL NavierStokesMultiGPU::computeResidual ( )
+{
+	std::vector<CL_REAL> results( _strips.size(), 0.0 );
+
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			// rows of the strip only, see setKernelArguments
+			runStripKernel(
+					strip,
+					kernel::pressureResidualReduction,
+					cl::NDRange( nx2 * strip.first ),
+					cl::NDRange( _clWorkgroupSize * strip.reductionGroups ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			runStripKernel(
+					strip,
+					kernel::pressureResidualSum,
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			strip.queue.enqueueReadBuffer( strip.residual_g, CL_FALSE, 0, sizeof(CL_REAL), &results[i] );
+		}
+
+		finish();
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR during pressure iteration: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+
+	// add the sums of the strips
+	REAL sum = 0.0;
+
+	for( unsigned int i = 0; i < _strips.size(); ++i )
+	{
+		sum += results[i];
+	}
+
+	return sqrt( sum / (_parameters->nx * _parameters->ny) );
+}
+
+//============================================================================
+void NavierStokesMultiGPU::adaptUV ( )
+{
+	int nx2 = _parameters->nx + 2;
+
+	try
+	{
+		for( unsigned int i = 0; i < _strips.size(); ++i )
+		{
+			DeviceStrip& strip = _strips[i];
+
+			strip.kernels[kernel::updateUV].setArg( 6, sizeof(CL_REAL), &_parameters->dt );
+
+			runStripKernel( strip, kernel::updateUV, cl::NDRange( 0, strip.first ), cl::NDRange( nx2, strip.last - strip.first ), cl::NullRange );
+		}
+
+		// the obstacle boundary conditions of the next step read the neighbouring rows
+		exchangeHalos( halo::U | halo::V );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while updating UV: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
+
+
+// -------------------------------------------------
+//	auxiliary functions
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesMultiGPU::runStripKernel
+	(
+		DeviceStrip&		strip,
+		int					kernelID,
+		const cl::NDRange&	offset,
+		const cl::NDRange&	global,
+		const cl::NDRange&	local
+	)
+{
+	strip.queue.enqueueNDRangeKernel( strip.kernels[kernelID], offset, global, local );
+}
+
+//============================================================================
+void NavierStokesMultiGPU::exchangeHalos ( int fields )
+{
+	int nx2   = _parameters->nx + 2;
+	int count = _strips.size();
+
+	::size_t rowSize = sizeof(CL_REAL) * nx2;
+
+	std::vector<cl::Event> transfers;
+
+	//-----------------------
+	// read the border rows of each strip
+	//-----------------------
+
+	for( int i = 0; i < count; ++i )
+	{
+		DeviceStrip& strip = _strips[i];
+
+		for( int f = 0; f < 4; ++f )
+		{
+			if( !( fields & ( 1 << f ) ) )
+				continue;
+
+			cl::Buffer& buffer = getHaloBuffer( strip, 1 << f );
+
+			// first and last row of the strip
+			CL_REAL* south = &_haloHost[ ( ( i * 4 + f ) * 2 ) * nx2 ];
+			CL_REAL* north = south + nx2;
+
+			if( i > 0 )
+			{
+				transfers.push_back( cl::Event() );
+				strip.queue.enqueueReadBuffer( buffer, CL_FALSE, rowSize * strip.first, rowSize, south, NULL, &transfers.back() );
+			}
+
+			if( i < count - 1 )
+			{
+				transfers.push_back( cl::Event() );
+				strip.queue.enqueueReadBuffer( buffer, CL_FALSE, rowSize * ( strip.last - 1 ), rowSize, north, NULL, &transfers.back() );
+			}
+		}
+	}
+
+	cl::Event::waitForEvents( transfers );
+	transfers.clear();
+
+	//-----------------------
+	// write them to the halo rows of the neighbours
+	//-----------------------
+
+	for( int i = 0; i < count; ++i )
+	{
+		DeviceStrip& strip = _strips[i];
+
+		for( int f = 0; f < 4; ++f )
+		{
+			if( !( fields & ( 1 << f ) ) )
+				continue;
+
+			cl::Buffer& buffer = getHaloBuffer( strip, 1 << f );
+
+			if( i > 0 )
+			{
+				// last row of the southern neighbour
+				CL_REAL* row = &_haloHost[ ( ( ( i - 1 ) * 4 + f ) * 2 + 1 ) * nx2 ];
+
+				transfers.push_back( cl::Event() );
+				strip.queue.enqueueWriteBuffer( buffer, CL_FALSE, rowSize * ( strip.first - 1 ), rowSize, row, NULL, &transfers.back() );
+			}
+
+			if( i < count - 1 )
+			{
+				// first row of the northern neighbour
+				CL_REAL* row = &_haloHost[ ( ( i + 1 ) * 4 + f ) * 2 * nx2 ];
+
+				transfers.push_back( cl::Event() );
+				strip.queue.enqueueWriteBuffer( buffer, CL_FALSE, rowSize * strip.last, rowSize, row, NULL, &transfers.back() );
+			}
+		}
+	}
+
+	// the host rows are overwritten by the next exchange
+	cl::Event::waitForEvents( transfers );
+}
+
+//============================================================================
+cl::Buffer& NavierStokesMultiGPU::getHaloBuffer
+	(
+		DeviceStrip&	strip,
+		int				haloField
+	)
+{
+	switch( haloField )
+	{
+		case halo::U: return strip.U_g;
+		case halo::V: return strip.V_g;
+		case halo::P: return strip.P_g;
+		default:      return strip.G_g;
+	}
+}
+
+//============================================================================
+void NavierStokesMultiGPU::finish ( )
+{
+	for( unsigned int i = 0; i < _strips.size(); ++i )
+	{
+		_strips[i].queue.finish();
+	}
+}
+
+//============================================================================
+void NavierStokesMultiGPU::setKernelArguments
+	(
+		DeviceStrip&	strip,
+		Parameters*		parameters,
+		int				workgroupSize
+	)
+{
+	// problem constants, the kernels are never specialized in this mode
+	KernelConstants constants( parameters );
+
+	// domain size including boundaries
+	int nx = constants.nx;
+	int ny = constants.ny;
+
+	// the reductions stop at the end of the strip: the UV maximum at row last,
+	// the residual skips row ny - 1, so it gets one row more unless the
+	// strip ends at the northern boundary
+	int uvRows       = strip.last;
+	int residualRows = strip.last == ny ? ny : strip.last + 1;
+
+	REAL alphaFG = constants.alpha;
+
+	// constant values for pressure equation
+	float dx2 = constants.dx2;
+	float dy2 = constants.dy2;
+
+	REAL constant_expr = constants.constant_expr;
+	REAL omega         = constants.omega;
+
+	int setPressureBoundary = 1;
+
+	try
+	{
+		cl::Kernel* kernel;
+
+		// domain boundaries
+		kernel = &strip.kernels[kernel::setHorizontalBoundaryConditions];
+		kernel->setArg( 0, strip.U_g );
+		kernel->setArg( 1, strip.V_g );
+		kernel->setArg( 2, sizeof(int), &(parameters->wN) );
+		kernel->setArg( 3, sizeof(int), &(parameters->wS) );
+		kernel->setArg( 4, sizeof(int), &nx );
+		kernel->setArg( 5, sizeof(int), &ny );
+
+		kernel = &strip.kernels[kernel::setVerticalBoundaryConditions];
+		kernel->setArg( 0, strip.U_g );
+		kernel->setArg( 1, strip.V_g );
+		kernel->setArg( 2, sizeof(int), &(parameters->wE) );
+		kernel->setArg( 3, sizeof(int), &(parameters->wW) );
+		kernel->setArg( 4, sizeof(int), &nx );
+		kernel->setArg( 5, sizeof(int), &ny );
+
+		kernel = &strip.kernels[kernel::setArbitraryBoundaryConditions];
+		kernel->setArg( 0, strip.U_g );
+		kernel->setArg( 1, strip.V_g );
+		kernel->setArg( 2, strip.FLAG_g );
+		kernel->setArg( 3, sizeof(int), &nx );
+		kernel->setArg( 4, sizeof(int), &ny );
+
+		if ( parameters->problem == "moving_lid" || parameters->problem == "channel" )
+		{
+			kernel = &strip.kernels[kernel::problemSpecific];
+			kernel->setArg( 0, strip.U_g );
+			kernel->setArg( 1, sizeof(int), &nx );
+			kernel->setArg( 2, sizeof(int), &ny );
+		}
+
+		// delta t computation (UV maximum)
+		kernel = &strip.kernels[kernel::getUVMaximum];
+		kernel->setArg( 0, strip.U_g );
+		kernel->setArg( 1, strip.V_g );
+		kernel->setArg( 2, strip.uvPartials_g );
+		kernel->setArg( 3, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 4, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 5, sizeof(int), &nx );
+		kernel->setArg( 6, sizeof(int), &uvRows );
+
+		kernel = &strip.kernels[kernel::getUVMaximumFinal];
+		kernel->setArg( 0, strip.uvPartials_g );
+		kernel->setArg( 1, strip.uvMaximum_g );
+		kernel->setArg( 2, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 3, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 4, sizeof(int), &strip.reductionGroups );
+
+		// F and G computation
+		kernel = &strip.kernels[kernel::computeF];
+		kernel->setArg( 0,  strip.U_g );
+		kernel->setArg( 1,  strip.V_g );
+		kernel->setArg( 2,  strip.FLAG_g );
+		kernel->setArg( 3,  strip.F_g );
+		kernel->setArg( 4,  sizeof(CL_REAL), &(parameters->gx) );
+		// kernel->setArg( 5, sizeof(CL_REAL), &_dt ); // set before kernel call
+		kernel->setArg( 6,  sizeof(CL_REAL), &(parameters->re) );
+		kernel->setArg( 7,  sizeof(CL_REAL), &alphaFG );
+		kernel->setArg( 8,  sizeof(CL_REAL), &(parameters->dx) );
+		kernel->setArg( 9,  sizeof(CL_REAL), &(parameters->dy) );
+		kernel->setArg( 10, sizeof(int), &nx );
+		kernel->setArg( 11, sizeof(int), &ny );
+
+		kernel = &strip.kernels[kernel::computeG];
+		kernel->setArg( 0,  strip.U_g );
+		kernel->setArg( 1,  strip.V_g );
+		kernel->setArg( 2,  strip.FLAG_g );
+		kernel->setArg( 3,  strip.G_g );
+		kernel->setArg( 4,  sizeof(CL_REAL), &(parameters->gy) );
+		// kernel->setArg( 5, sizeof(CL_REAL), &_dt ); // set before kernel call
+		kernel->setArg( 6,  sizeof(CL_REAL), &(parameters->re) );
+		kernel->setArg( 7,  sizeof(CL_REAL), &alphaFG );
+		kernel->setArg( 8,  sizeof(CL_REAL), &(parameters->dx) );
+		kernel->setArg( 9,  sizeof(CL_REAL), &(parameters->dy) );
+		kernel->setArg( 10, sizeof(int), &nx );
+		kernel->setArg( 11, sizeof(int), &ny );
+
+		// RHS computation
+		kernel = &strip.kernels[kernel::rightHandSide];
+		kernel->setArg( 0, strip.F_g );
+		kernel->setArg( 1, strip.G_g );
+		kernel->setArg( 2, strip.RHS_g );
+		// kernel->setArg( 3, sizeof(CL_REAL), &_dt ); // set before kernel call
+		kernel->setArg( 4, sizeof(CL_REAL), &(parameters->dx) );
+		kernel->setArg( 5, sizeof(CL_REAL), &(parameters->dy) );
+		kernel->setArg( 6, sizeof(int), &nx );
+		kernel->setArg( 7, sizeof(int), &ny );
+
+		// gauß seidel step, including the pressure boundary values
+		kernel = &strip.kernels[kernel::gaussSeidelRedBlack];
+		kernel->setArg( 0, strip.P_g );
+		kernel->setArg( 1, strip.FLAG_g );
+		kernel->setArg( 2, strip.RHS_g );
+		kernel->setArg( 3, sizeof(CL_REAL), &dx2 );
+		kernel->setArg( 4, sizeof(CL_REAL), &dy2 );
+		// kernel->setArg( 5, sizeof(int), &red ); // red/black flag, set before kernel call
+		kernel->setArg( 6, sizeof(CL_REAL), &constant_expr );
+		kernel->setArg( 7, sizeof(CL_REAL), &omega );
+		kernel->setArg( 8, sizeof(int), &nx );
+		kernel->setArg( 9, sizeof(int), &ny );
+		kernel->setArg( 10, sizeof(int), &setPressureBoundary );
+
+		// pressure iteration residual
+		kernel = &strip.kernels[kernel::pressureResidualReduction];
+		kernel->setArg( 0, strip.P_g );
+		kernel->setArg( 1, strip.RHS_g );
+		kernel->setArg( 2, strip.FLAG_g );
+		kernel->setArg( 3, strip.residualPartials_g );
+		kernel->setArg( 4, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 5, sizeof(CL_REAL), &dx2 );
+		kernel->setArg( 6, sizeof(CL_REAL), &dy2 );
+		kernel->setArg( 7, sizeof(int), &nx );
+		kernel->setArg( 8, sizeof(int), &residualRows );
+
+		kernel = &strip.kernels[kernel::pressureResidualSum];
+		kernel->setArg( 0, strip.residualPartials_g );
+		kernel->setArg( 1, strip.residual_g );
+		kernel->setArg( 2, sizeof(CL_REAL) * workgroupSize, NULL );
+		kernel->setArg( 3, sizeof(int), &strip.reductionGroups );
+
+		// UV update
+		kernel = &strip.kernels[kernel::updateUV];
+		kernel->setArg( 0,  strip.P_g );
+		kernel->setArg( 1,  strip.F_g );
+		kernel->setArg( 2,  strip.G_g );
+		kernel->setArg( 3,  strip.FLAG_g );
+		kernel->setArg( 4,  strip.U_g );
+		kernel->setArg( 5,  strip.V_g );
+		// kernel->setArg( 6, sizeof(CL_REAL), &_dt ); // set before kernel call
+		kernel->setArg( 7,  sizeof(CL_REAL), &(parameters->dx) );
+		kernel->setArg( 8,  sizeof(CL_REAL), &(parameters->dy) );
+		kernel->setArg( 9,  sizeof(int), &nx );
+		kernel->setArg( 10, sizeof(int), &ny );
+	}
+	catch( cl::Error error )
+	{
+		std::cerr << "CL ERROR while setting kernel arguments: " << error.what() << "(" << error.err() << ")" << std::endl;
+		throw error;
+	}
+}
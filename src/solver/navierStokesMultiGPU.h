@@ -0,0 +1,342 @@
+#ifndef NAVIERSTOKESMULTIGPU_H
+#define NAVIERSTOKESMULTIGPU_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "navierStokesSolver.h"
+#include "../CLManager.h"
+#include "../FlowField.h"
+
+//********************************************************************
+//**    additional types
+//********************************************************************
+
+//====================================================================
+//! Fields exchanged at the strip borders, may be combined
+
+namespace halo
+{
+	enum HaloFields
+	{
+		U = 0x01,	//! horizontal velocity
+		V = 0x02,	//! vertical velocity
+		P = 0x04,	//! pressure
+		G = 0x08	//! G, read one row below by the right hand side
+	};
+}
+
+//====================================================================
+/*! \struct DeviceStrip
+	\brief Queue, kernels and buffers of one device of the
+	multi-device solver
+
+	Each device holds the whole fields, but only computes the rows
+	[first, last). The rows first - 1 and last are copies of the rows
+	of the neighbouring strips (halo rows), all other rows are outdated.
+*/
+//====================================================================
+
+struct DeviceStrip
+{
+	cl::Device				device;
+	cl::CommandQueue		queue;
+	std::vector<cl::Kernel>	kernels;			//! own kernel objects with the buffers of this strip, indexed by kernel ID
+
+	cl::Buffer				U_g,				//! velocity in x-direction
+							V_g,				//! velocity in y-direction
+							P_g,				//! pressure
+							RHS_g,				//! right-hand side for pressure iteration
+							F_g,
+							G_g,
+							FLAG_g;				//! obstacle map
+
+	cl::Buffer				residualPartials_g,	//! partial residual sums, one per work group
+							uvPartials_g,		//! partial UV maxima per work group
+							residual_g,			//! sum of squared residuals of the strip
+							uvMaximum_g;		//! { u_max, v_max } of the strip
+
+	int						first;				//! first row computed by this device (including boundaries)
+	int						last;				//! row after the last row computed by this device
+	int						reductionGroups;	//! number of work groups of the first reduction stage
+};
+
+//====================================================================
+/*! \class NavierStokesMultiGPU
+	\brief Class for solving the Navier Stokes equations on several
+	OpenCL devices
+
+	The domain is split into horizontal strips of rows, one per device
+	(-clstrips). The kernels of the GPU solver are launched with a
+	global offset, so they work on the rows of a strip only. After
+	each phase the rows at the strip borders are exchanged through host
+	memory, and the reductions are combined on the host. The results
+	equal those of the GPU solver with the natural layout and without
+	tiling.
+*/
+//====================================================================
+
+class NavierStokesMultiGPU : public NavierStokesSolver, public FlowFieldDevice
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		std::vector<DeviceStrip>	_strips;			//! one strip per device, from south to north
+
+		std::vector<CL_REAL>		_haloHost;			//! host memory for the halo exchange, two rows per strip and field
+
+		// host copies of U, V, P and FLAG, transferred only on access
+		FlowField*					_field;				//! host memory for data exchange
+
+		// OpenCL data
+		CLManager*					_clManager;			//! pointer to the CL Manager
+		cl::Context*				_clContext;			//! pointer to CL context
+		int							_clWorkgroupSize;	//! work group size of the reductions
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+			//! \param pointer to cl manager object, created with the devices to use
+
+		NavierStokesMultiGPU
+			(
+				Parameters* parameters,
+				CLManager*  clManager
+			);
+
+		~NavierStokesMultiGPU ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	initialization
+		// -------------------------------------------------
+			//! @name initialisation
+			//! @{
+
+			//! \brief allocates and initialises simulation memory on all devices
+
+		void	initialize ( );
+
+			//! \brief takes the obstacle map and creates geometry information for each cell
+			//! true stands for fluid cells and false for boundary cells
+			//! Maps must have no obstacle cell between two fluid cells to be valid.
+			//! An additional boundary will be applied.
+			//! \param obstacle map (domain size)
+			//! \returns true if the obstacle map is valid, false otherwise
+
+		bool	setObstacleMap ( bool** map );
+
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! \returns true if the state was loaded, false otherwise
+
+		bool	loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	execution
+		// -------------------------------------------------
+			//! @name execution
+			//! @{
+
+			//! \brief simulates the next timestep
+			//! \returns number of iterations used to solve the pressure equation
+
+		int		doSimulationStep ( );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	interaction
+		// -------------------------------------------------
+			//! @name interaction
+			//! @{
+
+			//! \brief inserts or removes a line of obstacles
+			//! The line is drawn on every device, as all of them hold the whole fields.
+			//! \param first x offset of the obstacle to draw
+			//! \param first y offset of the obstacle to draw
+			//! \param last x offset of the obstacle to draw
+			//! \param last y offset of the obstacle to draw
+			//! \param drawing mode, true if a wall ist to be teared down instead of created
+
+		void drawObstacles (
+				int x0,
+				int y0,
+				int x1,
+				int y1,
+				bool delete_flag
+			);
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	data access
+		// -------------------------------------------------
+			//! @name data access
+			//! @{
+
+			//! \brief gives access to the horizontal velocity component
+			//! The strips are copied to host memory if the host copy is outdated.
+			//! \returns pointer to horizontal velocity array
+
+		REAL** getU_CPU ( );
+
+			//! \brief gives access to the vertical velocity component
+			//! \returns pointer to vertical velocity array
+
+		REAL** getV_CPU ( );
+
+			//! \brief gives access to the pressure
+			//! \returns pointer to pressure array
+
+		REAL** getP_CPU ( );
+
+			//! \brief gives access to the obstacle flags
+			//! \returns pointer to flag array
+
+		unsigned char** getFLAG_CPU ( );
+
+			//! \brief copies the rows of each strip from its device, used by the flow field
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		void downloadField ( int fieldID, void* host );
+
+			//! \brief copies a field to all devices, used by the flow field
+			//! \param field id (see namespace field)
+			//! \param continuous host memory of the field
+
+		void uploadField ( int fieldID, const void* host );
+
+			//! @}
+
+
+	protected:
+		// -------------------------------------------------
+		//	simulation
+		// -------------------------------------------------
+			//! @name simulation
+			//! @{
+
+			//! \brief calculates the stepsize for next time step
+			//! The maxima of the strips are combined on the host.
+
+		void	computeDeltaT ( );
+
+			//! \brief sets the domain, obstacle and problem specific boundary values for U and V
+
+		void	setBoundaryConditions ( );
+
+			//! \brief computes F, G and the right-hand side of the pressure equation
+
+		void	computeFGAndRightHandSide ( );
+
+			//! \brief red/black sweep for the pressure equation on all strips
+			//! The pressure halos are exchanged after each colour.
+
+		void	pressureSweep ( );
+
+			//! \brief computes the residual of the pressure equation
+			//! The sums of the strips are added on the host.
+			//! \returns residual
+
+		REAL	computeResidual ( );
+
+			//! \brief calculates new velocities
+
+		void	adaptUV ( );
+
+			//! @}
+
+
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief enqueues a kernel of a strip
+			//! The first row of a strip is passed as global offset,
+			//! so the kernels index the whole fields.
+			//! \param strip
+			//! \param kernel id
+			//! \param global offset
+			//! \param global range
+			//! \param local range
+
+		void	runStripKernel
+			(
+				DeviceStrip&		strip,
+				int					kernelID,
+				const cl::NDRange&	offset,
+				const cl::NDRange&	global,
+				const cl::NDRange&	local
+			);
+
+			//! \brief copies the rows at the strip borders to the halo rows of the
+			//! neighbouring strips. Waits for the previous commands of all strips.
+			//! \param fields to exchange, combination of halo::HaloFields
+
+		void	exchangeHalos ( int fields );
+
+			//! \brief returns the buffer of a strip for a halo field
+
+		cl::Buffer&	getHaloBuffer
+			(
+				DeviceStrip&	strip,
+				int				haloField
+			);
+
+			//! \brief waits for all commands of all strips
+
+		void	finish ( );
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	kernel arguments
+		// -------------------------------------------------
+			//! @name kernel arguments
+			//! @{
+
+			//! \brief sets kernel arguments for all kernels of a strip
+			//! Also used for the device strip of NavierStokesHybrid.
+			//! \param strip with buffers, kernels and rows
+			//! \param pointer to parameters struct
+			//! \param work group size of the reductions
+
+		static void	setKernelArguments
+			(
+				DeviceStrip&	strip,
+				Parameters*		parameters,
+				int				workgroupSize
+			);
+
+			//! @}
+};
+
+#endif // NAVIERSTOKESMULTIGPU_H
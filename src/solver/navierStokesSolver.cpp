@@ -4,6 +4,7 @@
 //********************************************************************
 
 #include <stdlib.h>
+#include <algorithm>
 #include "navierStokesSolver.h"
 
 
@@ -28,6 +29,105 @@ NavierStokesSolver::~NavierStokesSolver ( )
 }
 
 
+// -------------------------------------------------
+//	execution
+// -------------------------------------------------
+
+//============================================================================
+double NavierStokesSolver::advanceTime ( double time )
+{
+	return time + _parameters->dt;
+}
+
+//============================================================================
+bool NavierStokesSolver::isFinished ( double time )
+{
+	// interactive simulations run until stopped
+	return _parameters->VTKWriteFiles && time >= _parameters->VTKTimeLimit;
+}
+
+
+// -------------------------------------------------
+//	data access
+// -------------------------------------------------
+
+//============================================================================
+void NavierStokesSolver::getRegion_CPU
+	(
+		const OutputRegion&	region,
+		REAL*				data
+	)
+{
+	REAL** U = getU_CPU();
+	REAL** V = getV_CPU();
+	REAL** P = getP_CPU();
+
+	int width  = region.getWidth();
+	int height = region.getHeight();
+	int size   = width * height;
+
+	// same reduction as the regionOutputKernel
+	for( int y = 0; y < height; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			int xStart = region.x0 + x * region.factor;
+			int yStart = region.y0 + y * region.factor;
+
+			int xStop = xStart,
+				yStop = yStart;
+
+			if( region.filter == REGION_BOX )
+			{
+				xStop = std::min( xStart + region.factor - 1, region.x1 );
+				yStop = std::min( yStart + region.factor - 1, region.y1 );
+			}
+
+			REAL u = 0.0,
+				 v = 0.0,
+				 p = 0.0;
+
+			for( int j = yStart; j <= yStop; ++j )
+			{
+				for( int i = xStart; i <= xStop; ++i )
+				{
+					// u and v are located on cell borders
+					u += 0.5 * ( U[j][i-1] + U[j][i] );
+					v += 0.5 * ( V[j-1][i] + V[j][i] );
+					p += P[j][i];
+				}
+			}
+
+			REAL scale = 1.0 / (REAL)( ( xStop - xStart + 1 ) * ( yStop - yStart + 1 ) );
+
+			data[y * width + x]            = u * scale;
+			data[y * width + x + size]     = v * scale;
+			data[y * width + x + 2 * size] = p * scale;
+		}
+	}
+}
+
+//============================================================================
+bool NavierStokesSolver::requestSnapshot ( )
+{
+	// host solvers give direct access to the fields
+	return false;
+}
+
+//============================================================================
+void NavierStokesSolver::getSnapshot_CPU
+	(
+		REAL*** U,
+		REAL*** V,
+		REAL*** P
+	)
+{
+	*U = getU_CPU();
+	*V = getV_CPU();
+	*P = getP_CPU();
+}
+
+
 // -------------------------------------------------
 //	auxiliary functions
 // -------------------------------------------------
@@ -68,6 +68,23 @@ class NavierStokesSolver
 
 		virtual bool setObstacleMap ( bool** map ) = 0;
 
+			//! \brief replaces the simulation state, used to restart from a checkpoint
+			//! All arrays have the size (nx+2)*(ny+2) and may point to read-only
+			//! (memory mapped) memory. Must be called after initialize.
+			//! \param horizontal velocity
+			//! \param vertical velocity
+			//! \param pressure
+			//! \param obstacle flags
+			//! \returns true if the state was loaded, false otherwise
+
+		virtual bool loadState
+			(
+				const REAL* U,
+				const REAL* V,
+				const REAL* P,
+				const unsigned char* FLAG
+			) = 0;
+
 			//! @}
 
 
@@ -82,6 +99,18 @@ class NavierStokesSolver
 
 		virtual int doSimulationStep ( ) = 0;
 
+			//! \brief advances the simulated time after a time step
+			//! \param simulated time before the step
+			//! \returns simulated time of the fields given by getU_CPU etc.
+
+		virtual double advanceTime ( double time );
+
+			//! \brief checks whether the time limit has been reached
+			//! \param simulated time as returned by advanceTime
+			//! \returns true if no further time steps are needed
+
+		virtual bool isFinished ( double time );
+
 			//! @}
 
 
@@ -106,6 +135,45 @@ class NavierStokesSolver
 
 		virtual REAL** getP_CPU ( ) = 0;
 
+			//! \brief gives access to the obstacle flags
+			//! \returns pointer to flag array
+
+		virtual unsigned char** getFLAG_CPU ( ) = 0;
+
+			//! \brief extracts cell centered velocities and pressure of a region
+			//! Blocks of region.factor x region.factor cells are reduced to one
+			//! value as given by region.filter. The default implementation
+			//! works on the host copies of the fields.
+			//! \param region to extract
+			//! \param target for the u, v and p planes, each of size
+			//!        region.getWidth() * region.getHeight()
+
+		virtual void getRegion_CPU
+			(
+				const OutputRegion&	region,
+				REAL*				data
+			);
+
+			//! \brief starts copying the current fields to host memory in the background
+			//! \returns true if the copy was started and the fields have to be
+			//!          fetched with getSnapshot_CPU, which may be called after
+			//!          the next time step. false if the solver copies synchronously,
+			//!          the fields are then accessed with getU_CPU etc.
+
+		virtual bool requestSnapshot ( );
+
+			//! \brief waits for the copy started by requestSnapshot
+			//! \param returns pointer to horizontal velocity array
+			//! \param returns pointer to vertical velocity array
+			//! \param returns pointer to pressure array
+
+		virtual void getSnapshot_CPU
+			(
+				REAL*** U,
+				REAL*** V,
+				REAL*** P
+			);
+
 			//! @}
 
 
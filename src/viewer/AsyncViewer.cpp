@@ -0,0 +1,244 @@
+#include "AsyncViewer.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+//============================================================================
+AsyncViewerThread::AsyncViewerThread
+	(
+		AsyncViewer* viewer
+	)
+{
+	_viewer = viewer;
+}
+
+//============================================================================
+void AsyncViewerThread::run ( )
+{
+	_viewer->processFrames();
+}
+
+
+//============================================================================
+AsyncViewer::AsyncViewer
+	(
+		Parameters* parameters,
+		Viewer*     target,
+		int         numBuffers
+	) :
+	Viewer( parameters )
+{
+	_target    = target;
+	_thread    = new AsyncViewerThread( this );
+	_stop      = false;
+	_stallTime = 0;
+	_numStalls = 0;
+
+	if( numBuffers < 1 )
+		numBuffers = 1;
+
+	// buffers are allocated once and reused for all frames
+	_frames.resize( numBuffers );
+
+	for( int i = 0; i < numBuffers; ++i )
+	{
+		_frames[i].U = allocMatrix();
+		_frames[i].V = allocMatrix();
+		_frames[i].P = allocMatrix();
+
+		_freeFrames.push_back( i );
+	}
+}
+
+//============================================================================
+AsyncViewer::~AsyncViewer ( )
+{
+	// make sure the thread is not accessing the buffers any longer
+	finalize();
+
+	SAFE_DELETE( _thread );
+
+	for( unsigned int i = 0; i < _frames.size(); ++i )
+	{
+		free( _frames[i].U[0] ); free( _frames[i].U );
+		free( _frames[i].V[0] ); free( _frames[i].V );
+		free( _frames[i].P[0] ); free( _frames[i].P );
+	}
+
+	SAFE_DELETE( _target );
+}
+
+//============================================================================
+void AsyncViewer::initialze ( )
+{
+	_target->initialze();
+
+	_stop = false;
+	_thread->start();
+}
+
+//============================================================================
+void AsyncViewer::finalize ( )
+{
+	if( !_thread->isRunning() )
+		return;
+
+	// let the writer finish the queued frames
+	_mutex.lock();
+	_stop = true;
+	_frameQueued.wakeAll();
+	_mutex.unlock();
+
+	_thread->wait();
+
+	_target->finalize();
+
+	std::cout << "Asynchronous output: simulation stalled " << _numStalls << " times for "
+			  << ((double)_stallTime / 1000) << " s waiting for free buffers" << std::endl;
+}
+
+//============================================================================
+bool AsyncViewer::isOutputRequired
+	(
+		double time
+	)
+{
+	// the schedule is only accessed from the simulation thread
+	return _target->isOutputRequired( time );
+}
+
+//============================================================================
+double AsyncViewer::getNextOutput ( )
+{
+	return _target->getNextOutput();
+}
+
+//============================================================================
+void AsyncViewer::setNextOutput
+	(
+		double nextOutput
+	)
+{
+	_target->setNextOutput( nextOutput );
+}
+
+//============================================================================
+void AsyncViewer::renderFrame
+	(
+		REAL** U,
+		REAL** V,
+		REAL** P,
+		double time,
+		double dt,
+		unsigned int iteration
+	)
+{
+	//-----------------------
+	// get free buffer
+	//-----------------------
+
+	_mutex.lock();
+
+	if( _freeFrames.empty() )
+	{
+		// backpressure: wait for the writer
+		_stallTimer.start();
+
+		while( _freeFrames.empty() )
+		{
+			_frameFreed.wait( &_mutex );
+		}
+
+		_stallTime += _stallTimer.elapsed();
+		++_numStalls;
+	}
+
+	int index = _freeFrames.back();
+	_freeFrames.pop_back();
+
+	_mutex.unlock();
+
+	//-----------------------
+	// copy fields
+	//-----------------------
+
+	// the buffer is owned by this thread until it is queued
+	Frame& frame = _frames[index];
+
+	size_t size = ( _parameters->nx + 2 ) * ( _parameters->ny + 2 ) * sizeof( REAL );
+
+	// host matrices are continuous
+	memcpy( frame.U[0], U[0], size );
+	memcpy( frame.V[0], V[0], size );
+	memcpy( frame.P[0], P[0], size );
+
+	frame.time      = time;
+	frame.dt        = dt;
+	frame.iteration = iteration;
+
+	//-----------------------
+	// queue frame
+	//-----------------------
+
+	_mutex.lock();
+	_queuedFrames.push( index );
+	_frameQueued.wakeOne();
+	_mutex.unlock();
+}
+
+//============================================================================
+void AsyncViewer::processFrames ( )
+{
+	while( true )
+	{
+		_mutex.lock();
+
+		while( _queuedFrames.empty() && !_stop )
+		{
+			_frameQueued.wait( &_mutex );
+		}
+
+		// all frames written
+		if( _queuedFrames.empty() )
+		{
+			_mutex.unlock();
+			break;
+		}
+
+		int index = _queuedFrames.front();
+		_queuedFrames.pop();
+
+		_mutex.unlock();
+
+		Frame& frame = _frames[index];
+
+		_target->renderFrame( frame.U, frame.V, frame.P, frame.time, frame.dt, frame.iteration );
+
+		// give buffer back to the pool
+		_mutex.lock();
+		_freeFrames.push_back( index );
+		_frameFreed.wakeOne();
+		_mutex.unlock();
+	}
+}
+
+//============================================================================
+REAL** AsyncViewer::allocMatrix ( )
+{
+	int width  = _parameters->nx + 2;
+	int height = _parameters->ny + 2;
+
+	// array of pointers to rows
+	REAL** rows = (REAL**)malloc( height * sizeof( REAL* ) );
+
+	// the actual data array. allocation for all rows at once to get continuous memory
+	rows[0] = (REAL*)malloc( width * height * sizeof( REAL ) );
+
+	for ( int i = 1; i < height; ++i )
+	{
+		rows[i] = rows[0] + i * width;
+	}
+
+	return rows;
+}
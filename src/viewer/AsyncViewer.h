@@ -0,0 +1,184 @@
+#ifndef ASYNCVIEWER_H
+#define ASYNCVIEWER_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "Viewer.h"
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <vector>
+#include <queue>
+
+class AsyncViewer;
+
+//====================================================================
+/*! \class AsyncViewerThread
+	\brief Background thread passing queued frames to the target viewer
+*/
+//====================================================================
+
+class AsyncViewerThread : public QThread
+{
+	protected:
+		AsyncViewer* _viewer;	//! viewer owning the frame queue
+
+	public:
+		AsyncViewerThread ( AsyncViewer* viewer );
+
+	protected:
+		void run ( );
+};
+
+//====================================================================
+/*! \class AsyncViewer
+	\brief Viewer decorator rendering frames in a background thread
+
+	At each output time the fields are copied into a free buffer of
+	a fixed pool and queued. A writer thread passes the queued frames
+	to the target viewer, so the solver can continue meanwhile.
+	If all buffers are in use, the simulation waits for the writer
+	(backpressure). The time spent waiting is reported by finalize.
+
+	The target viewer must not rely on being called from the
+	simulation thread, so this is meant for file writers.
+*/
+//====================================================================
+
+class AsyncViewer : public Viewer
+{
+	friend class AsyncViewerThread;
+
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		//! copy of the fields of one frame
+		struct Frame
+		{
+			REAL**			U;
+			REAL**			V;
+			REAL**			P;
+			double			time;
+			double			dt;
+			unsigned int	iteration;
+		};
+
+		Viewer*				_target;		//! viewer doing the actual output, owned by this object
+
+		AsyncViewerThread*	_thread;		//! writer thread
+
+		std::vector<Frame>	_frames;		//! buffer pool
+		std::vector<int>	_freeFrames;	//! indices of unused buffers
+		std::queue<int>		_queuedFrames;	//! indices of buffers waiting for output
+
+		QMutex				_mutex;			//! protects the buffer lists and _stop
+		QWaitCondition		_frameQueued;	//! signaled if a frame was queued or the writer should stop
+		QWaitCondition		_frameFreed;	//! signaled if the writer has finished a frame
+
+		bool				_stop;			//! tells the writer thread to finish after the queued frames
+
+		QElapsedTimer		_stallTimer;	//! timer for backpressure measurement
+		qint64				_stallTime;		//! time the simulation waited for free buffers in ms
+		unsigned int		_numStalls;		//! number of frames the simulation had to wait for
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+			//! \param viewer doing the actual output. Deleted with this object.
+			//! \param number of frame buffers, at least 1
+
+		AsyncViewer
+			(
+				Parameters* parameters,
+				Viewer*     target,
+				int         numBuffers
+			);
+
+		~AsyncViewer ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	initialization
+		// -------------------------------------------------
+			//! @name initialisation
+			//! @{
+
+			//! \brief initialises the target viewer and starts the writer thread
+
+		void initialze ( );
+
+			//! \brief waits until all queued frames are written and reports stall times
+
+		void finalize ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	visualization
+		// -------------------------------------------------
+			//! @name visualization
+			//! @{
+
+			//! \brief forwards the output schedule of the target viewer
+
+		bool isOutputRequired ( double time );
+
+		double getNextOutput ( );
+
+		void setNextOutput ( double nextOutput );
+
+			//! \brief copies the fields to a free buffer and queues them for output
+			//! Blocks if all buffers are in use.
+			//! \param pointer to horizontal velocity components (host memory)
+			//! \param pointer to vertical velocity components (host memory)
+			//! \param pointer to pressure components (host memory)
+			//! \param simulated time
+			//! \param time step size of the snapshot
+			//! \param number of the current iteration
+
+		void renderFrame
+			(
+				REAL** U,
+				REAL** V,
+				REAL** P,
+				double time,
+				double dt,
+				unsigned int iteration
+			);
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief writer thread loop, passes queued frames to the target viewer
+
+		void processFrames ( );
+
+			//! \brief allocates a 2D matrix of the domain size incl. boundaries
+
+		REAL** allocMatrix ( );
+
+			//! @}
+};
+
+#endif // ASYNCVIEWER_H
@@ -0,0 +1,398 @@
+#include "FieldCompressor.h"
+
+#include <QRunnable>
+#include <iostream>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <zlib.h>
+
+// quantization code of values stored unchanged
+#define OUTLIER_CODE INT_MIN
+
+// largest magnitude of a quantization code
+#define MAX_CODE ( 1 << 30 )
+
+//====================================================================
+/*! \class FieldCompressorTask
+	\brief Compresses or decompresses one tile in the thread pool
+*/
+//====================================================================
+
+class FieldCompressorTask : public QRunnable
+{
+	protected:
+		FieldCompressor::Tile*	_tile;
+		bool					_decompress;
+
+	public:
+		FieldCompressorTask ( FieldCompressor::Tile* tile, bool decompress )
+		{
+			_tile       = tile;
+			_decompress = decompress;
+		}
+
+		void run ( )
+		{
+			if( _decompress )
+				FieldCompressor::decompressTile( _tile );
+			else
+				FieldCompressor::compressTile( _tile );
+		}
+};
+
+//============================================================================
+double FieldCompressor::getErrorBound
+	(
+		const REAL*	field,
+		int			size,
+		int			mode,
+		double		tolerance
+	)
+{
+	if( mode != COMPRESSION_RELATIVE )
+		return tolerance;
+
+	// relative to the value range of the field
+	double min = DBL_MAX,
+		   max = -DBL_MAX;
+
+	for( int i = 0; i < size; ++i )
+	{
+		// skip nan and inf, they are stored unchanged anyway
+		if( fabs( field[i] ) <= FLT_MAX )
+		{
+			if( field[i] < min ) min = field[i];
+			if( field[i] > max ) max = field[i];
+		}
+	}
+
+	return max > min ? tolerance * ( max - min ) : 0.0;
+}
+
+//============================================================================
+bool FieldCompressor::compress
+	(
+		const REAL*			field,
+		int					width,
+		int					height,
+		double				errorBound,
+		std::vector<char>*	output
+	)
+{
+	// a bound of zero would make every value an outlier
+	if( errorBound < FLT_MIN )
+		errorBound = FLT_MIN;
+
+	//-----------------------
+	// compress tiles
+	//-----------------------
+
+	int numTiles = ( height + TILE_ROWS - 1 ) / TILE_ROWS;
+
+	_tiles.resize( numTiles );
+
+	for( int i = 0; i < numTiles; ++i )
+	{
+		Tile& tile = _tiles[i];
+
+		tile.field      = field + i * TILE_ROWS * width;
+		tile.width      = width;
+		tile.rows       = i + 1 < numTiles ? TILE_ROWS : height - i * TILE_ROWS;
+		tile.errorBound = errorBound;
+
+		_pool.start( new FieldCompressorTask( &tile, false ) );
+	}
+
+	_pool.waitForDone();
+
+	for( int i = 0; i < numTiles; ++i )
+	{
+		if( !_tiles[i].success )
+		{
+			std::cerr << "Failed to compress tile " << i << " of the field." << std::endl;
+			return false;
+		}
+	}
+
+	//-----------------------
+	// assemble stream
+	//-----------------------
+
+	StreamHeader header;
+	memset( &header, 0, sizeof( header ) );
+
+	header.errorBound = errorBound;
+	header.width      = width;
+	header.height     = height;
+	header.tileRows   = TILE_ROWS;
+	header.numTiles   = numTiles;
+
+	size_t position = output->size();
+	size_t size     = sizeof( header ) + numTiles * sizeof( TileHeader );
+
+	for( int i = 0; i < numTiles; ++i )
+	{
+		size += _tiles[i].data.size();
+	}
+
+	output->resize( position + size );
+
+	memcpy( &(*output)[position], &header, sizeof( header ) );
+	position += sizeof( header );
+
+	for( int i = 0; i < numTiles; ++i )
+	{
+		memcpy( &(*output)[position], &_tiles[i].header, sizeof( TileHeader ) );
+		position += sizeof( TileHeader );
+	}
+
+	for( int i = 0; i < numTiles; ++i )
+	{
+		if( !_tiles[i].data.empty() )
+		{
+			memcpy( &(*output)[position], &_tiles[i].data[0], _tiles[i].data.size() );
+			position += _tiles[i].data.size();
+		}
+	}
+
+	return true;
+}
+
+//============================================================================
+bool FieldCompressor::decompress
+	(
+		const char*	data,
+		quint64		size,
+		REAL*		field,
+		int			fieldSize
+	)
+{
+	if( size < sizeof( StreamHeader ) )
+		return false;
+
+	StreamHeader header;
+	memcpy( &header, data, sizeof( header ) );
+
+	if( header.width < 0 || header.height < 0 ||
+		(quint64)header.width * header.height != (quint64)fieldSize ||
+		header.tileRows == 0 ||
+		header.numTiles != ( header.height + header.tileRows - 1 ) / header.tileRows ||
+		size < sizeof( header ) + header.numTiles * sizeof( TileHeader ) )
+	{
+		return false;
+	}
+
+	//-----------------------
+	// locate tiles
+	//-----------------------
+
+	_tiles.resize( header.numTiles );
+
+	quint64 position = sizeof( header ) + header.numTiles * sizeof( TileHeader );
+
+	for( unsigned int i = 0; i < header.numTiles; ++i )
+	{
+		Tile& tile = _tiles[i];
+
+		memcpy( &tile.header, data + sizeof( header ) + i * sizeof( TileHeader ), sizeof( TileHeader ) );
+
+		tile.target     = field + i * header.tileRows * header.width;
+		tile.width      = header.width;
+		tile.rows       = i + 1 < header.numTiles ? header.tileRows : header.height - i * header.tileRows;
+		tile.errorBound = header.errorBound;
+		tile.source     = data + position;
+
+		position += tile.header.compressedSize + (quint64)tile.header.numOutliers * sizeof( REAL );
+
+		if( position > size )
+			return false;
+	}
+
+	//-----------------------
+	// decompress tiles
+	//-----------------------
+
+	for( unsigned int i = 0; i < header.numTiles; ++i )
+	{
+		_pool.start( new FieldCompressorTask( &_tiles[i], true ) );
+	}
+
+	_pool.waitForDone();
+
+	for( unsigned int i = 0; i < header.numTiles; ++i )
+	{
+		if( !_tiles[i].success )
+			return false;
+	}
+
+	return true;
+}
+
+// -------------------------------------------------
+//	tile processing
+// -------------------------------------------------
+
+//============================================================================
+void FieldCompressor::compressTile
+	(
+		Tile* tile
+	)
+{
+	int width = tile->width;
+	int count = width * tile->rows;
+
+	double step = 2.0 * tile->errorBound;
+
+	std::vector<qint32>	codes( count );
+	std::vector<REAL>	reconstructed( count );
+	std::vector<REAL>	outliers;
+
+	//-----------------------
+	// predict and quantize
+	//-----------------------
+
+	for( int y = 0; y < tile->rows; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			int i = y * width + x;
+
+			// lorenzo prediction from reconstructed values, the decoder
+			// sees the same values. Neighbours outside the tile are 0.
+			double prediction = 0.0;
+
+			if( x > 0 )          prediction += reconstructed[i - 1];
+			if( y > 0 )          prediction += reconstructed[i - width];
+			if( x > 0 && y > 0 ) prediction -= reconstructed[i - width - 1];
+
+			REAL   value = tile->field[i];
+			double code  = floor( ( value - prediction ) / step + 0.5 );
+
+			// fails for nan and inf as well
+			if( fabs( code ) < MAX_CODE )
+			{
+				REAL result = (REAL)( prediction + code * step );
+
+				// rounding to REAL may exceed the bound
+				if( fabs( (double)result - value ) <= tile->errorBound )
+				{
+					codes[i]         = (qint32)code;
+					reconstructed[i] = result;
+					continue;
+				}
+			}
+
+			codes[i]         = OUTLIER_CODE;
+			reconstructed[i] = value;
+			outliers.push_back( value );
+		}
+	}
+
+	//-----------------------
+	// entropy coding
+	//-----------------------
+
+	uLong  codesSize    = count * sizeof( qint32 );
+	size_t outliersSize = outliers.size() * sizeof( REAL );
+
+	tile->data.resize( compressBound( codesSize ) + outliersSize );
+
+	uLongf compressedSize = compressBound( codesSize );
+
+	// mostly small codes, the fastest level already compresses well
+	tile->success =
+		compress2(
+				(Bytef*)&tile->data[0],
+				&compressedSize,
+				(const Bytef*)&codes[0],
+				codesSize,
+				Z_BEST_SPEED
+			) == Z_OK;
+
+	if( !tile->success )
+	{
+		tile->data.clear();
+		return;
+	}
+
+	if( outliersSize )
+	{
+		memcpy( &tile->data[compressedSize], &outliers[0], outliersSize );
+	}
+
+	tile->data.resize( compressedSize + outliersSize );
+
+	tile->header.compressedSize = compressedSize;
+	tile->header.numOutliers    = outliers.size();
+}
+
+//============================================================================
+void FieldCompressor::decompressTile
+	(
+		Tile* tile
+	)
+{
+	int width = tile->width;
+	int count = width * tile->rows;
+
+	double step = 2.0 * tile->errorBound;
+
+	std::vector<qint32> codes( count );
+
+	uLongf codesSize = count * sizeof( qint32 );
+
+	tile->success =
+		uncompress(
+				(Bytef*)&codes[0],
+				&codesSize,
+				(const Bytef*)tile->source,
+				tile->header.compressedSize
+			) == Z_OK &&
+		codesSize == count * sizeof( qint32 );
+
+	if( !tile->success )
+		return;
+
+	//-----------------------
+	// reconstruct values
+	//-----------------------
+
+	const char*  outliers    = tile->source + tile->header.compressedSize;
+	unsigned int numOutliers = 0;
+
+	REAL* reconstructed = tile->target;
+
+	for( int y = 0; y < tile->rows; ++y )
+	{
+		for( int x = 0; x < width; ++x )
+		{
+			int i = y * width + x;
+
+			if( codes[i] == OUTLIER_CODE )
+			{
+				if( numOutliers == tile->header.numOutliers )
+				{
+					tile->success = false;
+					return;
+				}
+
+				// outliers are not aligned
+				memcpy( &reconstructed[i], outliers + numOutliers * sizeof( REAL ), sizeof( REAL ) );
+				++numOutliers;
+				continue;
+			}
+
+			double prediction = 0.0;
+
+			if( x > 0 )          prediction += reconstructed[i - 1];
+			if( y > 0 )          prediction += reconstructed[i - width];
+			if( x > 0 && y > 0 ) prediction -= reconstructed[i - width - 1];
+
+			reconstructed[i] = (REAL)( prediction + codes[i] * step );
+		}
+	}
+
+	tile->success = numOutliers == tile->header.numOutliers;
+}
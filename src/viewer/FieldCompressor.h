@@ -0,0 +1,159 @@
+#ifndef FIELDCOMPRESSOR_H
+#define FIELDCOMPRESSOR_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "../Definitions.h"
+#include <QtGlobal>
+#include <QThreadPool>
+#include <vector>
+
+// number of rows per tile, tiles are compressed in parallel
+#define TILE_ROWS 64
+
+//====================================================================
+/*! \class FieldCompressor
+	\brief Error bounded lossy compression of 2D fields
+
+	Each value is predicted from its already reconstructed west,
+	south and south west neighbours (Lorenzo predictor). The
+	prediction error is quantized to multiples of twice the error
+	bound, so the reconstructed value differs from the original by
+	at most the error bound. Values that cannot be quantized within
+	the bound (or are not finite) are stored unchanged. The
+	quantization codes are zlib compressed.
+
+	The field is split into tiles of TILE_ROWS rows, which are
+	compressed and decompressed independently by a thread pool.
+
+	stream layout:
+	| header | tile headers | tile 0 | tile 1 | ... |
+*/
+//====================================================================
+
+class FieldCompressor
+{
+	public:
+		// -------------------------------------------------
+		//	stream structures
+		// -------------------------------------------------
+
+		//! header of a compressed field
+		struct StreamHeader
+		{
+			double		errorBound;		//! maximum absolute error
+			qint32		width;			//! number of values per row
+			qint32		height;			//! number of rows
+			quint32		tileRows;		//! number of rows per tile
+			quint32		numTiles;		//! number of tiles
+		};
+
+		//! header of a compressed tile
+		struct TileHeader
+		{
+			quint32		compressedSize;	//! size of the zlib compressed data
+			quint32		numOutliers;	//! number of unquantized values
+		};
+
+		//! data of one tile, used by the worker threads
+		struct Tile
+		{
+			const REAL*			field;		//! first value of the tile in the field
+			REAL*				target;		//! first value of the tile in the target field (decompression)
+			int					width;		//! number of values per row
+			int					rows;		//! number of rows of the tile
+			double				errorBound;	//! maximum absolute error
+			TileHeader			header;		//! sizes of the compressed data
+			std::vector<char>	data;		//! compressed data (compression)
+			const char*			source;		//! compressed data (decompression)
+			bool				success;	//! false if compression or decompression failed
+		};
+
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		QThreadPool			_pool;		//! threads compressing the tiles
+		std::vector<Tile>	_tiles;		//! tile data, kept to avoid reallocation
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	compression
+		// -------------------------------------------------
+			//! @name compression
+			//! @{
+
+			//! \brief computes the absolute error bound for a field
+			//! \param field values
+			//! \param number of values
+			//! \param COMPRESSION_ABSOLUTE or COMPRESSION_RELATIVE
+			//! \param absolute error or error relative to the value range of the field
+			//! \returns absolute error bound
+
+		static double getErrorBound
+			(
+				const REAL*	field,
+				int			size,
+				int			mode,
+				double		tolerance
+			);
+
+			//! \brief compresses a field
+			//! \param field values, row by row
+			//! \param number of values per row
+			//! \param number of rows
+			//! \param maximum absolute error of each value
+			//! \param buffer the compressed stream is appended to
+			//! \returns false if zlib failed, the buffer is unchanged then
+
+		bool compress
+			(
+				const REAL*			field,
+				int					width,
+				int					height,
+				double				errorBound,
+				std::vector<char>*	output
+			);
+
+			//! \brief decompresses a field
+			//! \param compressed stream
+			//! \param size of the compressed stream
+			//! \param target field, must have the size of the compressed field
+			//! \param number of values the target can hold
+			//! \returns true if the stream was valid
+
+		bool decompress
+			(
+				const char*	data,
+				quint64		size,
+				REAL*		field,
+				int			fieldSize
+			);
+
+			//! @}
+
+		// -------------------------------------------------
+		//	tile processing
+		// -------------------------------------------------
+			//! @name tile processing
+			//! @{
+
+			//! \brief quantizes and compresses a tile
+
+		static void compressTile ( Tile* tile );
+
+			//! \brief decompresses and reconstructs a tile
+
+		static void decompressTile ( Tile* tile );
+
+			//! @}
+};
+
+#endif // FIELDCOMPRESSOR_H
@@ -92,6 +92,7 @@ void GLViewer::renderFrame (
         REAL** V,
         REAL** P,
 		double time,
+		double,
 		unsigned int iteration
 	)
 {
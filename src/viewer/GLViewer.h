@@ -99,6 +99,7 @@ class GLViewer : public QGLWidget, public Viewer
                 REAL** V,
                 REAL** P,
 				double time,
+				double dt,
 				unsigned int iteration
 			);
 
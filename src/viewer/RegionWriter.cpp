@@ -0,0 +1,139 @@
+#include "RegionWriter.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <stdio.h>
+
+//============================================================================
+RegionWriter::RegionWriter
+	(
+		Parameters*			parameters,
+		const OutputRegion&	region
+	)
+{
+	_parameters = parameters;
+	_region     = region;
+	_nextOutput = 0.0;
+
+	_data.resize( 3 * region.getWidth() * region.getHeight() );
+}
+
+//============================================================================
+bool RegionWriter::isOutputRequired (
+		double time
+	)
+{
+	if( _nextOutput > time )
+		return false;
+
+	// determine next output time
+	_nextOutput = time + _region.interval;
+
+	return true;
+}
+
+//============================================================================
+double RegionWriter::getNextOutput ( )
+{
+	return _nextOutput;
+}
+
+//============================================================================
+void RegionWriter::setNextOutput (
+		double nextOutput
+	)
+{
+	_nextOutput = nextOutput;
+}
+
+//============================================================================
+const OutputRegion& RegionWriter::getRegion ( )
+{
+	return _region;
+}
+
+//============================================================================
+REAL* RegionWriter::getData ( )
+{
+	return &_data[0];
+}
+
+//============================================================================
+void RegionWriter::writeFile (
+		unsigned int iteration
+	)
+{
+	// www.vtk.org/VTK/img/file-formats.pdf‎
+
+	int width  = _region.getWidth();
+	int height = _region.getHeight();
+	int size   = width * height;
+
+	//-----------------------
+	// open file
+	//-----------------------
+
+	char suffix[16];
+	sprintf( suffix, "_%05d.vtk", iteration );
+
+	std::string filename = "output/" + _region.name + suffix;
+
+	std::ofstream vtk ( filename.c_str() );
+
+	if ( !vtk.is_open() )
+	{
+		std::cerr << "Failed to open vtk file \"" << filename << "\" for writing! (Does the directory exist?)" << std::endl;
+		return;
+	}
+
+	// set output flags
+	vtk << std::setprecision( 16 );
+
+	//-----------------------
+	// write vtk header
+	//-----------------------
+
+	vtk << "# vtk DataFile Version 2.0\n"
+		<< "Navier Stokes region " << _region.name << "\n"
+		<< "ASCII\n\n";
+
+	//-----------------------
+	// write grid
+	//-----------------------
+
+	// values are located at the centers of the (downsampled) cells,
+	// in the same coordinates as the full output of the VTKWriter
+	double offset = _region.filter == REGION_BOX ? 0.5 * _region.factor : 0.5;
+
+	vtk << "DATASET STRUCTURED_POINTS\n"
+		<< "DIMENSIONS " << width << " " << height << " 1\n"
+		<< "ORIGIN " << ( _region.x0 - 1 + offset ) << " " << ( _region.y0 - 1 + offset ) << " 0\n"
+		<< "SPACING " << _region.factor << " " << _region.factor << " 1\n";
+
+	//-----------------------
+	// write velocity
+	//-----------------------
+
+	vtk << "\nPOINT_DATA " << size << "\n"
+		<< "VECTORS velocity float\n";
+
+	for( int i = 0; i < size; ++i )
+	{
+		vtk << std::fixed << _data[i] << " " << _data[i + size] << " 0\n";
+	}
+
+	//-----------------------
+	// write pressure
+	//-----------------------
+
+	vtk << "\nSCALARS pressure float\n"
+		<< "LOOKUP_TABLE default\n";
+
+	for( int i = 0; i < size; ++i )
+	{
+		vtk << std::fixed << _data[i + 2 * size] << "\n";
+	}
+
+	vtk.close();
+}
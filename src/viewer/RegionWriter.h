@@ -0,0 +1,97 @@
+#ifndef REGIONWRITER_H
+#define REGIONWRITER_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "../Definitions.h"
+#include "../Parameters.h"
+#include <vector>
+
+//====================================================================
+/*! \class RegionWriter
+	\brief Class for writing a region of the domain, optionally
+	downsampled, to VTK legacy files
+
+	Each region given in the parameter file is written with its own
+	output interval to output/<name>_<iteration>.vtk. The data is
+	extracted by the solver (see NavierStokesSolver::getRegion_CPU),
+	so only the reduced region has to be read from the device.
+*/
+//====================================================================
+
+class RegionWriter
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		Parameters*			_parameters;	//! pointer to the set of simulation parameters
+		OutputRegion		_region;		//! region to write
+
+		double				_nextOutput;	//! next point in simulated time to write a file at
+
+		std::vector<REAL>	_data;			//! extracted u, v and p planes
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+			//! \param region to write
+
+		RegionWriter
+			(
+				Parameters*			parameters,
+				const OutputRegion&	region
+			);
+
+			//! @}
+
+		// -------------------------------------------------
+		//	file output
+		// -------------------------------------------------
+			//! @name file output
+			//! @{
+
+			//! \brief checks if the output interval of the region has passed
+			//! \param simulated time
+			//! \returns true if a file has to be written
+
+		bool isOutputRequired ( double time );
+
+			//! \returns next point in simulated time to write a file at, stored in checkpoints
+
+		double getNextOutput ( );
+
+			//! \brief continues the output schedule of a restored simulation
+			//! \param next point in simulated time to write a file at
+
+		void setNextOutput ( double nextOutput );
+
+			//! \returns region written by this writer
+
+		const OutputRegion& getRegion ( );
+
+			//! \returns buffer for the extracted planes, 3 * width * height values
+
+		REAL* getData ( );
+
+			//! \brief writes the extracted region to a VTK legacy file
+			//! \param number of the current iteration
+
+		void writeFile ( unsigned int iteration );
+
+			//! @}
+};
+
+#endif // REGIONWRITER_H
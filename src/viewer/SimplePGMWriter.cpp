@@ -19,6 +19,7 @@ void SimplePGMWriter::renderFrame (
         REAL** V,
         REAL** P,
 		double time,
+		double,
 		unsigned int iteration
 	)
 {
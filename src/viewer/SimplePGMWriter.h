@@ -47,6 +47,7 @@ class SimplePGMWriter : public Viewer
                 REAL** V,
                 REAL** P,
 				double time,
+				double dt,
 				unsigned int iteration
 			);
 
@@ -0,0 +1,104 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include <QtGlobal>
+
+/*
+ * time series container layout
+ * ----------------------------------------------------
+ * | file header | chunk 0 | chunk 1 | ... | index | footer |
+ * ----------------------------------------------------
+ *
+ * chunk:  chunk header followed by dataSize bytes of field data
+ *         (U, V and P incl. boundary cells, in this order)
+ *         SERIES_RAW:   REAL arrays
+ *         SERIES_LOSSY: for each field the size of the compressed
+ *                       stream (quint64) followed by the stream
+ *                       (see FieldCompressor)
+ * index:  one index entry per chunk
+ * footer: position of the index, always the last bytes of the file
+ *
+ * Index and footer are rewritten after each appended chunk, so the
+ * file is readable at any time. All values are stored in native
+ * byte order, SERIES_BYTE_ORDER in the file header is used to
+ * detect files written on a machine with different endianness.
+ */
+
+#define SERIES_MAGIC		"NSSERIES"
+#define SERIES_CHUNK_MAGIC	"CHNK"
+#define SERIES_INDEX_MAGIC	"NSINDEX"
+#define SERIES_VERSION		1
+#define SERIES_BYTE_ORDER	0x01020304
+
+// chunk encodings
+#define SERIES_RAW			0	// REAL arrays
+#define SERIES_LOSSY		1	// error bounded lossy compressed fields
+
+//====================================================================
+/*! \struct SeriesFileHeader
+	\brief Header at the start of a time series file
+*/
+//====================================================================
+
+struct SeriesFileHeader
+{
+	char		magic[8];		//! SERIES_MAGIC
+	quint32		version;		//! SERIES_VERSION
+	quint32		byteOrder;		//! SERIES_BYTE_ORDER in native byte order
+	quint32		realSize;		//! sizeof(REAL) of the writing program
+	qint32		nx;				//! number of interior cells in x-direction
+	qint32		ny;				//! number of interior cells in y-direction
+	quint32		reserved;
+	double		dx;				//! cell width
+	double		dy;				//! cell height
+};
+
+//====================================================================
+/*! \struct SeriesChunkHeader
+	\brief Header of a snapshot
+*/
+//====================================================================
+
+struct SeriesChunkHeader
+{
+	char		magic[4];		//! SERIES_CHUNK_MAGIC
+	quint32		encoding;		//! encoding of the field data (SERIES_RAW or SERIES_LOSSY)
+	quint32		iteration;		//! time step of the snapshot
+	quint32		reserved;
+	double		time;			//! simulated time
+	double		dt;				//! time step size
+	quint64		dataSize;		//! number of bytes following the header
+};
+
+//====================================================================
+/*! \struct SeriesIndexEntry
+	\brief Index entry of a snapshot
+*/
+//====================================================================
+
+struct SeriesIndexEntry
+{
+	quint64		offset;			//! file position of the chunk header
+	double		time;			//! simulated time
+	quint32		iteration;		//! time step of the snapshot
+	quint32		reserved;
+};
+
+//====================================================================
+/*! \struct SeriesFooter
+	\brief Last bytes of a time series file
+*/
+//====================================================================
+
+struct SeriesFooter
+{
+	quint64		indexOffset;	//! file position of the first index entry
+	quint64		numSteps;		//! number of index entries
+	char		magic[8];		//! SERIES_INDEX_MAGIC
+};
+
+#endif // TIMESERIES_H
@@ -0,0 +1,355 @@
+#include "TimeSeriesReader.h"
+#include "VTKWriter.h"
+#include "VTIWriter.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <QFile>
+
+//============================================================================
+TimeSeriesReader::TimeSeriesReader ( )
+{
+	_file     = 0;
+	_data     = 0;
+	_header   = 0;
+	_index    = 0;
+	_numSteps = 0;
+}
+
+//============================================================================
+TimeSeriesReader::~TimeSeriesReader ( )
+{
+	close();
+}
+
+//============================================================================
+bool TimeSeriesReader::open
+	(
+		std::string fileName
+	)
+{
+	close();
+
+	_file = new QFile( QString::fromStdString( fileName ) );
+
+	if( !_file->open( QIODevice::ReadOnly ) )
+	{
+		std::cerr << "Could not open series file \"" << fileName << "\"" << std::endl;
+		close();
+		return false;
+	}
+
+	qint64 size = _file->size();
+
+	if( size < (qint64)( sizeof( SeriesFileHeader ) + sizeof( SeriesFooter ) ) )
+	{
+		std::cerr << "\"" << fileName << "\" is no valid series file." << std::endl;
+		close();
+		return false;
+	}
+
+	_data = _file->map( 0, size );
+
+	if( !_data )
+	{
+		std::cerr << "Could not map series file \"" << fileName << "\"" << std::endl;
+		close();
+		return false;
+	}
+
+	//-----------------------
+	// check header
+	//-----------------------
+
+	_header = (const SeriesFileHeader*)_data;
+
+	if( memcmp( _header->magic, SERIES_MAGIC, sizeof( _header->magic ) ) != 0 ||
+		_header->version   != SERIES_VERSION )
+	{
+		std::cerr << "\"" << fileName << "\" is no valid series file." << std::endl;
+		close();
+		return false;
+	}
+
+	if( _header->byteOrder != SERIES_BYTE_ORDER || _header->realSize != sizeof( REAL ) )
+	{
+		std::cerr << "Series file \"" << fileName << "\" was written on an incompatible machine." << std::endl;
+		close();
+		return false;
+	}
+
+	//-----------------------
+	// locate index
+	//-----------------------
+
+	const SeriesFooter* footer = (const SeriesFooter*)( _data + size - sizeof( SeriesFooter ) );
+
+	if( strncmp( footer->magic, SERIES_INDEX_MAGIC, sizeof( footer->magic ) ) != 0 ||
+		footer->indexOffset + footer->numSteps * sizeof( SeriesIndexEntry ) + sizeof( SeriesFooter ) != (quint64)size )
+	{
+		std::cerr << "Index of series file \"" << fileName << "\" is corrupted." << std::endl;
+		close();
+		return false;
+	}
+
+	_index    = (const SeriesIndexEntry*)( _data + footer->indexOffset );
+	_numSteps = footer->numSteps;
+
+	// chunk headers must lie between file header and index
+	for( unsigned int step = 0; step < _numSteps; ++step )
+	{
+		if( _index[step].offset < sizeof( SeriesFileHeader ) ||
+			_index[step].offset > footer->indexOffset ||
+			footer->indexOffset - _index[step].offset < sizeof( SeriesChunkHeader ) )
+		{
+			std::cerr << "Index of series file \"" << fileName << "\" is corrupted." << std::endl;
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//============================================================================
+void TimeSeriesReader::close ( )
+{
+	if( _file )
+	{
+		if( _data )
+			_file->unmap( _data );
+
+		_file->close();
+		delete _file;
+	}
+
+	_file     = 0;
+	_data     = 0;
+	_header   = 0;
+	_index    = 0;
+	_numSteps = 0;
+}
+
+// -------------------------------------------------
+//	data access
+// -------------------------------------------------
+
+//============================================================================
+int TimeSeriesReader::getNx ( )
+{
+	return _header->nx;
+}
+
+//============================================================================
+int TimeSeriesReader::getNy ( )
+{
+	return _header->ny;
+}
+
+//============================================================================
+double TimeSeriesReader::getDx ( )
+{
+	return _header->dx;
+}
+
+//============================================================================
+double TimeSeriesReader::getDy ( )
+{
+	return _header->dy;
+}
+
+//============================================================================
+unsigned int TimeSeriesReader::getNumSteps ( )
+{
+	return _numSteps;
+}
+
+//============================================================================
+double TimeSeriesReader::getTime
+	(
+		unsigned int step
+	)
+{
+	return _index[step].time;
+}
+
+//============================================================================
+unsigned int TimeSeriesReader::getIteration
+	(
+		unsigned int step
+	)
+{
+	return _index[step].iteration;
+}
+
+//============================================================================
+double TimeSeriesReader::getDt
+	(
+		unsigned int step
+	)
+{
+	const SeriesChunkHeader* chunk = getChunk( step );
+
+	return chunk ? chunk->dt : 0.0;
+}
+
+//============================================================================
+bool TimeSeriesReader::readStep
+	(
+		unsigned int step,
+		REAL** U,
+		REAL** V,
+		REAL** P
+	)
+{
+	if( step >= _numSteps )
+		return false;
+
+	const SeriesChunkHeader* chunk = getChunk( step );
+
+	if( !chunk )
+	{
+		std::cerr << "Snapshot " << step << " of the series file is corrupted." << std::endl;
+		return false;
+	}
+
+	int     count = ( _header->nx + 2 ) * ( _header->ny + 2 );
+	quint64 size  = count * sizeof( REAL );
+
+	const uchar* data = (const uchar*)( chunk + 1 );
+
+	bool valid = memcmp( chunk->magic, SERIES_CHUNK_MAGIC, sizeof( chunk->magic ) ) == 0 &&
+				 (quint64)( data - _data ) + chunk->dataSize <= (quint64)_file->size();
+
+	if( valid && chunk->encoding == SERIES_RAW && chunk->dataSize == 3 * size )
+	{
+		memcpy( U[0], data,            size );
+		memcpy( V[0], data + size,     size );
+		memcpy( P[0], data + 2 * size, size );
+
+		return true;
+	}
+
+	if( valid && chunk->encoding == SERIES_LOSSY )
+	{
+		REAL*   fields[3] = { U[0], V[0], P[0] };
+		quint64 position  = 0;
+
+		for( int i = 0; i < 3 && valid; ++i )
+		{
+			quint64 streamSize = 0;
+
+			valid = position + sizeof( quint64 ) <= chunk->dataSize;
+
+			if( valid )
+			{
+				memcpy( &streamSize, data + position, sizeof( quint64 ) );
+				position += sizeof( quint64 );
+
+				valid = position + streamSize <= chunk->dataSize &&
+						_compressor.decompress( (const char*)( data + position ), streamSize, fields[i], count );
+
+				position += streamSize;
+			}
+		}
+
+		if( valid )
+			return true;
+	}
+
+	std::cerr << "Snapshot " << step << " of the series file is corrupted." << std::endl;
+	return false;
+}
+
+//============================================================================
+const SeriesChunkHeader* TimeSeriesReader::getChunk
+	(
+		unsigned int step
+	)
+{
+	quint64 size = _file->size();
+
+	if( step >= _numSteps || size < sizeof( SeriesChunkHeader ) ||
+		_index[step].offset > size - sizeof( SeriesChunkHeader ) )
+	{
+		return NULL;
+	}
+
+	return (const SeriesChunkHeader*)( _data + _index[step].offset );
+}
+
+// -------------------------------------------------
+//	conversion
+// -------------------------------------------------
+
+//============================================================================
+bool TimeSeriesReader::convert
+	(
+		std::string fileName,
+		Parameters* parameters
+	)
+{
+	TimeSeriesReader reader;
+
+	if( !reader.open( fileName ) )
+		return false;
+
+	parameters->nx = reader.getNx();
+	parameters->ny = reader.getNy();
+	parameters->dx = reader.getDx();
+	parameters->dy = reader.getDy();
+
+	int width  = parameters->nx + 2;
+	int height = parameters->ny + 2;
+
+	//-----------------------
+	// allocate host memory
+	//-----------------------
+
+	REAL** fields[3];
+
+	for( int i = 0; i < 3; ++i )
+	{
+		fields[i]    = (REAL**)malloc( height * sizeof( REAL* ) );
+		fields[i][0] = (REAL*)malloc( width * height * sizeof( REAL ) );
+
+		for( int y = 1; y < height; ++y )
+		{
+			fields[i][y] = fields[i][0] + y * width;
+		}
+	}
+
+	//-----------------------
+	// write vtk files
+	//-----------------------
+
+	VTKWriter* writer;
+
+	if( parameters->VTKFormat == VTK_XML || parameters->VTKFormat == VTK_XML_ZLIB )
+		writer = new VTIWriter( parameters );
+	else
+		writer = new VTKWriter( parameters );
+
+	bool success = true;
+
+	for( unsigned int step = 0; step < reader.getNumSteps() && success; ++step )
+	{
+		success = reader.readStep( step, fields[0], fields[1], fields[2] );
+
+		if( success )
+		{
+			writer->renderFrame( fields[0], fields[1], fields[2], reader.getTime( step ), reader.getDt( step ), reader.getIteration( step ) );
+		}
+	}
+
+	delete writer;
+
+	for( int i = 0; i < 3; ++i )
+	{
+		free( fields[i][0] );
+		free( fields[i] );
+	}
+
+	return success;
+}
@@ -0,0 +1,157 @@
+#ifndef TIMESERIESREADER_H
+#define TIMESERIESREADER_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "../Definitions.h"
+#include "../Parameters.h"
+#include "TimeSeries.h"
+#include "FieldCompressor.h"
+#include <string>
+
+class QFile;
+
+//====================================================================
+/*! \class TimeSeriesReader
+	\brief Class for reading time series files
+
+	The file is memory mapped, so any snapshot can be accessed
+	in constant time via the index.
+*/
+//====================================================================
+
+class TimeSeriesReader
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		QFile*						_file;		//! series file
+		uchar*						_data;		//! mapped file contents
+
+		const SeriesFileHeader*		_header;	//! file header in mapped memory
+		const SeriesIndexEntry*		_index;		//! index in mapped memory
+		unsigned int				_numSteps;	//! number of snapshots
+
+		FieldCompressor				_compressor;	//! decompression of lossy snapshots
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+		TimeSeriesReader ( );
+
+		~TimeSeriesReader ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	file handling
+		// -------------------------------------------------
+			//! @name file handling
+			//! @{
+
+			//! \brief maps a series file and checks header and index
+			//! \param file name
+			//! \returns true if the file is a valid series file
+
+		bool open ( std::string fileName );
+
+			//! \brief unmaps the current file
+
+		void close ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	data access
+		// -------------------------------------------------
+			//! @name data access
+			//! @{
+
+		int				getNx ( );
+		int				getNy ( );
+		double			getDx ( );
+		double			getDy ( );
+
+		unsigned int	getNumSteps ( );
+
+			//! \param index of the snapshot
+			//! \returns simulated time of the snapshot
+
+		double			getTime ( unsigned int step );
+
+			//! \param index of the snapshot
+			//! \returns time step of the snapshot
+
+		unsigned int	getIteration ( unsigned int step );
+
+			//! \param index of the snapshot
+			//! \returns time step size of the snapshot
+
+		double			getDt ( unsigned int step );
+
+			//! \brief copies the fields of a snapshot, decompressing them if necessary
+			//! The target matrices must have the size (nx+2)*(ny+2) and continuous memory.
+			//! \param index of the snapshot
+			//! \param target for horizontal velocity
+			//! \param target for vertical velocity
+			//! \param target for pressure
+			//! \returns true if the snapshot could be read
+
+		bool			readStep
+			(
+				unsigned int step,
+				REAL** U,
+				REAL** V,
+				REAL** P
+			);
+
+			//! @}
+
+		// -------------------------------------------------
+		//	conversion
+		// -------------------------------------------------
+			//! @name conversion
+			//! @{
+
+			//! \brief writes all snapshots of a series file as VTK files
+			//! The format is taken from parameters->VTKFormat.
+			//! \param file name of the series file
+			//! \param parameters, grid size is set from the series file
+			//! \returns true if all snapshots were converted
+
+		static bool convert
+			(
+				std::string fileName,
+				Parameters* parameters
+			);
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief returns the header of a snapshot
+			//! \returns NULL if the header does not lie within the file
+
+		const SeriesChunkHeader* getChunk ( unsigned int step );
+
+			//! @}
+};
+
+#endif // TIMESERIESREADER_H
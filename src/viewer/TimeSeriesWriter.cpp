@@ -0,0 +1,205 @@
+#include "TimeSeriesWriter.h"
+
+#include <iostream>
+#include <string.h>
+
+//============================================================================
+TimeSeriesWriter::TimeSeriesWriter
+	(
+		Parameters* parameters
+	) :
+	VTKWriter( parameters )
+{
+	_file    = 0;
+	_dataEnd = 0;
+}
+
+//============================================================================
+TimeSeriesWriter::~TimeSeriesWriter ( )
+{
+	if( _file )
+	{
+		fclose( _file );
+	}
+}
+
+//============================================================================
+void TimeSeriesWriter::finalize ( )
+{
+	if( _file )
+	{
+		fflush( _file );
+	}
+}
+
+//============================================================================
+void TimeSeriesWriter::renderFrame (
+		REAL** U,
+		REAL** V,
+		REAL** P,
+		double time,
+		double dt,
+		unsigned int iteration
+	)
+{
+	if( !_file && !openFile( iteration ) )
+		return;
+
+	std::cout << "Writing snapshot for iteration " << iteration << std::endl;
+
+	int     width  = _parameters->nx + 2;
+	int     height = _parameters->ny + 2;
+	quint64 size   = width * height * sizeof( REAL );
+
+	bool compress = _parameters->compressionMode != COMPRESSION_NONE;
+
+	//-----------------------
+	// compress fields
+	//-----------------------
+
+	if( compress )
+	{
+		REAL* fields[3] = { U[0], V[0], P[0] };
+
+		_compressed.clear();
+
+		for( int i = 0; i < 3 && compress; ++i )
+		{
+			double errorBound = FieldCompressor::getErrorBound(
+					fields[i],
+					width * height,
+					_parameters->compressionMode,
+					_parameters->compressionTolerance
+				);
+
+			// each stream is preceded by its size
+			size_t  position = _compressed.size();
+			_compressed.resize( position + sizeof( quint64 ) );
+
+			// the snapshot is stored uncompressed if zlib fails
+			if( !_compressor.compress( fields[i], width, height, errorBound, &_compressed ) )
+			{
+				std::cerr << "Snapshot for iteration " << iteration << " is written uncompressed." << std::endl;
+				compress = false;
+				break;
+			}
+
+			quint64 streamSize = _compressed.size() - position - sizeof( quint64 );
+			memcpy( &_compressed[position], &streamSize, sizeof( quint64 ) );
+		}
+	}
+
+	//-----------------------
+	// write chunk
+	//-----------------------
+
+	SeriesChunkHeader header;
+	memset( &header, 0, sizeof( header ) );
+
+	memcpy( header.magic, SERIES_CHUNK_MAGIC, sizeof( header.magic ) );
+	header.encoding  = compress ? SERIES_LOSSY : SERIES_RAW;
+	header.iteration = iteration;
+	header.time      = time;
+	header.dt        = dt;
+	header.dataSize  = compress ? _compressed.size() : 3 * size;
+
+	// the new chunk replaces the old index
+	fseeko( _file, _dataEnd, SEEK_SET );
+
+	fwrite( &header, sizeof( header ), 1, _file );
+
+	if( compress )
+	{
+		fwrite( &_compressed[0], 1, _compressed.size(), _file );
+	}
+	else
+	{
+		// host matrices are continuous
+		fwrite( U[0], 1, size, _file );
+		fwrite( V[0], 1, size, _file );
+		fwrite( P[0], 1, size, _file );
+	}
+
+	//-----------------------
+	// update index
+	//-----------------------
+
+	SeriesIndexEntry entry;
+	memset( &entry, 0, sizeof( entry ) );
+
+	entry.offset    = _dataEnd;
+	entry.time      = time;
+	entry.iteration = iteration;
+
+	_index.push_back( entry );
+
+	_dataEnd += sizeof( header ) + header.dataSize;
+
+	writeIndex();
+
+	if( ferror( _file ) )
+	{
+		std::cerr << "Failed to write snapshot for iteration " << iteration << "!" << std::endl;
+	}
+}
+
+//============================================================================
+bool TimeSeriesWriter::openFile (
+		unsigned int iteration
+	)
+{
+	char filename[32];
+	sprintf( filename, "output/series_%05d.nts", iteration );
+
+	_file = fopen( filename, "wb" );
+
+	if( !_file )
+	{
+		std::cerr << "Failed to open series file \"" << filename << "\" for writing! (Does the directory exist?)" << std::endl;
+		return false;
+	}
+
+	SeriesFileHeader header;
+	memset( &header, 0, sizeof( header ) );
+
+	memcpy( header.magic, SERIES_MAGIC, sizeof( header.magic ) );
+	header.version   = SERIES_VERSION;
+	header.byteOrder = SERIES_BYTE_ORDER;
+	header.realSize  = sizeof( REAL );
+	header.nx        = _parameters->nx;
+	header.ny        = _parameters->ny;
+	header.dx        = _parameters->dx;
+	header.dy        = _parameters->dy;
+
+	fwrite( &header, sizeof( header ), 1, _file );
+
+	_dataEnd = sizeof( header );
+	_index.clear();
+
+	writeIndex();
+
+	return true;
+}
+
+//============================================================================
+void TimeSeriesWriter::writeIndex ( )
+{
+	SeriesFooter footer;
+	memset( &footer, 0, sizeof( footer ) );
+
+	footer.indexOffset = _dataEnd;
+	footer.numSteps    = _index.size();
+	strncpy( footer.magic, SERIES_INDEX_MAGIC, sizeof( footer.magic ) );
+
+	fseeko( _file, _dataEnd, SEEK_SET );
+
+	if( !_index.empty() )
+	{
+		fwrite( &_index[0], sizeof( SeriesIndexEntry ), _index.size(), _file );
+	}
+
+	fwrite( &footer, sizeof( footer ), 1, _file );
+
+	// make the snapshot visible to readers
+	fflush( _file );
+}
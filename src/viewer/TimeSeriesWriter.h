@@ -0,0 +1,119 @@
+#ifndef TIMESERIESWRITER_H
+#define TIMESERIESWRITER_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "VTKWriter.h"
+#include "TimeSeries.h"
+#include "FieldCompressor.h"
+#include <stdio.h>
+#include <vector>
+
+//====================================================================
+/*! \class TimeSeriesWriter
+	\brief Class for writing all snapshots of a simulation to a
+	single chunked file with an index
+
+	See TimeSeries.h for the file layout. Files are written to
+	output/series_<first iteration>.nts and can be read with the
+	TimeSeriesReader.
+
+	If parameters->compressionMode is set, the fields are stored
+	with error bounded lossy compression.
+*/
+//====================================================================
+
+class TimeSeriesWriter : public VTKWriter
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		FILE*							_file;		//! series file, opened with the first snapshot
+		std::vector<SeriesIndexEntry>	_index;		//! index of all written snapshots
+		quint64							_dataEnd;	//! file position after the last chunk
+
+		FieldCompressor					_compressor;	//! lossy compression of the fields
+		std::vector<char>				_compressed;	//! compressed fields of the current snapshot
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+
+		TimeSeriesWriter ( Parameters* parameters );
+
+		~TimeSeriesWriter ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	initialization
+		// -------------------------------------------------
+			//! @name initialisation
+			//! @{
+
+			//! \brief flushes the series file
+
+		void finalize ( );
+
+			//! @}
+
+		// -------------------------------------------------
+		//	visualization
+		// -------------------------------------------------
+			//! @name visualization
+			//! @{
+
+			//! \brief appends a snapshot to the series file
+			//! \param pointer to horizontal velocity components (host memory)
+			//! \param pointer to vertical velocity components (host memory)
+			//! \param pointer to pressure components (host memory)
+			//! \param simulated time
+			//! \param time step size of the snapshot
+			//! \param number of the current iteration
+
+		void renderFrame
+			(
+				REAL** U,
+				REAL** V,
+				REAL** P,
+				double time,
+				double dt,
+				unsigned int iteration
+			);
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	auxiliary functions
+		// -------------------------------------------------
+			//! @name auxiliary functions
+			//! @{
+
+			//! \brief creates the series file and writes the file header
+			//! \param iteration of the first snapshot, used for the file name
+			//! \returns true if the file was created
+
+		bool openFile ( unsigned int iteration );
+
+			//! \brief writes index and footer after the last chunk
+
+		void writeIndex ( );
+
+			//! @}
+};
+
+#endif // TIMESERIESWRITER_H
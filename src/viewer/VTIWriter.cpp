@@ -0,0 +1,228 @@
+#include "VTIWriter.h"
+
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+// uncompressed size of a compressed block, VTK readers handle any size
+#define VTI_BLOCK_SIZE 65536
+
+//============================================================================
+VTIWriter::VTIWriter
+	(
+		Parameters* parameters
+	) :
+	VTKWriter( parameters )
+{
+	_compress = parameters->VTKFormat == VTK_XML_ZLIB;
+}
+
+//============================================================================
+void VTIWriter::writeFile (
+		REAL** U,
+		REAL** V,
+		REAL** P,
+		unsigned int iteration
+	)
+{
+	// www.vtk.org/VTK/img/file-formats.pdf‎
+
+	int nx = _parameters->nx;
+	int ny = _parameters->ny;
+
+	int nx1 = nx + 1,
+		ny1 = ny + 1;
+
+	//-----------------------
+	// prepare data arrays
+	//-----------------------
+
+	// U and V are located on cell borders
+	// => interpolate velocity on grid points
+
+	_velocity.resize( 3 * nx1 * ny1 );
+
+	float* velocity = &_velocity[0];
+
+	for( int y = 0; y < ny1; ++y )
+	{
+		for( int x = 0; x < nx1; ++x )
+		{
+			*velocity++ = ( U[y][x] + U[y+1][x] ) * 0.5;
+			*velocity++ = ( V[y][x] + V[y][x+1] ) * 0.5;
+			*velocity++ = 0.0;
+		}
+	}
+
+	_pressure.resize( nx * ny );
+
+	for( int y = 1; y < ny1; ++y )
+	{
+		for( int x = 1; x < nx1; ++x )
+		{
+			_pressure[ ( y - 1 ) * nx + x - 1 ] = P[y][x];
+		}
+	}
+
+	unsigned int velocityOffset, pressureOffset;
+
+	// the compressor is given for the whole file, so a failed
+	// compression falls back to raw data for all arrays
+	bool compress = _compress;
+
+	_appended.clear();
+
+	if( compress &&
+		(	!appendArray( (const char*)&_velocity[0], _velocity.size() * sizeof( float ), true, &velocityOffset ) ||
+			!appendArray( (const char*)&_pressure[0], _pressure.size() * sizeof( float ), true, &pressureOffset ) ) )
+	{
+		std::cerr << "Writing uncompressed vti data for iteration " << iteration << "." << std::endl;
+
+		compress = false;
+		_appended.clear();
+	}
+
+	if( !compress )
+	{
+		appendArray( (const char*)&_velocity[0], _velocity.size() * sizeof( float ), false, &velocityOffset );
+		appendArray( (const char*)&_pressure[0], _pressure.size() * sizeof( float ), false, &pressureOffset );
+	}
+
+	//-----------------------
+	// open file
+	//-----------------------
+
+	char filename[32];
+	sprintf( filename, "output/it_%05d.vti", iteration );
+
+	std::ofstream vti ( filename, std::ios::out | std::ios::binary );
+
+	if ( !vti.is_open() )
+	{
+		std::cerr << "Failed to open vtk file \"" << filename << "\" for writing! (Does the directory exist?)" << std::endl;
+		return;
+	}
+
+	//-----------------------
+	// write xml header
+	//-----------------------
+
+	int  endianTest   = 1;
+	bool littleEndian = *(char*)&endianTest == 1;
+
+	vti << "<?xml version=\"1.0\"?>\n"
+		<< "<VTKFile type=\"ImageData\" version=\"0.1\" byte_order=\""
+		<< ( littleEndian ? "LittleEndian" : "BigEndian" ) << "\""
+		<< ( compress ? " compressor=\"vtkZLibDataCompressor\"" : "" ) << ">\n"
+
+		<< "  <ImageData WholeExtent=\"0 " << nx << " 0 " << ny << " 0 0\" "
+		<< "Origin=\"0 0 0\" "
+		<< "Spacing=\"" << _parameters->dx << " " << _parameters->dy << " 1\">\n"
+
+		<< "    <Piece Extent=\"0 " << nx << " 0 " << ny << " 0 0\">\n"
+
+		<< "      <PointData Vectors=\"velocity\">\n"
+		<< "        <DataArray type=\"Float32\" Name=\"velocity\" NumberOfComponents=\"3\" "
+		<< "format=\"appended\" offset=\"" << velocityOffset << "\"/>\n"
+		<< "      </PointData>\n"
+
+		<< "      <CellData Scalars=\"pressure\">\n"
+		<< "        <DataArray type=\"Float32\" Name=\"pressure\" "
+		<< "format=\"appended\" offset=\"" << pressureOffset << "\"/>\n"
+		<< "      </CellData>\n"
+
+		<< "    </Piece>\n"
+		<< "  </ImageData>\n"
+		<< "  <AppendedData encoding=\"raw\">\n"
+		<< "   _";
+
+	//-----------------------
+	// write binary data
+	//-----------------------
+
+	vti.write( &_appended[0], _appended.size() );
+
+	vti << "\n  </AppendedData>\n"
+		<< "</VTKFile>\n";
+
+	vti.close();
+}
+
+//============================================================================
+bool VTIWriter::appendArray (
+		const char*   data,
+		unsigned int  size,
+		bool          compress,
+		unsigned int* offset
+	)
+{
+	*offset = _appended.size();
+
+	if( !compress )
+	{
+		// raw data is preceded by its size in bytes
+		_appended.resize( *offset + sizeof( unsigned int ) + size );
+
+		memcpy( &_appended[*offset], &size, sizeof( unsigned int ) );
+		memcpy( &_appended[*offset + sizeof( unsigned int )], data, size );
+
+		return true;
+	}
+
+	//-----------------------
+	// compressed data
+	//-----------------------
+
+	// header: number of blocks, uncompressed block size,
+	// uncompressed size of last block (0 if not partial),
+	// compressed size of each block. Followed by the compressed blocks.
+
+	unsigned int numBlocks = ( size + VTI_BLOCK_SIZE - 1 ) / VTI_BLOCK_SIZE;
+
+	std::vector<unsigned int> header( 3 + numBlocks );
+
+	header[0] = numBlocks;
+	header[1] = VTI_BLOCK_SIZE;
+	header[2] = size % VTI_BLOCK_SIZE;
+
+	unsigned int headerSize = header.size() * sizeof( unsigned int );
+	unsigned int position   = *offset + headerSize;
+
+	// reserve space for the worst case
+	_appended.resize( position + numBlocks * compressBound( VTI_BLOCK_SIZE ) );
+
+	for( unsigned int block = 0; block < numBlocks; ++block )
+	{
+		unsigned int blockSize = block + 1 < numBlocks || header[2] == 0
+							   ? VTI_BLOCK_SIZE
+							   : header[2];
+
+		uLongf compressedSize = _appended.size() - position;
+
+		// fastest compression level, output speed is more important than size
+		int result = compress2(
+				(Bytef*)&_appended[position],
+				&compressedSize,
+				(const Bytef*)( data + block * VTI_BLOCK_SIZE ),
+				blockSize,
+				Z_BEST_SPEED
+			);
+
+		if( result != Z_OK )
+		{
+			std::cerr << "Failed to compress vti data block (zlib error " << result << ")." << std::endl;
+			return false;
+		}
+
+		header[3 + block] = compressedSize;
+		position += compressedSize;
+	}
+
+	memcpy( &_appended[*offset], &header[0], headerSize );
+
+	_appended.resize( position );
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#ifndef VTIWRITER_H
+#define VTIWRITER_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "VTKWriter.h"
+#include <vector>
+
+//====================================================================
+/*! \class VTIWriter
+	\brief Class for writing the simulation results to file
+	in VTK XML image data format (.vti)
+
+	The regular grid is described by origin and spacing only.
+	Velocity (point data) and pressure (cell data) are stored as
+	appended binary data, either raw or zlib compressed in blocks.
+*/
+//====================================================================
+
+class VTIWriter : public VTKWriter
+{
+	protected:
+		// -------------------------------------------------
+		//	member variables
+		// -------------------------------------------------
+			//! @name member variables
+			//! @{
+
+		bool				_compress;	//! true if the data arrays are zlib compressed
+
+		// buffers are kept to avoid reallocation for each file
+		std::vector<float>	_velocity;	//! velocity interpolated on grid points
+		std::vector<float>	_pressure;	//! pressure of interior cells
+		std::vector<char>	_appended;	//! encoded data of the appended data section
+
+			//! @}
+
+	public:
+		// -------------------------------------------------
+		//	constructor / destructor
+		// -------------------------------------------------
+			//! @name constructor / destructor
+			//! @{
+
+			//! \param pointer to parameters struct
+
+		VTIWriter ( Parameters* parameters );
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	file output
+		// -------------------------------------------------
+			//! @name file output
+			//! @{
+
+			//! \brief writes a VTK XML image data file
+			//! \param pointer to horizontal velocity components (host memory)
+			//! \param pointer to vertical velocity components (host memory)
+			//! \param pointer to pressure components (host memory)
+			//! \param number of the current iteration
+
+		void writeFile
+			(
+				REAL** U,
+				REAL** V,
+				REAL** P,
+				unsigned int iteration
+			);
+
+			//! \brief appends a data array including its size header to the appended data buffer
+			//! \param pointer to the data
+			//! \param size of the data in bytes
+			//! \param true to compress the data in blocks
+			//! \param returns offset of the array in the appended data section
+			//! \returns false if the compression failed
+
+		bool appendArray
+			(
+				const char*   data,
+				unsigned int  size,
+				bool          compress,
+				unsigned int* offset
+			);
+
+			//! @}
+};
+
+#endif // VTIWRITER_H
@@ -14,27 +14,57 @@ VTKWriter::VTKWriter
 }
 
 //============================================================================
-void VTKWriter::renderFrame (
-        REAL** U,
-        REAL** V,
-        REAL** P,
-		double time,
-		unsigned int iteration
+bool VTKWriter::isOutputRequired (
+		double time
 	)
 {
-	// www.vtk.org/VTK/img/file-formats.pdf‎
-
 	if( _nextOutput > time )
-		return;
+		return false;
 
 	// determine next output time
 	_nextOutput = time + _parameters->VTKInterval;
 
+	return true;
+}
+
+//============================================================================
+double VTKWriter::getNextOutput ( )
+{
+	return _nextOutput;
+}
+
+//============================================================================
+void VTKWriter::setNextOutput (
+		double nextOutput
+	)
+{
+	_nextOutput = nextOutput;
+}
+
+//============================================================================
+void VTKWriter::renderFrame (
+        REAL** U,
+        REAL** V,
+        REAL** P,
+		double,
+		double,
+		unsigned int iteration
+	)
+{
 	std::cout << "Writing vtk file for iteration " << iteration << std::endl;
 
+	writeFile( U, V, P, iteration );
+}
 
-	// TODO: if a flow field object was used, maintaining the data arrays,
-	// pressure and velocities only had to be copied from the GPU memory if required
+//============================================================================
+void VTKWriter::writeFile (
+		REAL** U,
+		REAL** V,
+		REAL** P,
+		unsigned int iteration
+	)
+{
+	// www.vtk.org/VTK/img/file-formats.pdf‎
 
 	int nx = _parameters->nx;
 	int ny = _parameters->ny;
@@ -11,7 +11,8 @@
 //====================================================================
 /*! \class VTKWriter
 	\brief Class for writing the simulation results to file
-	in VTK format. Currently only VTK ASCII format ist supported
+	in VTK legacy ASCII format. Subclasses can provide other
+	file formats by overriding writeFile
 */
 //====================================================================
 
@@ -47,8 +48,24 @@ class VTKWriter : public Viewer
 			//! @name visualization
 			//! @{
 
+			//! \brief checks if the output interval has passed
+			//! \param simulated time
+			//! \param time step size of the snapshot
+			//! \returns true if a file has to be written
+
+		bool isOutputRequired ( double time );
+
+			//! \returns next point in simulated time to write a file at
+
+		double getNextOutput ( );
+
+			//! \brief continues the output schedule of a restored simulation
+			//! \param next point in simulated time to write a file at
+
+		void setNextOutput ( double nextOutput );
+
 			//! \brief visualizes the result of a timestep
-			//! Writes a ASCII file in VTK legacy format
+			//! Calls writeFile
 			//! \param pointer to horizontal velocity components (host memory)
 			//! \param pointer to vertical velocity components (host memory)
 			//! \param pointer to pressure components (host memory)
@@ -60,6 +77,30 @@ class VTKWriter : public Viewer
                 REAL** V,
                 REAL** P,
 				double time,
+				double dt,
+				unsigned int iteration
+			);
+
+			//! @}
+
+	protected:
+		// -------------------------------------------------
+		//	file output
+		// -------------------------------------------------
+			//! @name file output
+			//! @{
+
+			//! \brief writes a ASCII file in VTK legacy format
+			//! \param pointer to horizontal velocity components (host memory)
+			//! \param pointer to vertical velocity components (host memory)
+			//! \param pointer to pressure components (host memory)
+			//! \param number of the current iteration
+
+		virtual void writeFile
+			(
+				REAL** U,
+				REAL** V,
+				REAL** P,
 				unsigned int iteration
 			);
 
@@ -20,3 +20,34 @@ void Viewer::initialze ( )
 {
 
 }
+
+//============================================================================
+void Viewer::finalize ( )
+{
+
+}
+
+//============================================================================
+bool Viewer::isOutputRequired
+	(
+		double
+	)
+{
+	// render every frame by default
+	return true;
+}
+
+//============================================================================
+double Viewer::getNextOutput ( )
+{
+	return 0.0;
+}
+
+//============================================================================
+void Viewer::setNextOutput
+	(
+		double
+	)
+{
+
+}
@@ -58,6 +58,11 @@ class Viewer
 
 		virtual void initialze ( );
 
+			//! \brief handles cleanup after the last frame, if required
+			//! Called from the simulation thread when the simulation stops.
+
+		virtual void finalize ( );
+
 			//! @}
 
 		// -------------------------------------------------
@@ -66,10 +71,31 @@ class Viewer
 			//! @name visualization
 			//! @{
 
+			//! \brief checks if a frame has to be rendered at the given time
+			//! renderFrame is only called if this returns true, so viewers
+			//! with an output interval advance their schedule here.
+			//! Host copies of the fields are not required for this check.
+			//! \param simulated time
+			//! \param time step size of the snapshot
+			//! \returns true if renderFrame should be called
+
+		virtual bool isOutputRequired ( double time );
+
+			//! \brief gives the output schedule, stored in checkpoints
+			//! \returns next point in simulated time to render a frame at
+
+		virtual double getNextOutput ( );
+
+			//! \brief continues the output schedule of a restored simulation
+			//! \param next point in simulated time to render a frame at, see getNextOutput
+
+		virtual void setNextOutput ( double nextOutput );
+
 			//! \brief visualizes the result of a timestep
 			//! \param pointer to horizontal velocity components (host memory)
 			//! \param pointer to vertical velocity components (host memory)
 			//! \param pointer to pressure components (host memory)
+			//! \param simulated time
 			//! \param number of the current iteration
 			// TODO: give access to a FlowField class
 
@@ -79,6 +105,7 @@ class Viewer
 				REAL** V,
 				REAL** P,
 				double time,
+				double dt,
 				unsigned int iteration
 			) = 0;
 
@@ -0,0 +1,96 @@
+#ifndef OUTPUTSCHEDULETEST_H
+#define OUTPUTSCHEDULETEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "Test.h"
+#include "../src/viewer/RegionWriter.h"
+#include <math.h>
+#include <vector>
+
+//====================================================================
+/*! \class OutputScheduleTest
+	\brief Class for testing that a simulation restarted from a
+	checkpoint writes its outputs at the same steps as an
+	uninterrupted one
+*/
+//====================================================================
+
+class OutputScheduleTest : public Test
+{
+	public:
+		OutputScheduleTest ( std::string name ) : Test( name )
+		{
+
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			int steps = 200;
+
+			Parameters parameters;
+
+			OutputRegion region;
+			region.name     = "schedule";
+			region.x0       = 1;
+			region.y0       = 1;
+			region.x1       = 1;
+			region.y1       = 1;
+			region.factor   = 1;
+			region.filter   = REGION_STRIDE;
+			region.interval = 0.1;
+
+			// varying time step sizes as given by the step size control
+			std::vector<double> times( steps );
+			double time = 0.0;
+
+			for( int i = 0; i < steps; ++i )
+			{
+				time += 0.013 + 0.007 * sin( (double)i );
+				times[i] = time;
+			}
+
+			//-----------------------
+			// uninterrupted run
+			//-----------------------
+
+			std::vector<bool> outputs( steps );
+			std::vector<double> nextOutputs( steps );
+
+			RegionWriter uninterrupted( &parameters, region );
+
+			for( int i = 0; i < steps; ++i )
+			{
+				outputs[i]     = uninterrupted.isOutputRequired( times[i] );
+				nextOutputs[i] = uninterrupted.getNextOutput();
+			}
+
+			//-----------------------
+			// runs restarted after each step
+			//-----------------------
+
+			for( int checkpoint = 0; checkpoint < steps - 1; ++checkpoint )
+			{
+				// new writer as created by the restarted simulation
+				RegionWriter restarted( &parameters, region );
+				restarted.setNextOutput( nextOutputs[checkpoint] );
+
+				for( int i = checkpoint + 1; i < steps; ++i )
+				{
+					if( restarted.isOutputRequired( times[i] ) != outputs[i] )
+					{
+						std::cout << " Restart after step " << checkpoint << ": output of step " << i
+								  << " differs from the uninterrupted run" << std::endl;
+						return Error;
+					}
+				}
+			}
+
+			return Success;
+		}
+};
+
+#endif // OUTPUTSCHEDULETEST_H
@@ -57,6 +57,8 @@ class BoundaryKernelsTest : public CLTest
 
 			std::string kernelNames[] = {
 				"setBoundaryConditionsKernel",
+				"setHorizontalBoundaryConditionsKernel",
+				"setVerticalBoundaryConditionsKernel",
 				"setArbitraryBoundaryConditionsKernel",
 				// Problem specific boundary conditions
 				"setMovingLidBoundaryConditionsKernel",
@@ -88,6 +90,10 @@ class BoundaryKernelsTest : public CLTest
 			cl::Buffer U_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
 			cl::Buffer V_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
 
+			// same values for the 1D boundary kernels
+			cl::Buffer U1D_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+			cl::Buffer V1D_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
+
 
 			//-----------------------
 			// setBoundaryConditionsKernel
@@ -151,6 +157,63 @@ class BoundaryKernelsTest : public CLTest
 			}
 
 
+			//-----------------------
+			// setHorizontalBoundaryConditionsKernel, setVerticalBoundaryConditionsKernel
+			//-----------------------
+
+			// set kernel arguments
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 0, U1D_g );
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 1, V1D_g );
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 2, sizeof(int), &boundaryConditionNorth );
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 3, sizeof(int), &boundaryConditionSouth );
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 4, sizeof(int), &nx );
+			_clKernels["setHorizontalBoundaryConditionsKernel"].setArg( 5, sizeof(int), &ny );
+
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 0, U1D_g );
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 1, V1D_g );
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 2, sizeof(int), &boundaryConditionEast );
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 3, sizeof(int), &boundaryConditionWest );
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 4, sizeof(int), &nx );
+			_clKernels["setVerticalBoundaryConditionsKernel"].setArg( 5, sizeof(int), &ny );
+
+			// call kernels, horizontal boundaries first like the CPU implementation
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["setHorizontalBoundaryConditionsKernel"],
+					cl::NullRange,			// offset
+					cl::NDRange( nx ),		// global,
+					cl::NullRange			// local,
+				);
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["setVerticalBoundaryConditionsKernel"],
+					cl::NullRange,			// offset
+					cl::NDRange( ny ),		// global,
+					cl::NullRange			// local,
+				);
+
+			_clQueue.finish();
+
+			// get result
+			_clQueue.enqueueReadBuffer( U1D_g, CL_TRUE, 0, sizeof(cl_float) * size, *_U_buffer );
+			_clQueue.enqueueReadBuffer( V1D_g, CL_TRUE, 0, sizeof(cl_float) * size, *_V_buffer );
+
+			// compare results with the CPU result from above
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					if(
+							_U_h[y][x] != _U_buffer[y][x]
+							||
+							_V_h[y][x] != _V_buffer[y][x]
+						)
+					{
+						std::cout << " Kernel \"setHorizontalBoundaryConditionsKernel\" or \"setVerticalBoundaryConditionsKernel\"" << std::endl;
+						cleanup();
+						return Error;
+					}
+				}
+			}
 
 
 
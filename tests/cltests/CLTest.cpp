@@ -5,6 +5,8 @@
 
 #include "CLTest.h"
 #include <fstream>
+#include <stdlib.h>
+#include <string.h>
 
 //********************************************************************
 //**    implementation
@@ -24,7 +26,55 @@ CLTest::CLTest ( std::string name ) : Test ( name )
 	{
 		// create OpenCL platform
 		cl::Platform::get( &_clPlatforms );
-		_clPlatforms[0].getDevices( CL_DEVICE_TYPE_GPU, &_clDevices );
+
+		// device selection by the same environment variables as the simulation,
+		// so the tests can run on hosts without GPU
+		const char* env;
+
+		unsigned int platform = 0;
+		if( ( env = getenv( "FLOWSIM_CL_PLATFORM" ) ) != 0 )
+		{
+			platform = atoi( env );
+		}
+
+		std::vector<cl::Device> devices;
+
+		if( ( env = getenv( "FLOWSIM_CL_DEVICE_TYPE" ) ) != 0 )
+		{
+			cl_device_type type = CL_DEVICE_TYPE_ALL;
+
+			if( strcmp( env, "gpu" ) == 0 )
+				type = CL_DEVICE_TYPE_GPU;
+			else if( strcmp( env, "cpu" ) == 0 )
+				type = CL_DEVICE_TYPE_CPU;
+			else if( strcmp( env, "accelerator" ) == 0 )
+				type = CL_DEVICE_TYPE_ACCELERATOR;
+
+			_clPlatforms.at( platform ).getDevices( type, &devices );
+		}
+		else
+		{
+			// first GPU, any device if there is none
+			try
+			{
+				_clPlatforms.at( platform ).getDevices( CL_DEVICE_TYPE_GPU, &devices );
+			}
+			catch( cl::Error error )
+			{
+				if( error.err() != CL_DEVICE_NOT_FOUND )
+					throw error;
+
+				_clPlatforms.at( platform ).getDevices( CL_DEVICE_TYPE_ALL, &devices );
+			}
+		}
+
+		unsigned int device = 0;
+		if( ( env = getenv( "FLOWSIM_CL_DEVICE" ) ) != 0 )
+		{
+			device = atoi( env );
+		}
+
+		_clDevices = std::vector<cl::Device>( 1, devices.at( device ) );
 
 		// create context
 		_clContext = cl::Context( _clDevices );
@@ -0,0 +1,244 @@
+#ifndef CONVERGENCEKERNELTEST_H
+#define CONVERGENCEKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <math.h>
+
+//====================================================================
+/*! \class ConvergenceKernelTest
+	\brief Class for testing the kernels of the device controlled
+	pressure iteration
+*/
+//====================================================================
+
+class ConvergenceKernelTest : public CLTest
+{
+	private:
+
+		REAL** _P_h;
+		REAL** _RHS_h;
+		REAL** _P_buffer;
+
+		bool _clean;
+
+	public:
+		ConvergenceKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~ConvergenceKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _P_h );
+				freeHostMatrix( _RHS_h );
+				freeHostMatrix( _P_buffer );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			int nx = 12;	// including boundaries
+			int ny = 10;
+			int size = nx * ny;
+			int cells = ( nx - 2 ) * ( ny - 2 );
+
+			float dx2 = 0.1 * 0.1;
+			float dy2 = 0.1 * 0.1;
+			float constant_expr = 1.0 / ( 2.0 / dx2 + 2.0 / dy2 );
+			float omega = 0.0;	// 1 - omega
+			float epsilon = 0.001;
+			int boundary = 1;
+
+			std::string kernelNames[] = {
+				"gaussSeidelRedBlackControlledKernel",
+				"pressureConvergenceKernel",
+				"pressureResidualSumControlledKernel"
+			};
+			loadKernels( "pressure.cl", std::vector<std::string>(begin(kernelNames), end(kernelNames)) );
+
+			// allocate host memory
+			_P_h = allocHostMatrix( nx, ny );
+			_RHS_h = allocHostMatrix( nx, ny );
+			_P_buffer = allocHostMatrix( nx, ny );
+
+			unsigned char* FLAG_h[ny];
+			unsigned char flag_data[size];
+			FLAG_h[0] = flag_data;
+			for( int i = 1; i < ny; ++i )
+			{
+				FLAG_h[i] = flag_data + i * nx;
+			}
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_P_h[y][x]   = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_RHS_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					FLAG_h[y][x] = C_F;
+				}
+			}
+
+			// the residual is not converged at first
+			cl_float residual = 1.0 * cells;
+			cl_int control[2] = { 0, 0 };
+
+			// allocate device memory
+			cl::Buffer P_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer RHS_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_RHS_h );
+			cl::Buffer FLAG_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_char) * size, *FLAG_h );
+			cl::Buffer residual_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float), &residual );
+			cl::Buffer control_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_int) * 2, control );
+
+
+			//-----------------------
+			// pressureConvergenceKernel
+			//-----------------------
+
+			_clKernels["pressureConvergenceKernel"].setArg( 0, residual_g );
+			_clKernels["pressureConvergenceKernel"].setArg( 1, control_g );
+			_clKernels["pressureConvergenceKernel"].setArg( 3, sizeof(cl_float), &epsilon );
+			_clKernels["pressureConvergenceKernel"].setArg( 4, sizeof(int), &cells );
+
+			// residual, iterations since the last check and expected { flag, iterations } after the check
+			float checks[][4] = {
+				{ 1.0,     5, 0,  5 },	// not converged, iterations are counted
+				{ 0.00001, 3, 1,  8 },	// converged
+				{ 1.0,     4, 1,  8 }	// flag and number of iterations are kept
+			};
+
+			for( int i = 0; i < 3; ++i )
+			{
+				int iterations = checks[i][1];
+				residual = checks[i][0] * checks[i][0] * cells;
+
+				_clQueue.enqueueWriteBuffer( residual_g, CL_TRUE, 0, sizeof(cl_float), &residual );
+
+				_clKernels["pressureConvergenceKernel"].setArg( 2, sizeof(int), &iterations );
+
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["pressureConvergenceKernel"],
+						cl::NullRange,		// offset
+						cl::NDRange( 1 ),	// global
+						cl::NDRange( 1 )	// local
+					);
+
+				_clQueue.enqueueReadBuffer( control_g, CL_TRUE, 0, sizeof(cl_int) * 2, control );
+
+				if( control[0] != checks[i][2] || control[1] != checks[i][3] )
+				{
+					std::cout << " Kernel \"pressureConvergenceKernel\": check " << i << " gives { "
+							  << control[0] << ", " << control[1] << " } instead of { "
+							  << checks[i][2] << ", " << checks[i][3] << " }" << std::endl;
+					cleanup();
+					return Error;
+				}
+			}
+
+
+			//-----------------------
+			// gaussSeidelRedBlackControlledKernel
+			//-----------------------
+
+			// the flag is set now, so the sweeps must not change the pressure
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 0, P_g );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 1, FLAG_g );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 2, RHS_g );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 3, sizeof(cl_float), &dx2 );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 4, sizeof(cl_float), &dy2 );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 6, sizeof(cl_float), &constant_expr );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 7, sizeof(cl_float), &omega );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 8, sizeof(int), &nx );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 9, sizeof(int), &ny );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 10, sizeof(int), &boundary );
+			_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 11, control_g );
+
+			for( int red = 0; red < 2; ++red )
+			{
+				_clKernels["gaussSeidelRedBlackControlledKernel"].setArg( 5, sizeof(cl_int), &red );
+
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["gaussSeidelRedBlackControlledKernel"],
+						cl::NullRange,			// offset
+						cl::NDRange( nx, ny ),	// global
+						cl::NullRange			// local
+					);
+			}
+
+			_clQueue.finish();
+
+			_clQueue.enqueueReadBuffer( P_g, CL_TRUE, 0, sizeof(cl_float) * size, *_P_buffer );
+
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					if( _P_buffer[y][x] != _P_h[y][x] )
+					{
+						std::cout << " Kernel \"gaussSeidelRedBlackControlledKernel\": P changed after convergence at ("
+								  << x << "," << y << ")" << std::endl;
+						cleanup();
+						return Error;
+					}
+				}
+			}
+
+
+			//-----------------------
+			// pressureResidualSumControlledKernel
+			//-----------------------
+
+			// the residual of the last check must be kept after convergence
+			int count = 4;
+			cl_float partials[] = { 1.0, 2.0, 3.0, 4.0 };
+			cl_float previous = 0.5;
+
+			cl::Buffer partials_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * count, partials );
+
+			_clQueue.enqueueWriteBuffer( residual_g, CL_TRUE, 0, sizeof(cl_float), &previous );
+
+			_clKernels["pressureResidualSumControlledKernel"].setArg( 0, partials_g );
+			_clKernels["pressureResidualSumControlledKernel"].setArg( 1, residual_g );
+			_clKernels["pressureResidualSumControlledKernel"].setArg( 2, sizeof(cl_float) * _clWorkgroupSize, NULL );
+			_clKernels["pressureResidualSumControlledKernel"].setArg( 3, sizeof(int), &count );
+			_clKernels["pressureResidualSumControlledKernel"].setArg( 4, control_g );
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["pressureResidualSumControlledKernel"],
+					cl::NullRange,						// offset
+					cl::NDRange( _clWorkgroupSize ),	// global
+					cl::NDRange( _clWorkgroupSize )		// local
+				);
+
+			_clQueue.enqueueReadBuffer( residual_g, CL_TRUE, 0, sizeof(cl_float), &residual );
+
+			if( residual != previous )
+			{
+				std::cout << " Kernel \"pressureResidualSumControlledKernel\": residual changed after convergence: "
+						  << residual << " instead of " << previous << std::endl;
+				cleanup();
+				return Error;
+			}
+
+			cleanup();
+
+			return Success;
+		}
+};
+
+#endif // CONVERGENCEKERNELTEST_H
@@ -0,0 +1,244 @@
+#ifndef FGRHSKERNELTEST_H
+#define FGRHSKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <math.h>
+
+//====================================================================
+/*! \class FGRHSKernelTest
+	\brief Class for testing the fused F, G and right hand side kernel
+	against the separate kernels
+*/
+//====================================================================
+
+class FGRHSKernelTest : public CLTest
+{
+	private:
+
+		REAL** _U_h;
+		REAL** _V_h;
+		REAL** _buffer_separate;
+		REAL** _buffer_fused;
+
+		bool _clean;
+
+	public:
+		FGRHSKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~FGRHSKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _U_h );
+				freeHostMatrix( _V_h );
+				freeHostMatrix( _buffer_separate );
+				freeHostMatrix( _buffer_fused );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			// odd sizes, so the last work groups are only partially inside the domain
+			int nx = 45;
+			int ny = 27;
+			int size = nx * ny;
+
+			float gx = 0.1;
+			float gy = -0.3;
+
+			float dt = 0.01;
+			float re = 100;
+			float alpha = 0.9;
+			float dx = 0.1;
+			float dy = 0.12;
+
+			std::string fileNames[] = {
+				"computeFG.cl",
+				"rightHandSide.cl",
+				"computeFGRHS.cl"
+			};
+			std::string kernelNames[] = {
+				"computeF",
+				"computeG",
+				"rightHandSideKernel",
+				"computeFGRHSKernel"
+			};
+			loadKernels(
+					std::vector<std::string>(begin(fileNames), end(fileNames)),
+					std::vector<std::string>(begin(kernelNames), end(kernelNames))
+				);
+
+			// allocate host memory
+			_U_h = allocHostMatrix( nx, ny );
+			_V_h = allocHostMatrix( nx, ny );
+			_buffer_separate = allocHostMatrix( nx, ny );
+			_buffer_fused    = allocHostMatrix( nx, ny );
+
+			// create flag array with an obstacle
+			unsigned char* FLAG_h[ny];
+			unsigned char flag_data[size];
+			FLAG_h[0] = flag_data;
+			for( int i = 1; i < ny; ++i )
+			{
+				FLAG_h[i] = flag_data + i * nx;
+			}
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_U_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_V_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					FLAG_h[y][x] = ( x >= 10 && x < 20 && y >= 8 && y < 15 ) ? C_B : C_F;
+				}
+			}
+
+			// allocate device memory
+			cl::Buffer U_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+			cl::Buffer V_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
+			cl::Buffer FLAG_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_char) * size, *FLAG_h );
+
+			// F, G and RHS of both variants, initialised with the same values
+			cl::Buffer F_g[2], G_g[2], RHS_g[2];
+			for( int i = 0; i < 2; ++i )
+			{
+				F_g[i]   = cl::Buffer( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+				G_g[i]   = cl::Buffer( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
+				RHS_g[i] = cl::Buffer( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+			}
+
+
+			//-----------------------
+			// separate kernels
+			//-----------------------
+
+			_clKernels["computeF"].setArg( 0,  U_g );
+			_clKernels["computeF"].setArg( 1,  V_g );
+			_clKernels["computeF"].setArg( 2,  FLAG_g );
+			_clKernels["computeF"].setArg( 3,  F_g[0] );
+			_clKernels["computeF"].setArg( 4,  sizeof(cl_float), &gx );
+			_clKernels["computeF"].setArg( 5,  sizeof(cl_float), &dt );
+			_clKernels["computeF"].setArg( 6,  sizeof(cl_float), &re );
+			_clKernels["computeF"].setArg( 7,  sizeof(cl_float), &alpha );
+			_clKernels["computeF"].setArg( 8,  sizeof(cl_float), &dx );
+			_clKernels["computeF"].setArg( 9,  sizeof(cl_float), &dy );
+			_clKernels["computeF"].setArg( 10, sizeof(int), &nx );
+			_clKernels["computeF"].setArg( 11, sizeof(int), &ny );
+
+			_clKernels["computeG"].setArg( 0,  U_g );
+			_clKernels["computeG"].setArg( 1,  V_g );
+			_clKernels["computeG"].setArg( 2,  FLAG_g );
+			_clKernels["computeG"].setArg( 3,  G_g[0] );
+			_clKernels["computeG"].setArg( 4,  sizeof(cl_float), &gy );
+			_clKernels["computeG"].setArg( 5,  sizeof(cl_float), &dt );
+			_clKernels["computeG"].setArg( 6,  sizeof(cl_float), &re );
+			_clKernels["computeG"].setArg( 7,  sizeof(cl_float), &alpha );
+			_clKernels["computeG"].setArg( 8,  sizeof(cl_float), &dx );
+			_clKernels["computeG"].setArg( 9,  sizeof(cl_float), &dy );
+			_clKernels["computeG"].setArg( 10, sizeof(int), &nx );
+			_clKernels["computeG"].setArg( 11, sizeof(int), &ny );
+
+			_clKernels["rightHandSideKernel"].setArg( 0, F_g[0] );
+			_clKernels["rightHandSideKernel"].setArg( 1, G_g[0] );
+			_clKernels["rightHandSideKernel"].setArg( 2, RHS_g[0] );
+			_clKernels["rightHandSideKernel"].setArg( 3, sizeof(cl_float), &dt );
+			_clKernels["rightHandSideKernel"].setArg( 4, sizeof(cl_float), &dx );
+			_clKernels["rightHandSideKernel"].setArg( 5, sizeof(cl_float), &dy );
+			_clKernels["rightHandSideKernel"].setArg( 6, sizeof(int), &nx );
+			_clKernels["rightHandSideKernel"].setArg( 7, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel( _clKernels["computeF"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+			_clQueue.enqueueNDRangeKernel( _clKernels["computeG"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+			_clQueue.enqueueNDRangeKernel( _clKernels["rightHandSideKernel"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+
+
+			//-----------------------
+			// computeFGRHSKernel
+			//-----------------------
+
+			int localWidth  = 8;
+			int localHeight = 4;
+
+			_clKernels["computeFGRHSKernel"].setArg( 0,  U_g );
+			_clKernels["computeFGRHSKernel"].setArg( 1,  V_g );
+			_clKernels["computeFGRHSKernel"].setArg( 2,  FLAG_g );
+			_clKernels["computeFGRHSKernel"].setArg( 3,  F_g[1] );
+			_clKernels["computeFGRHSKernel"].setArg( 4,  G_g[1] );
+			_clKernels["computeFGRHSKernel"].setArg( 5,  RHS_g[1] );
+			_clKernels["computeFGRHSKernel"].setArg( 6,  sizeof(cl_float) * ( localWidth + 1 ) * localHeight, NULL );
+			_clKernels["computeFGRHSKernel"].setArg( 7,  sizeof(cl_float) * localWidth * ( localHeight + 1 ), NULL );
+			_clKernels["computeFGRHSKernel"].setArg( 8,  sizeof(cl_float), &gx );
+			_clKernels["computeFGRHSKernel"].setArg( 9,  sizeof(cl_float), &gy );
+			_clKernels["computeFGRHSKernel"].setArg( 10, sizeof(cl_float), &dt );
+			_clKernels["computeFGRHSKernel"].setArg( 11, sizeof(cl_float), &re );
+			_clKernels["computeFGRHSKernel"].setArg( 12, sizeof(cl_float), &alpha );
+			_clKernels["computeFGRHSKernel"].setArg( 13, sizeof(cl_float), &dx );
+			_clKernels["computeFGRHSKernel"].setArg( 14, sizeof(cl_float), &dy );
+			_clKernels["computeFGRHSKernel"].setArg( 15, sizeof(int), &nx );
+			_clKernels["computeFGRHSKernel"].setArg( 16, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["computeFGRHSKernel"],
+					cl::NullRange,		// offset
+					cl::NDRange(		// global
+							( ( nx + localWidth  - 1 ) / localWidth  ) * localWidth,
+							( ( ny + localHeight - 1 ) / localHeight ) * localHeight
+						),
+					cl::NDRange( localWidth, localHeight )	// local
+				);
+
+			_clQueue.finish();
+
+
+			//-----------------------
+			// compare
+			//-----------------------
+
+			std::string names[] = { "F", "G", "RHS" };
+			cl::Buffer* separate[] = { &F_g[0], &G_g[0], &RHS_g[0] };
+			cl::Buffer* fused[]    = { &F_g[1], &G_g[1], &RHS_g[1] };
+
+			for( int i = 0; i < 3; ++i )
+			{
+				_clQueue.enqueueReadBuffer( *separate[i], CL_TRUE, 0, sizeof(cl_float) * size, *_buffer_separate );
+				_clQueue.enqueueReadBuffer( *fused[i],    CL_TRUE, 0, sizeof(cl_float) * size, *_buffer_fused );
+
+				for( int y = 0; y < ny; ++y )
+				{
+					for( int x = 0; x < nx; ++x )
+					{
+						if( _buffer_separate[y][x] != _buffer_fused[y][x] )
+						{
+							std::cout << " Kernel \"computeFGRHSKernel\": " << names[i] << " differs at ("
+									  << x << "," << y << "): " << _buffer_fused[y][x]
+									  << " instead of " << _buffer_separate[y][x] << std::endl;
+							cleanup();
+							return Error;
+						}
+					}
+				}
+			}
+
+			cleanup();
+
+			return Success;
+		}
+};
+
+#endif // FGRHSKERNELTEST_H
@@ -0,0 +1,275 @@
+#ifndef OBSTACLEKERNELTEST_H
+#define OBSTACLEKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <stdlib.h>
+#include <time.h>
+
+//====================================================================
+/*! \class ObstacleKernelTest
+	\brief Class for testing the obstacle drawing kernel against
+	the drawing on host memory
+*/
+//====================================================================
+
+class ObstacleKernelTest : public CLTest
+{
+	private:
+
+		REAL** _U_h;
+		REAL** _V_h;
+		REAL** _P_h;
+		REAL** _buffer;
+
+		bool _clean;
+
+	public:
+		ObstacleKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~ObstacleKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _U_h );
+				freeHostMatrix( _V_h );
+				freeHostMatrix( _P_h );
+				freeHostMatrix( _buffer );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			int nx = 40;	// including boundaries
+			int ny = 30;
+			int size = nx * ny;
+
+			// crossing lines in all directions, the last one is a single square
+			int lines[][4] = {
+				{  1,  1, 30, 20 },
+				{ 35,  5,  3, 25 },
+				{ 10, 27, 10,  2 },
+				{  5, 14, 36, 14 },
+				{  7,  7,  7,  7 }
+			};
+			int numLines = 5;
+
+			loadKernels( "obstacles.cl", "drawObstacleLineKernel" );
+
+			// allocate host memory
+			_U_h    = allocHostMatrix( nx, ny );
+			_V_h    = allocHostMatrix( nx, ny );
+			_P_h    = allocHostMatrix( nx, ny );
+			_buffer = allocHostMatrix( nx, ny );
+
+			// flags with domain boundaries and an obstacle
+			unsigned char* FLAG_h[ny];
+			unsigned char flag_data[size];
+			unsigned char flag_buffer[size];
+			FLAG_h[0] = flag_data;
+			for( int i = 1; i < ny; ++i )
+			{
+				FLAG_h[i] = flag_data + i * nx;
+			}
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_U_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_V_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_P_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+
+					if( x == 0 || y == 0 || x == nx - 1 || y == ny - 1 )
+						FLAG_h[y][x] = 0x0F;
+					else if( x >= 20 && x < 24 && y >= 12 && y < 15 )
+						FLAG_h[y][x] = C_B;
+					else
+						FLAG_h[y][x] = C_F;
+				}
+			}
+
+			// allocate device memory
+			cl::Buffer U_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+			cl::Buffer V_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
+			cl::Buffer P_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer FLAG_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_char) * size, *FLAG_h );
+
+			_clKernels["drawObstacleLineKernel"].setArg( 0, U_g );
+			_clKernels["drawObstacleLineKernel"].setArg( 1, V_g );
+			_clKernels["drawObstacleLineKernel"].setArg( 2, P_g );
+			_clKernels["drawObstacleLineKernel"].setArg( 3, FLAG_g );
+			_clKernels["drawObstacleLineKernel"].setArg( 8, sizeof(int), &nx );
+
+			for( int i = 0; i < numLines; ++i )
+			{
+				for( int j = 0; j < 4; ++j )
+				{
+					_clKernels["drawObstacleLineKernel"].setArg( 4 + j, sizeof(int), &lines[i][j] );
+				}
+
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["drawObstacleLineKernel"],
+						cl::NullRange,		// offset
+						cl::NDRange( 1 ),	// global
+						cl::NullRange		// local
+					);
+
+				drawObstacleLineHost( FLAG_h, lines[i][0], lines[i][1], lines[i][2], lines[i][3] );
+			}
+
+			_clQueue.finish();
+
+			// compare flags
+			_clQueue.enqueueReadBuffer( FLAG_g, CL_TRUE, 0, sizeof(cl_char) * size, flag_buffer );
+
+			for( int i = 0; i < size; ++i )
+			{
+				if( flag_buffer[i] != flag_data[i] )
+				{
+					std::cout << " Kernel \"drawObstacleLineKernel\": flag differs at (" << i % nx << "," << i / nx << "): "
+							  << (int)flag_buffer[i] << " instead of " << (int)flag_data[i] << std::endl;
+					cleanup();
+					return Error;
+				}
+			}
+
+			// compare fields
+			std::string names[] = { "U", "V", "P" };
+			cl::Buffer* device[] = { &U_g, &V_g, &P_g };
+			REAL** host[] = { _U_h, _V_h, _P_h };
+
+			for( int i = 0; i < 3; ++i )
+			{
+				_clQueue.enqueueReadBuffer( *device[i], CL_TRUE, 0, sizeof(cl_float) * size, *_buffer );
+
+				for( int y = 0; y < ny; ++y )
+				{
+					for( int x = 0; x < nx; ++x )
+					{
+						if( _buffer[y][x] != host[i][y][x] )
+						{
+							std::cout << " Kernel \"drawObstacleLineKernel\": " << names[i] << " differs at ("
+									  << x << "," << y << ")" << std::endl;
+							cleanup();
+							return Error;
+						}
+					}
+				}
+			}
+
+			cleanup();
+
+			return Success;
+		}
+
+
+
+		//============================================================================
+		// auxiliary functions
+
+		// same as the former NavierStokesGPU::drawObstacles, the obstacle map is
+		// given by the flags (fluid cells are C_F)
+		void drawObstacleLineHost
+			(
+				unsigned char** FLAG,
+				int x0,
+				int y0,
+				int x1,
+				int y1
+			)
+		{
+			int dx    = abs( x1 - x0 );
+			int dy    = abs( y1 - y0 );
+			int sx    = x0 < x1 ? 1 : -1;
+			int sy    = y0 < y1 ? 1 : -1;
+			int error = dx - dy;
+			int e2;
+
+			while( true )
+			{
+				FLAG[y0][x0] = C_B
+						+ B_N
+						+ B_S * ( y0 > 1 ? FLAG[y0-1][x0] == C_F : 1 )
+						+ B_W * ( x0 > 1 ? FLAG[y0][x0-1] == C_F : 1 )
+						+ B_E;
+
+				FLAG[y0][x0+1] = C_B
+						+ B_N
+						+ B_S * ( y0 > 1 ? FLAG[y0-1][x0+1] == C_F : 1 )
+						+ B_W
+						+ B_E * ( FLAG[y0][x0+2] == C_F );
+
+				FLAG[y0+1][x0] = C_B
+						+ B_N * ( FLAG[y0+2][x0] == C_F )
+						+ B_S
+						+ B_W * ( x0 > 1 ? FLAG[y0+1][x0-1] == C_F : 1 )
+						+ B_E;
+
+				FLAG[y0+1][x0+1] = C_B
+						+ B_N
+						+ B_S * ( FLAG[y0+2][x0+1] == C_F )
+						+ B_W
+						+ B_E * ( FLAG[y0+1][x0+2] == C_F );
+
+				REAL** fields[] = { _U_h, _V_h };
+
+				for( int i = 0; i < 2; ++i )
+				{
+					REAL** M = fields[i];
+
+					M[y0][x0] = M[y0][x0+1] = M[y0+1][x0] = M[y0+1][x0+1] = 0.0;
+
+					if( y0 > 1 )
+					{
+						M[y0-1][x0] = M[y0-1][x0+1] = 0.0;
+					}
+					M[y0+2][x0] = M[y0+2][x0+1] = 0.0;
+
+					if( x0 > 1 )
+					{
+						M[y0][x0-1] = M[y0+1][x0-1] = 0.0;
+					}
+					M[y0][x0+2] = M[y0+1][x0+2] = 0.0;
+				}
+
+				_P_h[y0][x0] = _P_h[y0][x0+1] = _P_h[y0+1][x0] = _P_h[y0+1][x0+1] = 0.0;
+
+				if( x0 == x1 && y0 == y1 )
+				{
+					break;
+				}
+
+				e2 = error * 2;
+
+				if( e2 > -dy )
+				{
+					error = error - dy;
+					x0 = x0 + sx;
+				}
+
+				if( e2 < dx )
+				{
+					error = error + dx;
+					y0 = y0 + sy;
+				}
+			}
+		}
+};
+
+#endif // OBSTACLEKERNELTEST_H
@@ -0,0 +1,192 @@
+#ifndef REGIONOUTPUTKERNELTEST_H
+#define REGIONOUTPUTKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+//====================================================================
+/*! \class RegionOutputKernelTest
+	\brief Class for testing the region output kernel
+*/
+//====================================================================
+
+class RegionOutputKernelTest : public CLTest
+{
+	private:
+
+		REAL** _U_h;
+		REAL** _V_h;
+		REAL** _P_h;
+
+		bool _clean;
+
+	public:
+		RegionOutputKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~RegionOutputKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _U_h );
+				freeHostMatrix( _V_h );
+				freeHostMatrix( _P_h );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			int nx = 20;
+			int ny = 16;
+			int size = nx * ny;
+
+			// region of interior cells, not a multiple of the factor
+			int x0 = 2, y0 = 3, x1 = 17, y1 = 13;
+			int factor = 3;
+
+			int width  = ( x1 - x0 + factor ) / factor;
+			int height = ( y1 - y0 + factor ) / factor;
+			int outputSize = 3 * width * height;
+
+			loadKernels( "regionOutput.cl", "regionOutputKernel" );
+
+			// allocate host memory
+			_U_h = allocHostMatrix( nx, ny );
+			_V_h = allocHostMatrix( nx, ny );
+			_P_h = allocHostMatrix( nx, ny );
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_U_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 -10.0;
+					_V_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 -10.0;
+					_P_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 -10.0;
+				}
+			}
+
+			// allocate device memory
+			cl::Buffer U_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_U_h );
+			cl::Buffer V_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_V_h );
+			cl::Buffer P_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer output_g( _clContext, CL_MEM_WRITE_ONLY, sizeof(cl_float) * outputSize );
+
+			std::vector<REAL> output( outputSize );
+			std::vector<REAL> reference( outputSize );
+
+			// test stride and box filter
+			for( int box = 0; box < 2; ++box )
+			{
+				// set kernel arguments
+				_clKernels["regionOutputKernel"].setArg( 0,  U_g );
+				_clKernels["regionOutputKernel"].setArg( 1,  V_g );
+				_clKernels["regionOutputKernel"].setArg( 2,  P_g );
+				_clKernels["regionOutputKernel"].setArg( 3,  output_g );
+				_clKernels["regionOutputKernel"].setArg( 4,  sizeof(int), &x0 );
+				_clKernels["regionOutputKernel"].setArg( 5,  sizeof(int), &y0 );
+				_clKernels["regionOutputKernel"].setArg( 6,  sizeof(int), &x1 );
+				_clKernels["regionOutputKernel"].setArg( 7,  sizeof(int), &y1 );
+				_clKernels["regionOutputKernel"].setArg( 8,  sizeof(int), &factor );
+				_clKernels["regionOutputKernel"].setArg( 9,  sizeof(int), &box );
+				_clKernels["regionOutputKernel"].setArg( 10, sizeof(int), &width );
+				_clKernels["regionOutputKernel"].setArg( 11, sizeof(int), &height );
+				_clKernels["regionOutputKernel"].setArg( 12, sizeof(int), &nx );
+
+				// call kernel
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["regionOutputKernel"],
+						cl::NullRange,					// offset
+						cl::NDRange( width, height ),	// global,
+						cl::NullRange					// local,
+					);
+
+				_clQueue.finish();
+
+				// get result
+				_clQueue.enqueueReadBuffer( output_g, CL_TRUE, 0, sizeof(cl_float) * outputSize, &output[0] );
+
+				// extract region on CPU
+				extractRegion( &reference[0], x0, y0, x1, y1, factor, box, width, height );
+
+				// compare results
+				for( int i = 0; i < outputSize; ++i )
+				{
+					if( fabs( output[i] - reference[i] ) > 1e-5 * ( 1.0 + fabs( reference[i] ) ) )
+					{
+						std::cout << " Kernel \"regionOutputKernel\" (" << ( box ? "box" : "stride" ) << ")";
+						cleanup();
+						return Error;
+					}
+				}
+			}
+
+			cleanup();
+
+			return Success;
+		}
+
+		//============================================================================
+		void extractRegion
+			(
+				REAL* output,
+				int x0,
+				int y0,
+				int x1,
+				int y1,
+				int factor,
+				int box,
+				int width,
+				int height
+			)
+		{
+			int size = width * height;
+
+			for( int y = 0; y < height; ++y )
+			{
+				for( int x = 0; x < width; ++x )
+				{
+					int xStart = x0 + x * factor;
+					int yStart = y0 + y * factor;
+					int xStop  = box ? std::min( xStart + factor - 1, x1 ) : xStart;
+					int yStop  = box ? std::min( yStart + factor - 1, y1 ) : yStart;
+
+					REAL u = 0.0, v = 0.0, p = 0.0;
+
+					for( int j = yStart; j <= yStop; ++j )
+					{
+						for( int i = xStart; i <= xStop; ++i )
+						{
+							u += 0.5 * ( _U_h[j][i-1] + _U_h[j][i] );
+							v += 0.5 * ( _V_h[j-1][i] + _V_h[j][i] );
+							p += _P_h[j][i];
+						}
+					}
+
+					REAL scale = 1.0 / (REAL)( ( xStop - xStart + 1 ) * ( yStop - yStart + 1 ) );
+
+					output[y * width + x]            = u * scale;
+					output[y * width + x + size]     = v * scale;
+					output[y * width + x + 2 * size] = p * scale;
+				}
+			}
+		}
+};
+
+#endif // REGIONOUTPUTKERNELTEST_H
@@ -0,0 +1,334 @@
+#ifndef SPLITPRESSUREKERNELTEST_H
+#define SPLITPRESSUREKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <math.h>
+
+//====================================================================
+/*! \class SplitPressureKernelTest
+	\brief Class for testing the pressure iteration on the split
+	red/black layout against the natural layout
+*/
+//====================================================================
+
+class SplitPressureKernelTest : public CLTest
+{
+	private:
+
+		REAL** _P_h;
+		REAL** _RHS_h;
+		REAL** _P_natural;
+		REAL** _P_split;
+
+		bool _clean;
+
+	public:
+		SplitPressureKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~SplitPressureKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _P_h );
+				freeHostMatrix( _RHS_h );
+				freeHostMatrix( _P_natural );
+				freeHostMatrix( _P_split );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			// odd width, so the rows of the two colours differ in length
+			int nx = 67;
+			int ny = 42;
+			int size = nx * ny;
+
+			int w = ( nx + 1 ) / 2;
+			int splitSize = w * ny;
+
+			int iterations = 10;
+
+			REAL dx = 0.126;
+			REAL dy = 0.131;
+
+			float dx2 = 1.0 / ( dx * dx );
+			float dy2 = 1.0 / ( dy * dy );
+			float constant_expr = 1.7 / ( 2.0 * dx2 + 2.0 * dy2 );
+			float omega = 1.0 - 1.7;
+
+			int setBoundary = 1;
+
+			std::string fileNames[] = {
+				"pressure.cl",
+				"pressureSplit.cl"
+			};
+			std::string kernelNames[] = {
+				"gaussSeidelRedBlackKernel",
+				"pressureResidualReductionKernel",
+				"splitRedBlackKernel",
+				"splitRedBlackFlagKernel",
+				"mergeRedBlackKernel",
+				"gaussSeidelRedBlackSplitKernel",
+				"pressureResidualSplitReductionKernel"
+			};
+			loadKernels(
+					std::vector<std::string>(begin(fileNames), end(fileNames)),
+					std::vector<std::string>(begin(kernelNames), end(kernelNames))
+				);
+
+			// allocate host memory
+			_P_h       = allocHostMatrix( nx, ny );
+			_RHS_h     = allocHostMatrix( nx, ny );
+			_P_natural = allocHostMatrix( nx, ny );
+			_P_split   = allocHostMatrix( nx, ny );
+
+			// create flag array with a rectangular obstacle
+			unsigned char* FLAG_h[ny];
+			unsigned char flag_data[size];
+			FLAG_h[0] = flag_data;
+			for( int i = 1; i < ny; ++i )
+			{
+				FLAG_h[i] = flag_data + i * nx;
+			}
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_P_h[y][x]   = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_RHS_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					FLAG_h[y][x] = C_F;
+				}
+			}
+
+			for( int y = 10; y < 20; ++y )
+			{
+				for( int x = 20; x < 35; ++x )
+				{
+					FLAG_h[y][x] = C_B;
+				}
+
+				FLAG_h[y][20] = B_W;
+				FLAG_h[y][34] = B_E;
+			}
+
+			for( int x = 20; x < 35; ++x )
+			{
+				FLAG_h[10][x] = B_S;
+				FLAG_h[19][x] = B_N;
+			}
+
+			FLAG_h[10][20] = B_SW;
+			FLAG_h[10][34] = B_SE;
+			FLAG_h[19][20] = B_NW;
+			FLAG_h[19][34] = B_NE;
+
+			// allocate device memory
+			cl::Buffer P_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer P_merged_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer RHS_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_RHS_h );
+			cl::Buffer FLAG_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_char) * size, *FLAG_h );
+			cl::Buffer residual_g( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) );
+			cl::Buffer residualSplit_g( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) );
+
+			// [0] black cells, [1] red cells
+			cl::Buffer P_split_g[2], RHS_split_g[2], FLAG_split_g[2];
+			for( int i = 0; i < 2; ++i )
+			{
+				P_split_g[i]    = cl::Buffer( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) * splitSize );
+				RHS_split_g[i]  = cl::Buffer( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) * splitSize );
+				FLAG_split_g[i] = cl::Buffer( _clContext, CL_MEM_READ_WRITE, sizeof(cl_char) * splitSize );
+			}
+
+
+			//-----------------------
+			// natural layout
+			//-----------------------
+
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 0, P_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 1, FLAG_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 2, RHS_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 3, sizeof(cl_float), &dx2 );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 4, sizeof(cl_float), &dy2 );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 6, sizeof(cl_float), &constant_expr );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 7, sizeof(cl_float), &omega );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 8, sizeof(int), &nx );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 9, sizeof(int), &ny );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 10, sizeof(int), &setBoundary );
+
+			for( int i = 0; i < iterations; ++i )
+			{
+				for( int red = 0; red < 2; ++red )
+				{
+					_clKernels["gaussSeidelRedBlackKernel"].setArg( 5, sizeof(cl_int), &red );
+
+					_clQueue.enqueueNDRangeKernel (
+							_clKernels["gaussSeidelRedBlackKernel"],
+							cl::NullRange,			// offset
+							cl::NDRange( nx, ny ),	// global
+							cl::NullRange			// local
+						);
+				}
+			}
+
+			// residual with a single work group
+			_clKernels["pressureResidualReductionKernel"].setArg( 0, P_g );
+			_clKernels["pressureResidualReductionKernel"].setArg( 1, RHS_g );
+			_clKernels["pressureResidualReductionKernel"].setArg( 2, FLAG_g );
+			_clKernels["pressureResidualReductionKernel"].setArg( 3, residual_g );
+			_clKernels["pressureResidualReductionKernel"].setArg( 4, sizeof(cl_float) * _clWorkgroupSize, NULL );
+			_clKernels["pressureResidualReductionKernel"].setArg( 5, sizeof(cl_float), &dx2 );
+			_clKernels["pressureResidualReductionKernel"].setArg( 6, sizeof(cl_float), &dy2 );
+			_clKernels["pressureResidualReductionKernel"].setArg( 7, sizeof(int), &nx );
+			_clKernels["pressureResidualReductionKernel"].setArg( 8, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["pressureResidualReductionKernel"],
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+
+			//-----------------------
+			// split layout
+			//-----------------------
+
+			cl::Buffer* natural[] = { &P_merged_g, &RHS_g };
+			cl::Buffer* split[]   = { P_split_g, RHS_split_g };
+
+			for( int i = 0; i < 2; ++i )
+			{
+				_clKernels["splitRedBlackKernel"].setArg( 0, *natural[i] );
+				_clKernels["splitRedBlackKernel"].setArg( 1, split[i][0] );
+				_clKernels["splitRedBlackKernel"].setArg( 2, split[i][1] );
+				_clKernels["splitRedBlackKernel"].setArg( 3, sizeof(int), &nx );
+				_clKernels["splitRedBlackKernel"].setArg( 4, sizeof(int), &ny );
+
+				_clQueue.enqueueNDRangeKernel( _clKernels["splitRedBlackKernel"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+			}
+
+			_clKernels["splitRedBlackFlagKernel"].setArg( 0, FLAG_g );
+			_clKernels["splitRedBlackFlagKernel"].setArg( 1, FLAG_split_g[0] );
+			_clKernels["splitRedBlackFlagKernel"].setArg( 2, FLAG_split_g[1] );
+			_clKernels["splitRedBlackFlagKernel"].setArg( 3, sizeof(int), &nx );
+			_clKernels["splitRedBlackFlagKernel"].setArg( 4, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel( _clKernels["splitRedBlackFlagKernel"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 0,  P_split_g[0] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 1,  P_split_g[1] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 2,  FLAG_split_g[0] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 3,  FLAG_split_g[1] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 4,  RHS_split_g[0] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 5,  RHS_split_g[1] );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 6,  sizeof(cl_float), &dx2 );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 7,  sizeof(cl_float), &dy2 );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 9,  sizeof(cl_float), &constant_expr );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 10, sizeof(cl_float), &omega );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 11, sizeof(int), &nx );
+			_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 12, sizeof(int), &ny );
+
+			for( int i = 0; i < iterations; ++i )
+			{
+				for( int red = 0; red < 2; ++red )
+				{
+					_clKernels["gaussSeidelRedBlackSplitKernel"].setArg( 8, sizeof(cl_int), &red );
+
+					_clQueue.enqueueNDRangeKernel (
+							_clKernels["gaussSeidelRedBlackSplitKernel"],
+							cl::NullRange,			// offset
+							cl::NDRange( w, ny ),	// global
+							cl::NullRange			// local
+						);
+				}
+			}
+
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 0,  P_split_g[0] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 1,  P_split_g[1] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 2,  RHS_split_g[0] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 3,  RHS_split_g[1] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 4,  FLAG_split_g[0] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 5,  FLAG_split_g[1] );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 6,  residualSplit_g );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 7,  sizeof(cl_float) * _clWorkgroupSize, NULL );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 8,  sizeof(cl_float), &dx2 );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 9,  sizeof(cl_float), &dy2 );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 10, sizeof(int), &nx );
+			_clKernels["pressureResidualSplitReductionKernel"].setArg( 11, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["pressureResidualSplitReductionKernel"],
+					cl::NullRange,
+					cl::NDRange( _clWorkgroupSize ),
+					cl::NDRange( _clWorkgroupSize )
+				);
+
+			_clKernels["mergeRedBlackKernel"].setArg( 0, P_split_g[0] );
+			_clKernels["mergeRedBlackKernel"].setArg( 1, P_split_g[1] );
+			_clKernels["mergeRedBlackKernel"].setArg( 2, P_merged_g );
+			_clKernels["mergeRedBlackKernel"].setArg( 3, sizeof(int), &nx );
+			_clKernels["mergeRedBlackKernel"].setArg( 4, sizeof(int), &ny );
+
+			_clQueue.enqueueNDRangeKernel( _clKernels["mergeRedBlackKernel"], cl::NullRange, cl::NDRange( nx, ny ), cl::NullRange );
+
+			_clQueue.finish();
+
+
+			//-----------------------
+			// compare
+			//-----------------------
+
+			_clQueue.enqueueReadBuffer( P_g,        CL_TRUE, 0, sizeof(cl_float) * size, *_P_natural );
+			_clQueue.enqueueReadBuffer( P_merged_g, CL_TRUE, 0, sizeof(cl_float) * size, *_P_split );
+
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					if( fabs( _P_split[y][x] - _P_natural[y][x] ) > 1e-4 * ( 1.0 + fabs( _P_natural[y][x] ) ) )
+					{
+						std::cout << " Kernel \"gaussSeidelRedBlackSplitKernel\" differs at (" << x << "," << y << "): "
+								  << _P_split[y][x] << " instead of " << _P_natural[y][x] << std::endl;
+						cleanup();
+						return Error;
+					}
+				}
+			}
+
+			float residualNatural, residualSplit;
+
+			_clQueue.enqueueReadBuffer( residual_g, CL_TRUE, 0, sizeof(cl_float), &residualNatural );
+			_clQueue.enqueueReadBuffer( residualSplit_g, CL_TRUE, 0, sizeof(cl_float), &residualSplit );
+
+			if( fabs( residualSplit - residualNatural ) > 1e-3 * ( 1.0 + residualNatural ) )
+			{
+				std::cout << " Kernel \"pressureResidualSplitReductionKernel\": " << residualSplit
+						  << " instead of " << residualNatural << std::endl;
+				cleanup();
+				return Error;
+			}
+
+			cleanup();
+
+			return Success;
+		}
+};
+
+#endif // SPLITPRESSUREKERNELTEST_H
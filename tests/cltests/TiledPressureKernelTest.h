@@ -0,0 +1,276 @@
+#ifndef TILEDPRESSUREKERNELTEST_H
+#define TILEDPRESSUREKERNELTEST_H
+
+//********************************************************************
+//**    includes
+//********************************************************************
+
+#include "CLTest.h"
+#include <math.h>
+#include <sys/time.h>
+
+//====================================================================
+/*! \class TiledPressureKernelTest
+	\brief Class for testing the tiled pressure iteration kernel
+	against the untiled kernels
+*/
+//====================================================================
+
+class TiledPressureKernelTest : public CLTest
+{
+	private:
+
+		REAL** _P_h;
+		REAL** _RHS_h;
+		REAL** _P_untiled;
+		REAL** _P_tiled;
+
+		bool _clean;
+
+	public:
+		TiledPressureKernelTest ( std::string name ) : CLTest( name )
+		{
+			_clean = false;
+		}
+
+		~TiledPressureKernelTest ( )
+		{
+			cleanup();
+		}
+
+		void cleanup ( )
+		{
+			if( !_clean )
+			{
+				freeHostMatrix( _P_h );
+				freeHostMatrix( _RHS_h );
+				freeHostMatrix( _P_untiled );
+				freeHostMatrix( _P_tiled );
+				_clean = true;
+			}
+		}
+
+		//============================================================================
+		ErrorCode run ( )
+		{
+			// odd sizes, so the last tiles are only partially inside the domain
+			int nx = 203;
+			int ny = 131;
+			int size = nx * ny;
+
+			int iterations = 3;		// per launch of the tiled kernel
+			int launches   = 20;	// for the timing comparison
+
+			REAL dx = 0.126;
+			REAL dy = 0.131;
+
+			float dx2 = 1.0 / ( dx * dx );
+			float dy2 = 1.0 / ( dy * dy );
+			float constant_expr = 1.7 / ( 2.0 * dx2 + 2.0 * dy2 );
+			float omega = 1.0 - 1.7;
+
+			int setBoundary = 0;	// boundary values are set by the separate kernel
+
+			std::string kernelNames[] = {
+				"gaussSeidelRedBlackKernel",
+				"pressureBoundaryConditionsKernel",
+				"gaussSeidelRedBlackTiledKernel"
+			};
+			loadKernels( "pressure.cl", std::vector<std::string>(begin(kernelNames), end(kernelNames)) );
+
+
+			// allocate host memory
+			_P_h       = allocHostMatrix( nx, ny );
+			_RHS_h     = allocHostMatrix( nx, ny );
+			_P_untiled = allocHostMatrix( nx, ny );
+			_P_tiled   = allocHostMatrix( nx, ny );
+
+			// create flag array with a rectangular obstacle
+			unsigned char* FLAG_h[ny];
+			unsigned char flag_data[size];
+			FLAG_h[0] = flag_data;
+			for( int i = 1; i < ny; ++i )
+			{
+				FLAG_h[i] = flag_data + i * nx;
+			}
+
+			// init host memory with random values between -10 and 10
+			srand ( time( NULL ) );
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					_P_h[y][x]   = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					_RHS_h[y][x] = (REAL(rand()) / REAL(RAND_MAX)) * 20.0 - 10.0;
+					FLAG_h[y][x] = C_F;
+				}
+			}
+
+			for( int y = 40; y < 60; ++y )
+			{
+				for( int x = 50; x < 80; ++x )
+				{
+					FLAG_h[y][x] = C_B;
+				}
+
+				FLAG_h[y][50] = B_W;
+				FLAG_h[y][79] = B_E;
+			}
+
+			for( int x = 50; x < 80; ++x )
+			{
+				FLAG_h[40][x] = B_S;
+				FLAG_h[59][x] = B_N;
+			}
+
+			FLAG_h[40][50] = B_SW;
+			FLAG_h[40][79] = B_SE;
+			FLAG_h[59][50] = B_NW;
+			FLAG_h[59][79] = B_NE;
+
+			// allocate device memory
+			cl::Buffer P_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer P_tiled_g( _clContext, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_P_h );
+			cl::Buffer P_out_g( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) * size );
+			cl::Buffer RHS_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_float) * size, *_RHS_h );
+			cl::Buffer FLAG_g( _clContext, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(cl_char) * size, *FLAG_h );
+
+
+			//-----------------------
+			// untiled kernels
+			//-----------------------
+
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 0, P_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 1, FLAG_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 2, RHS_g );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 3, sizeof(cl_float), &dx2 );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 4, sizeof(cl_float), &dy2 );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 6, sizeof(cl_float), &constant_expr );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 7, sizeof(cl_float), &omega );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 8, sizeof(int), &nx );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 9, sizeof(int), &ny );
+			_clKernels["gaussSeidelRedBlackKernel"].setArg( 10, sizeof(int), &setBoundary );
+
+			_clKernels["pressureBoundaryConditionsKernel"].setArg( 0, P_g );
+			_clKernels["pressureBoundaryConditionsKernel"].setArg( 1, sizeof(int), &nx );
+			_clKernels["pressureBoundaryConditionsKernel"].setArg( 2, sizeof(int), &ny );
+
+			double untiledTime = getTime();
+
+			for( int i = 0; i < launches * iterations; ++i )
+			{
+				for( int red = 0; red < 2; ++red )
+				{
+					_clKernels["gaussSeidelRedBlackKernel"].setArg( 5, sizeof(cl_int), &red );
+
+					_clQueue.enqueueNDRangeKernel (
+							_clKernels["gaussSeidelRedBlackKernel"],
+							cl::NullRange,			// offset
+							cl::NDRange( nx, ny ),	// global
+							cl::NullRange			// local
+						);
+				}
+
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["pressureBoundaryConditionsKernel"],
+						cl::NullRange,			// offset
+						cl::NDRange( nx, ny ),	// global
+						cl::NullRange			// local
+					);
+			}
+
+			_clQueue.finish();
+
+			untiledTime = getTime() - untiledTime;
+
+			_clQueue.enqueueReadBuffer( P_g, CL_TRUE, 0, sizeof(cl_float) * size, *_P_untiled );
+
+
+			//-----------------------
+			// gaussSeidelRedBlackTiledKernel
+			//-----------------------
+
+			int tileWidth  = 16;
+			int tileHeight = _clWorkgroupSize >= 256 ? 16 : _clWorkgroupSize / 16;
+
+			int halo = 3 * iterations;
+			int blockSize = ( tileWidth + 2 * halo ) * ( tileHeight + 2 * halo );
+
+			cl::NDRange local( tileWidth, tileHeight );
+			cl::NDRange global(
+					( ( nx + tileWidth  - 1 ) / tileWidth  ) * tileWidth,
+					( ( ny + tileHeight - 1 ) / tileHeight ) * tileHeight
+				);
+
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 0,  P_tiled_g );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 1,  P_out_g );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 2,  FLAG_g );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 3,  RHS_g );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 4,  sizeof(cl_float) * blockSize, NULL );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 5,  sizeof(cl_float) * blockSize, NULL );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 6,  sizeof(cl_char) * blockSize, NULL );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 7,  sizeof(cl_float), &dx2 );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 8,  sizeof(cl_float), &dy2 );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 9,  sizeof(cl_float), &constant_expr );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 10, sizeof(cl_float), &omega );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 11, sizeof(int), &iterations );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 12, sizeof(int), &nx );
+			_clKernels["gaussSeidelRedBlackTiledKernel"].setArg( 13, sizeof(int), &ny );
+
+			double tiledTime = getTime();
+
+			for( int i = 0; i < launches; ++i )
+			{
+				_clQueue.enqueueNDRangeKernel (
+						_clKernels["gaussSeidelRedBlackTiledKernel"],
+						cl::NullRange,	// offset
+						global,			// global
+						local			// local
+					);
+
+				_clQueue.enqueueCopyBuffer( P_out_g, P_tiled_g, 0, 0, sizeof(cl_float) * size );
+			}
+
+			_clQueue.finish();
+
+			tiledTime = getTime() - tiledTime;
+
+			_clQueue.enqueueReadBuffer( P_tiled_g, CL_TRUE, 0, sizeof(cl_float) * size, *_P_tiled );
+
+
+			//-----------------------
+			// compare
+			//-----------------------
+
+			for( int y = 0; y < ny; ++y )
+			{
+				for( int x = 0; x < nx; ++x )
+				{
+					if( fabs( _P_tiled[y][x] - _P_untiled[y][x] ) > 1e-4 * ( 1.0 + fabs( _P_untiled[y][x] ) ) )
+					{
+						std::cout << " Kernel \"gaussSeidelRedBlackTiledKernel\" differs at (" << x << "," << y << "): "
+								  << _P_tiled[y][x] << " instead of " << _P_untiled[y][x] << std::endl;
+						cleanup();
+						return Error;
+					}
+				}
+			}
+
+			std::cout << " (" << launches * iterations << " iterations: untiled "
+					  << untiledTime << "s, tiled " << tiledTime << "s)";
+
+			cleanup();
+
+			return Success;
+		}
+
+		//============================================================================
+		double getTime ( )
+		{
+			timeval time;
+			gettimeofday( &time, NULL );
+			return time.tv_sec + time.tv_usec * 1e-6;
+		}
+};
+
+#endif // TILEDPRESSUREKERNELTEST_H
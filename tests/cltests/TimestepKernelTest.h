@@ -45,7 +45,11 @@ class TimestepKernelTest : public CLTest
 			int ny = 512;
 			int size = nx * ny;
 
-			loadKernels( "deltaT.cl", "getUVMaximumKernel" );
+			std::string kernelNames[] = {
+				"getUVMaximumKernel",
+				"getUVMaximumFinalKernel"
+			};
+			loadKernels( "deltaT.cl", std::vector<std::string>(begin(kernelNames), end(kernelNames)) );
 
 			// allocate host memory
 			_U_h = allocHostMatrix( nx, ny );
@@ -120,6 +124,52 @@ class TimestepKernelTest : public CLTest
 				return Error;
 			}
 
+
+			//-----------------------
+			// two stage reduction with getUVMaximumFinalKernel
+			//-----------------------
+
+			int groups = 8;
+
+			cl::Buffer partials_g( _clContext, CL_MEM_READ_WRITE, sizeof(cl_float) * 2 * groups );
+
+			_clKernels["getUVMaximumKernel"].setArg( 2, partials_g );
+
+			_clKernels["getUVMaximumFinalKernel"].setArg( 0, partials_g );
+			_clKernels["getUVMaximumFinalKernel"].setArg( 1, results_g );
+			_clKernels["getUVMaximumFinalKernel"].setArg( 2, sizeof(cl_float) * _clWorkgroupSize, NULL);
+			_clKernels["getUVMaximumFinalKernel"].setArg( 3, sizeof(cl_float) * _clWorkgroupSize, NULL);
+			_clKernels["getUVMaximumFinalKernel"].setArg( 4, sizeof(int), &groups );
+
+			// call kernels
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["getUVMaximumKernel"],
+					cl::NullRange,								// offset
+					cl::NDRange( _clWorkgroupSize * groups ),	// global,
+					cl::NDRange( _clWorkgroupSize )				// local,
+				);
+
+			_clQueue.enqueueNDRangeKernel (
+					_clKernels["getUVMaximumFinalKernel"],
+					cl::NullRange,						// offset
+					cl::NDRange( _clWorkgroupSize ),	// global,
+					cl::NDRange( _clWorkgroupSize )		// local,
+				);
+
+			_clQueue.finish();
+
+			results[0] = results[1] = 0.0;
+			_clQueue.enqueueReadBuffer( results_g, CL_TRUE, 0, sizeof(cl_float) * 2, results );
+
+			// check result
+			if( results[0] != max_u || results[1] != max_v )
+			{
+				std::cout << " Kernel \"getUVMaximumFinalKernel\"" << std::endl;
+				std::cout << "CPU: " << max_u << "\t" << max_v << std::endl;
+				std::cout << "GPU: " << results[0] << "\t" << results[1] << std::endl;
+				return Error;
+			}
+
 			freeHostMatrix( _U_h );
 			freeHostMatrix( _V_h );
 			_clean = true;
@@ -15,6 +15,13 @@
 #include "cltests/RHSKernelTest.h"
 #include "cltests/PressureEquationKernelTest.h"
 #include "cltests/UpdateUVKernelTest.h"
+#include "cltests/RegionOutputKernelTest.h"
+#include "cltests/TiledPressureKernelTest.h"
+#include "cltests/FGRHSKernelTest.h"
+#include "cltests/SplitPressureKernelTest.h"
+#include "cltests/ObstacleKernelTest.h"
+#include "cltests/ConvergenceKernelTest.h"
+#include "OutputScheduleTest.h"
 
 //********************************************************************
 //**    implementation
@@ -36,6 +43,13 @@ int main ( int argc, char *argv[] )
 	tests.push_back( new RHSKernelTest("Right hand side kernel test") );
 	tests.push_back( new PressureEquationKernelTest("Pressure equation test") );
 	tests.push_back( new UpdateUVKernelTest("UV update kernel test") );
+	tests.push_back( new RegionOutputKernelTest("Region output kernel test") );
+	tests.push_back( new TiledPressureKernelTest("Tiled pressure iteration test") );
+	tests.push_back( new FGRHSKernelTest("Fused F, G and RHS kernel test") );
+	tests.push_back( new SplitPressureKernelTest("Split red/black pressure iteration test") );
+	tests.push_back( new ObstacleKernelTest("Obstacle drawing kernel test") );
+	tests.push_back( new ConvergenceKernelTest("Device controlled pressure iteration test") );
+	tests.push_back( new OutputScheduleTest("Output schedule after restart test") );
 
 	unsigned int size = tests.size();
 
@@ -9,10 +9,12 @@ LIBS+= -lOpenCL
 SOURCES += \
 	test_main.cpp \
 	Test.cpp \
-	cltests/CLTest.cpp
+	cltests/CLTest.cpp \
+	../src/viewer/RegionWriter.cpp
 
 HEADERS += \
 	Test.h \
+	OutputScheduleTest.h \
 	cltests/AuxiliaryKernelsTest.h \
 	cltests/CLTest.h \
     cltests/TimestepKernelTest.h \
@@ -20,4 +22,10 @@ HEADERS += \
     cltests/FGKernelsTest.h \
     cltests/RHSKernelTest.h \
     cltests/UpdateUVKernelTest.h \
-    cltests/PressureEquationKernelTest.h
+    cltests/PressureEquationKernelTest.h \
+    cltests/RegionOutputKernelTest.h \
+    cltests/TiledPressureKernelTest.h \
+    cltests/FGRHSKernelTest.h \
+    cltests/SplitPressureKernelTest.h \
+    cltests/ObstacleKernelTest.h \
+    cltests/ConvergenceKernelTest.h